@@ -0,0 +1,30 @@
+QT       += core network
+QT       -= gui
+
+TARGET = bookmall-bench
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+SOURCES += \
+    main.cpp \
+    latencyhistogram.cpp \
+    scenario.cpp \
+    benchconnection.cpp \
+    benchrunner.cpp \
+    capturefile.cpp \
+    replayconnection.cpp \
+    replayrunner.cpp
+
+HEADERS += \
+    latencyhistogram.h \
+    scenario.h \
+    benchconnection.h \
+    benchrunner.h \
+    capturefile.h \
+    replayconnection.h \
+    replayrunner.h
+
+DISTFILES += \
+    scenarios/default.json
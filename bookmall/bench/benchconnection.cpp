@@ -0,0 +1,235 @@
+#include "benchconnection.h"
+#include <QDataStream>
+#include <QJsonDocument>
+#include <QJsonArray>
+
+BenchConnection::BenchConnection(int id, const Scenario& scenario, const QElapsedTimer& clock,
+                                 qint64 intervalUs, QObject* parent)
+    : QObject(parent), m_id(id), m_scenario(scenario), m_clock(clock),
+      m_intervalUs(intervalUs), m_nextSendAtUs(0), m_inflightStartUs(0),
+      m_inflight(nullptr), m_running(false), m_seq(0),
+      m_rng(quint32(QRandomGenerator::global()->generate() ^ quint32(id)))
+{
+    m_socket = new QTcpSocket(this);
+    m_socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    m_sendTimer = new QTimer(this);
+    m_sendTimer->setSingleShot(true);
+    m_sendTimer->setTimerType(Qt::PreciseTimer);
+    m_timeoutTimer = new QTimer(this);
+    m_timeoutTimer->setSingleShot(true);
+
+    connect(m_socket, &QTcpSocket::connected, this, &BenchConnection::onConnected);
+    connect(m_socket, &QTcpSocket::readyRead, this, &BenchConnection::onReadyRead);
+    connect(m_socket, QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::error),
+            this, &BenchConnection::onSocketError);
+    connect(m_sendTimer, &QTimer::timeout, this, &BenchConnection::sendNext);
+    connect(m_timeoutTimer, &QTimer::timeout, this, &BenchConnection::onRequestTimeout);
+}
+
+void BenchConnection::start()
+{
+    m_running = true;
+    m_socket->connectToHost(m_scenario.host, m_scenario.port);
+}
+
+void BenchConnection::stop()
+{
+    m_running = false;
+    m_sendTimer->stop();
+    m_timeoutTimer->stop();
+    m_inflight = nullptr;
+    m_socket->abort();
+}
+
+void BenchConnection::onConnected()
+{
+    m_recvBuffer.clear();
+    m_inflight = nullptr;
+    // 开环模式下随机错开各连接的首次发送时间，避免所有连接同时发包
+    m_nextSendAtUs = nowUs();
+    if (m_intervalUs > 0) {
+        m_nextSendAtUs += qint64(m_rng.bounded(quint32(qMin<qint64>(m_intervalUs, 0x7fffffff))));
+    }
+    scheduleNext();
+}
+
+void BenchConnection::scheduleNext()
+{
+    if (!m_running || m_inflight || m_socket->state() != QAbstractSocket::ConnectedState) {
+        return;
+    }
+    if (m_intervalUs <= 0) {
+        sendNext();
+        return;
+    }
+    qint64 delayUs = m_nextSendAtUs - nowUs();
+    if (delayUs <= 0) {
+        sendNext();
+    } else {
+        m_sendTimer->start(int((delayUs + 999) / 1000));
+    }
+}
+
+const BenchAction* BenchConnection::chooseAction()
+{
+    // 需要${orderId}但本连接还没有订单时重新选择；多次选不到则先执行创建订单的动作
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        const BenchAction& action = m_scenario.pickAction(m_rng);
+        if (!action.needsOrderId || !m_lastOrderId.isEmpty()) {
+            return &action;
+        }
+    }
+    for (const BenchAction& action : m_scenario.actions) {
+        if (!action.captureOrderId.isEmpty()) {
+            return &action;
+        }
+    }
+    return nullptr;
+}
+
+QString BenchConnection::fillPlaceholders(QString text)
+{
+    if (!text.contains("${")) {
+        return text;
+    }
+    auto pick = [this](const QStringList& pool) {
+        return pool.isEmpty() ? QString() : pool.at(int(m_rng.bounded(quint32(pool.size()))));
+    };
+    auto pickId = [this](const QList<int>& pool) {
+        return QString::number(pool.at(int(m_rng.bounded(quint32(pool.size())))));
+    };
+    text.replace("${userId}", pickId(m_scenario.userIds));
+    text.replace("${sellerId}", pickId(m_scenario.sellerIds));
+    text.replace("${bookId}", pick(m_scenario.bookIds));
+    text.replace("${keyword}", pick(m_scenario.keywords));
+    text.replace("${orderId}", m_lastOrderId);
+    text.replace("${seq}", QString("%1_%2").arg(m_id).arg(m_seq));
+    return text;
+}
+
+QJsonValue BenchConnection::fillTemplate(const QJsonValue& value)
+{
+    if (value.isString()) {
+        return fillPlaceholders(value.toString());
+    }
+    if (value.isArray()) {
+        QJsonArray array;
+        for (const QJsonValue& item : value.toArray()) {
+            array.append(fillTemplate(item));
+        }
+        return array;
+    }
+    if (value.isObject()) {
+        QJsonObject obj = value.toObject();
+        for (auto it = obj.begin(); it != obj.end(); ++it) {
+            it.value() = fillTemplate(it.value());
+        }
+        return obj;
+    }
+    return value;
+}
+
+void BenchConnection::sendNext()
+{
+    if (!m_running || m_inflight) {
+        return;
+    }
+    const BenchAction* action = chooseAction();
+    if (!action) {
+        return;
+    }
+
+    ++m_seq;
+    QJsonObject request = fillTemplate(action->request).toObject();
+    QByteArray payload = QJsonDocument(request).toJson(QJsonDocument::Compact);
+
+    // 长度前缀协议：4字节大端长度 + JSON
+    QByteArray frame;
+    QDataStream ds(&frame, QIODevice::WriteOnly);
+    ds.setByteOrder(QDataStream::BigEndian);
+    ds << quint32(payload.size());
+    frame.append(payload);
+
+    m_inflight = action;
+    m_inflightStartUs = m_intervalUs > 0 ? m_nextSendAtUs : nowUs();
+    if (m_intervalUs > 0) {
+        m_nextSendAtUs += m_intervalUs;
+    }
+    m_socket->write(frame);
+    m_timeoutTimer->start(m_scenario.timeoutMs);
+}
+
+void BenchConnection::onReadyRead()
+{
+    m_recvBuffer += m_socket->readAll();
+
+    while (m_recvBuffer.size() >= 4) {
+        QDataStream ds(m_recvBuffer.left(4));
+        ds.setByteOrder(QDataStream::BigEndian);
+        quint32 payloadLen = 0;
+        ds >> payloadLen;
+        if (m_recvBuffer.size() < 4 + int(payloadLen)) {
+            break;
+        }
+        QByteArray payload = m_recvBuffer.mid(4, payloadLen);
+        m_recvBuffer.remove(0, 4 + int(payloadLen));
+
+        if (!m_inflight) {
+            continue;  // 超时后迟到的响应，忽略
+        }
+        const qint64 latencyUs = nowUs() - m_inflightStartUs;
+        const BenchAction* action = m_inflight;
+        m_inflight = nullptr;
+        m_timeoutTimer->stop();
+
+        QJsonObject response = QJsonDocument::fromJson(payload).object();
+        const bool success = response.value("success").toBool();
+        if (success && !action->captureOrderId.isEmpty()) {
+            QString orderId = response.value(action->captureOrderId).toString();
+            if (!orderId.isEmpty()) {
+                m_lastOrderId = orderId;
+            }
+        }
+        emit requestFinished(action->name, latencyUs, success, false);
+    }
+    scheduleNext();
+}
+
+void BenchConnection::onRequestTimeout()
+{
+    if (!m_inflight) {
+        return;
+    }
+    const BenchAction* action = m_inflight;
+    m_inflight = nullptr;
+    emit requestFinished(action->name, nowUs() - m_inflightStartUs, false, true);
+
+    // 超时后连接上的响应顺序已不可信，重建连接
+    m_socket->abort();
+    if (m_running) {
+        m_socket->connectToHost(m_scenario.host, m_scenario.port);
+    }
+}
+
+void BenchConnection::onSocketError(QAbstractSocket::SocketError error)
+{
+    Q_UNUSED(error);
+    if (!m_running) {
+        return;
+    }
+    m_sendTimer->stop();
+    m_timeoutTimer->stop();
+    if (m_inflight) {
+        const BenchAction* action = m_inflight;
+        m_inflight = nullptr;
+        emit requestFinished(action->name, nowUs() - m_inflightStartUs, false, false);
+    }
+    emit connectionFailed(m_id, m_socket->errorString());
+
+    // 1秒后重连
+    QTimer::singleShot(1000, this, [this]() {
+        if (m_running && m_socket->state() == QAbstractSocket::UnconnectedState) {
+            m_socket->connectToHost(m_scenario.host, m_scenario.port);
+        }
+    });
+}
@@ -0,0 +1,64 @@
+#ifndef BENCHCONNECTION_H
+#define BENCHCONNECTION_H
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include "scenario.h"
+
+/**
+ * @brief 单个压测连接：异步收发长度前缀JSON帧，按场景权重循环发送请求
+ * @note 开环模式（intervalUs > 0）下延迟从"计划发送时间"开始计算，
+ *       服务器变慢导致的排队时间也会计入延迟，避免协调遗漏（coordinated omission）
+ */
+class BenchConnection : public QObject
+{
+    Q_OBJECT
+public:
+    BenchConnection(int id, const Scenario& scenario, const QElapsedTimer& clock,
+                    qint64 intervalUs, QObject* parent = nullptr);
+
+    void start();  // 连接服务器并开始发送
+    void stop();   // 停止发送并断开连接
+
+signals:
+    // 一个请求完成（成功、业务失败或超时）
+    void requestFinished(const QString& actionName, qint64 latencyUs, bool success, bool timedOut);
+    void connectionFailed(int id, const QString& error);
+
+private slots:
+    void onConnected();
+    void onReadyRead();
+    void onSocketError(QAbstractSocket::SocketError error);
+    void onRequestTimeout();
+
+private:
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+    void scheduleNext();
+    void sendNext();
+    const BenchAction* chooseAction();
+    QJsonValue fillTemplate(const QJsonValue& value);
+    QString fillPlaceholders(QString text);
+
+    int m_id;
+    const Scenario& m_scenario;
+    const QElapsedTimer& m_clock;
+    qint64 m_intervalUs;        // 开环模式下本连接的发送间隔，0为闭环
+    qint64 m_nextSendAtUs;      // 下一个请求的计划发送时间
+    qint64 m_inflightStartUs;   // 当前请求的计时起点
+    const BenchAction* m_inflight;
+    bool m_running;
+    quint64 m_seq;
+    QString m_lastOrderId;      // 本连接最近一次创建的订单，供${orderId}使用
+
+    QTcpSocket* m_socket;
+    QTimer* m_sendTimer;
+    QTimer* m_timeoutTimer;
+    QByteArray m_recvBuffer;
+    QRandomGenerator m_rng;
+};
+
+#endif // BENCHCONNECTION_H
@@ -0,0 +1,183 @@
+#include "benchrunner.h"
+#include "benchconnection.h"
+#include <QTcpSocket>
+#include <QTimer>
+#include <QDataStream>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDateTime>
+#include <QTextStream>
+
+BenchRunner::BenchRunner(Scenario scenario, QObject* parent)
+    : QObject(parent), m_scenario(scenario), m_measuring(false),
+      m_measureStartUs(0), m_measureEndUs(0), m_connectErrors(0)
+{
+}
+
+bool BenchRunner::primeBookIds(QString* error)
+{
+    if (!m_scenario.bookIds.isEmpty()) {
+        return true;
+    }
+
+    QTcpSocket socket;
+    socket.connectToHost(m_scenario.host, m_scenario.port);
+    if (!socket.waitForConnected(m_scenario.timeoutMs)) {
+        if (error) *error = "连接服务器失败：" + socket.errorString();
+        return false;
+    }
+
+    QByteArray payload = QJsonDocument(QJsonObject{{"action", "getAllBooks"}}).toJson(QJsonDocument::Compact);
+    QByteArray frame;
+    QDataStream ds(&frame, QIODevice::WriteOnly);
+    ds.setByteOrder(QDataStream::BigEndian);
+    ds << quint32(payload.size());
+    frame.append(payload);
+    socket.write(frame);
+
+    QByteArray buffer;
+    quint32 payloadLen = 0;
+    while (true) {
+        if (!socket.waitForReadyRead(m_scenario.timeoutMs)) {
+            if (error) *error = "获取图书列表超时";
+            return false;
+        }
+        buffer += socket.readAll();
+        if (buffer.size() < 4) {
+            continue;
+        }
+        QDataStream lenStream(buffer.left(4));
+        lenStream.setByteOrder(QDataStream::BigEndian);
+        lenStream >> payloadLen;
+        if (buffer.size() >= 4 + int(payloadLen)) {
+            break;
+        }
+    }
+
+    QJsonObject response = QJsonDocument::fromJson(buffer.mid(4, payloadLen)).object();
+    for (const QJsonValue& value : response.value("books").toArray()) {
+        QString bookId = value.toObject().value("bookId").toString();
+        if (!bookId.isEmpty()) {
+            m_scenario.bookIds.append(bookId);
+        }
+    }
+    if (m_scenario.bookIds.isEmpty()) {
+        if (error) *error = "服务器没有可用图书，请在场景文件中指定bookIds";
+        return false;
+    }
+    return true;
+}
+
+void BenchRunner::start()
+{
+    m_clock.start();
+
+    // 开环模式：把全局速率均分到每个连接
+    qint64 intervalUs = 0;
+    if (m_scenario.ratePerSec > 0) {
+        intervalUs = qint64(1000000.0 * m_scenario.connections / m_scenario.ratePerSec);
+    }
+
+    for (int i = 0; i < m_scenario.connections; ++i) {
+        BenchConnection* connection = new BenchConnection(i, m_scenario, m_clock, intervalUs, this);
+        connect(connection, &BenchConnection::requestFinished, this, &BenchRunner::onRequestFinished);
+        connect(connection, &BenchConnection::connectionFailed, this, &BenchRunner::onConnectionFailed);
+        m_connections.append(connection);
+        connection->start();
+    }
+
+    QTextStream(stderr) << QString("压测开始：%1 个连接，预热 %2 秒，计时 %3 秒，目标速率 %4\n")
+                           .arg(m_scenario.connections).arg(m_scenario.warmupSec).arg(m_scenario.durationSec)
+                           .arg(m_scenario.ratePerSec > 0 ? QString::number(m_scenario.ratePerSec) + " req/s" : QString("不限（闭环）"));
+
+    if (m_scenario.warmupSec > 0) {
+        QTimer::singleShot(m_scenario.warmupSec * 1000, this, &BenchRunner::beginMeasurement);
+    } else {
+        beginMeasurement();
+    }
+}
+
+void BenchRunner::beginMeasurement()
+{
+    m_stats.clear();
+    m_connectErrors = 0;
+    m_measureStartUs = m_clock.nsecsElapsed() / 1000;
+    m_measuring = true;
+    QTimer::singleShot(m_scenario.durationSec * 1000, this, &BenchRunner::finish);
+}
+
+void BenchRunner::finish()
+{
+    m_measuring = false;
+    m_measureEndUs = m_clock.nsecsElapsed() / 1000;
+    for (BenchConnection* connection : m_connections) {
+        connection->stop();
+    }
+    emit finished();
+}
+
+void BenchRunner::onRequestFinished(const QString& actionName, qint64 latencyUs, bool success, bool timedOut)
+{
+    if (!m_measuring) {
+        return;
+    }
+    ActionStats& stats = m_stats[actionName];
+    stats.latency.record(latencyUs);
+    if (!success) {
+        ++stats.errors;
+    }
+    if (timedOut) {
+        ++stats.timeouts;
+    }
+}
+
+void BenchRunner::onConnectionFailed(int id, const QString& error)
+{
+    if (m_measuring) {
+        ++m_connectErrors;
+    }
+    QTextStream(stderr) << QString("连接 %1 出错：%2\n").arg(id).arg(error);
+}
+
+QJsonObject BenchRunner::report() const
+{
+    const double seconds = qMax<qint64>(1, m_measureEndUs - m_measureStartUs) / 1000000.0;
+
+    LatencyHistogram total;
+    quint64 totalErrors = 0;
+    quint64 totalTimeouts = 0;
+    QJsonObject actions;
+    for (auto it = m_stats.constBegin(); it != m_stats.constEnd(); ++it) {
+        const ActionStats& stats = it.value();
+        QJsonObject obj;
+        obj["count"] = double(stats.latency.count());
+        obj["errors"] = double(stats.errors);
+        obj["timeouts"] = double(stats.timeouts);
+        obj["throughput"] = stats.latency.count() / seconds;
+        obj["latencyUs"] = stats.latency.toJson();
+        actions[it.key()] = obj;
+
+        total.merge(stats.latency);
+        totalErrors += stats.errors;
+        totalTimeouts += stats.timeouts;
+    }
+
+    QJsonObject summary;
+    summary["count"] = double(total.count());
+    summary["errors"] = double(totalErrors);
+    summary["timeouts"] = double(totalTimeouts);
+    summary["connectErrors"] = double(m_connectErrors);
+    summary["throughput"] = total.count() / seconds;
+    summary["latencyUs"] = total.toJson();
+
+    QJsonObject result;
+    result["scenario"] = m_scenario.name;
+    result["server"] = QString("%1:%2").arg(m_scenario.host).arg(m_scenario.port);
+    result["connections"] = m_scenario.connections;
+    result["targetRate"] = m_scenario.ratePerSec;
+    result["durationSec"] = seconds;
+    result["finishedAt"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    result["total"] = summary;
+    result["actions"] = actions;
+    return result;
+}
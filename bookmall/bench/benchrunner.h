@@ -0,0 +1,55 @@
+#ifndef BENCHRUNNER_H
+#define BENCHRUNNER_H
+
+#include <QObject>
+#include <QMap>
+#include <QList>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include "scenario.h"
+#include "latencyhistogram.h"
+
+class BenchConnection;
+
+/**
+ * @brief 压测调度器：建立N个并发连接，执行预热和计时阶段，汇总各动作的吞吐量和延迟分位数
+ */
+class BenchRunner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BenchRunner(Scenario scenario, QObject* parent = nullptr);
+
+    // 场景未指定bookIds时，先用一个同步连接从getAllBooks取图书ID
+    bool primeBookIds(QString* error);
+    void start();
+    QJsonObject report() const;
+
+signals:
+    void finished();
+
+private slots:
+    void onRequestFinished(const QString& actionName, qint64 latencyUs, bool success, bool timedOut);
+    void onConnectionFailed(int id, const QString& error);
+
+private:
+    struct ActionStats {
+        LatencyHistogram latency;
+        quint64 errors = 0;
+        quint64 timeouts = 0;
+    };
+
+    void beginMeasurement();
+    void finish();
+
+    Scenario m_scenario;
+    QElapsedTimer m_clock;
+    QList<BenchConnection*> m_connections;
+    QMap<QString, ActionStats> m_stats;
+    bool m_measuring;
+    qint64 m_measureStartUs;
+    qint64 m_measureEndUs;
+    quint64 m_connectErrors;
+};
+
+#endif // BENCHRUNNER_H
@@ -0,0 +1,158 @@
+#include "capturefile.h"
+#include <QFile>
+#include <QDataStream>
+#include <QJsonDocument>
+#include <QMap>
+#include <QPair>
+#include <algorithm>
+
+// 与服务器 TrafficCapture 的记录类型一致
+enum {
+    RecordOpen = 1,
+    RecordRequest = 2,
+    RecordClose = 3,
+    FormatVersion = 1
+};
+
+static const quint32 kMaxBlockBytes = 64 * 1024 * 1024;
+static const quint32 kMaxPayloadBytes = 10 * 1024 * 1024;  // 与服务器单帧上限一致
+
+bool CaptureFile::load(const QString& path, QString* error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = QString("无法打开录制文件 %1：%2").arg(path, file.errorString());
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setByteOrder(QDataStream::BigEndian);
+    char magic[4];
+    quint16 version = 0;
+    quint16 reserved = 0;
+    quint64 startMsecsValue = 0;
+    if (in.readRawData(magic, 4) != 4 || QByteArray(magic, 4) != "BMCP") {
+        if (error) *error = "不是流量录制文件：" + path;
+        return false;
+    }
+    in >> version >> reserved >> startMsecsValue;
+    if (in.status() != QDataStream::Ok || version != FormatVersion) {
+        if (error) *error = QString("不支持的录制文件版本：%1").arg(version);
+        return false;
+    }
+    startMsecs = qint64(startMsecsValue);
+
+    QMap<quint32, CapturedConnection> byId;
+    qint64 firstUs = -1;
+    qint64 lastUs = 0;
+    requestCount = 0;
+
+    for (;;) {
+        quint32 blockSize = 0;
+        in >> blockSize;
+        if (in.status() != QDataStream::Ok || blockSize > kMaxBlockBytes) {
+            break;  // 文件结束或块长度损坏
+        }
+        QByteArray block(int(blockSize), Qt::Uninitialized);
+        if (in.readRawData(block.data(), block.size()) != block.size()) {
+            break;  // 末尾不完整的块（录制中断）
+        }
+        const QByteArray records = qUncompress(block);
+        if (records.isEmpty()) {
+            continue;
+        }
+
+        QDataStream rs(records);
+        rs.setByteOrder(QDataStream::BigEndian);
+        while (!rs.atEnd()) {
+            quint8 type = 0;
+            quint32 connectionId = 0;
+            quint64 timeUs = 0;
+            rs >> type >> connectionId >> timeUs;
+            if (rs.status() != QDataStream::Ok || type < RecordOpen || type > RecordClose) {
+                break;  // 未知记录类型，本块其余部分无法解析
+            }
+
+            CapturedConnection& connection = byId[connectionId];
+            connection.id = connectionId;
+            if (type == RecordOpen) {
+                connection.openUs = qint64(timeUs);
+            } else if (type == RecordClose) {
+                connection.closeUs = qint64(timeUs);
+            } else if (type == RecordRequest) {
+                CapturedRequest request;
+                quint8 flags = 0;
+                quint32 payloadSize = 0;
+                rs >> request.serviceUs >> flags >> payloadSize;
+                if (payloadSize > kMaxPayloadBytes) {
+                    break;
+                }
+                request.payload.resize(int(payloadSize));
+                rs.readRawData(request.payload.data(), request.payload.size());
+                quint16 issuedSize = 0;
+                rs >> issuedSize;
+                QByteArray issued(int(issuedSize), Qt::Uninitialized);
+                rs.readRawData(issued.data(), issued.size());
+                if (rs.status() != QDataStream::Ok) {
+                    break;
+                }
+                request.timeUs = qint64(timeUs);
+                request.success = flags & 0x01;
+                request.serverBusy = flags & 0x02;
+                request.issued = QJsonDocument::fromJson(issued).object();
+                request.action = QJsonDocument::fromJson(request.payload).object().value("action").toString();
+                if (request.action.isEmpty()) {
+                    request.action = "(invalid)";
+                }
+                connection.requests.append(request);
+                ++requestCount;
+            }
+
+            if (firstUs < 0 || qint64(timeUs) < firstUs) {
+                firstUs = qint64(timeUs);
+            }
+            lastUs = qMax(lastUs, qint64(timeUs));
+        }
+    }
+
+    connections.clear();
+    for (CapturedConnection& connection : byId) {
+        std::stable_sort(connection.requests.begin(), connection.requests.end(),
+                         [](const CapturedRequest& a, const CapturedRequest& b) { return a.timeUs < b.timeUs; });
+        if (connection.openUs < 0) {
+            connection.openUs = connection.requests.isEmpty() ? 0 : connection.requests.first().timeUs;
+        }
+        connections.append(connection);
+    }
+    std::stable_sort(connections.begin(), connections.end(),
+                     [](const CapturedConnection& a, const CapturedConnection& b) { return a.openUs < b.openUs; });
+    durationUs = firstUs < 0 ? 0 : lastUs - firstUs;
+
+    if (requestCount == 0) {
+        if (error) *error = "录制文件中没有请求：" + path;
+        return false;
+    }
+    return true;
+}
+
+int CaptureFile::peakConcurrency() const
+{
+    // 建立记为+1、断开记为-1，按时间扫描取最大值（未断开的连接持续到录制结束）
+    QList<QPair<qint64, int>> events;
+    for (const CapturedConnection& connection : connections) {
+        events.append(qMakePair(connection.openUs, 1));
+        if (connection.closeUs >= 0) {
+            events.append(qMakePair(connection.closeUs, -1));
+        }
+    }
+    std::sort(events.begin(), events.end(), [](const QPair<qint64, int>& a, const QPair<qint64, int>& b) {
+        return a.first != b.first ? a.first < b.first : a.second < b.second;  // 同一时刻先断开再建立
+    });
+    int current = 0;
+    int peak = 0;
+    for (const auto& event : events) {
+        current += event.second;
+        peak = qMax(peak, current);
+    }
+    return qMax(1, peak);
+}
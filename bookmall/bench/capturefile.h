@@ -0,0 +1,47 @@
+#ifndef CAPTUREFILE_H
+#define CAPTUREFILE_H
+
+#include <QString>
+#include <QList>
+#include <QByteArray>
+#include <QJsonObject>
+
+// 录制的一帧请求（格式见服务器 trafficcapture.h）
+struct CapturedRequest {
+    qint64 timeUs = 0;         // 服务器收到完整帧的时间（相对录制开始，微秒）
+    quint32 serviceUs = 0;     // 服务器处理耗时（从收到帧到响应发出）
+    bool success = false;
+    bool serverBusy = false;
+    QString action;
+    QByteArray payload;        // 原始请求JSON
+    QJsonObject issued;        // 响应中签发的标识（token、orderId），回放时映射为新值
+};
+
+// 录制的一个连接：建立/断开时间和按顺序的请求
+struct CapturedConnection {
+    quint32 id = 0;
+    qint64 openUs = -1;
+    qint64 closeUs = -1;       // 录制结束时仍未断开为-1
+    QList<CapturedRequest> requests;
+};
+
+/**
+ * @brief 读取服务器的流量录制文件（BOOKMALL_CAPTURE_FILE）
+ * @note 文件末尾不完整的块（服务器异常退出）会被忽略；连接按建立时间排序，
+ *       连接内的请求按收到时间排序
+ */
+class CaptureFile
+{
+public:
+    bool load(const QString& path, QString* error);
+
+    // 录制期间同时保持的最大连接数
+    int peakConcurrency() const;
+
+    qint64 startMsecs = 0;     // 录制开始时间（UTC毫秒）
+    qint64 durationUs = 0;     // 第一条到最后一条记录的时长
+    int requestCount = 0;
+    QList<CapturedConnection> connections;
+};
+
+#endif // CAPTUREFILE_H
@@ -0,0 +1,124 @@
+#include "latencyhistogram.h"
+#include <QtMath>
+
+namespace {
+const int kSubBucketBits = 7;                                // 前128个值精确记录
+const int kSubBucketCount = 1 << kSubBucketBits;             // 128
+const int kSubBucketHalf = kSubBucketCount / 2;              // 64：每个2的幂区间的子桶数
+const int kMaxValueBits = 40;                                // 上限约12天，超出的值截断
+const int kBucketCount = kSubBucketCount + (kMaxValueBits - kSubBucketBits + 1) * kSubBucketHalf;
+}
+
+LatencyHistogram::LatencyHistogram()
+    : m_buckets(kBucketCount, 0), m_count(0), m_sum(0), m_min(0), m_max(0)
+{
+}
+
+int LatencyHistogram::bucketIndex(qint64 micros)
+{
+    if (micros < 0) {
+        micros = 0;
+    }
+    const qint64 maxValue = (qint64(1) << kMaxValueBits) - 1;
+    if (micros > maxValue) {
+        micros = maxValue;
+    }
+    if (micros < kSubBucketCount) {
+        return int(micros);
+    }
+
+    int msb = kSubBucketBits;
+    while ((micros >> (msb + 1)) != 0) {
+        ++msb;
+    }
+    const int shift = msb - (kSubBucketBits - 1);            // >= 1
+    const int sub = int(micros >> shift);                    // [64, 127]
+    return kSubBucketCount + (shift - 1) * kSubBucketHalf + (sub - kSubBucketHalf);
+}
+
+qint64 LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index < kSubBucketCount) {
+        return index;
+    }
+    const int offset = index - kSubBucketCount;
+    const int shift = offset / kSubBucketHalf + 1;
+    const qint64 sub = offset % kSubBucketHalf + kSubBucketHalf;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(qint64 micros)
+{
+    if (micros < 0) {
+        micros = 0;
+    }
+    ++m_buckets[bucketIndex(micros)];
+    if (m_count == 0 || micros < m_min) {
+        m_min = micros;
+    }
+    if (micros > m_max) {
+        m_max = micros;
+    }
+    ++m_count;
+    m_sum += micros;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    if (other.m_count == 0) {
+        return;
+    }
+    for (int i = 0; i < kBucketCount; ++i) {
+        m_buckets[i] += other.m_buckets[i];
+    }
+    if (m_count == 0 || other.m_min < m_min) {
+        m_min = other.m_min;
+    }
+    m_max = qMax(m_max, other.m_max);
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+}
+
+void LatencyHistogram::reset()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+    m_sum = 0;
+    m_min = 0;
+    m_max = 0;
+}
+
+qint64 LatencyHistogram::percentile(double p) const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+    p = qBound(0.0, p, 100.0);
+    // 目标名次向上取整，至少为1
+    quint64 rank = quint64(qCeil(p / 100.0 * double(m_count)));
+    if (rank < 1) {
+        rank = 1;
+    }
+    quint64 seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        seen += m_buckets[i];
+        if (seen >= rank) {
+            return qMin(bucketUpperBound(i), m_max);
+        }
+    }
+    return m_max;
+}
+
+QJsonObject LatencyHistogram::toJson() const
+{
+    QJsonObject obj;
+    obj["count"] = double(m_count);
+    obj["min"] = double(min());
+    obj["mean"] = mean();
+    obj["p50"] = double(percentile(50.0));
+    obj["p95"] = double(percentile(95.0));
+    obj["p99"] = double(percentile(99.0));
+    obj["p999"] = double(percentile(99.9));
+    obj["max"] = double(m_max);
+    return obj;
+}
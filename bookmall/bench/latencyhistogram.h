@@ -0,0 +1,42 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <QJsonObject>
+
+/**
+ * @brief 延迟直方图（HDR风格的对数-线性分桶，单位：微秒）
+ * @note 每个2的幂区间再线性细分为64个子桶，记录误差不超过约1.6%，
+ *       内存占用固定，记录为O(1)，可直接合并后计算p50/p95/p99/p999
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void record(qint64 micros);                   // 记录一次延迟
+    void merge(const LatencyHistogram& other);    // 合并另一个直方图
+    void reset();
+
+    quint64 count() const { return m_count; }
+    qint64 min() const { return m_count ? m_min : 0; }
+    qint64 max() const { return m_max; }
+    double mean() const { return m_count ? double(m_sum) / m_count : 0.0; }
+    qint64 percentile(double p) const;            // p取值0~100
+
+    // 输出{count,min,mean,p50,p95,p99,p999,max}
+    QJsonObject toJson() const;
+
+private:
+    static int bucketIndex(qint64 micros);
+    static qint64 bucketUpperBound(int index);
+
+    QVector<quint64> m_buckets;
+    quint64 m_count;
+    qint64 m_sum;
+    qint64 m_min;
+    qint64 m_max;
+};
+
+#endif // LATENCYHISTOGRAM_H
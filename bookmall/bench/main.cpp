@@ -0,0 +1,120 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonDocument>
+#include <QTextStream>
+#include "scenario.h"
+#include "benchrunner.h"
+#include "capturefile.h"
+#include "replayrunner.h"
+
+// bookmall-bench：无界面的TCP JSON协议压测工具
+// 用法：bookmall-bench scenarios/default.json [-c 连接数] [-d 秒] [-r 速率] [-o report.json]
+//       bookmall-bench --replay capture.bmcap [--speed 1|N|max] [-o report.json]
+
+// 输出JSON报告到文件或标准输出
+static void writeReport(const QJsonObject& report, const QString& outputPath)
+{
+    QTextStream err(stderr);
+    QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (outputPath.isEmpty()) {
+        QTextStream(stdout) << json;
+    } else {
+        QFile file(outputPath);
+        if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            file.write(json);
+            err << "报告已写入 " << outputPath << "\n";
+        } else {
+            err << "无法写入报告文件：" << file.errorString() << "\n";
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("bookmall-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("图书商城服务器压测工具：按场景文件回放加权请求组合，输出吞吐量和延迟分位数(JSON)");
+    parser.addHelpOption();
+    parser.addPositionalArgument("scenario", "场景文件路径（JSON）");
+    QCommandLineOption hostOption("host", "服务器地址（覆盖场景文件）", "host");
+    QCommandLineOption portOption("port", "服务器端口（覆盖场景文件）", "port");
+    QCommandLineOption connectionsOption(QStringList() << "c" << "connections", "并发连接数", "n");
+    QCommandLineOption durationOption(QStringList() << "d" << "duration", "计时阶段时长（秒）", "sec");
+    QCommandLineOption warmupOption(QStringList() << "w" << "warmup", "预热时长（秒）", "sec");
+    QCommandLineOption rateOption(QStringList() << "r" << "rate", "全局目标速率 req/s，0为闭环", "rps");
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "报告输出文件（默认标准输出）", "file");
+    QCommandLineOption replayOption("replay", "回放服务器的流量录制文件（不使用场景文件）", "capture");
+    QCommandLineOption speedOption("speed", "回放倍速：1为原速，N为N倍速，max为不等待录制间隔", "x", "1");
+    parser.addOptions({hostOption, portOption, connectionsOption, durationOption,
+                       warmupOption, rateOption, outputOption, replayOption, speedOption});
+    parser.process(app);
+
+    QTextStream err(stderr);
+    const QString outputPath = parser.value(outputOption);
+
+    if (parser.isSet(replayOption)) {
+        CaptureFile capture;
+        QString error;
+        if (!capture.load(parser.value(replayOption), &error)) {
+            err << error << "\n";
+            return 1;
+        }
+        ReplayOptions options;
+        if (parser.isSet(hostOption)) options.host = parser.value(hostOption);
+        if (parser.isSet(portOption)) options.port = quint16(parser.value(portOption).toUInt());
+        const QString speed = parser.value(speedOption).toLower();
+        if (speed == "max") {
+            options.speed = 0.0;
+        } else {
+            bool ok = false;
+            options.speed = speed.endsWith('x') ? speed.chopped(1).toDouble(&ok) : speed.toDouble(&ok);
+            if (!ok || options.speed <= 0) {
+                err << "无效的回放速度：" << speed << "\n";
+                return 1;
+            }
+        }
+
+        ReplayRunner replay(capture, options);
+        QObject::connect(&replay, &ReplayRunner::finished, &app, [&]() {
+            writeReport(replay.report(), outputPath);
+            app.quit();
+        });
+        replay.start();
+        return app.exec();
+    }
+
+    if (parser.positionalArguments().isEmpty()) {
+        err << "缺少场景文件参数（或使用 --replay 回放录制文件）\n";
+        parser.showHelp(1);
+    }
+
+    Scenario scenario;
+    QString error;
+    if (!scenario.loadFromFile(parser.positionalArguments().first(), &error)) {
+        err << error << "\n";
+        return 1;
+    }
+    if (parser.isSet(hostOption)) scenario.host = parser.value(hostOption);
+    if (parser.isSet(portOption)) scenario.port = quint16(parser.value(portOption).toUInt());
+    if (parser.isSet(connectionsOption)) scenario.connections = qMax(1, parser.value(connectionsOption).toInt());
+    if (parser.isSet(durationOption)) scenario.durationSec = qMax(1, parser.value(durationOption).toInt());
+    if (parser.isSet(warmupOption)) scenario.warmupSec = qMax(0, parser.value(warmupOption).toInt());
+    if (parser.isSet(rateOption)) scenario.ratePerSec = qMax(0.0, parser.value(rateOption).toDouble());
+
+    BenchRunner runner(scenario);
+    if (!runner.primeBookIds(&error)) {
+        err << error << "\n";
+        return 1;
+    }
+
+    QObject::connect(&runner, &BenchRunner::finished, &app, [&]() {
+        writeReport(runner.report(), outputPath);
+        app.quit();
+    });
+
+    runner.start();
+    return app.exec();
+}
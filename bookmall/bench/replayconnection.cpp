@@ -0,0 +1,205 @@
+#include "replayconnection.h"
+#include <QDataStream>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+
+ReplayConnection::ReplayConnection(const CapturedConnection& capture, const ReplayOptions& options,
+                                   const QElapsedTimer& clock, qint64 baseUs, QHash<QString, QString>* idMap,
+                                   QObject* parent)
+    : QObject(parent), m_capture(capture), m_options(options), m_clock(clock), m_baseUs(baseUs),
+      m_idMap(idMap), m_next(0), m_inflight(false), m_sentAtUs(0), m_lagUs(0), m_finished(false)
+{
+    m_socket = new QTcpSocket(this);
+    m_socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    m_sendTimer = new QTimer(this);
+    m_sendTimer->setSingleShot(true);
+    m_sendTimer->setTimerType(Qt::PreciseTimer);
+    m_timeoutTimer = new QTimer(this);
+    m_timeoutTimer->setSingleShot(true);
+
+    connect(m_socket, &QTcpSocket::connected, this, &ReplayConnection::onConnected);
+    connect(m_socket, &QTcpSocket::readyRead, this, &ReplayConnection::onReadyRead);
+    connect(m_socket, QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::error),
+            this, &ReplayConnection::onSocketError);
+    connect(m_sendTimer, &QTimer::timeout, this, &ReplayConnection::sendNext);
+    connect(m_timeoutTimer, &QTimer::timeout, this, &ReplayConnection::onRequestTimeout);
+}
+
+void ReplayConnection::start()
+{
+    m_socket->connectToHost(m_options.host, m_options.port);
+}
+
+qint64 ReplayConnection::dueUs(qint64 captureUs) const
+{
+    if (m_options.speed <= 0) {
+        return 0;
+    }
+    return qint64((captureUs - m_baseUs) / m_options.speed);
+}
+
+void ReplayConnection::onConnected()
+{
+    m_recvBuffer.clear();
+    scheduleNext();
+}
+
+void ReplayConnection::scheduleNext()
+{
+    if (m_finished || m_inflight || m_socket->state() != QAbstractSocket::ConnectedState) {
+        return;
+    }
+
+    // 全部请求完成：倍速回放时保持连接到录制中的断开时间，最大速度时立即断开
+    if (m_next >= m_capture.requests.size()) {
+        qint64 delayUs = m_capture.closeUs >= 0 ? dueUs(m_capture.closeUs) - nowUs() : 0;
+        if (delayUs > 0) {
+            QTimer::singleShot(int((delayUs + 999) / 1000), Qt::PreciseTimer, this, &ReplayConnection::finish);
+        } else {
+            finish();
+        }
+        return;
+    }
+
+    qint64 delayUs = dueUs(m_capture.requests.at(m_next).timeUs) - nowUs();
+    if (delayUs <= 0) {
+        sendNext();
+    } else {
+        m_sendTimer->start(int((delayUs + 999) / 1000));
+    }
+}
+
+QJsonValue ReplayConnection::substituteValue(const QJsonValue& value) const
+{
+    if (value.isString()) {
+        return m_idMap->value(value.toString(), value.toString());
+    }
+    if (value.isArray()) {
+        QJsonArray array;
+        for (const QJsonValue& item : value.toArray()) {
+            array.append(substituteValue(item));
+        }
+        return array;
+    }
+    if (value.isObject()) {
+        QJsonObject obj = value.toObject();
+        for (auto it = obj.begin(); it != obj.end(); ++it) {
+            it.value() = substituteValue(it.value());
+        }
+        return obj;
+    }
+    return value;
+}
+
+QByteArray ReplayConnection::substituteIds(const QByteArray& payload) const
+{
+    if (m_idMap->isEmpty()) {
+        return payload;
+    }
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(payload, &error);
+    if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+        return payload;  // 录制的非法帧原样发送
+    }
+    return QJsonDocument(substituteValue(doc.object()).toObject()).toJson(QJsonDocument::Compact);
+}
+
+void ReplayConnection::sendNext()
+{
+    if (m_finished || m_inflight || m_next >= m_capture.requests.size()) {
+        return;
+    }
+    const CapturedRequest& request = m_capture.requests.at(m_next);
+    const QByteArray payload = substituteIds(request.payload);
+
+    // 长度前缀协议：4字节大端长度 + JSON
+    QByteArray frame;
+    QDataStream ds(&frame, QIODevice::WriteOnly);
+    ds.setByteOrder(QDataStream::BigEndian);
+    ds << quint32(payload.size());
+    frame.append(payload);
+
+    m_inflight = true;
+    m_sentAtUs = nowUs();
+    m_lagUs = m_options.speed > 0 ? qMax<qint64>(0, m_sentAtUs - dueUs(request.timeUs)) : 0;
+    m_socket->write(frame);
+    m_timeoutTimer->start(m_options.timeoutMs);
+}
+
+void ReplayConnection::onReadyRead()
+{
+    m_recvBuffer += m_socket->readAll();
+
+    while (m_recvBuffer.size() >= 4) {
+        QDataStream ds(m_recvBuffer.left(4));
+        ds.setByteOrder(QDataStream::BigEndian);
+        quint32 payloadLen = 0;
+        ds >> payloadLen;
+        if (m_recvBuffer.size() < 4 + int(payloadLen)) {
+            break;
+        }
+        QByteArray payload = m_recvBuffer.mid(4, payloadLen);
+        m_recvBuffer.remove(0, 4 + int(payloadLen));
+
+        if (!m_inflight) {
+            continue;
+        }
+        const qint64 latencyUs = nowUs() - m_sentAtUs;
+        const CapturedRequest& request = m_capture.requests.at(m_next);
+        m_inflight = false;
+        m_timeoutTimer->stop();
+        ++m_next;
+
+        QJsonObject response = QJsonDocument::fromJson(payload).object();
+        const bool success = response.value("success").toBool();
+        if (success) {
+            for (auto it = request.issued.constBegin(); it != request.issued.constEnd(); ++it) {
+                const QString replayed = response.value(it.key()).toString();
+                if (!replayed.isEmpty() && replayed != it.value().toString()) {
+                    m_idMap->insert(it.value().toString(), replayed);
+                }
+            }
+        }
+        emit requestFinished(request, latencyUs, m_lagUs, success, false);
+    }
+    scheduleNext();
+}
+
+void ReplayConnection::onRequestTimeout()
+{
+    if (!m_inflight) {
+        return;
+    }
+    // 超时后本连接的响应顺序已不可信，其余请求不再发送
+    m_inflight = false;
+    emit requestFinished(m_capture.requests.at(m_next), nowUs() - m_sentAtUs, m_lagUs, false, true);
+    ++m_next;
+    finish();
+}
+
+void ReplayConnection::onSocketError(QAbstractSocket::SocketError error)
+{
+    Q_UNUSED(error);
+    if (m_finished) {
+        return;
+    }
+    if (m_inflight) {
+        m_inflight = false;
+        emit requestFinished(m_capture.requests.at(m_next), nowUs() - m_sentAtUs, m_lagUs, false, false);
+        ++m_next;
+    }
+    finish();
+}
+
+void ReplayConnection::finish()
+{
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+    m_sendTimer->stop();
+    m_timeoutTimer->stop();
+    m_socket->abort();
+    emit finished(m_capture.id, m_capture.requests.size() - m_next);
+}
@@ -0,0 +1,76 @@
+#ifndef REPLAYCONNECTION_H
+#define REPLAYCONNECTION_H
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include "capturefile.h"
+
+// 回放参数
+struct ReplayOptions {
+    QString host = "127.0.0.1";
+    quint16 port = 8888;
+    double speed = 1.0;        // 回放倍速，0表示不等待录制间隔（最大速度）
+    int timeoutMs = 5000;      // 单个请求超时
+};
+
+/**
+ * @brief 回放一个录制连接：按录制顺序逐条发送请求，收到响应后再发下一条
+ * @note 倍速回放时第i条请求的计划发送时间为 (录制时间 - 录制起点) / speed，前一条响应未返回时顺延，
+ *       顺延量计入lagUs；延迟从实际发送开始计算。全部请求完成后保持连接到录制中的断开时间，
+ *       使服务器上同时存在的连接数与录制时一致。录制中签发的token/orderId在回放响应中
+ *       换成新值后，之后所有连接请求中的同值字符串都替换为新值。
+ */
+class ReplayConnection : public QObject
+{
+    Q_OBJECT
+public:
+    ReplayConnection(const CapturedConnection& capture, const ReplayOptions& options,
+                     const QElapsedTimer& clock, qint64 baseUs, QHash<QString, QString>* idMap,
+                     QObject* parent = nullptr);
+
+    void start();
+    quint32 captureId() const { return m_capture.id; }
+
+signals:
+    void requestFinished(const CapturedRequest& captured, qint64 latencyUs, qint64 lagUs,
+                         bool success, bool timedOut);
+    // 连接结束；skipped为因超时或连接错误未能发送的请求数
+    void finished(quint32 captureId, int skipped);
+
+private slots:
+    void onConnected();
+    void onReadyRead();
+    void onSocketError(QAbstractSocket::SocketError error);
+    void onRequestTimeout();
+
+private:
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+    qint64 dueUs(qint64 captureUs) const;
+    void scheduleNext();
+    void sendNext();
+    void finish();
+    QByteArray substituteIds(const QByteArray& payload) const;
+    QJsonValue substituteValue(const QJsonValue& value) const;
+
+    const CapturedConnection& m_capture;
+    ReplayOptions m_options;
+    const QElapsedTimer& m_clock;
+    qint64 m_baseUs;                   // 录制时间轴的起点（第一个连接建立的时间）
+    QHash<QString, QString>* m_idMap;  // 录制值 -> 回放值，各连接共用
+
+    int m_next;                        // 下一条要发送的请求
+    bool m_inflight;
+    qint64 m_sentAtUs;
+    qint64 m_lagUs;
+    bool m_finished;
+
+    QTcpSocket* m_socket;
+    QTimer* m_sendTimer;
+    QTimer* m_timeoutTimer;
+    QByteArray m_recvBuffer;
+};
+
+#endif // REPLAYCONNECTION_H
@@ -0,0 +1,165 @@
+#include "replayrunner.h"
+#include <QTimer>
+#include <QDateTime>
+#include <QTextStream>
+
+ReplayRunner::ReplayRunner(const CaptureFile& capture, const ReplayOptions& options, QObject* parent)
+    : QObject(parent), m_capture(capture), m_options(options), m_baseUs(0),
+      m_concurrencyLimit(0), m_nextIndex(0), m_active(0), m_peakActive(0),
+      m_finishedCount(0), m_skipped(0), m_endUs(0)
+{
+    if (!m_capture.connections.isEmpty()) {
+        m_baseUs = m_capture.connections.first().openUs;
+    }
+}
+
+void ReplayRunner::start()
+{
+    m_clock.start();
+    const int total = m_capture.connections.size();
+
+    if (m_options.speed > 0) {
+        // 倍速回放：每个连接在 (录制建立时间 - 起点) / speed 时建立
+        for (int i = 0; i < total; ++i) {
+            const qint64 delayUs = qint64((m_capture.connections.at(i).openUs - m_baseUs) / m_options.speed);
+            QTimer::singleShot(int(delayUs / 1000), Qt::PreciseTimer, this, [this, i]() { startConnection(i); });
+        }
+        m_nextIndex = total;
+    } else {
+        m_concurrencyLimit = m_capture.peakConcurrency();
+        while (m_nextIndex < total && m_active < m_concurrencyLimit) {
+            startConnection(m_nextIndex++);
+        }
+    }
+
+    QTextStream(stderr) << QString("回放开始：%1 个连接，%2 个请求，录制时长 %3 秒，速度 %4\n")
+                           .arg(total).arg(m_capture.requestCount)
+                           .arg(m_capture.durationUs / 1000000.0, 0, 'f', 1)
+                           .arg(m_options.speed > 0 ? QString::number(m_options.speed) + "x"
+                                                    : QString("最大（%1 个并发连接）").arg(m_concurrencyLimit));
+    if (total == 0) {
+        QTimer::singleShot(0, this, &ReplayRunner::finished);
+    }
+}
+
+void ReplayRunner::startConnection(int index)
+{
+    ReplayConnection* connection = new ReplayConnection(m_capture.connections.at(index), m_options,
+                                                        m_clock, m_baseUs, &m_idMap, this);
+    connect(connection, &ReplayConnection::requestFinished, this, &ReplayRunner::onRequestFinished);
+    connect(connection, &ReplayConnection::finished, this, &ReplayRunner::onConnectionFinished);
+    ++m_active;
+    m_peakActive = qMax(m_peakActive, m_active);
+    connection->start();
+}
+
+void ReplayRunner::onRequestFinished(const CapturedRequest& captured, qint64 latencyUs, qint64 lagUs,
+                                     bool success, bool timedOut)
+{
+    ActionStats& stats = m_stats[captured.action];
+    stats.original.record(captured.serviceUs);
+    stats.replay.record(latencyUs);
+    if (!captured.success) {
+        ++stats.originalErrors;
+    }
+    if (!success) {
+        ++stats.errors;
+    }
+    if (timedOut) {
+        ++stats.timeouts;
+    }
+    if (success != captured.success) {
+        ++stats.mismatches;
+    }
+    if (m_options.speed > 0) {
+        m_lag.record(lagUs);
+    }
+}
+
+void ReplayRunner::onConnectionFinished(quint32 captureId, int skipped)
+{
+    if (skipped > 0) {
+        m_skipped += quint64(skipped);
+        QTextStream(stderr) << QString("录制连接 %1 中断，%2 个请求未回放\n").arg(captureId).arg(skipped);
+    }
+    if (ReplayConnection* connection = qobject_cast<ReplayConnection*>(sender())) {
+        connection->deleteLater();
+    }
+    --m_active;
+    ++m_finishedCount;
+
+    if (m_options.speed <= 0 && m_nextIndex < m_capture.connections.size()) {
+        startConnection(m_nextIndex++);
+    }
+    if (m_finishedCount == m_capture.connections.size()) {
+        m_endUs = m_clock.nsecsElapsed() / 1000;
+        emit finished();
+    }
+}
+
+QJsonObject ReplayRunner::compare(const ActionStats& stats, double seconds)
+{
+    QJsonObject original;
+    original["errors"] = double(stats.originalErrors);
+    original["latencyUs"] = stats.original.toJson();
+
+    QJsonObject replay;
+    replay["errors"] = double(stats.errors);
+    replay["timeouts"] = double(stats.timeouts);
+    replay["throughput"] = stats.replay.count() / seconds;
+    replay["latencyUs"] = stats.replay.toJson();
+
+    // 回放减录制：正值表示变慢
+    QJsonObject diff;
+    diff["mean"] = stats.replay.mean() - stats.original.mean();
+    diff["p50"] = double(stats.replay.percentile(50) - stats.original.percentile(50));
+    diff["p95"] = double(stats.replay.percentile(95) - stats.original.percentile(95));
+    diff["p99"] = double(stats.replay.percentile(99) - stats.original.percentile(99));
+    diff["max"] = double(stats.replay.max() - stats.original.max());
+
+    QJsonObject obj;
+    obj["count"] = double(stats.replay.count());
+    obj["mismatches"] = double(stats.mismatches);
+    obj["original"] = original;
+    obj["replay"] = replay;
+    obj["latencyDiffUs"] = diff;
+    return obj;
+}
+
+QJsonObject ReplayRunner::report() const
+{
+    const qint64 endUs = m_endUs > 0 ? m_endUs : m_clock.nsecsElapsed() / 1000;
+    const double seconds = qMax<qint64>(1, endUs) / 1000000.0;
+
+    ActionStats total;
+    QJsonObject actions;
+    for (auto it = m_stats.constBegin(); it != m_stats.constEnd(); ++it) {
+        const ActionStats& stats = it.value();
+        actions[it.key()] = compare(stats, seconds);
+        total.original.merge(stats.original);
+        total.replay.merge(stats.replay);
+        total.originalErrors += stats.originalErrors;
+        total.errors += stats.errors;
+        total.timeouts += stats.timeouts;
+        total.mismatches += stats.mismatches;
+    }
+
+    QJsonObject summary = compare(total, seconds);
+    summary["skipped"] = double(m_skipped);
+
+    QJsonObject result;
+    result["capturedAt"] = QDateTime::fromMSecsSinceEpoch(m_capture.startMsecs).toString(Qt::ISODate);
+    result["server"] = QString("%1:%2").arg(m_options.host).arg(m_options.port);
+    result["speed"] = m_options.speed > 0 ? QString::number(m_options.speed) + "x" : QString("max");
+    result["connections"] = m_capture.connections.size();
+    result["peakConnections"] = m_peakActive;
+    result["capturedDurationSec"] = m_capture.durationUs / 1000000.0;
+    result["durationSec"] = seconds;
+    if (m_options.speed > 0) {
+        result["scheduleLagUs"] = m_lag.toJson();  // 实际发送相对计划时间的顺延
+    }
+    result["finishedAt"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    result["total"] = summary;
+    result["actions"] = actions;
+    return result;
+}
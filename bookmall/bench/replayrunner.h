@@ -0,0 +1,66 @@
+#ifndef REPLAYRUNNER_H
+#define REPLAYRUNNER_H
+
+#include <QObject>
+#include <QMap>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include "capturefile.h"
+#include "replayconnection.h"
+#include "latencyhistogram.h"
+
+/**
+ * @brief 流量回放调度器：按录制中的连接建立时间（除以倍速）逐个建立回放连接，
+ *        汇总各动作的录制延迟与回放延迟并输出分位数差值
+ * @note 最大速度（speed为0）时不按录制时间建立连接，同时保持的连接数等于录制中的峰值连接数，
+ *       一个连接回放完后立即开始下一个。录制延迟是服务器处理耗时，回放延迟是客户端观测的往返时间
+ *       （多出网络传输，本机回放时差别很小）。
+ */
+class ReplayRunner : public QObject
+{
+    Q_OBJECT
+public:
+    ReplayRunner(const CaptureFile& capture, const ReplayOptions& options, QObject* parent = nullptr);
+
+    void start();
+    QJsonObject report() const;
+
+signals:
+    void finished();
+
+private slots:
+    void onRequestFinished(const CapturedRequest& captured, qint64 latencyUs, qint64 lagUs,
+                           bool success, bool timedOut);
+    void onConnectionFinished(quint32 captureId, int skipped);
+
+private:
+    struct ActionStats {
+        LatencyHistogram original;    // 录制时的服务器处理耗时
+        LatencyHistogram replay;      // 回放时的往返延迟
+        quint64 originalErrors = 0;
+        quint64 errors = 0;
+        quint64 timeouts = 0;
+        quint64 mismatches = 0;       // 成功/失败与录制时不一致
+    };
+
+    void startConnection(int index);
+    static QJsonObject compare(const ActionStats& stats, double seconds);
+
+    const CaptureFile& m_capture;
+    ReplayOptions m_options;
+    QElapsedTimer m_clock;
+    qint64 m_baseUs;
+    QHash<QString, QString> m_idMap;
+    QMap<QString, ActionStats> m_stats;
+    LatencyHistogram m_lag;
+    int m_concurrencyLimit;
+    int m_nextIndex;
+    int m_active;
+    int m_peakActive;
+    int m_finishedCount;
+    quint64 m_skipped;
+    qint64 m_endUs;
+};
+
+#endif // REPLAYRUNNER_H
@@ -0,0 +1,95 @@
+#include "scenario.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonArray>
+
+static QList<int> toIntList(const QJsonArray& array)
+{
+    QList<int> list;
+    for (const QJsonValue& value : array) {
+        list.append(value.isString() ? value.toString().toInt() : value.toInt());
+    }
+    return list;
+}
+
+static QStringList toStringList(const QJsonArray& array)
+{
+    QStringList list;
+    for (const QJsonValue& value : array) {
+        list.append(value.isString() ? value.toString() : QString::number(value.toDouble()));
+    }
+    return list;
+}
+
+bool Scenario::loadFromFile(const QString& path, QString* error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = QString("无法打开场景文件 %1：%2").arg(path, file.errorString());
+        return false;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        if (error) *error = QString("场景文件JSON格式错误：%1").arg(parseError.errorString());
+        return false;
+    }
+
+    QJsonObject root = doc.object();
+    name = root.value("name").toString(QFileInfo(path).baseName());
+    host = root.value("host").toString(host);
+    port = quint16(root.value("port").toInt(port));
+    connections = root.value("connections").toInt(connections);
+    durationSec = root.value("durationSec").toInt(durationSec);
+    warmupSec = root.value("warmupSec").toInt(warmupSec);
+    ratePerSec = root.value("ratePerSec").toDouble(ratePerSec);
+    timeoutMs = root.value("timeoutMs").toInt(timeoutMs);
+    userIds = toIntList(root.value("userIds").toArray());
+    sellerIds = toIntList(root.value("sellerIds").toArray());
+    bookIds = toStringList(root.value("bookIds").toArray());
+    keywords = toStringList(root.value("keywords").toArray());
+
+    actions.clear();
+    m_totalWeight = 0;
+    for (const QJsonValue& value : root.value("mix").toArray()) {
+        QJsonObject obj = value.toObject();
+        BenchAction action;
+        action.request = obj.value("request").toObject();
+        action.name = obj.value("name").toString(action.request.value("action").toString());
+        action.weight = obj.value("weight").toInt(1);
+        action.captureOrderId = obj.value("captureOrderId").toString();
+        action.needsOrderId = QJsonDocument(action.request).toJson(QJsonDocument::Compact).contains("${orderId}");
+        if (action.request.value("action").toString().isEmpty() || action.weight <= 0) {
+            if (error) *error = QString("动作 %1 缺少action字段或权重无效").arg(action.name);
+            return false;
+        }
+        m_totalWeight += action.weight;
+        actions.append(action);
+    }
+
+    if (actions.isEmpty()) {
+        if (error) *error = "场景文件中没有定义mix动作";
+        return false;
+    }
+    if (userIds.isEmpty()) {
+        userIds.append(1);
+    }
+    if (sellerIds.isEmpty()) {
+        sellerIds.append(1);
+    }
+    return true;
+}
+
+const BenchAction& Scenario::pickAction(QRandomGenerator& rng) const
+{
+    int ticket = int(rng.bounded(quint32(m_totalWeight)));
+    for (const BenchAction& action : actions) {
+        ticket -= action.weight;
+        if (ticket < 0) {
+            return action;
+        }
+    }
+    return actions.last();
+}
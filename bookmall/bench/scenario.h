@@ -0,0 +1,50 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QJsonObject>
+#include <QRandomGenerator>
+
+// 单个压测动作：名称、权重和请求模板
+// 模板中的字符串值支持占位符：${userId} ${bookId} ${keyword} ${orderId} ${sellerId} ${seq}
+struct BenchAction {
+    QString name;              // 报表中使用的动作名（如browse/search）
+    int weight = 1;            // 在混合负载中的权重
+    QJsonObject request;       // 请求模板（必须包含action字段）
+    QString captureOrderId;    // 非空时从响应中读取该字段作为本连接的${orderId}
+    bool needsOrderId = false; // 模板中使用了${orderId}
+};
+
+/**
+ * @brief 压测场景：从JSON场景文件加载连接数、速率、时长和加权动作组合
+ * @note 场景文件格式见 scenarios/default.json，命令行参数可覆盖其中的同名配置
+ */
+class Scenario
+{
+public:
+    bool loadFromFile(const QString& path, QString* error);
+
+    // 按权重随机选择一个动作
+    const BenchAction& pickAction(QRandomGenerator& rng) const;
+
+    QString name;
+    QString host = "127.0.0.1";
+    quint16 port = 8888;
+    int connections = 8;           // 并发连接数
+    int durationSec = 30;          // 计入统计的压测时长
+    int warmupSec = 0;             // 预热时长（不计入统计）
+    double ratePerSec = 0.0;       // 全局目标速率，0表示每个连接收到响应后立即发下一条（闭环）
+    int timeoutMs = 5000;          // 单个请求超时
+    QList<BenchAction> actions;
+    QList<int> userIds;            // ${userId}取值池
+    QList<int> sellerIds;          // ${sellerId}取值池
+    QStringList bookIds;           // ${bookId}取值池
+    QStringList keywords;          // ${keyword}取值池
+
+private:
+    int m_totalWeight = 0;
+};
+
+#endif // SCENARIO_H
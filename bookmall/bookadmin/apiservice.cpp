@@ -39,16 +39,66 @@ QJsonObject ApiService::login(const QString &username, const QString &password)
     request["action"] = "adminLogin";
     request["username"] = username;
     request["password"] = password;
-    return tcpClient->sendRequest(request, 10000);
+    QJsonObject response = tcpClient->sendRequest(request, 10000);
+    if (response.value("success").toBool()) {
+        tcpClient->setSessionToken(response.value("token").toString());
+    }
+    return response;
+}
+
+// 退出登录：注销服务器上的会话
+QJsonObject ApiService::logout()
+{
+    QJsonObject request;
+    request["action"] = "logout";
+    QJsonObject response = tcpClient->sendRequest(request, 5000);
+    tcpClient->clearSessionToken();
+    return response;
+}
+
+// 批量请求：服务器按顺序返回每个子请求的响应
+QJsonArray ApiService::batch(const QJsonArray &requests)
+{
+    QJsonObject request;
+    request["action"] = "batch";
+    request["requests"] = requests;
+    QJsonObject response = tcpClient->sendRequest(request, 15000);
+
+    QJsonArray results;
+    QJsonArray responses = response["responses"].toArray();
+    if (response["success"].toBool() && responses.size() == requests.size()) {
+        for (const QJsonValue &entry : responses) {
+            results.append(entry.toObject()["response"]);
+        }
+        return results;
+    }
+
+    // 旧版服务器不认识batch：逐个发送
+    if (response["message"].toString().startsWith("未知的请求类型")) {
+        for (const QJsonValue &sub : requests) {
+            results.append(tcpClient->sendRequest(sub.toObject(), 10000));
+        }
+        return results;
+    }
+
+    // 批量请求本身失败（断线、登录过期等）：每个子请求都返回同一个错误
+    for (int i = 0; i < requests.size(); ++i) {
+        results.append(response);
+    }
+    return results;
 }
 
 // ===== 用户管理API =====
 
-QJsonObject ApiService::getAllUsers(const QString &adminId)
+QJsonObject ApiService::getAllUsers(const QString &adminId, int offset, int limit)
 {
     QJsonObject request;
     request["action"] = "adminGetAllUsers";
     request["adminId"] = adminId;
+    if (limit > 0) {
+        request["offset"] = offset;
+        request["limit"] = limit;
+    }
     return tcpClient->sendRequest(request, 10000);
 }
 
@@ -141,6 +191,17 @@ QJsonObject ApiService::getAllSellers(const QString &adminId)
     return tcpClient->sendRequest(request, 10000);
 }
 
+QJsonArray ApiService::getAllUsersAndSellers(const QString &adminId)
+{
+    QJsonObject users;
+    users["action"] = "adminGetAllUsers";
+    users["adminId"] = adminId;
+    QJsonObject sellers;
+    sellers["action"] = "adminGetAllSellers";
+    sellers["adminId"] = adminId;
+    return batch(QJsonArray{users, sellers});
+}
+
 QJsonObject ApiService::getSeller(const QString &adminId, const QString &sellerId)
 {
     QJsonObject request;
@@ -194,11 +255,15 @@ QJsonObject ApiService::banSeller(const QString &adminId, const QString &sellerI
 
 // ===== 图书全局管理API =====
 
-QJsonObject ApiService::getAllBooksGlobal(const QString &adminId)
+QJsonObject ApiService::getAllBooksGlobal(const QString &adminId, int offset, int limit)
 {
     QJsonObject request;
     request["action"] = "adminGetAllBooks";
     request["adminId"] = adminId;
+    if (limit > 0) {
+        request["offset"] = offset;
+        request["limit"] = limit;
+    }
     return tcpClient->sendRequest(request, 10000);
 }
 
@@ -259,11 +324,15 @@ QJsonObject ApiService::updateBookGlobal(const QString &adminId, const QString &
 
 // ===== 订单全局管理API =====
 
-QJsonObject ApiService::getAllOrdersGlobal(const QString &adminId)
+QJsonObject ApiService::getAllOrdersGlobal(const QString &adminId, int offset, int limit)
 {
     QJsonObject request;
     request["action"] = "adminGetAllOrders";
     request["adminId"] = adminId;
+    if (limit > 0) {
+        request["offset"] = offset;
+        request["limit"] = limit;
+    }
     return tcpClient->sendRequest(request, 10000);
 }
 
@@ -295,6 +364,14 @@ QJsonObject ApiService::getSystemStats(const QString &adminId)
     return tcpClient->sendRequest(request, 10000);
 }
 
+QJsonObject ApiService::getServerMetrics(const QString &adminId)
+{
+    QJsonObject request;
+    request["action"] = "adminGetServerMetrics";
+    request["adminId"] = adminId;
+    return tcpClient->sendRequest(request, 10000);
+}
+
 QJsonObject ApiService::getDashboardData(const QString &adminId)
 {
     QJsonObject request;
@@ -450,7 +527,8 @@ QJsonObject ApiService::sendChatMessage(const QString &senderId, const QString &
 }
 
 QJsonObject ApiService::getChatHistory(const QString &userId, const QString &userType, 
-                                      const QString &otherUserId, const QString &otherUserType)
+                                      const QString &otherUserId, const QString &otherUserType,
+                                      int beforeId, int limit)
 {
     QJsonObject request;
     request["action"] = "getChatHistory";
@@ -462,6 +540,39 @@ QJsonObject ApiService::getChatHistory(const QString &userId, const QString &use
     if (!otherUserType.isEmpty()) {
         request["otherUserType"] = otherUserType;
     }
+    if (limit > 0) {
+        request["limit"] = limit;
+        if (beforeId > 0) {
+            request["beforeId"] = beforeId;
+        }
+    }
+    return tcpClient->sendRequest(request, 10000);
+}
+
+QJsonObject ApiService::getConversations(const QString &userId, const QString &userType,
+                                         const QString &peerType, int offset, int limit)
+{
+    QJsonObject request;
+    request["action"] = "getConversations";
+    request["userId"] = userId;
+    request["userType"] = userType;
+    if (!peerType.isEmpty()) {
+        request["peerType"] = peerType;
+    }
+    request["offset"] = offset;
+    request["limit"] = limit;
+    return tcpClient->sendRequest(request, 10000);
+}
+
+QJsonObject ApiService::markConversationRead(const QString &userId, const QString &userType,
+                                             int peerId, const QString &peerType)
+{
+    QJsonObject request;
+    request["action"] = "markConversationRead";
+    request["userId"] = userId;
+    request["userType"] = userType;
+    request["peerId"] = peerId;
+    request["peerType"] = peerType;
     return tcpClient->sendRequest(request, 10000);
 }
 
@@ -23,11 +23,15 @@ public:
 
     // 管理员登录
     QJsonObject login(const QString &username, const QString &password);
+    QJsonObject logout();
+    
+    // 批量请求：requests一帧发出，返回与之一一对应的响应（服务器不支持batch时逐个发送）
+    QJsonArray batch(const QJsonArray &requests);
     
     // ===== 管理员专用API =====
     
     // 用户管理API（管理所有买家）
-    QJsonObject getAllUsers(const QString &adminId);
+    QJsonObject getAllUsers(const QString &adminId, int offset = 0, int limit = 0);  // offset/limit用于分页，limit<=0时返回全部
     QJsonObject getUser(const QString &adminId, const QString &userId);
     QJsonObject addUser(const QString &adminId, const QJsonObject &userData);
     QJsonObject updateUser(const QString &adminId, const QString &userId, const QJsonObject &userData);
@@ -46,9 +50,10 @@ public:
     QJsonObject updateSeller(const QString &adminId, const QString &sellerId, const QJsonObject &sellerData);
     QJsonObject deleteSeller(const QString &adminId, const QString &sellerId);
     QJsonObject banSeller(const QString &adminId, const QString &sellerId, bool banned);
+    QJsonArray getAllUsersAndSellers(const QString &adminId);  // 一次往返取回 [买家列表响应, 商家列表响应]
     
     // 图书全局管理API
-    QJsonObject getAllBooksGlobal(const QString &adminId);
+    QJsonObject getAllBooksGlobal(const QString &adminId, int offset = 0, int limit = 0);
     QJsonObject getPendingBooks(const QString &adminId);  // 获取待审核书籍列表
     QJsonObject getPendingSellerCertifications(const QString &adminId);  // 获取待审核商家认证申请列表
     QJsonObject approveBook(const QString &adminId, const QString &isbn);  // 审核通过书籍
@@ -57,7 +62,7 @@ public:
     QJsonObject updateBookGlobal(const QString &adminId, const QString &bookId, const QJsonObject &bookData);
     
     // 订单全局管理API
-    QJsonObject getAllOrdersGlobal(const QString &adminId);
+    QJsonObject getAllOrdersGlobal(const QString &adminId, int offset = 0, int limit = 0);
     QJsonObject getOrderDetails(const QString &adminId, const QString &orderId);
     QJsonObject deleteOrderGlobal(const QString &adminId, const QString &orderId);
     
@@ -68,6 +73,7 @@ public:
     QJsonObject getSellerStats(const QString &adminId);
     QJsonObject getBookStats(const QString &adminId);
     QJsonObject getOrderStats(const QString &adminId);
+    QJsonObject getServerMetrics(const QString &adminId);  // 服务器按动作的请求数/错误数/延迟分位数
     
     // 系统日志API
     QJsonObject getSystemLogs(const QString &adminId, const QString &startDate, const QString &endDate);
@@ -90,8 +96,15 @@ public:
     QJsonObject sendChatMessage(const QString &senderId, const QString &senderType, 
                                 const QString &receiverId, const QString &receiverType, 
                                 const QString &message);
+    // limit > 0 时只取beforeId（0为最新）之前的最多limit条
     QJsonObject getChatHistory(const QString &userId, const QString &userType, 
-                               const QString &otherUserId = "", const QString &otherUserType = "");
+                               const QString &otherUserId = "", const QString &otherUserType = "",
+                               int beforeId = 0, int limit = 0);
+    // 会话列表（按最近消息倒序分页），peerType为空表示全部
+    QJsonObject getConversations(const QString &userId, const QString &userType,
+                                 const QString &peerType = "", int offset = 0, int limit = 50);
+    QJsonObject markConversationRead(const QString &userId, const QString &userType,
+                                     int peerId, const QString &peerType);
 
 signals:
     void connected();
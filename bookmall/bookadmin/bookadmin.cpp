@@ -4,6 +4,7 @@
 #include <QPushButton>
 #include <QLabel>
 #include <QTableWidget>
+#include <QTableView>
 #include <QTextEdit>
 #include <QListWidget>
 #include <QTimer>
@@ -27,9 +28,22 @@
 #include <QBuffer>
 #include <QPixmap>
 #include <QImage>
+#include <QPainter>
+#include <QJsonArray>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
 #include "apiservice.h"
+#include "rowtablemodel.h"
 #include <QDebug>
 
+// 聊天窗口显示最近的消息条数（按消息ID分页读取）
+static const int kChatHistoryPageSize = 100;
+// 会话列表每页条数，列表末尾的“加载更多”按offset取下一页
+static const int kChatConversationPageSize = 50;
+// 会话列表中“加载更多”项的标记（Qt::UserRole + 2）
+static const int kLoadMoreRole = Qt::UserRole + 2;
+
 BookAdmin::BookAdmin(QWidget *parent)
     : QMainWindow(parent)
     , selectedUserRow(-1)
@@ -79,14 +93,9 @@ BookAdmin::BookAdmin(QWidget *parent)
     
     // 自动连接服务器
     QTimer::singleShot(500, this, [this]() {
-        qDebug() << "自动连接服务器...";
-        if (!apiService->isConnected()) {
-            if (apiService->connectToServer(serverIp, serverPort)) {
-                qDebug() << "自动连接服务器成功";
-            } else {
-                qDebug() << "自动连接服务器失败";
-            }
-        }
+        // 异步连接：连接结果通过connected/errorOccurred通知，失败后自动重连
+        qDebug() << "自动连接服务器:" << serverIp << ":" << serverPort;
+        apiService->connectToServer(serverIp, serverPort);
     });
 }
 
@@ -398,16 +407,18 @@ void BookAdmin::initUI()
     usersButtonLayout->addWidget(banUserBtn);
     usersButtonLayout->addWidget(unbanUserBtn);
     usersButtonLayout->addStretch();
+    usersFilterEdit = new QLineEdit();
+    usersButtonLayout->addWidget(usersFilterEdit);
     usersButtonLayout->addWidget(backFromUsersBtn);
 
     usersLayout->addLayout(usersButtonLayout);
 
-    usersTable = new QTableWidget();
-    usersTable->setColumnCount(8);
-    usersTable->setHorizontalHeaderLabels({"用户ID", "用户名", "邮箱", "注册日期", "状态", "余额", "会员等级", "身份"});
-    usersTable->horizontalHeader()->setStretchLastSection(true);
-    usersTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-    usersTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    usersModel = new RowTableModel({"用户ID", "用户名", "邮箱", "注册日期", "状态", "余额", "会员等级", "身份"}, this);
+    usersModel->setNumericColumns({0, 5, 6});
+    // 身份为"审核中"时显示为橙色，提示管理员可以点击审核
+    usersModel->setHighlight(7, "审核中", QColor(255, 140, 0), "点击此处进入审核界面");
+    usersProxy = new RowFilterProxyModel(this);
+    usersTable = createTableView(usersModel, usersProxy, usersFilterEdit, &selectedUserRow);
     usersLayout->addWidget(usersTable);
 
     stackedWidget->addWidget(usersPage);
@@ -508,16 +519,16 @@ void BookAdmin::initUI()
     booksButtonLayout->addWidget(editBookBtn);
     booksButtonLayout->addWidget(deleteBookBtn);
     booksButtonLayout->addStretch();
+    booksFilterEdit = new QLineEdit();
+    booksButtonLayout->addWidget(booksFilterEdit);
     booksButtonLayout->addWidget(backFromBooksBtn);
 
     allBooksLayout->addLayout(booksButtonLayout);
     
-    booksTable = new QTableWidget();
-    booksTable->setColumnCount(7);
-    booksTable->setHorizontalHeaderLabels({"ISBN", "书名", "作者", "分类", "价格", "库存", "状态"});
-    booksTable->horizontalHeader()->setStretchLastSection(true);
-    booksTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-    booksTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    booksModel = new RowTableModel({"ISBN", "书名", "作者", "分类", "价格", "库存", "状态"}, this);
+    booksModel->setNumericColumns({4, 5});
+    booksProxy = new RowFilterProxyModel(this);
+    booksTable = createTableView(booksModel, booksProxy, booksFilterEdit, &selectedBookRow);
     allBooksLayout->addWidget(booksTable);
     
     booksTabWidget->addTab(allBooksTab, "所有书籍");
@@ -572,16 +583,16 @@ void BookAdmin::initUI()
     ordersButtonLayout->addWidget(viewOrderDetailsBtn);
     ordersButtonLayout->addWidget(deleteOrderBtn);
     ordersButtonLayout->addStretch();
+    ordersFilterEdit = new QLineEdit();
+    ordersButtonLayout->addWidget(ordersFilterEdit);
     ordersButtonLayout->addWidget(backFromOrdersBtn);
 
     ordersLayout->addLayout(ordersButtonLayout);
 
-    ordersTable = new QTableWidget();
-    ordersTable->setColumnCount(6);
-    ordersTable->setHorizontalHeaderLabels({"订单ID", "用户ID", "总金额", "状态", "日期", "商品详情"});
-    ordersTable->horizontalHeader()->setStretchLastSection(true);
-    ordersTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-    ordersTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ordersModel = new RowTableModel({"订单ID", "用户ID", "总金额", "状态", "日期", "商品详情"}, this);
+    ordersModel->setNumericColumns({1, 2});
+    ordersProxy = new RowFilterProxyModel(this);
+    ordersTable = createTableView(ordersModel, ordersProxy, ordersFilterEdit, &selectedOrderRow);
     ordersLayout->addWidget(ordersTable);
 
     stackedWidget->addWidget(ordersPage);
@@ -608,8 +619,30 @@ void BookAdmin::initUI()
 
     statsDisplay = new QTextEdit();
     statsDisplay->setReadOnly(true);
+    statsDisplay->setMaximumHeight(200);
     statsLayout->addWidget(statsDisplay);
 
+    // 服务器运行指标：延迟图 + 按动作明细
+    QLabel *metricsTitle = new QLabel("服务器接口延迟（最慢的动作在前）");
+    metricsTitle->setStyleSheet("font-size: 16px; font-weight: bold; padding: 5px;");
+    statsLayout->addWidget(metricsTitle);
+
+    serverGaugeLabel = new QLabel();
+    serverGaugeLabel->setStyleSheet("color: #7f8c8d; padding: 2px 5px;");
+    statsLayout->addWidget(serverGaugeLabel);
+
+    latencyChart = new LatencyChartWidget();
+    latencyChart->setMinimumHeight(220);
+    statsLayout->addWidget(latencyChart);
+
+    metricsTable = new QTableWidget();
+    metricsTable->setColumnCount(8);
+    metricsTable->setHorizontalHeaderLabels({"动作", "请求数", "错误数", "p50(ms)", "p99(ms)", "最大(ms)", "数据库(ms)", "业务处理(ms)"});
+    metricsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    metricsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    metricsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    statsLayout->addWidget(metricsTable);
+
     stackedWidget->addWidget(statsPage);
     
     // ===== 申诉管理页面 =====
@@ -676,6 +709,9 @@ void BookAdmin::initUI()
     refreshChatBtn = new QPushButton("刷新列表");
     chatUserListLayout->addWidget(refreshChatBtn);
     
+    newChatBtn = new QPushButton("选择用户发起会话");
+    chatUserListLayout->addWidget(newChatBtn);
+    
     chatUserList = new QListWidget();
     chatUserList->setStyleSheet("border: 1px solid #ddd; border-radius: 5px;");
     chatUserListLayout->addWidget(chatUserList, 1);
@@ -714,6 +750,7 @@ void BookAdmin::initUI()
     
     chatMainLayout->addWidget(chatAreaWidget, 1);
     
+    chatConversationOffset = 0;
     currentChatUserId = -1;
     currentChatUserType = "";
     
@@ -780,6 +817,37 @@ void BookAdmin::initUI()
     stackedWidget->addWidget(reviewPage);
 }
 
+// 创建只读表格视图：源模型 -> 排序/过滤代理 -> QTableView
+// 视图只绘制可见行，不再为每个单元格分配QTableWidgetItem
+QTableView *BookAdmin::createTableView(RowTableModel *model, RowFilterProxyModel *proxy, QLineEdit *filterEdit, int *selectedRow)
+{
+    proxy->setSourceModel(model);
+
+    QTableView *view = new QTableView();
+    view->setModel(proxy);
+    view->horizontalHeader()->setStretchLastSection(true);
+    view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    // 点击表头前保持服务器返回的顺序
+    view->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    view->setSortingEnabled(true);
+
+    filterEdit->setPlaceholderText("输入关键字过滤");
+    filterEdit->setClearButtonEnabled(true);
+    filterEdit->setMaximumWidth(220);
+    connect(filterEdit, &QLineEdit::textChanged, proxy, &RowFilterProxyModel::setFilterFixedString);
+
+    // 刷新时增删行会让行号变化，按视图当前行重新定位选中的源数据行
+    auto syncSelection = [view, proxy, selectedRow]() {
+        *selectedRow = proxy->sourceRow(view->currentIndex().row());
+    };
+    connect(model, &QAbstractItemModel::rowsInserted, view, syncSelection);
+    connect(model, &QAbstractItemModel::rowsRemoved, view, syncSelection);
+    connect(model, &QAbstractItemModel::modelReset, view, syncSelection);
+
+    return view;
+}
+
 void BookAdmin::initConnections()
 {
     // 登录
@@ -802,6 +870,7 @@ void BookAdmin::initConnections()
 
     // 聊天管理
     connect(refreshChatBtn, &QPushButton::clicked, this, &BookAdmin::loadChatUsers);
+    connect(newChatBtn, &QPushButton::clicked, this, &BookAdmin::onNewChatClicked);
     connect(chatUserList, &QListWidget::itemClicked, this, &BookAdmin::onChatUserSelected);
     connect(sendChatBtn, &QPushButton::clicked, this, &BookAdmin::onSendChatClicked);
     connect(backFromChatBtn, &QPushButton::clicked, this, &BookAdmin::showDashboardPage);
@@ -818,7 +887,11 @@ void BookAdmin::initConnections()
     connect(banUserBtn, &QPushButton::clicked, this, &BookAdmin::onBanUserClicked);
     connect(unbanUserBtn, &QPushButton::clicked, this, &BookAdmin::onUnbanUserClicked);
     connect(backFromUsersBtn, &QPushButton::clicked, this, &BookAdmin::showDashboardPage);
-    connect(usersTable, &QTableWidget::cellClicked, this, &BookAdmin::onUserTableCellClicked);
+    // 视图行号经代理映射回源模型行号，排序/过滤后选中的仍是同一条数据
+    connect(usersTable, &QTableView::clicked, this, [this](const QModelIndex &index) {
+        onUserTableCellClicked(usersProxy->sourceRow(index.row()), index.column());
+    });
+    connect(usersModel, &RowTableModel::fetchMoreRequested, this, &BookAdmin::fetchMoreUsers, Qt::QueuedConnection);
 
     // 商家管理
     connect(refreshSellersBtn, &QPushButton::clicked, this, &BookAdmin::onRefreshSellersClicked);
@@ -839,7 +912,10 @@ void BookAdmin::initConnections()
     connect(editBookBtn, &QPushButton::clicked, this, &BookAdmin::onEditBookClicked);
     connect(deleteBookBtn, &QPushButton::clicked, this, &BookAdmin::onDeleteBookClicked);
     connect(backFromBooksBtn, &QPushButton::clicked, this, &BookAdmin::showDashboardPage);
-    connect(booksTable, &QTableWidget::cellClicked, this, &BookAdmin::onBookTableCellClicked);
+    connect(booksTable, &QTableView::clicked, this, [this](const QModelIndex &index) {
+        onBookTableCellClicked(booksProxy->sourceRow(index.row()), index.column());
+    });
+    connect(booksModel, &RowTableModel::fetchMoreRequested, this, &BookAdmin::fetchMoreBooks, Qt::QueuedConnection);
     // 待审核书籍
     connect(refreshPendingBooksBtn, &QPushButton::clicked, this, &BookAdmin::onRefreshPendingBooksClicked);
     connect(approveBookBtn, &QPushButton::clicked, this, &BookAdmin::onApproveBookClicked);
@@ -850,7 +926,10 @@ void BookAdmin::initConnections()
     connect(viewOrderDetailsBtn, &QPushButton::clicked, this, &BookAdmin::onViewOrderDetailsClicked);
     connect(deleteOrderBtn, &QPushButton::clicked, this, &BookAdmin::onDeleteOrderClicked);
     connect(backFromOrdersBtn, &QPushButton::clicked, this, &BookAdmin::showDashboardPage);
-    connect(ordersTable, &QTableWidget::cellClicked, this, &BookAdmin::onOrderTableCellClicked);
+    connect(ordersTable, &QTableView::clicked, this, [this](const QModelIndex &index) {
+        onOrderTableCellClicked(ordersProxy->sourceRow(index.row()), index.column());
+    });
+    connect(ordersModel, &RowTableModel::fetchMoreRequested, this, &BookAdmin::fetchMoreOrders, Qt::QueuedConnection);
 
     // 统计
     connect(refreshStatsBtn, &QPushButton::clicked, this, &BookAdmin::onRefreshStatsClicked);
@@ -937,7 +1016,7 @@ void BookAdmin::applyStyle()
         }
         
         /* 表格统一样式 */
-        QTableWidget {
+        QTableView {
             background-color: white;
             border: 1px solid %2;
             border-radius: 8px;
@@ -946,12 +1025,12 @@ void BookAdmin::applyStyle()
             color: %3;
         }
         
-        QTableWidget::item {
+        QTableView::item {
             padding: 8px;
             border: none;
         }
         
-        QTableWidget::item:selected {
+        QTableView::item:selected {
             background-color: %4;
             color: white;
         }
@@ -1213,6 +1292,7 @@ void BookAdmin::onLoginClicked()
 
 void BookAdmin::onLogoutClicked()
 {
+    apiService->logout();
     isLoggedIn = false;
     currentAdminId.clear();
     currentAdminName.clear();
@@ -1230,9 +1310,9 @@ void BookAdmin::onBanUserClicked()
         return;
     }
     
-    QString userId = usersTable->item(selectedUserRow, 0)->text();
-    QString username = usersTable->item(selectedUserRow, 1)->text();
-    QString currentStatus = usersTable->item(selectedUserRow, 4)->text();  // 状态列
+    QString userId = usersModel->text(selectedUserRow, 0);
+    QString username = usersModel->text(selectedUserRow, 1);
+    QString currentStatus = usersModel->text(selectedUserRow, 4);  // 状态列
     
     if (currentStatus == "封禁") {
         QMessageBox::information(this, "提示", "该用户已被封禁，无需重复封禁");
@@ -1262,9 +1342,9 @@ void BookAdmin::onUnbanUserClicked()
         return;
     }
     
-    QString userId = usersTable->item(selectedUserRow, 0)->text();
-    QString username = usersTable->item(selectedUserRow, 1)->text();
-    QString currentStatus = usersTable->item(selectedUserRow, 4)->text();  // 状态列
+    QString userId = usersModel->text(selectedUserRow, 0);
+    QString username = usersModel->text(selectedUserRow, 1);
+    QString currentStatus = usersModel->text(selectedUserRow, 4);  // 状态列
     
     if (currentStatus != "封禁") {
         QMessageBox::information(this, "提示", "该用户未被封禁，无需解封");
@@ -1292,16 +1372,12 @@ void BookAdmin::onUserTableCellClicked(int row, int column)
     selectedUserRow = row;
     
     // 如果点击的是身份列（第8列，索引7）且身份为"审核中"，进入审核界面
-    if (column == 7) {
-        QTableWidgetItem *roleItem = usersTable->item(row, 7); // 身份列在第8列（索引7）
-        if (roleItem && roleItem->text() == "审核中") {
+    if (column == 7 && row >= 0) {
+        if (usersModel->text(row, 7) == "审核中") {  // 身份列在第8列（索引7）
             // 获取用户ID
-            QTableWidgetItem *userIdItem = usersTable->item(row, 0);
-            if (userIdItem) {
-                QString userId = userIdItem->text();
-                showReviewPage(userId.toInt());
-                return;
-            }
+            QString userId = usersModel->text(row, 0);
+            showReviewPage(userId.toInt());
+            return;
         }
     }
 }
@@ -1387,7 +1463,7 @@ void BookAdmin::onEditBookClicked()
         return;
     }
     
-    QString bookId = booksTable->item(selectedBookRow, 0)->text();
+    QString bookId = booksModel->text(selectedBookRow, 0);
     
     // 获取当前图书信息
     QJsonObject response = apiService->getAllBooksGlobal(currentAdminId);
@@ -1540,7 +1616,7 @@ void BookAdmin::onDeleteBookClicked()
         QMessageBox::warning(this, "提示", "请先选择要删除的图书！");
         return;
     }
-    QString bookId = booksTable->item(selectedBookRow, 0)->text();
+    QString bookId = booksModel->text(selectedBookRow, 0);
     QMessageBox::StandardButton reply = QMessageBox::question(
         this, "确认", "确定要删除该图书吗？", QMessageBox::Yes | QMessageBox::No);
     if (reply == QMessageBox::Yes) {
@@ -1573,7 +1649,7 @@ void BookAdmin::onDeleteOrderClicked()
         QMessageBox::warning(this, "提示", "请先选择要删除的订单！");
         return;
     }
-    QString orderId = ordersTable->item(selectedOrderRow, 0)->text();
+    QString orderId = ordersModel->text(selectedOrderRow, 0);
     QMessageBox::StandardButton reply = QMessageBox::question(
         this, "确认", "确定要删除该订单吗？", QMessageBox::Yes | QMessageBox::No);
     if (reply == QMessageBox::Yes) {
@@ -1618,6 +1694,7 @@ void BookAdmin::showUsersPage() {
     if (usersTitleLabel) {
         usersTitleLabel->setText("用户管理");
     }
+    usersProxy->setColumnFilter(-1, QString());
     loadUsers(); 
     stackedWidget->setCurrentWidget(usersPage); 
 }
@@ -1690,36 +1767,112 @@ void BookAdmin::loadChatUsers()
         }
     }
     
-    // 获取所有用户和卖家，显示在列表中
+    // 会话列表：只取有过聊天的买家/卖家，按最近消息倒序分页加载
     chatUserList->clear();
+    chatConversationOffset = 0;
+    loadMoreChatUsers();
+}
+
+void BookAdmin::loadMoreChatUsers()
+{
+    // 去掉上一页末尾的“加载更多”项
+    if (chatUserList->count() > 0 && chatUserList->item(chatUserList->count() - 1)->data(kLoadMoreRole).toBool()) {
+        delete chatUserList->takeItem(chatUserList->count() - 1);
+    }
     
-    // 获取所有买家
-    QJsonObject usersResponse = apiService->getAllUsers(currentAdminId);
+    QJsonObject response = apiService->getConversations(currentAdminId, "admin", "", chatConversationOffset,
+                                                        kChatConversationPageSize);
+    if (!response["success"].toBool()) {
+        return;
+    }
+    
+    QJsonArray conversations = response["conversations"].toArray();
+    chatConversationOffset += conversations.size();
+    for (const QJsonValue &conversationVal : conversations) {
+        QJsonObject conversation = conversationVal.toObject();
+        QString peerType = conversation["peerType"].toString();
+        int peerId = conversation["peerId"].toInt();
+        QString itemText = QString("%1: %2 (ID: %3)")
+                               .arg(peerType == "seller" ? "卖家" : "买家")
+                               .arg(conversation["peerName"].toString())
+                               .arg(peerId);
+        int unreadCount = conversation["unreadCount"].toInt();
+        if (unreadCount > 0) {
+            itemText += QString(" [%1条未读]").arg(unreadCount);
+        }
+        QListWidgetItem *item = new QListWidgetItem(itemText);
+        item->setToolTip(conversation["lastContent"].toString());
+        item->setData(Qt::UserRole, peerId);
+        item->setData(Qt::UserRole + 1, peerType);
+        chatUserList->addItem(item);
+    }
+    
+    if (response["hasMore"].toBool() && !conversations.isEmpty()) {
+        QListWidgetItem *moreItem = new QListWidgetItem("加载更多会话...");
+        moreItem->setData(kLoadMoreRole, true);
+        moreItem->setTextAlignment(Qt::AlignCenter);
+        chatUserList->addItem(moreItem);
+    } else if (chatConversationOffset == 0) {
+        QListWidgetItem *emptyItem = new QListWidgetItem("暂无聊天会话，可点击“选择用户发起会话”");
+        emptyItem->setFlags(Qt::NoItemFlags);
+        chatUserList->addItem(emptyItem);
+    }
+}
+
+void BookAdmin::onNewChatClicked()
+{
+    if (!isLoggedIn || currentAdminId.isEmpty()) {
+        return;
+    }
+    
+    if (!apiService->isConnected()) {
+        if (!apiService->connectToServer(serverIp, serverPort)) {
+            QMessageBox::warning(this, "连接失败", "无法连接到服务器");
+            return;
+        }
+    }
+    
+    // 会话列表只含聊过的用户，这里列出全部买家和卖家（一次往返），可以给任何人发消息
+    QJsonArray responses = apiService->getAllUsersAndSellers(currentAdminId);
+    QStringList labels;
+    QList<QPair<int, QString>> targets;
+    
+    QJsonObject usersResponse = responses.at(0).toObject();
     if (usersResponse["success"].toBool()) {
-        QJsonArray users = usersResponse["users"].toArray();
-        for (const QJsonValue &userVal : users) {
+        for (const QJsonValue &userVal : usersResponse["users"].toArray()) {
             QJsonObject user = userVal.toObject();
-            QString itemText = QString("买家: %1 (ID: %2)").arg(user["username"].toString()).arg(user["userId"].toInt());
-            QListWidgetItem *item = new QListWidgetItem(itemText);
-            item->setData(Qt::UserRole, user["userId"].toInt());
-            item->setData(Qt::UserRole + 1, "buyer");
-            chatUserList->addItem(item);
+            labels << QString("买家: %1 (ID: %2)").arg(user["username"].toString()).arg(user["userId"].toInt());
+            targets.append(qMakePair(user["userId"].toInt(), QString("buyer")));
         }
     }
-    
-    // 获取所有卖家
-    QJsonObject sellersResponse = apiService->getAllSellers(currentAdminId);
+    QJsonObject sellersResponse = responses.at(1).toObject();
     if (sellersResponse["success"].toBool()) {
-        QJsonArray sellers = sellersResponse["sellers"].toArray();
-        for (const QJsonValue &sellerVal : sellers) {
+        for (const QJsonValue &sellerVal : sellersResponse["sellers"].toArray()) {
             QJsonObject seller = sellerVal.toObject();
-            QString itemText = QString("卖家: %1 (ID: %2)").arg(seller["sellerName"].toString()).arg(seller["sellerId"].toInt());
-            QListWidgetItem *item = new QListWidgetItem(itemText);
-            item->setData(Qt::UserRole, seller["sellerId"].toInt());
-            item->setData(Qt::UserRole + 1, "seller");
-            chatUserList->addItem(item);
+            labels << QString("卖家: %1 (ID: %2)").arg(seller["sellerName"].toString()).arg(seller["sellerId"].toInt());
+            targets.append(qMakePair(seller["sellerId"].toInt(), QString("seller")));
         }
     }
+    
+    if (labels.isEmpty()) {
+        QMessageBox::information(this, "提示", "没有可选择的用户");
+        return;
+    }
+    
+    bool ok = false;
+    QString picked = QInputDialog::getItem(this, "发起会话", "选择买家或卖家:", labels, 0, false, &ok);
+    if (!ok) {
+        return;
+    }
+    const int index = labels.indexOf(picked);
+    if (index < 0) {
+        return;
+    }
+    
+    chatUserList->clearSelection();
+    currentChatUserId = targets.at(index).first;
+    currentChatUserType = targets.at(index).second;
+    loadChatHistory();
 }
 
 void BookAdmin::onChatUserSelected()
@@ -1729,9 +1882,22 @@ void BookAdmin::onChatUserSelected()
         return;
     }
     
+    if (item->data(kLoadMoreRole).toBool()) {
+        // 加载时会删除被点击的这一项，放到点击信号处理完之后
+        QTimer::singleShot(0, this, &BookAdmin::loadMoreChatUsers);
+        return;
+    }
+    
     currentChatUserId = item->data(Qt::UserRole).toInt();
     currentChatUserType = item->data(Qt::UserRole + 1).toString();
     
+    if (currentChatUserId <= 0) {
+        return;
+    }
+    
+    // 打开会话时清零未读数
+    apiService->markConversationRead(currentAdminId, "admin", currentChatUserId, currentChatUserType);
+    
     // 加载与该用户的聊天历史
     loadChatHistory();
 }
@@ -1762,7 +1928,9 @@ void BookAdmin::loadChatHistory()
         currentAdminId,  // 管理员ID
         "admin",         // 管理员类型
         QString::number(currentChatUserId),  // 对方用户ID
-        currentChatUserType  // 对方用户类型
+        currentChatUserType,  // 对方用户类型
+        0,
+        kChatHistoryPageSize  // 只取最近的一页
     );
     
     if (response["success"].toBool()) {
@@ -2066,125 +2234,92 @@ void BookAdmin::onBackFromReviewBtnClicked()
 // 数据加载
 void BookAdmin::loadUsers()
 {
-    QJsonObject response = apiService->getAllUsers(currentAdminId);
+    // 刷新已加载的范围（至少一页），更多用户在滚动到底部时分页拉取
+    QJsonObject response = apiService->getAllUsers(currentAdminId, 0, usersModel->refreshLimit());
     if (response["success"].toBool()) {
-        QJsonArray users = response["users"].toArray();
-        usersTable->setRowCount(0);
-        for (const QJsonValue &userVal : users) {
-            QJsonObject user = userVal.toObject();
-            int row = usersTable->rowCount();
-            usersTable->insertRow(row);
-            usersTable->setItem(row, 0, new QTableWidgetItem(QString::number(user["userId"].toInt())));
-            usersTable->setItem(row, 1, new QTableWidgetItem(user["username"].toString()));
-            usersTable->setItem(row, 2, new QTableWidgetItem(user["email"].toString()));
-            usersTable->setItem(row, 3, new QTableWidgetItem(user["registerDate"].toString()));
-            usersTable->setItem(row, 4, new QTableWidgetItem(user["status"].toString()));
-            usersTable->setItem(row, 5, new QTableWidgetItem(QString::number(user["balance"].toDouble(), 'f', 2)));
-            
-            // 显示会员等级（放在身份列前面），用数字表示（1-5）
-            int membershipLevelInt = 1;
-            if (user.contains("membershipLevel")) {
-                QJsonValue levelVal = user["membershipLevel"];
-                if (levelVal.isDouble()) {
-                    membershipLevelInt = levelVal.toInt();
-                } else {
-                    QString levelStr = levelVal.toString();
-                    // 兼容旧数据：如果是文本，转换为整数
-                    if (levelStr == "普通") membershipLevelInt = 1;
-                    else if (levelStr == "银卡") membershipLevelInt = 2;
-                    else if (levelStr == "金卡") membershipLevelInt = 3;
-                    else if (levelStr == "白金") membershipLevelInt = 4;
-                    else if (levelStr == "钻石") membershipLevelInt = 5;
-                    else membershipLevelInt = levelStr.toInt();
-                }
-            }
-            if (membershipLevelInt < 1 || membershipLevelInt > 5) {
-                membershipLevelInt = 1;
-            }
-            usersTable->setItem(row, 6, new QTableWidgetItem(QString::number(membershipLevelInt)));
-            
-            // 显示身份：0-审核中，1-买家，2-卖家
-            int role = user["role"].toInt();
-            QString roleText;
-            switch (role) {
-                case 0:
-                    roleText = "审核中";
-                    break;
-                case 1:
-                    roleText = "买家";
-                    break;
-                case 2:
-                    roleText = "卖家";
-                    break;
-                default:
-                    roleText = "未知";
-                    break;
-            }
-            QTableWidgetItem *roleItem = new QTableWidgetItem(roleText);
-            usersTable->setItem(row, 7, roleItem);
-            
-            // 如果身份是"审核中"，设置为可点击样式，提示管理员可以点击审核
-            if (roleText == "审核中") {
-                roleItem->setForeground(QBrush(QColor(255, 140, 0))); // 橙色
-                roleItem->setToolTip("点击此处进入审核界面");
-                roleItem->setFlags(roleItem->flags() | Qt::ItemIsEnabled);
-            }
-        }
+        // 差异更新：只重绘变化的行，选中、滚动位置和排序保持不变
+        usersModel->setRows(makeUserRows(response["users"].toArray()), response["hasMore"].toBool());
     }
 }
 
 void BookAdmin::loadBuyers()
 {
-    // 加载买家（只显示role=1的用户）
-    QJsonObject response = apiService->getAllUsers(currentAdminId);
-    if (response["success"].toBool()) {
-        QJsonArray users = response["users"].toArray();
-        usersTable->setRowCount(0);
-        for (const QJsonValue &userVal : users) {
-            QJsonObject user = userVal.toObject();
-            
-            // 只显示买家（role=1）
-            int role = user["role"].toInt();
-            if (role != 1) {
-                continue;  // 跳过非买家用户
-            }
-            
-            int row = usersTable->rowCount();
-            usersTable->insertRow(row);
-            usersTable->setItem(row, 0, new QTableWidgetItem(QString::number(user["userId"].toInt())));
-            usersTable->setItem(row, 1, new QTableWidgetItem(user["username"].toString()));
-            usersTable->setItem(row, 2, new QTableWidgetItem(user["email"].toString()));
-            usersTable->setItem(row, 3, new QTableWidgetItem(user["registerDate"].toString()));
-            usersTable->setItem(row, 4, new QTableWidgetItem(user["status"].toString()));
-            usersTable->setItem(row, 5, new QTableWidgetItem(QString::number(user["balance"].toDouble(), 'f', 2)));
-            
-            // 显示会员等级（放在身份列前面），用数字表示（1-5）
-            int membershipLevelInt = 1;
-            if (user.contains("membershipLevel")) {
-                QJsonValue levelVal = user["membershipLevel"];
-                if (levelVal.isDouble()) {
-                    membershipLevelInt = levelVal.toInt();
-                } else {
-                    QString levelStr = levelVal.toString();
-                    // 兼容旧数据：如果是文本，转换为整数
-                    if (levelStr == "普通") membershipLevelInt = 1;
-                    else if (levelStr == "银卡") membershipLevelInt = 2;
-                    else if (levelStr == "金卡") membershipLevelInt = 3;
-                    else if (levelStr == "白金") membershipLevelInt = 4;
-                    else if (levelStr == "钻石") membershipLevelInt = 5;
-                    else membershipLevelInt = levelStr.toInt();
-                }
-            }
-            if (membershipLevelInt < 1 || membershipLevelInt > 5) {
-                membershipLevelInt = 1;
+    // 加载买家（只显示role=1的用户）：数据与用户管理共用，由代理按身份列过滤
+    usersProxy->setColumnFilter(7, "买家");
+    loadUsers();
+}
+
+void BookAdmin::fetchMoreUsers(int offset)
+{
+    QJsonObject response = apiService->getAllUsers(currentAdminId, offset, RowTableModel::PAGE_SIZE);
+    if (!response["success"].toBool()) {
+        qWarning() << "fetchMoreUsers: 加载下一页失败:" << response["message"].toString();
+        usersModel->cancelFetch();
+        return;
+    }
+    usersModel->appendRows(makeUserRows(response["users"].toArray()), response["hasMore"].toBool());
+}
+
+QVector<TableRow> BookAdmin::makeUserRows(const QJsonArray &users) const
+{
+    QVector<TableRow> rows;
+    rows.reserve(users.size());
+    for (const QJsonValue &userVal : users) {
+        QJsonObject user = userVal.toObject();
+        
+        // 显示会员等级（放在身份列前面），用数字表示（1-5）
+        int membershipLevelInt = 1;
+        if (user.contains("membershipLevel")) {
+            QJsonValue levelVal = user["membershipLevel"];
+            if (levelVal.isDouble()) {
+                membershipLevelInt = levelVal.toInt();
+            } else {
+                QString levelStr = levelVal.toString();
+                // 兼容旧数据：如果是文本，转换为整数
+                if (levelStr == "普通") membershipLevelInt = 1;
+                else if (levelStr == "银卡") membershipLevelInt = 2;
+                else if (levelStr == "金卡") membershipLevelInt = 3;
+                else if (levelStr == "白金") membershipLevelInt = 4;
+                else if (levelStr == "钻石") membershipLevelInt = 5;
+                else membershipLevelInt = levelStr.toInt();
             }
-            usersTable->setItem(row, 6, new QTableWidgetItem(QString::number(membershipLevelInt)));
-            
-            // 显示身份（买家）
-            QTableWidgetItem *roleItem = new QTableWidgetItem("买家");
-            usersTable->setItem(row, 7, roleItem);
         }
-    }
+        if (membershipLevelInt < 1 || membershipLevelInt > 5) {
+            membershipLevelInt = 1;
+        }
+        
+        // 显示身份：0-审核中，1-买家，2-卖家
+        QString roleText;
+        switch (user["role"].toInt()) {
+            case 0:
+                roleText = "审核中";
+                break;
+            case 1:
+                roleText = "买家";
+                break;
+            case 2:
+                roleText = "卖家";
+                break;
+            default:
+                roleText = "未知";
+                break;
+        }
+        
+        TableRow row;
+        row.key = QString::number(user["userId"].toInt());
+        row.cells = QStringList{
+            row.key,
+            user["username"].toString(),
+            user["email"].toString(),
+            user["registerDate"].toString(),
+            user["status"].toString(),
+            QString::number(user["balance"].toDouble(), 'f', 2),
+            QString::number(membershipLevelInt),
+            roleText
+        };
+        rows.append(row);
+    }
+    return rows;
 }
 
 void BookAdmin::loadSellers()
@@ -2263,13 +2398,13 @@ void BookAdmin::onReviewSellerClicked()
 void BookAdmin::loadBooks()
 {
     qDebug() << "开始加载图书列表...";
-    QJsonObject response = apiService->getAllBooksGlobal(currentAdminId);
+    QJsonObject response = apiService->getAllBooksGlobal(currentAdminId, 0, booksModel->refreshLimit());
     
     if (response["success"].toBool()) {
         QJsonArray books = response["books"].toArray();
-        qDebug() << "获取到" << books.size() << "本图书";
+        qDebug() << "获取到" << books.size() << "本图书，共" << response["total"].toInt() << "本";
         
-        booksTable->setRowCount(0);
+        booksModel->setRows(makeBookRows(books), response["hasMore"].toBool());
         
         if (books.isEmpty()) {
             qDebug() << "图书列表为空";
@@ -2277,38 +2412,58 @@ void BookAdmin::loadBooks()
             return;
         }
         
-        for (const QJsonValue &bookVal : books) {
-            QJsonObject book = bookVal.toObject();
-            int row = booksTable->rowCount();
-            booksTable->insertRow(row);
-            
-            // 获取分类信息（优先使用category字段，如果没有则组合category1和category2）
-            QString category = book["category"].toString();
-            if (category.isEmpty()) {
-                QString category1 = book["category1"].toString();
-                QString category2 = book["category2"].toString();
-                category = category1;
-                if (!category2.isEmpty()) {
-                    category += " / " + category2;
-                }
-            }
-            
-            booksTable->setItem(row, 0, new QTableWidgetItem(book["isbn"].toString()));
-            booksTable->setItem(row, 1, new QTableWidgetItem(book["title"].toString()));
-            booksTable->setItem(row, 2, new QTableWidgetItem(book["author"].toString()));
-            booksTable->setItem(row, 3, new QTableWidgetItem(category));
-            booksTable->setItem(row, 4, new QTableWidgetItem(QString::number(book["price"].toDouble(), 'f', 2)));
-            booksTable->setItem(row, 5, new QTableWidgetItem(QString::number(book["stock"].toInt())));
-            booksTable->setItem(row, 6, new QTableWidgetItem(book["status"].toString()));
-        }
-        
-        qDebug() << "图书列表加载完成，共" << booksTable->rowCount() << "行";
+        qDebug() << "图书列表加载完成，共" << booksModel->rowCount() << "行";
     } else {
         QString errorMsg = response["message"].toString();
         qDebug() << "加载图书失败:" << errorMsg;
         QMessageBox::warning(this, "错误", "加载图书列表失败：" + errorMsg);
-        booksTable->setRowCount(0);
+        booksModel->clear();
+    }
+}
+
+void BookAdmin::fetchMoreBooks(int offset)
+{
+    QJsonObject response = apiService->getAllBooksGlobal(currentAdminId, offset, RowTableModel::PAGE_SIZE);
+    if (!response["success"].toBool()) {
+        qWarning() << "fetchMoreBooks: 加载下一页失败:" << response["message"].toString();
+        booksModel->cancelFetch();
+        return;
     }
+    booksModel->appendRows(makeBookRows(response["books"].toArray()), response["hasMore"].toBool());
+}
+
+QVector<TableRow> BookAdmin::makeBookRows(const QJsonArray &books) const
+{
+    QVector<TableRow> rows;
+    rows.reserve(books.size());
+    for (const QJsonValue &bookVal : books) {
+        QJsonObject book = bookVal.toObject();
+        
+        // 获取分类信息（优先使用category字段，如果没有则组合category1和category2）
+        QString category = book["category"].toString();
+        if (category.isEmpty()) {
+            QString category1 = book["category1"].toString();
+            QString category2 = book["category2"].toString();
+            category = category1;
+            if (!category2.isEmpty()) {
+                category += " / " + category2;
+            }
+        }
+        
+        TableRow row;
+        row.key = book["isbn"].toString();
+        row.cells = QStringList{
+            book["isbn"].toString(),
+            book["title"].toString(),
+            book["author"].toString(),
+            category,
+            QString::number(book["price"].toDouble(), 'f', 2),
+            QString::number(book["stock"].toInt()),
+            book["status"].toString()
+        };
+        rows.append(row);
+    }
+    return rows;
 }
 
 void BookAdmin::loadPendingBooks()
@@ -2418,24 +2573,45 @@ void BookAdmin::onRejectBookClicked()
 
 void BookAdmin::loadOrders()
 {
-    QJsonObject response = apiService->getAllOrdersGlobal(currentAdminId);
+    QJsonObject response = apiService->getAllOrdersGlobal(currentAdminId, 0, ordersModel->refreshLimit());
     if (response["success"].toBool()) {
-        QJsonArray orders = response["orders"].toArray();
-        ordersTable->setRowCount(0);
-        for (const QJsonValue &orderVal : orders) {
-            QJsonObject order = orderVal.toObject();
-            int row = ordersTable->rowCount();
-            ordersTable->insertRow(row);
-            ordersTable->setItem(row, 0, new QTableWidgetItem(order["orderId"].toString()));
-            ordersTable->setItem(row, 1, new QTableWidgetItem(order["userId"].toString()));
-            ordersTable->setItem(row, 2, new QTableWidgetItem(QString::number(order["totalAmount"].toDouble(), 'f', 2)));
-            ordersTable->setItem(row, 3, new QTableWidgetItem(order["status"].toString()));
-            ordersTable->setItem(row, 4, new QTableWidgetItem(order["orderDate"].toString()));
-            ordersTable->setItem(row, 5, new QTableWidgetItem(order["items"].toString()));
-        }
+        ordersModel->setRows(makeOrderRows(response["orders"].toArray()), response["hasMore"].toBool());
     }
 }
 
+void BookAdmin::fetchMoreOrders(int offset)
+{
+    QJsonObject response = apiService->getAllOrdersGlobal(currentAdminId, offset, RowTableModel::PAGE_SIZE);
+    if (!response["success"].toBool()) {
+        qWarning() << "fetchMoreOrders: 加载下一页失败:" << response["message"].toString();
+        ordersModel->cancelFetch();
+        return;
+    }
+    ordersModel->appendRows(makeOrderRows(response["orders"].toArray()), response["hasMore"].toBool());
+}
+
+QVector<TableRow> BookAdmin::makeOrderRows(const QJsonArray &orders) const
+{
+    QVector<TableRow> rows;
+    rows.reserve(orders.size());
+    for (const QJsonValue &orderVal : orders) {
+        QJsonObject order = orderVal.toObject();
+        
+        TableRow row;
+        row.key = order["orderId"].toString();
+        row.cells = QStringList{
+            row.key,
+            order["userId"].toString(),
+            QString::number(order["totalAmount"].toDouble(), 'f', 2),
+            order["status"].toString(),
+            order["orderDate"].toString(),
+            order["items"].toString()
+        };
+        rows.append(row);
+    }
+    return rows;
+}
+
 void BookAdmin::loadStats()
 {
     QJsonObject response = apiService->getSystemStats(currentAdminId);
@@ -2487,5 +2663,157 @@ void BookAdmin::loadStats()
             statsDisplay->setPlainText(statsText);
         }
     }
+
+    loadServerMetrics();
+}
+
+// 加载服务器运行指标：按p99从高到低排序，图中只画最慢的前10个动作
+void BookAdmin::loadServerMetrics()
+{
+    if (!metricsTable || !latencyChart) return;
+
+    QJsonObject response = apiService->getServerMetrics(currentAdminId);
+    if (!response["success"].toBool()) {
+        serverGaugeLabel->setText("获取服务器指标失败：" + response["message"].toString());
+        return;
+    }
+
+    QJsonObject metrics = response["metrics"].toObject();
+    QJsonObject connections = metrics["connections"].toObject();
+    QJsonObject pool = metrics["threadPool"].toObject();
+    QJsonObject db = metrics["db"].toObject();
+    serverGaugeLabel->setText(QString("运行 %1 秒 | 活跃连接 %2 | 线程池 %3/%4，排队 %5 | 数据库锁等待 %6，p99等待 %7 ms")
+                              .arg(metrics["uptimeSec"].toInt())
+                              .arg(connections["active"].toInt())
+                              .arg(pool["activeThreads"].toInt())
+                              .arg(pool["maxThreads"].toInt())
+                              .arg(pool["queued"].toInt())
+                              .arg(db["lockWaiters"].toInt())
+                              .arg(db["lockWaitUs"].toObject()["p99"].toDouble() / 1000.0, 0, 'f', 2));
+
+    QList<QJsonObject> actions;
+    for (const QJsonValue &value : metrics["actions"].toArray()) {
+        actions.append(value.toObject());
+    }
+    std::sort(actions.begin(), actions.end(), [](const QJsonObject &a, const QJsonObject &b) {
+        return a["latencyUs"].toObject()["p99"].toDouble() > b["latencyUs"].toObject()["p99"].toDouble();
+    });
+
+    auto toMs = [](double us) { return QString::number(us / 1000.0, 'f', 2); };
+    metricsTable->setRowCount(actions.size());
+    QVector<QString> labels;
+    QVector<double> p50;
+    QVector<double> p99;
+    for (int i = 0; i < actions.size(); ++i) {
+        const QJsonObject &action = actions[i];
+        QJsonObject latency = action["latencyUs"].toObject();
+        metricsTable->setItem(i, 0, new QTableWidgetItem(action["action"].toString()));
+        metricsTable->setItem(i, 1, new QTableWidgetItem(QString::number(action["count"].toDouble(), 'f', 0)));
+        metricsTable->setItem(i, 2, new QTableWidgetItem(QString::number(action["errors"].toDouble(), 'f', 0)));
+        metricsTable->setItem(i, 3, new QTableWidgetItem(toMs(latency["p50"].toDouble())));
+        metricsTable->setItem(i, 4, new QTableWidgetItem(toMs(latency["p99"].toDouble())));
+        metricsTable->setItem(i, 5, new QTableWidgetItem(toMs(latency["max"].toDouble())));
+        metricsTable->setItem(i, 6, new QTableWidgetItem(toMs(action["dbTimeUs"].toDouble())));
+        metricsTable->setItem(i, 7, new QTableWidgetItem(toMs(action["handlerTimeUs"].toDouble())));
+
+        if (i < 10) {
+            labels.append(action["action"].toString());
+            p50.append(latency["p50"].toDouble() / 1000.0);
+            p99.append(latency["p99"].toDouble() / 1000.0);
+        }
+    }
+    latencyChart->setLatencyData(labels, p50, p99);
+}
+
+// ===== 接口延迟柱状图 =====
+LatencyChartWidget::LatencyChartWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    setMinimumHeight(200);
+}
+
+void LatencyChartWidget::setLatencyData(const QVector<QString> &actions, const QVector<double> &p50, const QVector<double> &p99)
+{
+    actionLabels = actions;
+    p50Data = p50;
+    p99Data = p99;
+    update();
+}
+
+void LatencyChartWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.fillRect(rect(), QColor(248, 249, 250));
+
+    if (actionLabels.isEmpty()) {
+        painter.setPen(QColor(127, 140, 141));
+        painter.setFont(QFont("Microsoft YaHei", 12));
+        painter.drawText(rect(), Qt::AlignCenter, "暂无数据");
+        return;
+    }
+
+    int marginLeft = 60;
+    int marginRight = 20;
+    int marginTop = 30;
+    int marginBottom = 50;
+    int chartWidth = width() - marginLeft - marginRight;
+    int chartHeight = height() - marginTop - marginBottom;
+    if (chartWidth <= 0 || chartHeight <= 0) return;
+
+    // Y轴上限取p99最大值向上取整到1/2/5×10^n
+    double maxValue = 0.0;
+    for (double v : p99Data) maxValue = qMax(maxValue, v);
+    for (double v : p50Data) maxValue = qMax(maxValue, v);
+    double magnitude = qPow(10.0, qFloor(std::log10(qMax(maxValue, 0.01))));
+    double axisMax = magnitude;
+    for (double factor : {1.0, 2.0, 5.0, 10.0}) {
+        axisMax = factor * magnitude;
+        if (axisMax >= maxValue) break;
+    }
+
+    // 坐标轴与刻度
+    painter.setFont(QFont("Microsoft YaHei", 8));
+    for (int i = 0; i <= 4; ++i) {
+        int y = marginTop + chartHeight - chartHeight * i / 4;
+        painter.setPen(QPen(QColor(220, 221, 225), 1, Qt::DashLine));
+        painter.drawLine(marginLeft, y, marginLeft + chartWidth, y);
+        painter.setPen(QColor(127, 140, 141));
+        painter.drawText(QRect(0, y - 8, marginLeft - 5, 16), Qt::AlignRight | Qt::AlignVCenter,
+                         QString::number(axisMax * i / 4, 'g', 3) + "ms");
+    }
+    painter.setPen(QPen(QColor(52, 73, 94), 2));
+    painter.drawLine(marginLeft, marginTop + chartHeight, marginLeft + chartWidth, marginTop + chartHeight);
+    painter.drawLine(marginLeft, marginTop, marginLeft, marginTop + chartHeight);
+
+    // 每个动作一组：左p50、右p99
+    int count = actionLabels.size();
+    double groupWidth = double(chartWidth) / count;
+    double barWidth = qMin(24.0, groupWidth * 0.35);
+    QColor p50Color(52, 152, 219);
+    QColor p99Color(231, 76, 60);
+    for (int i = 0; i < count; ++i) {
+        double center = marginLeft + groupWidth * (i + 0.5);
+        double values[2] = { p50Data.value(i), p99Data.value(i) };
+        QColor colors[2] = { p50Color, p99Color };
+        for (int k = 0; k < 2; ++k) {
+            double barHeight = chartHeight * values[k] / axisMax;
+            QRectF bar(center - barWidth + k * barWidth, marginTop + chartHeight - barHeight, barWidth - 2, barHeight);
+            painter.fillRect(bar, colors[k]);
+        }
+        painter.setPen(QColor(44, 62, 80));
+        QString label = painter.fontMetrics().elidedText(actionLabels[i], Qt::ElideRight, int(groupWidth) - 4);
+        painter.drawText(QRectF(center - groupWidth / 2, marginTop + chartHeight + 5, groupWidth, 20),
+                         Qt::AlignHCenter | Qt::AlignTop, label);
+    }
+
+    // 图例
+    painter.fillRect(QRect(marginLeft + 5, 8, 12, 12), p50Color);
+    painter.setPen(QColor(44, 62, 80));
+    painter.drawText(QPoint(marginLeft + 22, 18), "p50");
+    painter.fillRect(QRect(marginLeft + 60, 8, 12, 12), p99Color);
+    painter.drawText(QPoint(marginLeft + 77, 18), "p99");
 }
 
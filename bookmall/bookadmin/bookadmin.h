@@ -3,6 +3,8 @@
 
 #include <QMainWindow>
 #include <QString>
+#include <QWidget>
+#include <QVector>
 
 // 前向声明，避免循环依赖和头文件包含问题
 class QStackedWidget;
@@ -10,11 +12,38 @@ class QLineEdit;
 class QPushButton;
 class QLabel;
 class QTableWidget;
+class QTableView;
+class QJsonArray;
 class QTextEdit;
 class QListWidget;
 class QTimer;
 class QWidget;
 class ApiService;
+class RowTableModel;
+class RowFilterProxyModel;
+struct TableRow;
+
+/**
+ * @brief 接口延迟柱状图：按请求动作并排显示p50和p99延迟（毫秒）
+ */
+class LatencyChartWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit LatencyChartWidget(QWidget *parent = nullptr);
+
+    // 设置各动作的延迟数据（三个向量一一对应，单位：毫秒）
+    void setLatencyData(const QVector<QString> &actions, const QVector<double> &p50, const QVector<double> &p99);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QVector<QString> actionLabels;
+    QVector<double> p50Data;
+    QVector<double> p99Data;
+};
 
 class BookAdmin : public QMainWindow
 {
@@ -34,6 +63,11 @@ private slots:
     void onBanUserClicked();      // 封禁用户
     void onUnbanUserClicked();    // 解封用户
     void onUserTableCellClicked(int row, int column);
+
+    // 表格分页：视图滚动到底部时向服务器拉取下一页
+    void fetchMoreUsers(int offset);
+    void fetchMoreBooks(int offset);
+    void fetchMoreOrders(int offset);
     
     // 审核相关
     void onApproveCertificationClicked();
@@ -101,6 +135,15 @@ private:
     void loadBooks();
     void loadOrders();
     void loadStats();
+    void loadServerMetrics();
+
+    // 服务器返回的JSON数组 -> 表格行
+    QVector<TableRow> makeUserRows(const QJsonArray &users) const;
+    QVector<TableRow> makeBookRows(const QJsonArray &books) const;
+    QVector<TableRow> makeOrderRows(const QJsonArray &orders) const;
+    // 创建只读表格视图：源模型 -> 排序/过滤代理 -> QTableView，过滤框输入即时过滤；
+    // selectedRow 在刷新增删行后自动跟随视图当前行
+    QTableView *createTableView(RowTableModel *model, RowFilterProxyModel *proxy, QLineEdit *filterEdit, int *selectedRow);
 
     // UI组件
     QStackedWidget *stackedWidget;
@@ -136,7 +179,10 @@ private:
     // 用户管理页面
     QWidget *usersPage;
     QLabel *usersTitleLabel;  // 用户管理页面标题（用于切换显示"用户管理"或"买家管理"）
-    QTableWidget *usersTable;
+    QTableView *usersTable;
+    RowTableModel *usersModel;
+    RowFilterProxyModel *usersProxy;  // 买家管理时按身份列只显示"买家"
+    QLineEdit *usersFilterEdit;
     QPushButton *refreshUsersBtn;
     QPushButton *banUserBtn;      // 封禁用户按钮
     QPushButton *unbanUserBtn;    // 解封用户按钮
@@ -169,7 +215,10 @@ private:
 
     // 图书管理页面
     QWidget *booksPage;
-    QTableWidget *booksTable;
+    QTableView *booksTable;
+    RowTableModel *booksModel;
+    RowFilterProxyModel *booksProxy;
+    QLineEdit *booksFilterEdit;
     QPushButton *refreshBooksBtn;
     QPushButton *editBookBtn;
     QPushButton *deleteBookBtn;
@@ -181,7 +230,10 @@ private:
 
     // 订单管理页面
     QWidget *ordersPage;
-    QTableWidget *ordersTable;
+    QTableView *ordersTable;
+    RowTableModel *ordersModel;
+    RowFilterProxyModel *ordersProxy;
+    QLineEdit *ordersFilterEdit;
     QPushButton *refreshOrdersBtn;
     QPushButton *viewOrderDetailsBtn;
     QPushButton *deleteOrderBtn;
@@ -190,6 +242,9 @@ private:
     // 统计页面
     QWidget *statsPage;
     QTextEdit *statsDisplay;
+    LatencyChartWidget *latencyChart;  // 服务器接口延迟图
+    QTableWidget *metricsTable;        // 服务器按动作的指标明细
+    QLabel *serverGaugeLabel;          // 连接数、线程池、数据库锁排队情况
     QPushButton *refreshStatsBtn;
     QPushButton *backFromStatsBtn;
     
@@ -211,14 +266,18 @@ private:
     QTextEdit *chatInput;
     QPushButton *sendChatBtn;
     QPushButton *refreshChatBtn;
+    QPushButton *newChatBtn;  // 选择任意买家/卖家发起会话（包括没有聊过的）
     QPushButton *backFromChatBtn;
+    int chatConversationOffset;  // 会话列表已加载的条数（分页）
     int currentChatUserId;
     QString currentChatUserType;
     QTimer *chatRefreshTimer;  // 聊天刷新定时器
     QTimer *dashboardRefreshTimer;  // 仪表盘自动刷新定时器
     // showChatPage() 已在第69行声明，删除此重复声明
     void loadChatUsers();
+    void loadMoreChatUsers();
     void onChatUserSelected();
+    void onNewChatClicked();
     void loadChatHistory();
     void onSendChatClicked();
 
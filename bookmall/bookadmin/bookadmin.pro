@@ -12,11 +12,13 @@ SOURCES += \
     apiservice.cpp \
     bookadmin.cpp \
     main.cpp \
+    rowtablemodel.cpp \
     tcpclient.cpp
 
 HEADERS += \
     apiservice.h \
     bookadmin.h \
+    rowtablemodel.h \
     tcpclient.h
 
 # Default rules for deployment.
@@ -0,0 +1,272 @@
+#include "rowtablemodel.h"
+#include <QBrush>
+
+RowTableModel::RowTableModel(const QStringList &headers, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_headers(headers)
+{
+}
+
+int RowTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+int RowTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_headers.size();
+}
+
+QVariant RowTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+
+    const TableRow &row = m_rows.at(index.row());
+    QString value = index.column() < row.cells.size() ? row.cells.at(index.column()) : QString();
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return value;
+    case SortRole:
+        if (m_numericColumns.contains(index.column())) {
+            return value.toDouble();
+        }
+        return value;
+    case Qt::ForegroundRole:
+        if (index.column() == m_highlightColumn && value == m_highlightValue) {
+            return QBrush(m_highlightColor);
+        }
+        break;
+    case Qt::ToolTipRole:
+        if (index.column() == m_highlightColumn && value == m_highlightValue) {
+            return m_highlightToolTip;
+        }
+        break;
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+QVariant RowTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    if (orientation == Qt::Horizontal) {
+        return section < m_headers.size() ? m_headers.at(section) : QVariant();
+    }
+    return section + 1;
+}
+
+bool RowTableModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_hasMore && !m_fetching;
+}
+
+void RowTableModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+    // 只发请求信号，真正的网络请求由窗口在事件循环中排队执行，避免在视图布局过程中阻塞
+    m_fetching = true;
+    emit fetchMoreRequested(m_rows.size());
+}
+
+void RowTableModel::setNumericColumns(const QList<int> &columns)
+{
+    m_numericColumns = QSet<int>::fromList(columns);
+}
+
+void RowTableModel::setHighlight(int column, const QString &value, const QColor &color, const QString &toolTip)
+{
+    m_highlightColumn = column;
+    m_highlightValue = value;
+    m_highlightColor = color;
+    m_highlightToolTip = toolTip;
+}
+
+void RowTableModel::setRows(const QVector<TableRow> &rows, bool hasMore)
+{
+    m_hasMore = hasMore;
+    m_fetching = false;
+
+    // 新数据的主键 -> 行号；主键重复时无法逐行比对，直接整体重置
+    QHash<QString, int> newIndex;
+    newIndex.reserve(rows.size());
+    bool duplicated = false;
+    for (int i = 0; i < rows.size() && !duplicated; ++i) {
+        duplicated = newIndex.contains(rows.at(i).key);
+        newIndex.insert(rows.at(i).key, i);
+    }
+
+    if (m_rows.isEmpty() || rows.isEmpty() || duplicated) {
+        beginResetModel();
+        m_rows = rows;
+        rebuildKeyIndex();
+        endResetModel();
+        return;
+    }
+
+    // 1. 删除新数据中已不存在的行（从后往前，连续的一段只发一次信号）
+    int last = m_rows.size() - 1;
+    while (last >= 0) {
+        if (newIndex.contains(m_rows.at(last).key)) {
+            --last;
+            continue;
+        }
+        int first = last;
+        while (first > 0 && !newIndex.contains(m_rows.at(first - 1).key)) {
+            --first;
+        }
+        beginRemoveRows(QModelIndex(), first, last);
+        m_rows.erase(m_rows.begin() + first, m_rows.begin() + last + 1);
+        endRemoveRows();
+        last = first - 1;
+    }
+    rebuildKeyIndex();
+
+    // 2. 按新顺序逐行比对：主键相同只在内容变化时发dataChanged，新主键就地插入
+    int changedFirst = -1;
+    int changedLast = -1;
+    for (int i = 0; i < rows.size(); ++i) {
+        const TableRow &incoming = rows.at(i);
+
+        if (i < m_rows.size() && m_rows.at(i).key == incoming.key) {
+            if (m_rows.at(i).cells != incoming.cells) {
+                m_rows[i].cells = incoming.cells;
+                if (changedFirst >= 0 && changedLast == i - 1) {
+                    changedLast = i;
+                } else {
+                    emitRowsChanged(changedFirst, changedLast);
+                    changedFirst = changedLast = i;
+                }
+            }
+            continue;
+        }
+
+        emitRowsChanged(changedFirst, changedLast);
+        changedFirst = changedLast = -1;
+
+        if (m_keyIndex.contains(incoming.key)) {
+            // 已有行的相对顺序变了（如排序字段被修改），无法局部更新，整体重置
+            beginResetModel();
+            m_rows = rows;
+            rebuildKeyIndex();
+            endResetModel();
+            return;
+        }
+
+        int end = i;
+        while (end + 1 < rows.size() && !m_keyIndex.contains(rows.at(end + 1).key)) {
+            ++end;
+        }
+        beginInsertRows(QModelIndex(), i, end);
+        m_rows.insert(i, end - i + 1, TableRow());
+        for (int k = i; k <= end; ++k) {
+            m_rows[k] = rows.at(k);
+        }
+        endInsertRows();
+        i = end;
+    }
+    emitRowsChanged(changedFirst, changedLast);
+    rebuildKeyIndex();
+}
+
+void RowTableModel::appendRows(const QVector<TableRow> &rows, bool hasMore)
+{
+    m_hasMore = hasMore;
+    m_fetching = false;
+
+    QVector<TableRow> fresh;
+    fresh.reserve(rows.size());
+    for (const TableRow &row : rows) {
+        if (m_keyIndex.contains(row.key)) {
+            continue;
+        }
+        m_keyIndex.insert(row.key, m_rows.size() + fresh.size());
+        fresh.append(row);
+    }
+    if (fresh.isEmpty()) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + fresh.size() - 1);
+    m_rows += fresh;
+    endInsertRows();
+}
+
+void RowTableModel::cancelFetch()
+{
+    m_fetching = false;
+}
+
+void RowTableModel::clear()
+{
+    setRows(QVector<TableRow>(), false);
+}
+
+QString RowTableModel::text(int row, int column) const
+{
+    if (row < 0 || row >= m_rows.size()) {
+        return QString();
+    }
+    const QStringList &cells = m_rows.at(row).cells;
+    return column >= 0 && column < cells.size() ? cells.at(column) : QString();
+}
+
+void RowTableModel::rebuildKeyIndex()
+{
+    m_keyIndex.clear();
+    m_keyIndex.reserve(m_rows.size());
+    for (int i = 0; i < m_rows.size(); ++i) {
+        m_keyIndex.insert(m_rows.at(i).key, i);
+    }
+}
+
+void RowTableModel::emitRowsChanged(int first, int last)
+{
+    if (first < 0) {
+        return;
+    }
+    emit dataChanged(index(first, 0), index(last, columnCount() - 1));
+}
+
+// ===== RowFilterProxyModel =====
+
+RowFilterProxyModel::RowFilterProxyModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+{
+    setSortRole(RowTableModel::SortRole);
+    setFilterKeyColumn(-1);  // 文本过滤匹配任意一列
+    setFilterCaseSensitivity(Qt::CaseInsensitive);
+}
+
+void RowFilterProxyModel::setColumnFilter(int column, const QString &value)
+{
+    m_filterColumn = column;
+    m_filterValue = value;
+    invalidateFilter();
+}
+
+int RowFilterProxyModel::sourceRow(int proxyRow) const
+{
+    if (proxyRow < 0 || proxyRow >= rowCount()) {
+        return -1;
+    }
+    return mapToSource(index(proxyRow, 0)).row();
+}
+
+bool RowFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (m_filterColumn >= 0 && !m_filterValue.isEmpty()) {
+        QModelIndex cell = sourceModel()->index(sourceRow, m_filterColumn, sourceParent);
+        if (cell.data().toString() != m_filterValue) {
+            return false;
+        }
+    }
+    return QSortFilterProxyModel::filterAcceptsRow(sourceRow, sourceParent);
+}
@@ -6,12 +6,17 @@
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QTimer>
-#include <QMutex>
-#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
 #include <QString>
 #include <QByteArray>
 
 // TCP客户端类 - 用于与服务端通信
+// 连接管理：connectToServer只记录服务器地址并发起异步连接，不等待连接完成；连接断开后按指数退避自动重连，
+// 连接期间开启TCP keepalive，空闲时定时发送应用层心跳（ping），心跳无响应视为断线。
+// 未连接时发出的请求在队列中等待，连上后按顺序发送；断线时已发出但未收到响应的只读请求（get/search）
+// 在重连后重发，其他请求返回"连接中断"，避免重复下单或支付。
 class TcpClient : public QObject
 {
     Q_OBJECT
@@ -20,33 +25,82 @@ public:
     explicit TcpClient(QObject *parent = nullptr);
     ~TcpClient();
 
+    enum {
+        CONNECT_TIMEOUT_MS = 3000,      // 单次连接尝试的超时
+        RECONNECT_INITIAL_MS = 500,     // 首次重连等待，之后每次翻倍
+        RECONNECT_MAX_MS = 30000,       // 重连等待上限
+        HEARTBEAT_IDLE_MS = 15000,      // 连接空闲超过该时长时发送心跳
+        HEARTBEAT_TIMEOUT_MS = 10000,   // 心跳超过该时长无响应视为断线
+        HEARTBEAT_CHECK_MS = 5000
+    };
+
+    // 异步连接：参数有效时立即返回true，连接结果通过connected/errorOccurred信号通知
     bool connectToServer(const QString &host = "localhost", quint16 port = 8888);
+    // 停止自动重连并断开连接（不等待），队列中的请求返回失败
     void disconnectFromServer();
     bool isConnected() const;
 
-    // 发送JSON请求并等待响应
+    // 发送JSON请求并等待响应：等待期间运行局部事件循环，界面照常响应；未连接时请求排队，连上后发送
     QJsonObject sendRequest(const QJsonObject &request, int timeout = 5000);
 
+    // 登录后服务器返回的会话token，之后的请求自动携带
+    void setSessionToken(const QString &token);
+    void clearSessionToken();
+
 signals:
     void connected();
     void disconnected();
-    void errorOccurred(const QString &error);
+    void errorOccurred(const QString &error);      // 每次断线只通知一次，重连失败时不重复通知
+    void reconnecting(int attempt, int delayMs);
+    void requestFinished(quint64 requestId);       // 内部使用：某个请求收到响应或失败
 
 private slots:
     void onConnected();
     void onDisconnected();
     void onReadyRead();
     void onError(QAbstractSocket::SocketError error);
+    void onConnectTimeout();
+    void onHeartbeatTimer();
+    void startConnecting();
 
 private:
+    struct PendingRequest {
+        quint64 id = 0;
+        QByteArray frame;
+        bool replayable = false;   // 只读请求：断线后可以重发
+        bool heartbeat = false;
+        bool abandoned = false;    // 调用方已超时返回，响应到达后丢弃
+    };
+
+    void connectionLost(const QString &reason);
+    void scheduleReconnect();
+    void flushOutbox();
+    void writeRequest(const PendingRequest &request);
+    void completeRequest(quint64 id, const QJsonObject &response);
+    void failRequest(quint64 id, const QString &error);
+    static QByteArray encodeFrame(const QJsonObject &object);
+    static bool isReplayable(const QString &action);
+
     QTcpSocket *socket;
-    QJsonObject pendingResponse;
-    bool responseReceived;
-    QTimer *timeoutTimer;
-    QMutex responseMutex;
-    QWaitCondition responseCondition;
+    QString serverHost;
+    quint16 serverPort;
+    bool autoReconnect;
+    int reconnectAttempt;
+    bool errorReported;             // 本次断线已经通知过界面
+    QTimer *reconnectTimer;
+    QTimer *connectTimeoutTimer;
+    QTimer *heartbeatTimer;
+    QElapsedTimer lastActivity;     // 最近一次收发数据
+    QElapsedTimer heartbeatSent;
+    bool heartbeatPending;
+
+    QList<PendingRequest> outbox;       // 等待连接后发送
+    QList<PendingRequest> inflight;     // 已发送、按发送顺序等待响应（服务器按顺序处理同一连接的请求）
+    QHash<quint64, QJsonObject> completed;
+    quint64 nextRequestId;
+
     QByteArray recvBuffer;  // 接收缓冲区，用于处理分片数据
+    QString authToken;      // 会话token（为空表示未登录）
 };
 
 #endif // TCPCLIENT_H
-
@@ -40,17 +40,35 @@ QJsonObject ApiService::login(const QString &username, const QString &password)
     request["username"] = username;
     request["password"] = password;
     request["userType"] = "seller";  // 商家端登录，明确指定为seller
-    return tcpClient->sendRequest(request, 10000);
+    QJsonObject response = tcpClient->sendRequest(request, 10000);
+    if (response.value("success").toBool()) {
+        tcpClient->setSessionToken(response.value("token").toString());
+    }
+    return response;
+}
+
+// 退出登录：注销服务器上的会话
+QJsonObject ApiService::logout()
+{
+    QJsonObject request;
+    request["action"] = "logout";
+    QJsonObject response = tcpClient->sendRequest(request, 5000);
+    tcpClient->clearSessionToken();
+    return response;
 }
 
 // ===== 商家端专用API =====
 
 // 图书管理API
-QJsonObject ApiService::getSellerBooks(const QString &sellerId)
+QJsonObject ApiService::getSellerBooks(const QString &sellerId, int offset, int limit)
 {
     QJsonObject request;
     request["action"] = "sellerGetBooks";
     request["sellerId"] = sellerId;
+    if (limit > 0) {
+        request["offset"] = offset;
+        request["limit"] = limit;
+    }
     return tcpClient->sendRequest(request, 10000);
 }
 
@@ -89,11 +107,15 @@ QJsonObject ApiService::deleteBook(const QString &sellerId, const QString &bookI
 }
 
 // 订单管理API
-QJsonObject ApiService::getSellerOrders(const QString &sellerId)
+QJsonObject ApiService::getSellerOrders(const QString &sellerId, int offset, int limit)
 {
     QJsonObject request;
     request["action"] = "sellerGetOrders";
     request["sellerId"] = sellerId;
+    if (limit > 0) {
+        request["offset"] = offset;
+        request["limit"] = limit;
+    }
     return tcpClient->sendRequest(request, 10000);
 }
 
@@ -128,11 +150,15 @@ QJsonObject ApiService::deleteOrder(const QString &sellerId, const QString &orde
 }
 
 // 会员管理API
-QJsonObject ApiService::getMembers(const QString &sellerId)
+QJsonObject ApiService::getMembers(const QString &sellerId, int offset, int limit, const QJsonObject &filters)
 {
-    QJsonObject request;
+    QJsonObject request = filters;
     request["action"] = "sellerGetMembers";
     request["sellerId"] = sellerId;
+    if (limit > 0) {
+        request["offset"] = offset;
+        request["limit"] = limit;
+    }
     return tcpClient->sendRequest(request, 10000);
 }
 
@@ -187,6 +213,17 @@ QJsonObject ApiService::getDashboardStats(const QString &sellerId)
     return tcpClient->sendRequest(request, 10000);
 }
 
+QJsonObject ApiService::getDashboardSnapshot(const QString &sellerId, const QString &etag)
+{
+    QJsonObject request;
+    request["action"] = "sellerDashboardSnapshot";
+    request["sellerId"] = sellerId;
+    if (!etag.isEmpty()) {
+        request["etag"] = etag;
+    }
+    return tcpClient->sendRequest(request, 10000);
+}
+
 QJsonObject ApiService::getSalesReport(const QString &sellerId, const QString &startDate, const QString &endDate)
 {
     QJsonObject request;
@@ -298,7 +335,8 @@ QJsonObject ApiService::sendChatMessage(const QString &senderId, const QString &
 }
 
 QJsonObject ApiService::getChatHistory(const QString &userId, const QString &userType, 
-                                      const QString &otherUserId, const QString &otherUserType)
+                                      const QString &otherUserId, const QString &otherUserType,
+                                      int beforeId, int limit)
 {
     QJsonObject request;
     request["action"] = "getChatHistory";
@@ -310,6 +348,39 @@ QJsonObject ApiService::getChatHistory(const QString &userId, const QString &use
     if (!otherUserType.isEmpty()) {
         request["otherUserType"] = otherUserType;
     }
+    if (limit > 0) {
+        request["limit"] = limit;
+        if (beforeId > 0) {
+            request["beforeId"] = beforeId;
+        }
+    }
+    return tcpClient->sendRequest(request, 10000);
+}
+
+QJsonObject ApiService::getConversations(const QString &userId, const QString &userType,
+                                         const QString &peerType, int offset, int limit)
+{
+    QJsonObject request;
+    request["action"] = "getConversations";
+    request["userId"] = userId;
+    request["userType"] = userType;
+    if (!peerType.isEmpty()) {
+        request["peerType"] = peerType;
+    }
+    request["offset"] = offset;
+    request["limit"] = limit;
+    return tcpClient->sendRequest(request, 10000);
+}
+
+QJsonObject ApiService::markConversationRead(const QString &userId, const QString &userType,
+                                             int peerId, const QString &peerType)
+{
+    QJsonObject request;
+    request["action"] = "markConversationRead";
+    request["userId"] = userId;
+    request["userType"] = userType;
+    request["peerId"] = peerId;
+    request["peerType"] = peerType;
     return tcpClient->sendRequest(request, 10000);
 }
 
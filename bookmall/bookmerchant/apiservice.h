@@ -23,23 +23,27 @@ public:
 
     // 用户相关API（商家登录）
     QJsonObject login(const QString &username, const QString &password);
+    QJsonObject logout();
     
     // ===== 商家端专用API =====
     
+    // 列表类接口的 offset/limit 用于分页，limit<=0 时返回全部
+    
     // 图书管理API
-    QJsonObject getSellerBooks(const QString &sellerId);
+    QJsonObject getSellerBooks(const QString &sellerId, int offset = 0, int limit = 0);
     QJsonObject addBook(const QString &sellerId, const QJsonObject &bookData);
     QJsonObject updateBook(const QString &sellerId, const QString &bookId, const QJsonObject &bookData);
     QJsonObject deleteBook(const QString &sellerId, const QString &bookId);
     
     // 订单管理API
-    QJsonObject getSellerOrders(const QString &sellerId);
+    QJsonObject getSellerOrders(const QString &sellerId, int offset = 0, int limit = 0);
     QJsonObject createOrder(const QString &sellerId, const QJsonObject &orderData);
     QJsonObject updateOrderStatus(const QString &sellerId, const QString &orderId, const QString &status);
     QJsonObject deleteOrder(const QString &sellerId, const QString &orderId);
     
     // 会员管理API
-    QJsonObject getMembers(const QString &sellerId);
+    // filters可含 memberLevel、minSpent、maxSpent、activeDays（最近N天内下过单）
+    QJsonObject getMembers(const QString &sellerId, int offset = 0, int limit = 0, const QJsonObject &filters = QJsonObject());
     QJsonObject addMember(const QString &sellerId, const QJsonObject &memberData);
     QJsonObject updateMember(const QString &sellerId, const QString &memberId, const QJsonObject &memberData);
     QJsonObject deleteMember(const QString &sellerId, const QString &memberId);
@@ -47,6 +51,8 @@ public:
     
     // 统计报表API
     QJsonObject getDashboardStats(const QString &sellerId);
+    // 仪表板快照（统计+状态计数+近7天曲线）；etag为上次返回的版本，未变化时只返回 notModified
+    QJsonObject getDashboardSnapshot(const QString &sellerId, const QString &etag = QString());
     QJsonObject getSalesReport(const QString &sellerId, const QString &startDate, const QString &endDate);
     QJsonObject getInventoryReport(const QString &sellerId, const QString &startDate, const QString &endDate);
     QJsonObject getMemberReport(const QString &sellerId, const QString &startDate, const QString &endDate);
@@ -65,8 +71,15 @@ public:
     QJsonObject sendChatMessage(const QString &senderId, const QString &senderType, 
                                 const QString &receiverId, const QString &receiverType, 
                                 const QString &message);
+    // limit > 0 时只取beforeId（0为最新）之前的最多limit条
     QJsonObject getChatHistory(const QString &userId, const QString &userType, 
-                               const QString &otherUserId = "", const QString &otherUserType = "");
+                               const QString &otherUserId = "", const QString &otherUserType = "",
+                               int beforeId = 0, int limit = 0);
+    // 会话列表（按最近消息倒序分页），peerType为空表示全部
+    QJsonObject getConversations(const QString &userId, const QString &userType,
+                                 const QString &peerType = "", int offset = 0, int limit = 50);
+    QJsonObject markConversationRead(const QString &userId, const QString &userType,
+                                     int peerId, const QString &peerType);
     
     // 评论相关API
     QJsonObject getBookReviews(const QString &bookId);
@@ -9,6 +9,7 @@
 #include <QDialogButtonBox>
 #include <QDebug>
 #include <QHeaderView>
+#include <QTableView>
 #include <QDate>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -30,6 +31,11 @@
 #include <QRectF>
 #include <cmath>
 
+// 买家会话列表每页条数，列表末尾的“加载更多”按offset取下一页
+static const int kBuyerListPageSize = 50;
+// 买家列表中“加载更多”项的标记（Qt::UserRole + 1）
+static const int kLoadMoreRole = Qt::UserRole + 1;
+
 BookMerchant::BookMerchant(QWidget *parent)
     : QMainWindow(parent)
     , selectedBookRow(-1)
@@ -39,6 +45,7 @@ BookMerchant::BookMerchant(QWidget *parent)
     , serverIp("127.0.0.1")     // 默认服务器IP
     , serverPort(8888)           // 默认服务器端口
     , currentChatBuyerId(-1)     // 初始化当前聊天买家ID（-1表示与客服聊天）
+    , buyerListOffset(0)
     , salesChartWidget(nullptr)  // 初始化销量趋势图组件
 {
     apiService = new ApiService(this);
@@ -86,18 +93,13 @@ BookMerchant::BookMerchant(QWidget *parent)
     
     // 程序启动后500ms自动连接服务器
     QTimer::singleShot(500, this, [this]() {
-        qDebug() << "自动连接服务器...";
-        if (!apiService->isConnected()) {
-            if (apiService->connectToServer(serverIp, serverPort)) {
-                qDebug() << "自动连接服务器成功";
-            } else {
-                qDebug() << "自动连接服务器失败，将在登录时重试";
-                if (loginStatusLabel) {
-                    loginStatusLabel->setText("⚠ 正在连接服务器...");
-                    loginStatusLabel->setStyleSheet("color: orange;");
-                }
-            }
+        // 异步连接：连接成功后由connected信号更新状态，失败后自动重连
+        qDebug() << "自动连接服务器:" << serverIp << ":" << serverPort;
+        if (loginStatusLabel && !apiService->isConnected()) {
+            loginStatusLabel->setText("⚠ 正在连接服务器...");
+            loginStatusLabel->setStyleSheet("color: orange;");
         }
+        apiService->connectToServer(serverIp, serverPort);
     });
 }
 
@@ -367,16 +369,16 @@ void BookMerchant::initUI()
     booksButtonLayout->addWidget(editBookBtn);
     booksButtonLayout->addWidget(deleteBookBtn);
     booksButtonLayout->addStretch();
+    booksFilterEdit = new QLineEdit();
+    booksButtonLayout->addWidget(booksFilterEdit);
     booksButtonLayout->addWidget(backFromBooksBtn);
 
     booksLayout->addLayout(booksButtonLayout);
 
-    booksTable = new QTableWidget();
-    booksTable->setColumnCount(9);
-    booksTable->setHorizontalHeaderLabels({"ISBN", "书名", "作者", "分类", "子分类", "价格", "库存", "销量", "状态"});
-    booksTable->horizontalHeader()->setStretchLastSection(true);
-    booksTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-    booksTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    booksModel = new RowTableModel({"ISBN", "书名", "作者", "分类", "子分类", "价格", "库存", "销量", "状态"}, this);
+    booksModel->setNumericColumns({5, 6, 7});
+    booksProxy = new RowFilterProxyModel(this);
+    booksTable = createTableView(booksModel, booksProxy, booksFilterEdit, &selectedBookRow);
     booksLayout->addWidget(booksTable);
 
     stackedWidget->addWidget(booksPage);
@@ -406,16 +408,16 @@ void BookMerchant::initUI()
     ordersButtonLayout->addWidget(updateOrderStatusBtn);
     ordersButtonLayout->addWidget(deleteOrderBtn);
     ordersButtonLayout->addStretch();
+    ordersFilterEdit = new QLineEdit();
+    ordersButtonLayout->addWidget(ordersFilterEdit);
     ordersButtonLayout->addWidget(backFromOrdersBtn);
 
     ordersLayout->addLayout(ordersButtonLayout);
 
-    ordersTable = new QTableWidget();
-    ordersTable->setColumnCount(6);
-    ordersTable->setHorizontalHeaderLabels({"订单ID", "客户", "总金额", "状态", "下单时间", "发货时间"});
-    ordersTable->horizontalHeader()->setStretchLastSection(true);
-    ordersTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-    ordersTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ordersModel = new RowTableModel({"订单ID", "客户", "总金额", "状态", "下单时间", "发货时间"}, this);
+    ordersModel->setNumericColumns({2});
+    ordersProxy = new RowFilterProxyModel(this);
+    ordersTable = createTableView(ordersModel, ordersProxy, ordersFilterEdit, &selectedOrderRow);
     ordersLayout->addWidget(ordersTable);
 
     stackedWidget->addWidget(ordersPage);
@@ -438,16 +440,16 @@ void BookMerchant::initUI()
     membersButtonLayout->addWidget(editMemberBtn);
     membersButtonLayout->addWidget(deleteMemberBtn);
     membersButtonLayout->addStretch();
+    membersFilterEdit = new QLineEdit();
+    membersButtonLayout->addWidget(membersFilterEdit);
     membersButtonLayout->addWidget(backFromMembersBtn);
 
     membersLayout->addLayout(membersButtonLayout);
 
-    membersTable = new QTableWidget();
-    membersTable->setColumnCount(5);
-    membersTable->setHorizontalHeaderLabels({"用户ID", "用户名", "邮箱", "会员等级", "注册日期"});
-    membersTable->horizontalHeader()->setStretchLastSection(true);
-    membersTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-    membersTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    membersModel = new RowTableModel({"用户ID", "用户名", "邮箱", "会员等级", "注册日期", "订单数", "累计消费", "最近下单"}, this);
+    membersModel->setNumericColumns({0, 5, 6});
+    membersProxy = new RowFilterProxyModel(this);
+    membersTable = createTableView(membersModel, membersProxy, membersFilterEdit, &selectedMemberRow);
     membersLayout->addWidget(membersTable);
 
     stackedWidget->addWidget(membersPage);
@@ -1176,6 +1178,37 @@ void BookMerchant::initUI()
     stackedWidget->addWidget(buyerChatPage);
 }
 
+// 创建只读表格视图：源模型 -> 排序/过滤代理 -> QTableView
+// 视图只绘制可见行，不再为每个单元格分配QTableWidgetItem
+QTableView *BookMerchant::createTableView(RowTableModel *model, RowFilterProxyModel *proxy, QLineEdit *filterEdit, int *selectedRow)
+{
+    proxy->setSourceModel(model);
+
+    QTableView *view = new QTableView();
+    view->setModel(proxy);
+    view->horizontalHeader()->setStretchLastSection(true);
+    view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    // 点击表头前保持服务器返回的顺序（如订单按下单时间倒序）
+    view->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    view->setSortingEnabled(true);
+
+    filterEdit->setPlaceholderText("输入关键字过滤");
+    filterEdit->setClearButtonEnabled(true);
+    filterEdit->setMaximumWidth(220);
+    connect(filterEdit, &QLineEdit::textChanged, proxy, &RowFilterProxyModel::setFilterFixedString);
+
+    // 刷新时增删行会让行号变化，按视图当前行重新定位选中的源数据行
+    auto syncSelection = [view, proxy, selectedRow]() {
+        *selectedRow = proxy->sourceRow(view->currentIndex().row());
+    };
+    connect(model, &QAbstractItemModel::rowsInserted, view, syncSelection);
+    connect(model, &QAbstractItemModel::rowsRemoved, view, syncSelection);
+    connect(model, &QAbstractItemModel::modelReset, view, syncSelection);
+
+    return view;
+}
+
 void BookMerchant::initConnections()
 {
     // 登录页面
@@ -1197,20 +1230,30 @@ void BookMerchant::initConnections()
     connect(editBookBtn, &QPushButton::clicked, this, &BookMerchant::onEditBookClicked);
     connect(deleteBookBtn, &QPushButton::clicked, this, &BookMerchant::onDeleteBookClicked);
     connect(backFromBooksBtn, &QPushButton::clicked, this, &BookMerchant::showMainPage);
-    connect(booksTable, &QTableWidget::cellClicked, this, &BookMerchant::onBookTableCellClicked);
+    // 视图行号经代理映射回源模型行号，排序/过滤后选中的仍是同一条数据
+    connect(booksTable, &QTableView::clicked, this, [this](const QModelIndex &index) {
+        onBookTableCellClicked(booksProxy->sourceRow(index.row()), index.column());
+    });
+    connect(booksModel, &RowTableModel::fetchMoreRequested, this, &BookMerchant::fetchMoreBooks, Qt::QueuedConnection);
 
     // 订单管理
     connect(refreshOrdersBtn, &QPushButton::clicked, this, &BookMerchant::onRefreshOrdersClicked);
     connect(updateOrderStatusBtn, &QPushButton::clicked, this, &BookMerchant::onUpdateOrderStatusClicked);
     connect(deleteOrderBtn, &QPushButton::clicked, this, &BookMerchant::onDeleteOrderClicked);
     connect(backFromOrdersBtn, &QPushButton::clicked, this, &BookMerchant::showMainPage);
-    connect(ordersTable, &QTableWidget::cellClicked, this, &BookMerchant::onOrderTableCellClicked);
+    connect(ordersTable, &QTableView::clicked, this, [this](const QModelIndex &index) {
+        onOrderTableCellClicked(ordersProxy->sourceRow(index.row()), index.column());
+    });
+    connect(ordersModel, &RowTableModel::fetchMoreRequested, this, &BookMerchant::fetchMoreOrders, Qt::QueuedConnection);
 
     // 会员管理
     connect(editMemberBtn, &QPushButton::clicked, this, &BookMerchant::onEditMemberClicked);
     connect(deleteMemberBtn, &QPushButton::clicked, this, &BookMerchant::onDeleteMemberClicked);
     connect(backFromMembersBtn, &QPushButton::clicked, this, &BookMerchant::showMainPage);
-    connect(membersTable, &QTableWidget::cellClicked, this, &BookMerchant::onMemberTableCellClicked);
+    connect(membersTable, &QTableView::clicked, this, [this](const QModelIndex &index) {
+        onMemberTableCellClicked(membersProxy->sourceRow(index.row()), index.column());
+    });
+    connect(membersModel, &RowTableModel::fetchMoreRequested, this, &BookMerchant::fetchMoreMembers, Qt::QueuedConnection);
 
     // 统计报表
     connect(refreshStatsBtn, &QPushButton::clicked, this, &BookMerchant::onRefreshStatsClicked);
@@ -1317,7 +1360,7 @@ void BookMerchant::applyStyle()
         }
         
         /* 表格统一样式 */
-        QTableWidget {
+        QTableView {
             background-color: white;
             border: 1px solid %2;
             border-radius: 8px;
@@ -1326,12 +1369,12 @@ void BookMerchant::applyStyle()
             color: %3;
         }
         
-        QTableWidget::item {
+        QTableView::item {
             padding: 8px;
             border: none;
         }
         
-        QTableWidget::item:selected {
+        QTableView::item:selected {
             background-color: %4;
             color: white;
         }
@@ -1760,205 +1803,79 @@ void BookMerchant::updateDashboardData()
         return;
     }
     
-    // 先尝试从服务器获取统计数据
-    QJsonObject response = apiService->getDashboardStats(currentSellerId);
+    // 一次请求取回统计卡片、订单状态计数和近7天曲线；带上上次的版本号，数据没变时服务器只回 notModified
+    QJsonObject response = apiService->getDashboardSnapshot(currentSellerId, dashboardEtag);
     
-    if (response["success"].toBool()) {
-        // 解析服务器返回的统计数据
-        QJsonObject stats = response["stats"].toObject();
-        
-        // 获取总数据
-        int totalOrders = stats["totalOrders"].toInt(0);
-        double totalSales = stats["totalSales"].toDouble(0.0);
-        int totalBooks = stats["totalBooks"].toInt(0);
-        int totalMembers = stats["totalMembers"].toInt(0);
-        
-        // 更新图书总数（直接使用服务器数据）
-        if (booksValueLabel) {
-            booksValueLabel->setText(QString::number(totalBooks));
-        }
-        
-        // 计算今日订单、销量和收入（需要从订单数据中计算）
-        // 强制重新加载订单数据以获取最新数据（不显示提示，不更新仪表板避免循环）
-        loadOrders(false, false);  // 不显示提示，不更新仪表板
-        
-        int todayOrderCount = 0;
-        int todaySalesCount = 0;
-        double todayRevenueAmount = 0.0;
-        
-        if (ordersTable && ordersTable->rowCount() > 0) {
-            QDate today = QDate::currentDate();
-            QString todayStr = today.toString("yyyy-MM-dd");
-            
-            // 订单表格列：0-订单ID, 1-客户, 2-总金额, 3-状态, 4-下单时间, 5-发货时间
-            for (int i = 0; i < ordersTable->rowCount(); ++i) {
-                // 检查下单时间列（第4列，索引4）
-                QTableWidgetItem *dateItem = ordersTable->item(i, 4);
-                if (dateItem && dateItem->text().contains(todayStr)) {
-                    todayOrderCount++;
-                    
-                    // 获取订单金额（第2列，索引2）
-                    QTableWidgetItem *amountItem = ordersTable->item(i, 2);
-                    if (amountItem) {
-                        QString amountText = amountItem->text();
-                        // 移除可能的货币符号和空格
-                        amountText.remove("¥").remove("$").remove(",").remove(" ");
-                        bool ok;
-                        double amount = amountText.toDouble(&ok);
-                        if (ok && amount > 0) {
-                            todayRevenueAmount += amount;
-                        }
-                    }
-                    
-                    // 注意：订单表格中没有直接的数量列，销量需要从订单items中计算
-                    // 这里暂时使用订单数量作为销量（每个订单算1个销量单位）
-                    // 如果需要更精确的销量，需要从订单的items JSON中解析
-                    todaySalesCount += 1;  // 每个订单算1个销量单位
-                }
-            }
-        }
-        
-        // 更新今日订单数
-        if (orderValueLabel) {
-            orderValueLabel->setText(QString::number(todayOrderCount));
-        }
-        
-        // 更新今日销量
-        if (salesValueLabel) {
-            salesValueLabel->setText(QString::number(todaySalesCount));
-        }
-        
-        // 更新今日收入
-        if (revenueValueLabel) {
-            revenueValueLabel->setText(QString("¥%1").arg(todayRevenueAmount, 0, 'f', 2));
-        }
-        
-        // 更新订单状态统计（从订单表格中统计）
-        updateOrderStatusStats();
-        
-        // 更新销量趋势图
-        updateSalesChart();
-    } else {
-        // 如果服务器没有返回数据，从本地数据计算
-        // 先加载最新数据（不显示提示，不更新仪表板避免循环）
-        loadBooks();
-        loadOrders(false, false);  // 不显示提示，不更新仪表板
-        
-        // 从本地数据计算统计
-        if (booksValueLabel && booksTable) {
-            booksValueLabel->setText(QString::number(booksTable->rowCount()));
-        }
-        
-        // 计算今日订单和销量、收入
-        int todayOrderCount = 0;
-        int todaySalesCount = 0;
-        double todayRevenueAmount = 0.0;
-        
-        if (ordersTable) {
-            QDate today = QDate::currentDate();
-            QString todayStr = today.toString("yyyy-MM-dd");
-            
-            for (int i = 0; i < ordersTable->rowCount(); ++i) {
-                // 查找日期列（通常在订单表格中）
-                QTableWidgetItem *dateItem = nullptr;
-                for (int col = 0; col < ordersTable->columnCount(); ++col) {
-                    QTableWidgetItem *item = ordersTable->item(i, col);
-                    if (item && item->text().contains(todayStr)) {
-                        dateItem = item;
-                        break;
-                    }
-                }
-                
-                if (dateItem) {
-                    todayOrderCount++;
-                    
-                    // 尝试获取订单金额（通常在价格或金额列）
-                    for (int col = 0; col < ordersTable->columnCount(); ++col) {
-                        QTableWidgetItem *amountItem = ordersTable->item(i, col);
-                        if (amountItem) {
-                            QString amountText = amountItem->text();
-                            // 移除可能的货币符号
-                            amountText.remove("¥").remove("$").remove(",");
-                            bool ok;
-                            double amount = amountText.toDouble(&ok);
-                            if (ok && amount > 0) {
-                                todayRevenueAmount += amount;
-                                break;
-                            }
-                        }
-                    }
-                    
-                    // 尝试获取数量（用于计算销量）
-                    for (int col = 0; col < ordersTable->columnCount(); ++col) {
-                        QTableWidgetItem *qtyItem = ordersTable->item(i, col);
-                        if (qtyItem) {
-                            bool ok;
-                            int qty = qtyItem->text().toInt(&ok);
-                            if (ok && qty > 0) {
-                                todaySalesCount += qty;
-                                break;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-        
-        // 更新显示
-        if (orderValueLabel) {
-            orderValueLabel->setText(QString::number(todayOrderCount));
-        }
-        if (salesValueLabel) {
-            salesValueLabel->setText(QString::number(todaySalesCount));
-        }
-        if (revenueValueLabel) {
-            revenueValueLabel->setText(QString("¥%1").arg(todayRevenueAmount, 0, 'f', 2));
-        }
-        
-        // 更新订单状态统计（从订单表格中统计）
-        updateOrderStatusStats();
-        
-        // 更新销量趋势图
-        updateSalesChart();
+    if (!response["success"].toBool()) {
+        qWarning() << "updateDashboardData: 获取仪表板快照失败:" << response["message"].toString();
+        return;
+    }
+    
+    if (response["notModified"].toBool()) {
+        return;  // 数据未变化，不重绘
+    }
+    
+    dashboardEtag = response["etag"].toString();
+    QJsonObject snapshot = response["snapshot"].toObject();
+    QJsonObject stats = snapshot["stats"].toObject();
+    
+    // 更新图书总数
+    if (booksValueLabel) {
+        booksValueLabel->setText(QString::number(stats["totalBooks"].toInt(0)));
+    }
+    
+    // 今日订单、销量和收入由服务器按下单时间聚合（订单表格只加载了部分页）
+    // 订单中没有直接的数量字段，销量暂按每个订单1个销量单位计算
+    int todayOrderCount = snapshot["todayOrders"].toInt(0);
+    double todayRevenueAmount = snapshot["todayRevenue"].toDouble(0.0);
+    
+    if (orderValueLabel) {
+        orderValueLabel->setText(QString::number(todayOrderCount));
+    }
+    if (salesValueLabel) {
+        salesValueLabel->setText(QString::number(todayOrderCount));
+    }
+    if (revenueValueLabel) {
+        revenueValueLabel->setText(QString("¥%1").arg(todayRevenueAmount, 0, 'f', 2));
     }
+    
+    // 更新订单状态统计
+    orderStatusCounts = snapshot["statusCounts"].toObject();
+    updateOrderStatusStats();
+    
+    // 更新销量趋势图
+    updateSalesChart(snapshot["chart"].toArray());
 }
 
 void BookMerchant::updateOrderStatusStats()
 {
-    if (!ordersTable) {
-        return;
-    }
-    
     // 初始化计数器
     int pendingCount = 0;
     int shippedCount = 0;
     int completedCount = 0;
     int cancelledCount = 0;
     
-    // 订单表格列：0-订单ID, 1-客户, 2-总金额, 3-状态, 4-下单时间, 5-发货时间
-    // 从订单表格中统计不同状态的订单数量
-    for (int i = 0; i < ordersTable->rowCount(); ++i) {
-        QTableWidgetItem *statusItem = ordersTable->item(i, 3);  // 状态列（第3列，索引3）
-        if (statusItem) {
-            QString status = statusItem->text().trimmed();
-            
-            // 待处理：包括待支付、已支付（等待发货）
-            if (status == "待支付" || status == "已支付" || status == "待处理" || 
-                status.contains("待") || status.contains("支付")) {
-                pendingCount++;
-            } 
-            // 已发货：已发货、发货中
-            else if (status == "已发货" || status == "发货中" || status.contains("发货")) {
-                shippedCount++;
-            } 
-            // 已完成：已完成、完成、已收货（买家确认收货后状态变为已完成）
-            else if (status == "已完成" || status == "完成" || status == "已收货" || status.contains("完成") || status.contains("收货")) {
-                completedCount++;
-            } 
-            // 已取消：已取消、取消
-            else if (status == "已取消" || status == "取消" || status.contains("取消")) {
-                cancelledCount++;
-            }
+    // 订单表格只加载了部分页，按服务器返回的全部订单状态计数统计（状态 -> 订单数）
+    for (auto it = orderStatusCounts.constBegin(); it != orderStatusCounts.constEnd(); ++it) {
+        QString status = it.key().trimmed();
+        int count = it.value().toInt();
+        
+        // 待处理：包括待支付、已支付（等待发货）
+        if (status == "待支付" || status == "已支付" || status == "待处理" || 
+            status.contains("待") || status.contains("支付")) {
+            pendingCount += count;
+        } 
+        // 已发货：已发货、发货中
+        else if (status == "已发货" || status == "发货中" || status.contains("发货")) {
+            shippedCount += count;
+        } 
+        // 已完成：已完成、完成、已收货（买家确认收货后状态变为已完成）
+        else if (status == "已完成" || status == "完成" || status == "已收货" || status.contains("完成") || status.contains("收货")) {
+            completedCount += count;
+        } 
+        // 已取消：已取消、取消
+        else if (status == "已取消" || status == "取消" || status.contains("取消")) {
+            cancelledCount += count;
         }
     }
     
@@ -1980,98 +1897,40 @@ void BookMerchant::updateOrderStatusStats()
              << "已完成:" << completedCount << "已取消:" << cancelledCount;
 }
 
-void BookMerchant::updateSalesChart()
+void BookMerchant::updateSalesChart(const QJsonArray &series)
 {
-    if (!isLoggedIn || currentSellerId.isEmpty() || !salesChartWidget) {
-        qDebug() << "updateSalesChart: 未登录或salesChartWidget为空";
+    if (!salesChartWidget) {
         return;
     }
     
-    // 计算近7天的日期范围
-    QDate endDate = QDate::currentDate();
-    QDate startDate = endDate.addDays(-6);  // 包括今天共7天
-    
-    QString startDateStr = startDate.toString("yyyy-MM-dd");
-    QString endDateStr = endDate.toString("yyyy-MM-dd");
-    
-    qDebug() << "updateSalesChart: 获取销售数据 - 卖家ID:" << currentSellerId 
-             << "日期范围:" << startDateStr << "到" << endDateStr;
-    
-    // 从服务器获取近7天的销售数据
-    QJsonObject response = apiService->getSalesReport(
-        currentSellerId,
-        startDateStr,
-        endDateStr
-    );
-    
-    qDebug() << "updateSalesChart: 服务器响应:" << QJsonDocument(response).toJson(QJsonDocument::Compact);
+    // 日期到销售额的映射
+    QMap<QString, double> salesMap;
+    for (const QJsonValue &value : series) {
+        QJsonObject item = value.toObject();
+        salesMap[item["date"].toString()] = item["amount"].toDouble(0.0);
+    }
     
     QVector<double> salesData;
     QVector<QString> dateLabels;
     
-    if (response["success"].toBool()) {
-        // 服务器返回的字段是"data"，不是"sales"
-        QJsonArray salesArray = response["data"].toArray();
-        if (salesArray.isEmpty() && response.contains("sales")) {
-            // 兼容旧版本，如果"data"为空，尝试读取"sales"
-            salesArray = response["sales"].toArray();
-        }
-        qDebug() << "updateSalesChart: 获取到" << salesArray.size() << "条销售记录";
-        
-        // 创建日期到销售额的映射
-        QMap<QString, double> salesMap;
-        for (const QJsonValue &value : salesArray) {
-            QJsonObject item = value.toObject();
-            QString date = item["date"].toString();
-            double amount = item["amount"].toDouble(0.0);
-            salesMap[date] = amount;
-            qDebug() << "updateSalesChart: 日期" << date << "销售额:" << amount;
-        }
-        
-        // 按日期顺序填充数据（近7天）
-        for (int i = 0; i < 7; ++i) {
-            QDate date = startDate.addDays(i);
-            QString dateStr = date.toString("yyyy-MM-dd");
-            
-            // 显示具体日期（MM/dd格式），如果是今天则显示"今天"
-            QString dateLabel;
-            if (date == QDate::currentDate()) {
-                dateLabel = "今天";
-            } else {
-                dateLabel = date.toString("MM/dd");
-            }
-            
-            double amount = salesMap.value(dateStr, 0.0);
-            dateLabels.append(dateLabel);
-            salesData.append(amount);
-            qDebug() << "updateSalesChart: 日期" << dateStr << "(" << dateLabel << ") 销售额:" << amount;
-        }
-    } else {
-        QString errorMsg = response["message"].toString();
-        if (errorMsg.isEmpty()) {
-            errorMsg = response["error"].toString();
-        }
-        qDebug() << "updateSalesChart: 服务器返回失败:" << errorMsg;
+    // 按日期顺序填充数据（近7天，没有数据的日期为0）
+    QDate endDate = QDate::currentDate();
+    QDate startDate = endDate.addDays(-6);  // 包括今天共7天
+    for (int i = 0; i < 7; ++i) {
+        QDate date = startDate.addDays(i);
         
-        // 如果服务器没有返回数据，使用默认值（全0）
-        for (int i = 0; i < 7; ++i) {
-            QDate date = startDate.addDays(i);
-            
-            // 显示具体日期（MM/dd格式），如果是今天则显示"今天"
-            QString dateLabel;
-            if (date == QDate::currentDate()) {
-                dateLabel = "今天";
-            } else {
-                dateLabel = date.toString("MM/dd");
-            }
-            
-            dateLabels.append(dateLabel);
-            salesData.append(0.0);
+        // 显示具体日期（MM/dd格式），如果是今天则显示"今天"
+        QString dateLabel;
+        if (date == endDate) {
+            dateLabel = "今天";
+        } else {
+            dateLabel = date.toString("MM/dd");
         }
+        
+        dateLabels.append(dateLabel);
+        salesData.append(salesMap.value(date.toString("yyyy-MM-dd"), 0.0));
     }
     
-    qDebug() << "updateSalesChart: 最终数据 - 日期标签:" << dateLabels << "销售额:" << salesData;
-    
     // 更新图表数据
     salesChartWidget->setSalesData(salesData, dateLabels);
     salesChartWidget->update();  // 触发重绘
@@ -2393,6 +2252,7 @@ void BookMerchant::onLoginClicked()
         currentSellerId = userIdStr;
         currentSellerName = username;
         isLoggedIn = true;
+        dashboardEtag.clear();  // 新登录必须完整渲染一次仪表板
         
         loginUsername->clear();
         loginPassword->clear();
@@ -2429,9 +2289,11 @@ void BookMerchant::onLogoutClicked()
         dashboardRefreshTimer->stop();
     }
     
+    apiService->logout();
     isLoggedIn = false;
     currentSellerId.clear();
     currentSellerName.clear();
+    dashboardEtag.clear();
     apiService->disconnectFromServer();
     showLoginPage();
     QMessageBox::information(this, "提示", "已退出登录");
@@ -2445,39 +2307,12 @@ void BookMerchant::onRefreshBooksClicked()
 
 void BookMerchant::loadBooks()
 {
-    QJsonObject response = apiService->getSellerBooks(currentSellerId);
+    // 刷新已加载的范围（至少一页），更多数据在滚动到底部时分页拉取
+    QJsonObject response = apiService->getSellerBooks(currentSellerId, 0, booksModel->refreshLimit());
     
     if (response["success"].toBool()) {
-        QJsonArray books = response["books"].toArray();
-        
-        booksTable->setRowCount(0);
-        for (const QJsonValue &bookValue : books) {
-            QJsonObject book = bookValue.toObject();
-            int row = booksTable->rowCount();
-            booksTable->insertRow(row);
-            
-            booksTable->setItem(row, 0, new QTableWidgetItem(book["isbn"].toString()));
-            booksTable->setItem(row, 1, new QTableWidgetItem(book["title"].toString()));
-            booksTable->setItem(row, 2, new QTableWidgetItem(book["author"].toString()));
-            // 兼容旧数据：优先使用category1，如果没有则使用category
-            QString category1 = book.contains("category1") ? book["category1"].toString() : 
-                                (book.contains("category") ? book["category"].toString() : "");
-            QString category2 = book.contains("category2") ? book["category2"].toString() : 
-                                (book.contains("subCategory") ? book["subCategory"].toString() : "");
-            booksTable->setItem(row, 3, new QTableWidgetItem(category1));
-            booksTable->setItem(row, 4, new QTableWidgetItem(category2));
-            booksTable->setItem(row, 5, new QTableWidgetItem(QString::number(book["price"].toDouble(), 'f', 2)));
-            booksTable->setItem(row, 6, new QTableWidgetItem(QString::number(book["stock"].toInt())));
-            // 显示销量，如果服务器返回了sales字段则使用，否则默认为0
-            int sales = book.contains("sales") ? book["sales"].toInt() : 0;
-            booksTable->setItem(row, 7, new QTableWidgetItem(QString::number(sales)));
-            // 显示状态，如果为空则显示"待审核"
-            QString status = book["status"].toString();
-            if (status.isEmpty()) {
-                status = "待审核";
-            }
-            booksTable->setItem(row, 8, new QTableWidgetItem(status));
-        }
+        // 差异更新：只重绘变化的行，选中、滚动位置和排序保持不变
+        booksModel->setRows(makeBookRows(response["books"].toArray()), response["hasMore"].toBool());
     } else {
         QMessageBox::warning(this, "错误", "加载图书失败：" + response["message"].toString());
     }
@@ -2486,6 +2321,55 @@ void BookMerchant::loadBooks()
     updateDashboardData();
 }
 
+void BookMerchant::fetchMoreBooks(int offset)
+{
+    QJsonObject response = apiService->getSellerBooks(currentSellerId, offset, RowTableModel::PAGE_SIZE);
+    if (!response["success"].toBool()) {
+        qWarning() << "fetchMoreBooks: 加载下一页失败:" << response["message"].toString();
+        booksModel->cancelFetch();
+        return;
+    }
+    booksModel->appendRows(makeBookRows(response["books"].toArray()), response["hasMore"].toBool());
+}
+
+QVector<TableRow> BookMerchant::makeBookRows(const QJsonArray &books) const
+{
+    QVector<TableRow> rows;
+    rows.reserve(books.size());
+    for (const QJsonValue &bookValue : books) {
+        QJsonObject book = bookValue.toObject();
+        
+        // 兼容旧数据：优先使用category1，如果没有则使用category
+        QString category1 = book.contains("category1") ? book["category1"].toString() : 
+                            (book.contains("category") ? book["category"].toString() : "");
+        QString category2 = book.contains("category2") ? book["category2"].toString() : 
+                            (book.contains("subCategory") ? book["subCategory"].toString() : "");
+        // 显示销量，如果服务器返回了sales字段则使用，否则默认为0
+        int sales = book.contains("sales") ? book["sales"].toInt() : 0;
+        // 显示状态，如果为空则显示"待审核"
+        QString status = book["status"].toString();
+        if (status.isEmpty()) {
+            status = "待审核";
+        }
+        
+        TableRow row;
+        row.key = book["isbn"].toString();
+        row.cells = QStringList{
+            book["isbn"].toString(),
+            book["title"].toString(),
+            book["author"].toString(),
+            category1,
+            category2,
+            QString::number(book["price"].toDouble(), 'f', 2),
+            QString::number(book["stock"].toInt()),
+            QString::number(sales),
+            status
+        };
+        rows.append(row);
+    }
+    return rows;
+}
+
 void BookMerchant::onAddBookClicked()
 {
     QDialog dialog(this);
@@ -2634,7 +2518,7 @@ void BookMerchant::onEditBookClicked()
         return;
     }
     
-    QString bookId = booksTable->item(selectedBookRow, 0)->text();
+    QString bookId = booksModel->text(selectedBookRow, 0);
     
     QDialog dialog(this);
     dialog.setWindowTitle("编辑图书");
@@ -2642,12 +2526,12 @@ void BookMerchant::onEditBookClicked()
     
     QFormLayout *form = new QFormLayout(&dialog);
     
-    QLineEdit *titleEdit = new QLineEdit(booksTable->item(selectedBookRow, 1)->text());
-    QLineEdit *authorEdit = new QLineEdit(booksTable->item(selectedBookRow, 2)->text());
+    QLineEdit *titleEdit = new QLineEdit(booksModel->text(selectedBookRow, 1));
+    QLineEdit *authorEdit = new QLineEdit(booksModel->text(selectedBookRow, 2));
     
     // 获取当前图书的分类
-    QString currentCategory1 = booksTable->item(selectedBookRow, 3)->text();
-    QString currentCategory2 = booksTable->item(selectedBookRow, 4)->text();
+    QString currentCategory1 = booksModel->text(selectedBookRow, 3);
+    QString currentCategory2 = booksModel->text(selectedBookRow, 4);
     
     // 一级分类下拉框
     QComboBox *categoryCombo = new QComboBox();
@@ -2709,10 +2593,10 @@ void BookMerchant::onEditBookClicked()
     QDoubleSpinBox *priceEdit = new QDoubleSpinBox();
     priceEdit->setRange(0, 9999.99);
     priceEdit->setDecimals(2);
-    priceEdit->setValue(booksTable->item(selectedBookRow, 5)->text().toDouble());
+    priceEdit->setValue(booksModel->text(selectedBookRow, 5).toDouble());
     QSpinBox *stockEdit = new QSpinBox();
     stockEdit->setRange(0, 999999);
-    stockEdit->setValue(booksTable->item(selectedBookRow, 6)->text().toInt());
+    stockEdit->setValue(booksModel->text(selectedBookRow, 6).toInt());
     
     // 描述输入框（编辑时，初始为空，需要从服务器获取或留空）
     QTextEdit *descEdit = new QTextEdit();
@@ -2801,8 +2685,8 @@ void BookMerchant::onDeleteBookClicked()
         return;
     }
     
-    QString bookId = booksTable->item(selectedBookRow, 0)->text();
-    QString bookName = booksTable->item(selectedBookRow, 1)->text();
+    QString bookId = booksModel->text(selectedBookRow, 0);
+    QString bookName = booksModel->text(selectedBookRow, 1);
     
     QMessageBox::StandardButton reply = QMessageBox::question(
         this, "确认删除", 
@@ -2845,10 +2729,8 @@ void BookMerchant::loadOrders(bool showEmptyMessage, bool updateDashboard)
     
     qDebug() << "loadOrders: 开始加载订单，卖家ID:" << currentSellerId;
     
-    QJsonObject response = apiService->getSellerOrders(currentSellerId);
-    
-    // 调试：打印完整响应
-    qDebug() << "loadOrders: 收到响应:" << QJsonDocument(response).toJson(QJsonDocument::Compact);
+    // 刷新已加载的范围（至少一页），更多订单在滚动到底部时分页拉取
+    QJsonObject response = apiService->getSellerOrders(currentSellerId, 0, ordersModel->refreshLimit());
     
     if (response["success"].toBool()) {
         QJsonArray orders = response["orders"].toArray();
@@ -2870,69 +2752,26 @@ void BookMerchant::loadOrders(bool showEmptyMessage, bool updateDashboard)
             totalSalesLabel->setText(QString("¥%1").arg(totalSales, 0, 'f', 2));
         }
         
-        ordersTable->setRowCount(0);
+        // 全部订单按状态计数，用于订单状态统计（表格只加载了部分页）
+        orderStatusCounts = response["statusCounts"].toObject();
         
         if (orders.isEmpty()) {
+            ordersModel->clear();
             qDebug() << "loadOrders: 订单列表为空";
             // 只在用户主动点击订单管理时提示一次
             if (showEmptyMessage) {
                 QMessageBox::information(this, "提示", "您还没有任何订单");
             }
         } else {
-            for (const QJsonValue &orderValue : orders) {
-                QJsonObject order = orderValue.toObject();
-                
-                // 调试：打印每个订单的详细信息
-                qDebug() << "loadOrders: 处理订单:" << QJsonDocument(order).toJson(QJsonDocument::Compact);
-                
-                int row = ordersTable->rowCount();
-                ordersTable->insertRow(row);
-                
-                QString orderId = order["orderId"].toString();
-                if (orderId.isEmpty()) {
-                    qWarning() << "loadOrders: 订单ID为空，跳过该订单";
-                    continue;
-                }
-                
-                ordersTable->setItem(row, 0, new QTableWidgetItem(orderId));
-                
-                // 客户信息
-                QString customer = order["customer"].toString();
-                if (customer.isEmpty()) {
-                    customer = QString("用户%1").arg(order["userId"].toInt());
-                }
-                ordersTable->setItem(row, 1, new QTableWidgetItem(customer));
-                
-                // 总金额
-                double totalAmount = order["totalAmount"].toDouble();
-                if (totalAmount == 0.0) {
-                    totalAmount = order["amount"].toDouble();
-                }
-                ordersTable->setItem(row, 2, new QTableWidgetItem(QString::number(totalAmount, 'f', 2)));
-                
-                // 订单状态
-                QString status = order["status"].toString();
-                ordersTable->setItem(row, 3, new QTableWidgetItem(status));
-                
-                // 下单时间
-                QString orderDate = order["orderDate"].toString();
-                if (orderDate.isEmpty()) {
-                    orderDate = order["createTime"].toString();
-                }
-                ordersTable->setItem(row, 4, new QTableWidgetItem(orderDate));
-                
-                // 发货时间（如果已发货）
-                QString shipTime = order["shipTime"].toString();
-                QString displayShipTime = shipTime.isEmpty() ? "未发货" : shipTime;
-                ordersTable->setItem(row, 5, new QTableWidgetItem(displayShipTime));
-            }
+            bool firstFill = ordersModel->rowCount() == 0;
+            // 差异更新：定时刷新时只有状态变化的订单会重绘
+            ordersModel->setRows(makeOrderRows(orders), response["hasMore"].toBool());
             
-            qDebug() << "loadOrders: 成功加载了" << ordersTable->rowCount() << "个订单到表格";
+            qDebug() << "loadOrders: 表格已加载" << ordersModel->rowCount() << "个订单，共" << totalOrders << "个";
             
-            // 强制刷新表格显示
-            ordersTable->resizeColumnsToContents();
-            ordersTable->update();
-            ordersTable->repaint();
+            if (firstFill) {
+                ordersTable->resizeColumnsToContents();
+            }
         }
     } else {
         QString errorMsg = response["message"].toString();
@@ -2949,6 +2788,66 @@ void BookMerchant::loadOrders(bool showEmptyMessage, bool updateDashboard)
     }
 }
 
+void BookMerchant::fetchMoreOrders(int offset)
+{
+    QJsonObject response = apiService->getSellerOrders(currentSellerId, offset, RowTableModel::PAGE_SIZE);
+    if (!response["success"].toBool()) {
+        qWarning() << "fetchMoreOrders: 加载下一页失败:" << response["message"].toString();
+        ordersModel->cancelFetch();
+        return;
+    }
+    ordersModel->appendRows(makeOrderRows(response["orders"].toArray()), response["hasMore"].toBool());
+}
+
+QVector<TableRow> BookMerchant::makeOrderRows(const QJsonArray &orders) const
+{
+    QVector<TableRow> rows;
+    rows.reserve(orders.size());
+    for (const QJsonValue &orderValue : orders) {
+        QJsonObject order = orderValue.toObject();
+        
+        QString orderId = order["orderId"].toString();
+        if (orderId.isEmpty()) {
+            qWarning() << "loadOrders: 订单ID为空，跳过该订单";
+            continue;
+        }
+        
+        // 客户信息
+        QString customer = order["customer"].toString();
+        if (customer.isEmpty()) {
+            customer = QString("用户%1").arg(order["userId"].toInt());
+        }
+        
+        // 总金额
+        double totalAmount = order["totalAmount"].toDouble();
+        if (totalAmount == 0.0) {
+            totalAmount = order["amount"].toDouble();
+        }
+        
+        // 下单时间
+        QString orderDate = order["orderDate"].toString();
+        if (orderDate.isEmpty()) {
+            orderDate = order["createTime"].toString();
+        }
+        
+        // 发货时间（如果已发货）
+        QString shipTime = order["shipTime"].toString();
+        
+        TableRow row;
+        row.key = orderId;
+        row.cells = QStringList{
+            orderId,
+            customer,
+            QString::number(totalAmount, 'f', 2),
+            order["status"].toString(),
+            orderDate,
+            shipTime.isEmpty() ? "未发货" : shipTime
+        };
+        rows.append(row);
+    }
+    return rows;
+}
+
 void BookMerchant::onUpdateOrderStatusClicked()
 {
     if (selectedOrderRow < 0) {
@@ -2956,8 +2855,8 @@ void BookMerchant::onUpdateOrderStatusClicked()
         return;
     }
     
-    QString orderId = ordersTable->item(selectedOrderRow, 0)->text();
-    QString currentStatus = ordersTable->item(selectedOrderRow, 3)->text();
+    QString orderId = ordersModel->text(selectedOrderRow, 0);
+    QString currentStatus = ordersModel->text(selectedOrderRow, 3);
     
     // 检查订单状态，只有"已支付"状态的订单才能发货
     if (currentStatus != "已支付") {
@@ -3003,7 +2902,7 @@ void BookMerchant::onDeleteOrderClicked()
         return;
     }
     
-    QString orderId = ordersTable->item(selectedOrderRow, 0)->text();
+    QString orderId = ordersModel->text(selectedOrderRow, 0);
     
     QMessageBox::StandardButton reply = QMessageBox::question(
         this, "确认删除", 
@@ -3033,35 +2932,57 @@ void BookMerchant::onOrderTableCellClicked(int row, int column)
 // ===== 会员管理 =====
 void BookMerchant::loadMembers()
 {
-    QJsonObject response = apiService->getMembers(currentSellerId);
+    QJsonObject response = apiService->getMembers(currentSellerId, 0, membersModel->refreshLimit());
     
     if (response["success"].toBool()) {
-        QJsonArray members = response["members"].toArray();
-        
-        membersTable->setRowCount(0);
-        for (const QJsonValue &memberValue : members) {
-            QJsonObject member = memberValue.toObject();
-            int row = membersTable->rowCount();
-            membersTable->insertRow(row);
-            
-            membersTable->setItem(row, 0, new QTableWidgetItem(QString::number(member["userId"].toInt())));
-            membersTable->setItem(row, 1, new QTableWidgetItem(member["username"].toString()));
-            membersTable->setItem(row, 2, new QTableWidgetItem(member["email"].toString()));
-            
-            // 显示会员等级（memberLevel字符串，如"普通会员"、"银卡会员"等）
-            QString memberLevel = member["memberLevel"].toString();
-            if (memberLevel.isEmpty()) {
-                memberLevel = "普通会员";
-            }
-            membersTable->setItem(row, 3, new QTableWidgetItem(memberLevel));
-            // 卖家不能看到会员余额，已移除余额列
-            membersTable->setItem(row, 4, new QTableWidgetItem(member["registerDate"].toString()));
-        }
+        membersModel->setRows(makeMemberRows(response["members"].toArray()), response["hasMore"].toBool());
     } else {
         QMessageBox::warning(this, "错误", "加载会员失败：" + response["message"].toString());
     }
 }
 
+void BookMerchant::fetchMoreMembers(int offset)
+{
+    QJsonObject response = apiService->getMembers(currentSellerId, offset, RowTableModel::PAGE_SIZE);
+    if (!response["success"].toBool()) {
+        qWarning() << "fetchMoreMembers: 加载下一页失败:" << response["message"].toString();
+        membersModel->cancelFetch();
+        return;
+    }
+    membersModel->appendRows(makeMemberRows(response["members"].toArray()), response["hasMore"].toBool());
+}
+
+QVector<TableRow> BookMerchant::makeMemberRows(const QJsonArray &members) const
+{
+    QVector<TableRow> rows;
+    rows.reserve(members.size());
+    for (const QJsonValue &memberValue : members) {
+        QJsonObject member = memberValue.toObject();
+        
+        // 显示会员等级（memberLevel字符串，如"普通会员"、"银卡会员"等）
+        QString memberLevel = member["memberLevel"].toString();
+        if (memberLevel.isEmpty()) {
+            memberLevel = "普通会员";
+        }
+        
+        TableRow row;
+        row.key = QString::number(member["userId"].toInt());
+        // 卖家不能看到会员余额，已移除余额列
+        row.cells = QStringList{
+            row.key,
+            member["username"].toString(),
+            member["email"].toString(),
+            memberLevel,
+            member["registerDate"].toString(),
+            QString::number(member["orderCount"].toInt()),
+            QString::number(member["totalSpent"].toDouble(), 'f', 2),
+            member["lastOrder"].toString()
+        };
+        rows.append(row);
+    }
+    return rows;
+}
+
 void BookMerchant::onEditMemberClicked()
 {
     if (selectedMemberRow < 0) {
@@ -3069,15 +2990,15 @@ void BookMerchant::onEditMemberClicked()
         return;
     }
     
-    QString memberId = membersTable->item(selectedMemberRow, 0)->text();
-    QString currentMemberLevel = membersTable->item(selectedMemberRow, 3)->text();  // 会员等级在第3列（索引3）
+    QString memberId = membersModel->text(selectedMemberRow, 0);
+    QString currentMemberLevel = membersModel->text(selectedMemberRow, 3);  // 会员等级在第3列（索引3）
     
     QDialog dialog(this);
     dialog.setWindowTitle("编辑会员");
     
     QFormLayout *form = new QFormLayout(&dialog);
     
-    QLineEdit *emailEdit = new QLineEdit(membersTable->item(selectedMemberRow, 2)->text());  // 邮箱在第2列
+    QLineEdit *emailEdit = new QLineEdit(membersModel->text(selectedMemberRow, 2));  // 邮箱在第2列
     QComboBox *levelCombo = new QComboBox();
     levelCombo->addItems({"普通会员", "银卡会员", "金卡会员", "白金会员", "钻石会员"});
     // 设置当前选中的会员等级
@@ -3117,8 +3038,8 @@ void BookMerchant::onDeleteMemberClicked()
         return;
     }
     
-    QString memberId = membersTable->item(selectedMemberRow, 0)->text();
-    QString username = membersTable->item(selectedMemberRow, 1)->text();
+    QString memberId = membersModel->text(selectedMemberRow, 0);
+    QString username = membersModel->text(selectedMemberRow, 1);
     
     QMessageBox::StandardButton reply = QMessageBox::question(
         this, "确认删除", 
@@ -3720,46 +3641,46 @@ void BookMerchant::loadBuyerList()
         }
     }
     
-    // 获取所有聊天历史，提取买家ID
-    QJsonObject response = apiService->getChatHistory(
-        currentSellerId,
-        "seller"
-    );
+    // 从会话列表取与本店有聊天的买家（按最近消息倒序分页），不再下载全部聊天记录
+    buyerListWidget->clear();
+    buyerListOffset = 0;
+    loadMoreBuyers();
+}
+
+void BookMerchant::loadMoreBuyers()
+{
+    // 去掉上一页末尾的“加载更多”项
+    if (buyerListWidget->count() > 0
+        && buyerListWidget->item(buyerListWidget->count() - 1)->data(kLoadMoreRole).toBool()) {
+        delete buyerListWidget->takeItem(buyerListWidget->count() - 1);
+    }
+    
+    QJsonObject response = apiService->getConversations(currentSellerId, "seller", "buyer", buyerListOffset,
+                                                        kBuyerListPageSize);
     
     if (response["success"].toBool()) {
-        buyerListWidget->clear();
-        
-        // 提取所有买家ID
-        QSet<int> buyerIds;
-        QJsonArray messages = response["messages"].toArray();
-        
-        for (const QJsonValue &msgVal : messages) {
-            QJsonObject msg = msgVal.toObject();
-            QString senderType = msg["senderType"].toString();
-            int senderId = msg["senderId"].toInt();
-            int receiverId = msg["receiverId"].toInt();
-            
-            // 如果消息是买家发送给卖家的，记录买家ID
-            if (senderType == "buyer" && receiverId == currentSellerId.toInt()) {
-                buyerIds.insert(senderId);
-            }
-            // 如果消息是卖家发送给买家的，也记录买家ID
-            else if (senderType == "seller" && receiverId > 0) {
-                buyerIds.insert(receiverId);
+        QJsonArray conversations = response["conversations"].toArray();
+        buyerListOffset += conversations.size();
+        for (const QJsonValue &conversationVal : conversations) {
+            QJsonObject conversation = conversationVal.toObject();
+            int buyerId = conversation["peerId"].toInt();
+            QString itemText = QString("买家 %1 (ID:%2)").arg(conversation["peerName"].toString()).arg(buyerId);
+            int unreadCount = conversation["unreadCount"].toInt();
+            if (unreadCount > 0) {
+                itemText += QString(" [%1条未读]").arg(unreadCount);
             }
-        }
-        
-        // 添加买家到列表
-        QList<int> sortedBuyerIds = buyerIds.values();
-        std::sort(sortedBuyerIds.begin(), sortedBuyerIds.end());
-        
-        for (int buyerId : sortedBuyerIds) {
-            QListWidgetItem *item = new QListWidgetItem(QString("买家 ID:%1").arg(buyerId));
+            QListWidgetItem *item = new QListWidgetItem(itemText);
+            item->setToolTip(conversation["lastContent"].toString());
             item->setData(Qt::UserRole, buyerId);
             buyerListWidget->addItem(item);
         }
         
-        if (buyerIds.isEmpty()) {
+        if (response["hasMore"].toBool() && !conversations.isEmpty()) {
+            QListWidgetItem *moreItem = new QListWidgetItem("加载更多买家...");
+            moreItem->setData(kLoadMoreRole, true);
+            moreItem->setTextAlignment(Qt::AlignCenter);
+            buyerListWidget->addItem(moreItem);
+        } else if (buyerListOffset == 0) {
             QListWidgetItem *emptyItem = new QListWidgetItem("暂无买家消息");
             emptyItem->setFlags(Qt::NoItemFlags);  // 禁用点击
             buyerListWidget->addItem(emptyItem);
@@ -3773,6 +3694,12 @@ void BookMerchant::onBuyerListItemClicked(QListWidgetItem *item)
         return;  // 如果是禁用项（如"暂无买家消息"），不处理
     }
     
+    if (item->data(kLoadMoreRole).toBool()) {
+        // 加载时会删除被点击的这一项，放到点击信号处理完之后
+        QTimer::singleShot(0, this, &BookMerchant::loadMoreBuyers);
+        return;
+    }
+    
     int buyerId = item->data(Qt::UserRole).toInt();
     if (buyerId <= 0) {
         return;
@@ -3780,6 +3707,9 @@ void BookMerchant::onBuyerListItemClicked(QListWidgetItem *item)
     
     currentChatBuyerId = buyerId;
     
+    // 打开会话时清零未读数
+    apiService->markConversationRead(currentSellerId, "seller", buyerId, "buyer");
+    
     // 更新当前买家标签
     currentBuyerLabel->setText(QString("与买家(ID:%1)聊天").arg(buyerId));
     
@@ -3838,7 +3768,9 @@ void BookMerchant::loadBuyerChatHistory()
         currentSellerId,
         "seller",
         QString::number(currentChatBuyerId),
-        "buyer"
+        "buyer",
+        0,
+        100  // 只取最近的100条，定时刷新时按时间增量显示
     );
     
     if (response["success"].toBool()) {
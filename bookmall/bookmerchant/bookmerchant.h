@@ -7,6 +7,7 @@
 #include <QPushButton>
 #include <QLabel>
 #include <QTableWidget>
+#include <QTableView>
 #include <QTextEdit>
 #include <QComboBox>
 #include <QSpinBox>
@@ -18,6 +19,7 @@
 #include <QPainter>
 #include <QVector>
 #include "apiservice.h"
+#include "rowtablemodel.h"
 
 // 自定义折线图组件
 // 这是一个自定义的Qt组件类，用于绘制销售趋势折线图
@@ -84,6 +86,11 @@ private slots:
     void onDeleteMemberClicked();
     void onMemberTableCellClicked(int row, int column);
 
+    // 表格分页：视图滚动到底部时向服务器拉取下一页
+    void fetchMoreBooks(int offset);
+    void fetchMoreOrders(int offset);
+    void fetchMoreMembers(int offset);
+
     // 统计报表
     void onRefreshStatsClicked();
     void onGenerateSalesReportClicked();
@@ -122,13 +129,21 @@ private:
     QWidget* createStatusItem(const QString &label, const QString &value, const QString &color, QLabel **valueLabelPtr = nullptr);
     void updateDashboardData();  // 更新仪表板数据
     void updateOrderStatusStats();  // 更新订单状态统计
-    void updateSalesChart();  // 更新销量趋势图
+    void updateSalesChart(const QJsonArray &series);  // 更新销量趋势图（近7天 [{date, amount}]）
 
     // 数据加载
     void loadBooks();
     void loadOrders(bool showEmptyMessage = false, bool updateDashboard = true);  // 加载订单，showEmptyMessage: 是否显示空订单提示，updateDashboard: 是否更新仪表板
     void loadMembers();
     void loadStats();
+
+    // 服务器返回的JSON数组 -> 表格行
+    QVector<TableRow> makeBookRows(const QJsonArray &books) const;
+    QVector<TableRow> makeOrderRows(const QJsonArray &orders) const;
+    QVector<TableRow> makeMemberRows(const QJsonArray &members) const;
+    // 创建只读表格视图：源模型 -> 排序/过滤代理 -> QTableView，过滤框输入即时过滤；
+    // selectedRow 在刷新增删行后自动跟随视图当前行
+    QTableView *createTableView(RowTableModel *model, RowFilterProxyModel *proxy, QLineEdit *filterEdit, int *selectedRow);
     void loadReviews();  // 加载评论数据
 
     // UI组件
@@ -171,7 +186,10 @@ private:
     
     // 图书管理页面
     QWidget *booksPage;
-    QTableWidget *booksTable;
+    QTableView *booksTable;
+    RowTableModel *booksModel;
+    RowFilterProxyModel *booksProxy;
+    QLineEdit *booksFilterEdit;
     QPushButton *refreshBooksBtn;
     QPushButton *addBookBtn;
     QPushButton *editBookBtn;
@@ -190,7 +208,11 @@ private:
 
     // 订单管理页面
     QWidget *ordersPage;
-    QTableWidget *ordersTable;
+    QTableView *ordersTable;
+    RowTableModel *ordersModel;
+    RowFilterProxyModel *ordersProxy;
+    QLineEdit *ordersFilterEdit;
+    QJsonObject orderStatusCounts;  // 服务器返回的全部订单按状态计数（表格只加载了部分页）
     QPushButton *refreshOrdersBtn;
     QPushButton *updateOrderStatusBtn;
     QPushButton *deleteOrderBtn;
@@ -199,7 +221,10 @@ private:
 
     // 会员管理页面
     QWidget *membersPage;
-    QTableWidget *membersTable;
+    QTableView *membersTable;
+    RowTableModel *membersModel;
+    RowFilterProxyModel *membersProxy;
+    QLineEdit *membersFilterEdit;
     QPushButton *editMemberBtn;
     QPushButton *deleteMemberBtn;
     QPushButton *backFromMembersBtn;
@@ -265,6 +290,7 @@ private:
     QLabel *currentBuyerLabel;  // 当前选中的买家标签
     QTimer *buyerChatRefreshTimer;  // 买家聊天刷新定时器
     int currentChatBuyerId;  // 当前聊天的买家ID
+    int buyerListOffset;  // 买家会话列表已加载的条数（分页）
     QDateTime lastBuyerChatMessageTime;  // 最后一条买家聊天消息的时间
     
     // 评论管理页面
@@ -281,6 +307,7 @@ private:
     void onSendBuyerChatClicked();  // 发送买家消息
     void onBuyerListItemClicked(QListWidgetItem *item);  // 选择买家
     void loadBuyerList();  // 加载买家列表
+    void loadMoreBuyers();  // 加载买家列表的下一页
 
     // 数据
     ApiService *apiService;
@@ -297,6 +324,7 @@ private:
     
     // 仪表板刷新定时器
     QTimer *dashboardRefreshTimer;
+    QString dashboardEtag;  // 上次渲染的仪表板快照版本，未变化时服务器只回 notModified
 };
 
 #endif // BOOKMERCHANT_H
@@ -12,11 +12,13 @@ SOURCES += \
     apiservice.cpp \
     bookmerchant.cpp \
     main.cpp \
+    rowtablemodel.cpp \
     tcpclient.cpp
 
 HEADERS += \
     apiservice.h \
     bookmerchant.h \
+    rowtablemodel.h \
     tcpclient.h
 
 # Default rules for deployment.
@@ -0,0 +1,112 @@
+#ifndef ROWTABLEMODEL_H
+#define ROWTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QSortFilterProxyModel>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QColor>
+
+// 表格的一行：主键 + 各列显示文本
+// 代替QTableWidget每个单元格一个QTableWidgetItem，几万行也只是一段连续内存
+struct TableRow
+{
+    QString key;        // 行主键（订单ID/ISBN/用户ID），刷新时按它做差异比对
+    QStringList cells;  // 各列显示文本
+
+    bool operator==(const TableRow &other) const { return key == other.key && cells == other.cells; }
+    bool operator!=(const TableRow &other) const { return !(*this == other); }
+};
+
+// 只读表格模型（配合QTableView使用，只绘制可见行）
+// - setRows()：按主键与现有数据比对，只对变化的行发dataChanged、对增删的行发插入/删除信号，
+//   视图的选中、滚动位置和排序都保持不变
+// - 服务器分页：视图滚动到底部时调用fetchMore()，模型只发出fetchMoreRequested(offset)，
+//   窗口收到后（排队连接）向服务器拉取下一页，再调用appendRows()
+class RowTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum { SortRole = Qt::UserRole + 1 };  // 排序用的数据：数值列返回double，其余返回文本
+
+    enum { PAGE_SIZE = 500 };              // 每页向服务器请求的行数
+
+    explicit RowTableModel(const QStringList &headers, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    // 这些列按数值排序（价格、库存、ID等）
+    void setNumericColumns(const QList<int> &columns);
+    // 某列等于指定值时用高亮色显示并附带提示（如身份列的"审核中"）
+    void setHighlight(int column, const QString &value, const QColor &color, const QString &toolTip);
+
+    // 用新数据替换已加载部分（差异更新）；hasMore表示服务器上还有下一页
+    void setRows(const QVector<TableRow> &rows, bool hasMore = false);
+    // 追加下一页；已存在的主键会被跳过（翻页期间新数据插到前面导致的重叠）
+    void appendRows(const QVector<TableRow> &rows, bool hasMore);
+    // 拉取下一页失败时调用，允许之后重新触发fetchMore
+    void cancelFetch();
+    void clear();
+
+    const TableRow &rowAt(int row) const { return m_rows.at(row); }
+    QString text(int row, int column) const;
+    int rowOfKey(const QString &key) const { return m_keyIndex.value(key, -1); }
+    bool hasMore() const { return m_hasMore; }
+
+    // 刷新时应请求的条数：至少一页，且不少于当前已加载的行数，避免刷新后列表"缩回"第一页
+    int refreshLimit() const { return qMax(int(PAGE_SIZE), m_rows.size()); }
+
+signals:
+    void fetchMoreRequested(int offset);
+
+private:
+    void rebuildKeyIndex();
+    void emitRowsChanged(int first, int last);
+
+    QStringList m_headers;
+    QVector<TableRow> m_rows;
+    QHash<QString, int> m_keyIndex;
+    QSet<int> m_numericColumns;
+
+    int m_highlightColumn = -1;
+    QString m_highlightValue;
+    QColor m_highlightColor;
+    QString m_highlightToolTip;
+
+    bool m_hasMore = false;
+    bool m_fetching = false;
+};
+
+// 排序/过滤代理：
+// - 文本过滤：setFilterFixedString()，匹配任意一列
+// - 列过滤：setColumnFilter()，某列必须等于指定值（如只看"买家"），传入空字符串取消
+class RowFilterProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit RowFilterProxyModel(QObject *parent = nullptr);
+
+    void setColumnFilter(int column, const QString &value);
+
+    // 视图行号 -> 源模型行号（无效时返回-1）
+    int sourceRow(int proxyRow) const;
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    int m_filterColumn = -1;
+    QString m_filterValue;
+};
+
+#endif // ROWTABLEMODEL_H
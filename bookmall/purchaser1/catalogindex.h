@@ -0,0 +1,50 @@
+#ifndef CATALOGINDEX_H
+#define CATALOGINDEX_H
+
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include "book.h"
+#include "user.h"
+
+// 客户端图书目录索引（每次同步图书后重建一次）
+// - 分类倒排表：分类ID -> 图书行号（allBooks中的下标），分类浏览不再遍历分类树和全部图书
+// - 每本书预先算好热度和分类编号，推荐时只做一次线性打分 + 部分排序取前K本
+// 行号只在下一次rebuild()之前有效
+class CatalogIndex
+{
+public:
+    CatalogIndex();
+
+    // 根据图书列表和已挂好图书ID的分类树重建索引
+    void rebuild(const QList<Book> &books, CategoryNode *root);
+    void clear();
+
+    int size() const { return m_heat.size(); }
+
+    // 分类下的图书行号（保持分类树中的顺序，已去重）
+    // includeChildren为true时包含直接子分类的图书（选择一级分类）
+    QVector<int> booksInCategory(const QString &categoryId, bool includeChildren) const;
+
+    // 按 热度 + 偏好权重*10（一级或二级分类命中偏好时）取前quantity本，返回行号，得分高的在前
+    QVector<int> topBooks(const QList<UserPreference> &prefs, int quantity) const;
+
+private:
+    int categoryIndex(const QString &category);
+    void collectPostings(CategoryNode *node, const QHash<QString, int> &rowOfBook);
+
+    QVector<double> m_heat;     // 每本书的基础得分（热度）
+    QVector<int> m_category1;   // 每本书一级分类编号（-1表示无）
+    QVector<int> m_category2;   // 每本书二级分类编号（-1表示无）
+    QHash<QString, int> m_categoryIndex;  // 分类名称 -> 编号
+
+    QHash<QString, QVector<int>> m_ownPostings;    // 分类ID -> 本分类的图书行号
+    QHash<QString, QVector<int>> m_browsePostings; // 分类ID -> 本分类及直接子分类的图书行号
+
+    // 推荐结果缓存：同样的偏好和数量直接返回（rebuild时清空）
+    mutable QString m_topCacheKey;
+    mutable QVector<int> m_topCache;
+};
+
+#endif // CATALOGINDEX_H
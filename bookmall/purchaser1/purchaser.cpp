@@ -106,14 +106,9 @@ Purchaser::Purchaser(QWidget *parent)
 
    // 程序启动时自动连接服务器
    QTimer::singleShot(500, this, [this]() {
-       qDebug() << "自动连接服务器...";
-       if (!apiService->isConnected()) {
-           if (apiService->connectToServer(serverIp, serverPort)) {
-               qDebug() << "自动连接服务器成功";
-           } else {
-               qDebug() << "自动连接服务器失败，将在用户操作时重试";
-           }
-       }
+       // 异步连接：连接结果通过connected/errorOccurred通知，失败后自动重连
+       qDebug() << "自动连接服务器:" << serverIp << ":" << serverPort;
+       apiService->connectToServer(serverIp, serverPort);
    });
 }
 
@@ -2447,7 +2442,7 @@ void Purchaser::updateProfileDisplay()
     }
     
     // 查询卖家认证状态（如果组件已初始化）
-    if (sellerStatusLabel && apiService->isConnected() || apiService->connectToServer(serverIp, serverPort)) {
+    if (sellerStatusLabel) {
         QJsonObject response = apiService->getSellerCertStatus(QString::number(currentUser->getId()));
         if (response.value("success").toBool()) {
             QString status = response.value("status").toString();
@@ -2485,50 +2480,42 @@ QList<Book> Purchaser::PopularRecommend(int quantity)
 {
     QList<Book> recommended;
 
-    // 如果有登录用户，考虑用户偏好
-    if (currentUser && !currentUser->getPreferences().isEmpty()) {
-        // 获取用户偏好
-        QList<UserPreference> prefs = currentUser->getPreferences();
-
-        // 按偏好权重和热度综合排序
-        QList<Book> sortedBooks = allBooks;
-
-        std::sort(sortedBooks.begin(), sortedBooks.end(),
-                  [&prefs](const Book &a, const Book &b) {
-                      // 计算偏好得分
-                      double scoreA = a.getHeat();
-                      double scoreB = b.getHeat();
-
-                      for (const auto &pref : prefs) {
-                          if (a.getCategory1() == pref.category ||
-                              a.getCategory2() == pref.category) {
-                              scoreA += pref.weight * 10;
-                          }
-                          if (b.getCategory1() == pref.category ||
-                              b.getCategory2() == pref.category) {
-                              scoreB += pref.weight * 10;
-                          }
-                      }
-
-                      return scoreA > scoreB;
-                  });
-
-        // 取前quantity本
-        for (int i = 0; i < qMin(quantity, sortedBooks.size()); i++) {
-            recommended.append(sortedBooks[i]);
+    // 优先使用服务器推荐（基于全站购买/收藏共现），服务器不可用或无结果时退回本地按偏好和热度计算
+    if (currentUser && apiService->isConnected()) {
+        QJsonObject response = apiService->getRecommendations(QString::number(currentUser->getId()), quantity);
+        if (response.value("success").toBool()) {
+            for (const QJsonValue &value : response.value("books").toArray()) {
+                QJsonObject bookObj = value.toObject();
+                QString bookId = bookObj.value("bookId").toString();
+                if (bookMap.contains(bookId)) {
+                    recommended.append(bookMap[bookId]);  // 本地目录中的完整信息（封面、评分、收藏量）
+                } else {
+                    Book book;
+                    book.bookId = bookId;
+                    book.title = bookObj.value("bookName").toString();
+                    book.author = bookObj.value("author").toString();
+                    book.categoryId1 = bookObj.value("category1").toString();
+                    book.categoryId2 = bookObj.value("category2").toString();
+                    book.price = bookObj.value("price").toDouble();
+                    book.merchantId = bookObj.value("merchantId").toInt();
+                    recommended.append(book);
+                }
+            }
+            if (!recommended.isEmpty()) {
+                return recommended;
+            }
         }
-    } else {
-        // 无用户偏好，按热度排序
-        QList<Book> sortedBooks = allBooks;
+    }
 
-        std::sort(sortedBooks.begin(), sortedBooks.end(),
-                  [](const Book &a, const Book &b) {
-                      return a.getHeat() > b.getHeat();
-                  });
+    // 如果有登录用户，考虑用户偏好（按偏好权重和热度综合排序）；否则只按热度排序
+    QList<UserPreference> prefs;
+    if (currentUser) {
+        prefs = currentUser->getPreferences();
+    }
 
-        for (int i = 0; i < qMin(quantity, sortedBooks.size()); i++) {
-            recommended.append(sortedBooks[i]);
-        }
+    // 目录索引中每本书的得分要素已预先算好，这里只做一次线性打分并取前quantity本
+    for (int row : catalogIndex.topBooks(prefs, quantity)) {
+        recommended.append(allBooks.at(row));
     }
 
     return recommended;
@@ -2537,52 +2524,19 @@ QList<Book> Purchaser::PopularRecommend(int quantity)
 QList<Book> Purchaser::GetBooksByCategory(const QString &categoryId1, const QString &categoryId2)
 {
     QList<Book> result;
-    QSet<QString> addedBookIds;  // 用于去重，避免同一本书被添加多次
-
-    qDebug() << "GetBooksByCategory - categoryId1:" << categoryId1 << "categoryId2:" << categoryId2;
 
-    std::function<void(CategoryNode*)> searchCategory;
-    searchCategory = [&](CategoryNode* node) {
-        // 检查是否匹配一级分类或二级分类
-        bool matchCategory1 = (categoryId2.isEmpty() && node->getId() == categoryId1);
-        bool matchCategory2 = (!categoryId2.isEmpty() && node->getId() == categoryId2);
-        
-        if (matchCategory1 || matchCategory2) {
-            qDebug() << "找到匹配的分类节点:" << node->getName() << "ID:" << node->getId() << "图书数量:" << node->getBookIds().size();
-            
-            // 找到分类，获取所有图书
-            for (const auto &bookId : node->getBookIds()) {
-                if (bookMap.contains(bookId) && !addedBookIds.contains(bookId)) {
-                    result.append(bookMap[bookId]);
-                    addedBookIds.insert(bookId);  // 标记已添加
-                    qDebug() << "添加图书到结果:" << bookId << bookMap[bookId].getTitle();
-                }
-            }
+    // 选择一级分类时包含其子分类的图书，选择二级分类时只取该分类（倒排表构建时已去重）
+    QVector<int> rows = categoryId2.isEmpty()
+            ? catalogIndex.booksInCategory(categoryId1, true)
+            : catalogIndex.booksInCategory(categoryId2, false);
 
-            // 如果是父分类（选择一级分类时），还需要获取子分类的图书（但要去重）
-            if (matchCategory1) {  // 只有选择一级分类时才获取子分类的图书
-                qDebug() << "获取子分类图书，子分类数量:" << node->getChildren().size();
-            for (auto child : node->getChildren()) {
-                    qDebug() << "检查子分类:" << child->getName() << "ID:" << child->getId() << "图书数量:" << child->getBookIds().size();
-                for (const auto &bookId : child->getBookIds()) {
-                        if (bookMap.contains(bookId) && !addedBookIds.contains(bookId)) {
-                        result.append(bookMap[bookId]);
-                            addedBookIds.insert(bookId);  // 标记已添加
-                            qDebug() << "从子分类添加图书:" << bookId << bookMap[bookId].getTitle();
-                        }
-                    }
-                }
-            }
-        }
-
-        // 递归查找子节点
-        for (auto child : node->getChildren()) {
-            searchCategory(child);
-        }
-    };
+    result.reserve(rows.size());
+    for (int row : rows) {
+        result.append(allBooks.at(row));
+    }
 
-    searchCategory(categoryRoot);
-    qDebug() << "GetBooksByCategory 返回结果数量:" << result.size();
+    qDebug() << "GetBooksByCategory - categoryId1:" << categoryId1 << "categoryId2:" << categoryId2
+             << "返回结果数量:" << result.size();
     return result;
 }
 
@@ -2976,6 +2930,7 @@ void Purchaser::onLogoutClicked()
     int result = QMessageBox::question(this, "确认退出", "确定要退出登录吗？",
                                       QMessageBox::Yes | QMessageBox::No);
     if (result == QMessageBox::Yes) {
+        apiService->logout();
         currentUser = nullptr;
         isLoggedIn = false;
         showLoginPage();
@@ -3239,10 +3194,7 @@ void Purchaser::onBookItemClicked(QListWidgetItem *item)
         bookCoverLabel->setPixmap(coverPixmap.scaled(200, 300, Qt::KeepAspectRatio, Qt::SmoothTransformation));
     }
 
-    // 加载评论和评分
-    loadBookRatingStats();
-    loadBookReviews();
-    
+    // 评论和评分由showBookDetailPage加载
     showBookDetailPage();
 }
 
@@ -4486,16 +4438,16 @@ void Purchaser::showMainPage()
 void Purchaser::showBookDetailPage()
 {
     // 加载评论和评分
-    loadBookRatingStats();
-    loadBookReviews();
+    loadBookFeedback();
     
     stackedWidget->setCurrentWidget(bookDetailPage);
 }
 
-// 加载商品评分统计
-void Purchaser::loadBookRatingStats()
+// 加载商品评分统计和评论：两个查询合并为一次批量请求
+void Purchaser::loadBookFeedback()
 {
     if (currentBook.getId().isEmpty()) {
+        reviewsDisplay->clear();
         return;
     }
     
@@ -4505,7 +4457,14 @@ void Purchaser::loadBookRatingStats()
         }
     }
     
-    QJsonObject response = apiService->getBookRatingStats(currentBook.getId());
+    QJsonArray responses = apiService->getBookFeedback(currentBook.getId());
+    showBookRatingStats(responses.at(0).toObject());
+    showBookReviews(responses.at(1).toObject());
+}
+
+// 显示商品评分统计
+void Purchaser::showBookRatingStats(const QJsonObject &response)
+{
     if (response.value("success").toBool()) {
         double avgRating = response.value("averageRating").toDouble();
         int reviewCount = response.value("reviewCount").toInt();
@@ -4521,21 +4480,9 @@ void Purchaser::loadBookRatingStats()
     }
 }
 
-// 加载商品评论
-void Purchaser::loadBookReviews()
+// 显示商品评论
+void Purchaser::showBookReviews(const QJsonObject &response)
 {
-    if (currentBook.getId().isEmpty()) {
-        reviewsDisplay->clear();
-        return;
-    }
-    
-    if (!apiService->isConnected()) {
-        if (!apiService->connectToServer(serverIp, serverPort)) {
-            return;
-        }
-    }
-    
-    QJsonObject response = apiService->getBookReviews(currentBook.getId());
     if (response.value("success").toBool()) {
         QJsonArray reviews = response.value("reviews").toArray();
         
@@ -4638,8 +4585,7 @@ void Purchaser::onAddReviewClicked()
         if (response.value("success").toBool()) {
             QMessageBox::information(this, "成功", "评论提交成功");
             // 重新加载评论和评分
-            loadBookRatingStats();
-            loadBookReviews();
+            loadBookFeedback();
         } else {
             QString errorMsg = response.value("message").toString();
             QMessageBox::warning(this, "评论失败", errorMsg.isEmpty() ? "评论提交失败，请稍后重试" : errorMsg);
@@ -5228,6 +5174,8 @@ void Purchaser::loadLocalBooks()
         bookMap[book.getId()] = book;
     }
     
+    catalogIndex.rebuild(allBooks, categoryRoot);
+    
     qDebug() << "已加载本地图书数据，共" << allBooks.size() << "本";
 }
 
@@ -5422,6 +5370,9 @@ void Purchaser::updateBooksToCategories()
     }
     
     qDebug() << "已将" << allBooks.size() << "本图书添加到分类树";
+    
+    // 分类树已挂好图书，重建目录索引（分类浏览和推荐都走索引）
+    catalogIndex.rebuild(allBooks, categoryRoot);
     qDebug() << "一级分类数量:" << category1Map.size() << "二级分类数量:" << category2Map.size();
     
     // 调试：打印"其他"分类的图书数量
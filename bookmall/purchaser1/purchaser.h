@@ -14,6 +14,7 @@
 #include <QTimer>
 #include "user.h"
 #include "book.h"
+#include "catalogindex.h"
 #include "apiservice.h"
 #include <QComboBox>
 #include <QPushButton>
@@ -89,8 +90,9 @@ private slots:
     
     // 评论相关
     void onAddReviewClicked();  // 添加评论按钮点击
-    void loadBookReviews();  // 加载商品评论
-    void loadBookRatingStats();  // 加载商品评分统计
+    void loadBookFeedback();  // 加载商品评分统计和评论（一次往返）
+    void showBookRatingStats(const QJsonObject &response);  // 显示商品评分统计
+    void showBookReviews(const QJsonObject &response);  // 显示商品评论
     
     // 工具函数
     QString truncateBookTitle(const QString &title, int maxLength = 12);  // 截断过长的书名
@@ -292,6 +294,7 @@ private:
     QList<Book> allBooks;
     QMap<QString, Book> bookMap;
     CategoryNode *categoryRoot;
+    CatalogIndex catalogIndex;  // 分类倒排表和推荐打分索引，每次同步图书后重建
     QList<Order> allOrders;
     bool isLoggedIn;
 
@@ -12,11 +12,13 @@ SOURCES += \
     book.cpp \
     user.cpp \
     tcpclient.cpp \
-    apiservice.cpp
+    apiservice.cpp \
+    catalogindex.cpp
 
 HEADERS += \
     purchaser.h \
     book.h \
     user.h \
     tcpclient.h \
-    apiservice.h
+    apiservice.h \
+    catalogindex.h
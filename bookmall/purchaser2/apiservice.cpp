@@ -39,7 +39,53 @@ QJsonObject ApiService::login(const QString &username, const QString &password)
     request["action"] = "login";
     request["username"] = username;
     request["password"] = password;
-    return tcpClient->sendRequest(request, 10000);  // 增加超时时间到10秒
+    QJsonObject response = tcpClient->sendRequest(request, 10000);  // 增加超时时间到10秒
+    if (response.value("success").toBool()) {
+        tcpClient->setSessionToken(response.value("token").toString());
+    }
+    return response;
+}
+
+// 退出登录：注销服务器上的会话
+QJsonObject ApiService::logout()
+{
+    QJsonObject request;
+    request["action"] = "logout";
+    QJsonObject response = tcpClient->sendRequest(request, 5000);
+    tcpClient->clearSessionToken();
+    return response;
+}
+
+// 批量请求：服务器按顺序返回每个子请求的响应
+QJsonArray ApiService::batch(const QJsonArray &requests)
+{
+    QJsonObject request;
+    request["action"] = "batch";
+    request["requests"] = requests;
+    QJsonObject response = tcpClient->sendRequest(request, 15000);
+
+    QJsonArray results;
+    QJsonArray responses = response["responses"].toArray();
+    if (response["success"].toBool() && responses.size() == requests.size()) {
+        for (const QJsonValue &entry : responses) {
+            results.append(entry.toObject()["response"]);
+        }
+        return results;
+    }
+
+    // 旧版服务器不认识batch：逐个发送
+    if (response["message"].toString().startsWith("未知的请求类型")) {
+        for (const QJsonValue &sub : requests) {
+            results.append(tcpClient->sendRequest(sub.toObject(), 10000));
+        }
+        return results;
+    }
+
+    // 批量请求本身失败（断线、登录过期等）：每个子请求都返回同一个错误
+    for (int i = 0; i < requests.size(); ++i) {
+        results.append(response);
+    }
+    return results;
 }
 
 QJsonObject ApiService::changePassword(const QString &userId, const QString &oldPassword, const QString &newPassword)
@@ -195,6 +241,16 @@ QJsonObject ApiService::removeFavorite(const QString &userId, const QString &boo
     return tcpClient->sendRequest(request);
 }
 
+// 推荐相关API
+QJsonObject ApiService::getRecommendations(const QString &userId, int k)
+{
+    QJsonObject request;
+    request["action"] = "getRecommendations";
+    request["userId"] = userId;
+    request["k"] = k;
+    return tcpClient->sendRequest(request);
+}
+
 // 订单相关API
 QJsonObject ApiService::createOrder(const QString &userId,
                                     const QJsonArray &items,
@@ -326,3 +382,14 @@ QJsonObject ApiService::getBookRatingStats(const QString &bookId)
     return tcpClient->sendRequest(request, 10000);
 }
 
+QJsonArray ApiService::getBookFeedback(const QString &bookId)
+{
+    QJsonObject stats;
+    stats["action"] = "getBookRatingStats";
+    stats["bookId"] = bookId;
+    QJsonObject reviews;
+    reviews["action"] = "getBookReviews";
+    reviews["bookId"] = bookId;
+    return batch(QJsonArray{stats, reviews});
+}
+
@@ -21,6 +21,9 @@ public:
 
     // 用户相关API
     QJsonObject login(const QString &username, const QString &password);
+    QJsonObject logout();
+    // 批量请求：requests一帧发出，返回与之一一对应的响应（服务器不支持batch时逐个发送）
+    QJsonArray batch(const QJsonArray &requests);
     QJsonObject registerUser(const QString &username, const QString &password, const QString &email = "");
     QJsonObject changePassword(const QString &userId, const QString &oldPassword, const QString &newPassword);
     QJsonObject updateUserInfo(const QString &userId, const QString &phone, const QString &email, const QString &address);  // 更新用户信息
@@ -48,6 +51,9 @@ public:
     QJsonObject addFavorite(const QString &userId, const QString &bookId);
     QJsonObject removeFavorite(const QString &userId, const QString &bookId);
     
+    // 推荐相关API（服务器按购买/收藏记录计算；userId为空时返回热门榜）
+    QJsonObject getRecommendations(const QString &userId, int k);
+    
     // 订单相关API
     // 下单时需要传递用户ID、订单项、收货人信息（姓名/电话/地址）
     QJsonObject createOrder(const QString &userId,
@@ -73,6 +79,7 @@ public:
     QJsonObject addReview(const QString &userId, const QString &bookId, int rating, const QString &comment);
     QJsonObject getBookReviews(const QString &bookId);
     QJsonObject getBookRatingStats(const QString &bookId);
+    QJsonArray getBookFeedback(const QString &bookId);  // 一次往返取回 [评分统计响应, 评论列表响应]
 
 signals:
     void connected();
@@ -0,0 +1,173 @@
+#include "catalogindex.h"
+#include <QSet>
+#include <QPair>
+#include <algorithm>
+
+CatalogIndex::CatalogIndex()
+{
+}
+
+void CatalogIndex::clear()
+{
+    m_heat.clear();
+    m_category1.clear();
+    m_category2.clear();
+    m_categoryIndex.clear();
+    m_ownPostings.clear();
+    m_browsePostings.clear();
+    m_topCacheKey.clear();
+    m_topCache.clear();
+}
+
+void CatalogIndex::rebuild(const QList<Book> &books, CategoryNode *root)
+{
+    clear();
+
+    m_heat.reserve(books.size());
+    m_category1.reserve(books.size());
+    m_category2.reserve(books.size());
+
+    // 图书ID -> 行号；ID重复时以后出现的为准（与bookMap一致）
+    QHash<QString, int> rowOfBook;
+    rowOfBook.reserve(books.size());
+
+    for (int i = 0; i < books.size(); ++i) {
+        const Book &book = books.at(i);
+        m_heat.append(book.getHeat());
+        m_category1.append(categoryIndex(book.getCategory1()));
+        m_category2.append(categoryIndex(book.getCategory2()));
+        rowOfBook.insert(book.getId(), i);
+    }
+
+    if (root) {
+        collectPostings(root, rowOfBook);
+    }
+}
+
+int CatalogIndex::categoryIndex(const QString &category)
+{
+    if (category.isEmpty()) {
+        return -1;
+    }
+    auto it = m_categoryIndex.constFind(category);
+    if (it != m_categoryIndex.constEnd()) {
+        return it.value();
+    }
+    int index = m_categoryIndex.size();
+    m_categoryIndex.insert(category, index);
+    return index;
+}
+
+// 把rows追加到list末尾，跳过list中已有的行号
+static void appendUnique(QVector<int> &list, const QVector<int> &rows)
+{
+    if (list.isEmpty()) {
+        list = rows;
+        return;
+    }
+    QSet<int> seen;
+    seen.reserve(list.size() + rows.size());
+    for (int row : list) {
+        seen.insert(row);
+    }
+    for (int row : rows) {
+        if (!seen.contains(row)) {
+            seen.insert(row);
+            list.append(row);
+        }
+    }
+}
+
+void CatalogIndex::collectPostings(CategoryNode *node, const QHash<QString, int> &rowOfBook)
+{
+    // 先序遍历分类树：同一ID出现在多个节点（动态创建的分类）时按遍历顺序合并
+    QVector<int> own;
+    for (const QString &bookId : node->getBookIds()) {
+        auto it = rowOfBook.constFind(bookId);
+        if (it != rowOfBook.constEnd()) {
+            own.append(it.value());
+        }
+    }
+
+    QVector<int> browse = own;
+    for (CategoryNode *child : node->getChildren()) {
+        QVector<int> childRows;
+        for (const QString &bookId : child->getBookIds()) {
+            auto it = rowOfBook.constFind(bookId);
+            if (it != rowOfBook.constEnd()) {
+                childRows.append(it.value());
+            }
+        }
+        appendUnique(browse, childRows);
+    }
+
+    appendUnique(m_ownPostings[node->getId()], own);
+    appendUnique(m_browsePostings[node->getId()], browse);
+
+    for (CategoryNode *child : node->getChildren()) {
+        collectPostings(child, rowOfBook);
+    }
+}
+
+QVector<int> CatalogIndex::booksInCategory(const QString &categoryId, bool includeChildren) const
+{
+    const QHash<QString, QVector<int>> &postings = includeChildren ? m_browsePostings : m_ownPostings;
+    return postings.value(categoryId);
+}
+
+QVector<int> CatalogIndex::topBooks(const QList<UserPreference> &prefs, int quantity) const
+{
+    int count = m_heat.size();
+    int k = qMin(quantity, count);
+    if (k <= 0) {
+        return QVector<int>();
+    }
+
+    QString key = QString::number(k);
+    for (const auto &pref : prefs) {
+        key += "|" + pref.category + ":" + QString::number(pref.weight);
+    }
+    if (key == m_topCacheKey) {
+        return m_topCache;
+    }
+
+    // 偏好展开成 分类编号 -> 加分 的表，每本书的得分只需查两次表
+    QVector<double> bonus(m_categoryIndex.size(), 0.0);
+    for (const auto &pref : prefs) {
+        auto it = m_categoryIndex.constFind(pref.category);
+        if (it != m_categoryIndex.constEnd()) {
+            bonus[it.value()] += pref.weight * 10;
+        }
+    }
+
+    QVector<QPair<double, int>> scored;
+    scored.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        double score = m_heat.at(i);
+        int c1 = m_category1.at(i);
+        int c2 = m_category2.at(i);
+        if (c1 >= 0) {
+            score += bonus.at(c1);
+        }
+        if (c2 >= 0 && c2 != c1) {
+            score += bonus.at(c2);
+        }
+        scored.append(qMakePair(score, i));
+    }
+
+    // 只排出前k名：O(n log k)，得分相同时按原顺序
+    std::partial_sort(scored.begin(), scored.begin() + k, scored.end(),
+                      [](const QPair<double, int> &a, const QPair<double, int> &b) {
+                          return a.first > b.first || (a.first == b.first && a.second < b.second);
+                      });
+
+    QVector<int> rows;
+    rows.reserve(k);
+    for (int i = 0; i < k; ++i) {
+        rows.append(scored.at(i).second);
+    }
+
+    m_topCacheKey = key;
+    m_topCache = rows;
+    return rows;
+}
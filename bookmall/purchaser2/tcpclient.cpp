@@ -1,39 +1,38 @@
 #include "tcpclient.h"
 #include <QDebug>
-#include <QMutex>
-#include <QWaitCondition>
 #include <QDataStream>
-#include <QElapsedTimer>
-#include <QDateTime>
 #include <QEventLoop>
-#include <QCoreApplication>
+#include <QRandomGenerator>
 
 TcpClient::TcpClient(QObject *parent)
-    : QObject(parent), socket(nullptr), responseReceived(false)
+    : QObject(parent), socket(nullptr), serverPort(0), autoReconnect(false), reconnectAttempt(0),
+      errorReported(false), heartbeatPending(false), nextRequestId(0)
 {
     socket = new QTcpSocket(this);
-    timeoutTimer = new QTimer(this);
-    timeoutTimer->setSingleShot(true);
+    reconnectTimer = new QTimer(this);
+    reconnectTimer->setSingleShot(true);
+    connectTimeoutTimer = new QTimer(this);
+    connectTimeoutTimer->setSingleShot(true);
+    heartbeatTimer = new QTimer(this);
+    heartbeatTimer->setInterval(HEARTBEAT_CHECK_MS);
 
     connect(socket, &QTcpSocket::connected, this, &TcpClient::onConnected);
     connect(socket, &QTcpSocket::disconnected, this, &TcpClient::onDisconnected);
     connect(socket, &QTcpSocket::readyRead, this, &TcpClient::onReadyRead);
     connect(socket, QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::error),
             this, &TcpClient::onError);
-    connect(timeoutTimer, &QTimer::timeout, this, [this]() {
-        QMutexLocker locker(&responseMutex);
-        if (!responseReceived) {
-            responseReceived = true;
-            responseCondition.wakeAll();
-        }
-    });
-    
-    recvBuffer.clear();
+    connect(reconnectTimer, &QTimer::timeout, this, &TcpClient::startConnecting);
+    connect(connectTimeoutTimer, &QTimer::timeout, this, &TcpClient::onConnectTimeout);
+    connect(heartbeatTimer, &QTimer::timeout, this, &TcpClient::onHeartbeatTimer);
 }
 
 TcpClient::~TcpClient()
 {
-    disconnectFromServer();
+    // 析构时不再重连，也不等待连接关闭
+    autoReconnect = false;
+    reconnectTimer->stop();
+    socket->disconnect(this);
+    socket->abort();
 }
 
 bool TcpClient::connectToServer(const QString &host, quint16 port)
@@ -47,42 +46,56 @@ bool TcpClient::connectToServer(const QString &host, quint16 port)
         qDebug() << "错误：端口号为0";
         return false;
     }
-    
-    if (socket->state() == QAbstractSocket::ConnectedState) {
-        qDebug() << "已经连接到服务器，无需重复连接";
-        return true;
-    }
 
-    qDebug() << "正在连接到服务器:" << host << ":" << port;
-    socket->connectToHost(host, port);
-    
-    // 使用非阻塞方式等待连接，避免长时间阻塞
-    QElapsedTimer timer;
-    timer.start();
-    int timeout = 3000;  // 减少超时时间到3秒
-    
-    while (socket->state() != QAbstractSocket::ConnectedState && timer.elapsed() < timeout) {
-        if (socket->state() == QAbstractSocket::UnconnectedState) {
-            qDebug() << "连接失败:" << socket->errorString() << "(" << host << ":" << port << ")";
-            return false;
+    if (host != serverHost || port != serverPort) {
+        serverHost = host;
+        serverPort = port;
+        if (socket->state() != QAbstractSocket::UnconnectedState) {
+            socket->abort();  // 换了服务器地址，旧连接不再使用
         }
-        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);  // 处理事件，避免阻塞
     }
-    
+    autoReconnect = true;
+
     if (socket->state() == QAbstractSocket::ConnectedState) {
-        qDebug() << "成功连接到服务器" << host << ":" << port << "（耗时:" << timer.elapsed() << "ms）";
         return true;
-    } else {
-        qDebug() << "连接超时:" << socket->errorString() << "(" << host << ":" << port << ")";
-        return false;
     }
+    if (socket->state() == QAbstractSocket::ClosingState) {
+        socket->abort();
+    }
+    startConnecting();
+    return true;
+}
+
+void TcpClient::startConnecting()
+{
+    if (serverHost.isEmpty() || socket->state() != QAbstractSocket::UnconnectedState) {
+        return;
+    }
+    reconnectTimer->stop();
+    qDebug() << "正在连接到服务器:" << serverHost << ":" << serverPort;
+    socket->connectToHost(serverHost, serverPort);
+    connectTimeoutTimer->start(CONNECT_TIMEOUT_MS);
 }
 
 void TcpClient::disconnectFromServer()
 {
+    autoReconnect = false;
+    reconnectTimer->stop();
+    connectTimeoutTimer->stop();
+    heartbeatTimer->stop();
+
+    // 排队和等待中的请求都不会再有响应
+    QList<PendingRequest> pending = inflight + outbox;
+    inflight.clear();
+    outbox.clear();
+    for (const PendingRequest &request : pending) {
+        if (!request.heartbeat && !request.abandoned) {
+            failRequest(request.id, "已断开与服务器的连接");
+        }
+    }
+
     if (socket->state() != QAbstractSocket::UnconnectedState) {
-        socket->disconnectFromHost();
-        socket->waitForDisconnected(3000);
+        socket->disconnectFromHost();  // 待发送数据写完后断开，不阻塞
     }
 }
 
@@ -91,150 +104,273 @@ bool TcpClient::isConnected() const
     return socket->state() == QAbstractSocket::ConnectedState;
 }
 
+QByteArray TcpClient::encodeFrame(const QJsonObject &object)
+{
+    // 长度前缀协议：4字节大端长度 + JSON
+    QByteArray payload = QJsonDocument(object).toJson(QJsonDocument::Compact);
+    QByteArray frame;
+    QDataStream ds(&frame, QIODevice::WriteOnly);
+    ds.setByteOrder(QDataStream::BigEndian);
+    ds << (quint32)payload.size();
+    frame.append(payload);
+    return frame;
+}
+
+bool TcpClient::isReplayable(const QString &action)
+{
+    return action.startsWith("get") || action.startsWith("search")
+           || action.startsWith("sellerGet") || action.startsWith("adminGet");
+}
+
 QJsonObject TcpClient::sendRequest(const QJsonObject &request, int timeout)
 {
-    if (!isConnected()) {
+    if (serverHost.isEmpty()) {
         QJsonObject errorResponse;
         errorResponse["success"] = false;
         errorResponse["error"] = "未连接到服务器";
-        qDebug() << "发送请求失败：未连接到服务器";
+        qDebug() << "发送请求失败：未设置服务器地址";
         return errorResponse;
     }
 
-    // 使用请求ID来匹配响应（简单实现，使用时间戳）
-    qint64 requestId = QDateTime::currentMSecsSinceEpoch();
-    
-    QMutexLocker locker(&responseMutex);
-    responseReceived = false;
-    pendingResponse = QJsonObject();
-    recvBuffer.clear();  // 清空接收缓冲区
-
-    // 发送请求 - 使用长度前缀协议：4字节大端长度 + JSON
-    QJsonDocument doc(request);
-    QByteArray payload = doc.toJson(QJsonDocument::Compact);
-    
-    QByteArray frame;
-    QDataStream ds(&frame, QIODevice::WriteOnly);
-    ds.setByteOrder(QDataStream::BigEndian);
-    ds << (quint32)payload.size();
-    frame.append(payload);
-    
-    qDebug() << "发送请求到服务器，JSON大小:" << payload.size() << "字节，总帧大小:" << frame.size() << "字节";
-    qDebug() << "请求内容:" << QString::fromUtf8(payload);
-    
-    qint64 bytesWritten = socket->write(frame);
-    socket->flush();
-    
-    if (bytesWritten != frame.size()) {
-        qDebug() << "警告：数据未完全发送，已发送:" << bytesWritten << "总大小:" << frame.size();
+    // 已登录时自动附带会话token
+    QJsonObject outgoing = request;
+    if (!authToken.isEmpty() && !outgoing.contains("token")) {
+        outgoing["token"] = authToken;
+    }
+
+    PendingRequest pending;
+    pending.id = ++nextRequestId;
+    pending.frame = encodeFrame(outgoing);
+    pending.replayable = isReplayable(request.value("action").toString());
+    const quint64 id = pending.id;
+
+    if (isConnected()) {
+        writeRequest(pending);
     } else {
-        qDebug() << "数据已成功发送";
+        // 未连接：请求排队，立即发起一次连接（不等重连退避），连上后按顺序发送
+        qDebug() << "尚未连接到服务器，请求排队等待连接:" << request.value("action").toString();
+        outbox.append(pending);
+        if (autoReconnect) {
+            startConnecting();
+        }
     }
 
-    // 等待响应 - 关键：必须处理事件循环，否则onReadyRead无法被调用
-    qDebug() << "等待服务器响应，超时时间:" << timeout << "ms";
-    
-    // 释放锁，让事件循环能够运行
-    locker.unlock();
-    
-    timeoutTimer->start(timeout);
-    
-    // 使用QEventLoop确保事件循环运行，这样onReadyRead才能被调用
-    QEventLoop eventLoop;
-    QTimer timeoutTimer2;
-    timeoutTimer2.setSingleShot(true);
-    connect(&timeoutTimer2, &QTimer::timeout, &eventLoop, &QEventLoop::quit);
-    timeoutTimer2.start(timeout);
-    
-    // 使用QElapsedTimer精确计时
-    QElapsedTimer timer;
-    timer.start();
-    
-    // 循环等待，处理事件循环（优化：减少检查频率，提高响应速度）
-    bool received = false;
-    int checkInterval = 10;  // 每10ms检查一次，减少CPU占用
-    int lastCheckTime = 0;
-    
-    while (timeoutTimer2.isActive() && timer.elapsed() < timeout) {
-        int currentTime = timer.elapsed();
-        
-        // 只在间隔时间到达时检查响应
-        if (currentTime - lastCheckTime >= checkInterval) {
-            lastCheckTime = currentTime;
-            
-            // 检查是否收到响应
-            {
-                QMutexLocker checkLocker(&responseMutex);
-                if (responseReceived) {
-                    received = true;
-                    qDebug() << "收到服务器响应（耗时:" << timer.elapsed() << "ms）";
-                    break;
-                }
+    // 等待本请求的响应：局部事件循环在响应到达或超时时退出，期间界面和其他网络事件照常处理
+    if (!completed.contains(id)) {
+        QEventLoop eventLoop;
+        QTimer waitTimer;
+        waitTimer.setSingleShot(true);
+        connect(&waitTimer, &QTimer::timeout, &eventLoop, &QEventLoop::quit);
+        connect(this, &TcpClient::requestFinished, &eventLoop, [&eventLoop, id](quint64 finishedId) {
+            if (finishedId == id) {
+                eventLoop.quit();
             }
+        });
+        waitTimer.start(timeout);
+        eventLoop.exec();
+    }
+
+    if (completed.contains(id)) {
+        QJsonObject result = completed.take(id);
+        if (result.value("sessionExpired").toBool()) {
+            authToken.clear();  // 会话已失效，需要重新登录
         }
-        
-        // 处理事件循环，让onReadyRead能够被调用（关键！）
-        // 减少每次处理的事件数量，提高响应速度
-        QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
-        
-        // 如果超时，退出
-        if (currentTime >= timeout && !responseReceived) {
-            if (currentTime < timeout + 100) {  // 只在第一次超时时打印
-                qDebug() << "已超过超时时间(" << timeout << "ms)，继续等待延迟响应...";
-            }
+        return result;
+    }
+
+    // 超时：还没发出的请求从队列中移除；已发出的保留位置（响应按顺序到达），到达后丢弃
+    bool sent = true;
+    for (int i = 0; i < outbox.size(); ++i) {
+        if (outbox.at(i).id == id) {
+            outbox.removeAt(i);
+            sent = false;
+            break;
         }
     }
-    
-    timeoutTimer->stop();
-    timeoutTimer2.stop();
-    
-    // 最后再处理一次事件，确保刚到达的响应能被处理
-    if (!received) {
-        QCoreApplication::processEvents(QEventLoop::AllEvents, 100);
-        QMutexLocker checkLocker(&responseMutex);
-        if (responseReceived) {
-            received = true;
-            qDebug() << "收到延迟的服务器响应（在最后处理事件后，总耗时:" << timer.elapsed() << "ms）";
+    for (PendingRequest &entry : inflight) {
+        if (entry.id == id) {
+            entry.abandoned = true;
         }
     }
-    
-    // 重新获取锁
-    locker.relock();
-    
-    if (responseReceived && received) {
-        qDebug() << "成功收到服务器响应";
-        QJsonObject result = pendingResponse;
-        // 重置状态，准备下次请求
-        responseReceived = false;
-        pendingResponse = QJsonObject();
-        return result;
-    } else {
-        qDebug() << "请求超时，未收到服务器响应（等待了" << timer.elapsed() << "ms）";
-        QJsonObject errorResponse;
-        errorResponse["success"] = false;
+
+    QJsonObject errorResponse;
+    errorResponse["success"] = false;
+    if (sent) {
+        qDebug() << "请求超时，未收到服务器响应（等待了" << timeout << "ms）";
         errorResponse["error"] = "请求超时（服务器可能未响应）";
-        return errorResponse;
+    } else {
+        qDebug() << "请求超时：等待期间未能连接到服务器";
+        errorResponse["error"] = "未连接到服务器（正在重连）";
+    }
+    return errorResponse;
+}
+
+void TcpClient::writeRequest(const PendingRequest &request)
+{
+    inflight.append(request);
+    socket->write(request.frame);
+    lastActivity.restart();
+}
+
+void TcpClient::flushOutbox()
+{
+    while (!outbox.isEmpty() && isConnected()) {
+        writeRequest(outbox.takeFirst());
     }
 }
 
+void TcpClient::completeRequest(quint64 id, const QJsonObject &response)
+{
+    completed.insert(id, response);
+    emit requestFinished(id);
+}
+
+void TcpClient::failRequest(quint64 id, const QString &error)
+{
+    QJsonObject errorResponse;
+    errorResponse["success"] = false;
+    errorResponse["error"] = error;
+    completeRequest(id, errorResponse);
+}
+
+void TcpClient::setSessionToken(const QString &token)
+{
+    authToken = token;
+}
+
+void TcpClient::clearSessionToken()
+{
+    authToken.clear();
+}
+
 void TcpClient::onConnected()
 {
-    qDebug() << "已连接到服务器";
+    qDebug() << "已连接到服务器" << serverHost << ":" << serverPort;
+    connectTimeoutTimer->stop();
+    reconnectAttempt = 0;
+    errorReported = false;
+    heartbeatPending = false;
+    recvBuffer.clear();
+
+    // 系统级保活探测半开连接，应用层心跳负责更快发现服务器无响应
+    socket->setSocketOption(QAbstractSocket::KeepAliveOption, 1);
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    lastActivity.restart();
+    heartbeatTimer->start();
+
     emit connected();
+    flushOutbox();
 }
 
 void TcpClient::onDisconnected()
 {
     qDebug() << "与服务器断开连接";
     emit disconnected();
+    connectionLost(QString());
+}
+
+void TcpClient::onError(QAbstractSocket::SocketError error)
+{
+    Q_UNUSED(error);
+    QString errorString = socket->errorString();
+    qDebug() << "Socket错误:" << errorString;
+    if (socket->state() != QAbstractSocket::ConnectedState) {
+        connectionLost(errorString);
+    } else if (!errorReported) {
+        errorReported = true;
+        emit errorOccurred(errorString);
+    }
+}
+
+void TcpClient::onConnectTimeout()
+{
+    if (socket->state() == QAbstractSocket::ConnectedState) {
+        return;
+    }
+    qDebug() << "连接超时:" << serverHost << ":" << serverPort;
+    socket->abort();
+    connectionLost("连接服务器超时");
+}
+
+void TcpClient::onHeartbeatTimer()
+{
+    if (!isConnected()) {
+        return;
+    }
+    if (heartbeatPending) {
+        if (heartbeatSent.elapsed() >= HEARTBEAT_TIMEOUT_MS) {
+            qDebug() << "心跳超时，重新连接服务器";
+            socket->abort();
+            connectionLost("服务器无响应，正在重新连接");
+        }
+        return;
+    }
+    // 只在连接空闲时发送心跳；心跳不带token，不延长也不影响会话
+    if (inflight.isEmpty() && lastActivity.elapsed() >= HEARTBEAT_IDLE_MS) {
+        PendingRequest ping;
+        ping.id = ++nextRequestId;
+        ping.frame = encodeFrame(QJsonObject{{"action", "ping"}});
+        ping.heartbeat = true;
+        heartbeatPending = true;
+        heartbeatSent.start();
+        writeRequest(ping);
+    }
+}
+
+void TcpClient::connectionLost(const QString &reason)
+{
+    connectTimeoutTimer->stop();
+    heartbeatTimer->stop();
+    heartbeatPending = false;
+    recvBuffer.clear();
+
+    // 已发出未收到响应的请求：只读请求重连后重发，其他请求结果未知，返回失败由界面提示用户
+    QList<PendingRequest> replay;
+    QList<quint64> failed;
+    for (const PendingRequest &request : inflight) {
+        if (request.heartbeat || request.abandoned) {
+            continue;
+        }
+        if (request.replayable) {
+            replay.append(request);
+        } else {
+            failed.append(request.id);
+        }
+    }
+    inflight.clear();
+    outbox = replay + outbox;
+
+    scheduleReconnect();
+    for (quint64 id : failed) {
+        failRequest(id, "与服务器的连接中断，请求可能未完成，请刷新后确认");
+    }
+    if (!reason.isEmpty() && !errorReported) {
+        errorReported = true;
+        emit errorOccurred(reason);
+    }
+}
+
+void TcpClient::scheduleReconnect()
+{
+    if (!autoReconnect || reconnectTimer->isActive() || socket->state() != QAbstractSocket::UnconnectedState) {
+        return;
+    }
+    // 指数退避并加入随机抖动，避免服务器重启后所有客户端同时重连
+    int delayMs = RECONNECT_INITIAL_MS << qMin(reconnectAttempt, 6);
+    delayMs = qMin(delayMs, int(RECONNECT_MAX_MS));
+    delayMs += int(QRandomGenerator::global()->bounded(quint32(delayMs / 4 + 1)));
+    ++reconnectAttempt;
+    qDebug() << "将在" << delayMs << "ms后第" << reconnectAttempt << "次重连服务器";
+    emit reconnecting(reconnectAttempt, delayMs);
+    reconnectTimer->start(delayMs);
 }
 
 void TcpClient::onReadyRead()
 {
     QByteArray data = socket->readAll();
     recvBuffer.append(data);
-    qDebug() << "收到服务器数据，大小:" << data.size() << "字节，缓冲区总大小:" << recvBuffer.size() << "字节";
-    
+    lastActivity.restart();
+
     // 解析长度前缀协议：4字节大端长度 + JSON payload
     while (recvBuffer.size() >= 4) {
         // 读取长度前缀
@@ -242,49 +378,46 @@ void TcpClient::onReadyRead()
         ds.setByteOrder(QDataStream::BigEndian);
         quint32 payloadLen = 0;
         ds >> payloadLen;
-        
+
         // 防御：检查payload长度是否合理（最大10MB）
         if (payloadLen > 10 * 1024 * 1024) {
             qDebug() << "错误：payload长度过大:" << payloadLen << "，关闭连接";
-            socket->close();
+            socket->abort();
+            connectionLost("服务器响应格式错误");
             return;
         }
-        
+
         // 检查是否收到完整帧
         if (recvBuffer.size() < 4 + (int)payloadLen) {
-            // 数据不完整，等待更多数据
-            qDebug() << "数据不完整，等待更多数据。需要:" << (4 + payloadLen) << "字节，当前:" << recvBuffer.size() << "字节";
-            break;
+            break;  // 数据不完整，等待更多数据
         }
-        
+
         // 提取JSON payload
         QByteArray payload = recvBuffer.mid(4, payloadLen);
         recvBuffer = recvBuffer.mid(4 + payloadLen);  // 移除已处理的数据
-        
-        qDebug() << "解析到完整帧，JSON大小:" << payload.size() << "字节";
-        qDebug() << "JSON内容:" << QString::fromUtf8(payload);
-        
-        // 解析JSON
+
+        if (inflight.isEmpty()) {
+            // 没有等待中的请求（如服务器繁忙时接入即拒绝的响应），忽略
+            qDebug() << "收到未对应请求的服务器数据，已忽略:" << QString::fromUtf8(payload);
+            continue;
+        }
+        // 服务器按顺序处理同一连接上的请求，响应对应最早发出的请求
+        const PendingRequest request = inflight.takeFirst();
+        if (request.heartbeat) {
+            heartbeatPending = false;
+            continue;
+        }
+        if (request.abandoned) {
+            continue;
+        }
+
         QJsonParseError error;
         QJsonDocument doc = QJsonDocument::fromJson(payload, &error);
-        
         if (error.error == QJsonParseError::NoError && doc.isObject()) {
-            QMutexLocker locker(&responseMutex);
-            pendingResponse = doc.object();
-            responseReceived = true;
-            qDebug() << "JSON解析成功，响应内容:" << QJsonDocument(pendingResponse).toJson(QJsonDocument::Compact);
-            responseCondition.wakeAll();  // 唤醒等待的线程
+            completeRequest(request.id, doc.object());
         } else {
             qDebug() << "接收到的数据格式错误:" << error.errorString();
-            qDebug() << "错误位置:" << error.offset;
+            failRequest(request.id, "服务器响应格式错误");
         }
     }
 }
-
-void TcpClient::onError(QAbstractSocket::SocketError error)
-{
-    QString errorString = socket->errorString();
-    qDebug() << "Socket错误:" << errorString;
-    emit errorOccurred(errorString);
-}
-
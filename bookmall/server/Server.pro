@@ -23,20 +23,15 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 
+# 服务器核心源文件与无界面版（serverd.pro）共用
+include(servercore.pri)
+
 SOURCES += \
         main.cpp \
-        serverwindow.cpp \
-    threadpool.cpp \
-    tcpserver.cpp \
-    clientthreadfactory.cpp \
-    data.cpp
+        serverwindow.cpp
 
 HEADERS += \
-        serverwindow.h \
-    threadpool.h \
-    tcpserver.h \
-    clientthreadfactory.h \
-    data.h
+        serverwindow.h
 
 FORMS += \
         serverwindow.ui
@@ -0,0 +1,325 @@
+#include "cartservice.h"
+#include "data.h"
+#include <QThread>
+#include <QWaitCondition>
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QDebug>
+
+// 后台写回线程：每FLUSH_INTERVAL_MS毫秒调用一次flushDirty()
+class CartFlushThread : public QThread
+{
+public:
+    void requestStop()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stop = true;
+        m_wakeup.wakeAll();
+    }
+
+protected:
+    void run() override
+    {
+        QMutexLocker locker(&m_mutex);
+        while (!m_stop) {
+            m_wakeup.wait(&m_mutex, CartService::FLUSH_INTERVAL_MS);
+            if (m_stop) {
+                break;
+            }
+            locker.unlock();
+            CartService::getInstance().flushDirty();
+            locker.relock();
+        }
+    }
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_wakeup;
+    bool m_stop = false;
+};
+
+CartService::CartService()
+{
+}
+
+CartService::~CartService()
+{
+    stop();
+}
+
+CartService& CartService::getInstance()
+{
+    static CartService instance;
+    return instance;
+}
+
+void CartService::start()
+{
+    if (m_flushThread) {
+        return;
+    }
+    m_flushThread = new CartFlushThread;
+    m_flushThread->start();
+    qDebug() << "✓ 购物车写回线程已启动，写回周期" << FLUSH_INTERVAL_MS << "ms";
+}
+
+void CartService::stop()
+{
+    if (m_flushThread) {
+        m_flushThread->requestStop();
+        m_flushThread->wait();
+        delete m_flushThread;
+        m_flushThread = nullptr;
+    }
+    flushDirty();
+}
+
+template <typename Fn>
+bool CartService::withCart(int userId, Fn fn)
+{
+    Shard &shard = shardFor(userId);
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    {
+        QMutexLocker locker(&shard.mutex);
+        auto it = shard.carts.find(userId);
+        if (it != shard.carts.end()) {
+            it->lastAccessMs = nowMs;
+            return fn(it.value());
+        }
+    }
+
+    // 首次访问：在分片锁外从cart表加载；加载失败不能当作空购物车，否则下次写回会清掉表中的数据
+    bool ok = false;
+    QJsonArray rows = Database::getInstance().getCart(userId, &ok);
+    if (!ok) {
+        return false;
+    }
+    cacheBookInfo(rows, nowMs);
+
+    UserCart loaded;
+    for (const QJsonValue &rowVal : rows) {
+        QJsonObject row = rowVal.toObject();
+        CartLine line;
+        line.bookId = row["bookId"].toString();
+        line.quantity = row["quantity"].toInt();
+        line.addTime = row["addTime"].toString();
+        if (line.addTime.isEmpty()) {
+            line.addTime = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
+        }
+        loaded.lines.append(line);
+    }
+
+    QMutexLocker locker(&shard.mutex);
+    auto it = shard.carts.find(userId);
+    if (it == shard.carts.end()) {
+        it = shard.carts.insert(userId, loaded);  // 加载期间其他线程可能已经加载过，以先到的为准
+    }
+    it->lastAccessMs = nowMs;
+    return fn(it.value());
+}
+
+bool CartService::addItem(int userId, const QString& bookId, int quantity)
+{
+    if (quantity <= 0) {
+        return false;
+    }
+    return withCart(userId, [&](UserCart &cart) {
+        cart.dirty = true;
+        for (CartLine &line : cart.lines) {
+            if (line.bookId == bookId) {
+                line.quantity += quantity;
+                return true;
+            }
+        }
+        CartLine line;
+        line.bookId = bookId;
+        line.quantity = quantity;
+        line.addTime = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
+        cart.lines.append(line);
+        return true;
+    });
+}
+
+bool CartService::updateQuantity(int userId, const QString& bookId, int quantity)
+{
+    if (quantity <= 0) {
+        return removeItem(userId, bookId);
+    }
+    return withCart(userId, [&](UserCart &cart) {
+        for (CartLine &line : cart.lines) {
+            if (line.bookId == bookId) {
+                if (line.quantity != quantity) {
+                    line.quantity = quantity;
+                    cart.dirty = true;
+                }
+                return true;
+            }
+        }
+        qWarning() << "未找到要更新的购物车项，用户ID:" << userId << "图书ID:" << bookId;
+        return false;
+    });
+}
+
+bool CartService::removeItem(int userId, const QString& bookId)
+{
+    return withCart(userId, [&](UserCart &cart) {
+        for (int i = 0; i < cart.lines.size(); ++i) {
+            if (cart.lines.at(i).bookId == bookId) {
+                cart.lines.remove(i);
+                cart.dirty = true;
+                break;
+            }
+        }
+        return true;  // 与原DELETE语义一致：不存在也视为成功
+    });
+}
+
+bool CartService::items(int userId, QJsonArray* items)
+{
+    QVector<CartLine> lines;
+    if (!withCart(userId, [&](UserCart &cart) { lines = cart.lines; return true; })) {
+        return false;
+    }
+
+    // 图书名称和价格：缓存中没有或已过期的图书一次批量查询
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    QStringList missing;
+    {
+        QReadLocker locker(&m_bookInfoLock);
+        for (const CartLine &line : lines) {
+            auto it = m_bookInfo.constFind(line.bookId);
+            if (it == m_bookInfo.constEnd() || nowMs - it->fetchedMs > BOOK_INFO_TTL_MS) {
+                missing.append(line.bookId);
+            }
+        }
+    }
+    if (!missing.isEmpty()) {
+        QJsonArray books = Database::getInstance().getBookBasics(missing);
+        // 已删除的图书也记一条空信息，避免每次都查询
+        QJsonArray entries;
+        for (const QString &bookId : missing) {
+            QJsonObject entry;
+            entry["bookId"] = bookId;
+            for (const QJsonValue &bookVal : books) {
+                if (bookVal.toObject()["bookId"].toString() == bookId) {
+                    entry = bookVal.toObject();
+                    break;
+                }
+            }
+            entries.append(entry);
+        }
+        cacheBookInfo(entries, nowMs);
+    }
+
+    QReadLocker locker(&m_bookInfoLock);
+    for (const CartLine &line : lines) {
+        BookInfo info = m_bookInfo.value(line.bookId);
+        QJsonObject item;
+        item["bookId"] = line.bookId;
+        item["bookName"] = info.title;
+        item["price"] = info.price;
+        item["quantity"] = line.quantity;
+        items->append(item);
+    }
+    return true;
+}
+
+void CartService::cacheBookInfo(const QJsonArray& books, qint64 nowMs)
+{
+    QWriteLocker locker(&m_bookInfoLock);
+    if (m_bookInfo.size() + books.size() > BOOK_INFO_LIMIT) {
+        m_bookInfo.clear();
+    }
+    for (const QJsonValue &bookVal : books) {
+        QJsonObject book = bookVal.toObject();
+        BookInfo info;
+        info.title = book["bookName"].toString();
+        info.price = book["price"].toDouble();
+        info.fetchedMs = nowMs;
+        m_bookInfo.insert(book["bookId"].toString(), info);
+    }
+}
+
+QJsonArray CartService::toJson(const QVector<CartLine>& lines)
+{
+    QJsonArray array;
+    for (const CartLine &line : lines) {
+        QJsonObject item;
+        item["bookId"] = line.bookId;
+        item["quantity"] = line.quantity;
+        item["addTime"] = line.addTime;
+        array.append(item);
+    }
+    return array;
+}
+
+void CartService::markDirty(const QList<int>& userIds)
+{
+    for (int userId : userIds) {
+        Shard &shard = shardFor(userId);
+        QMutexLocker locker(&shard.mutex);
+        auto it = shard.carts.find(userId);
+        if (it != shard.carts.end()) {
+            it->dirty = true;
+        }
+    }
+}
+
+bool CartService::flushUser(int userId)
+{
+    QMutexLocker flushLocker(&m_flushMutex);
+
+    QMap<int, QJsonArray> batch;
+    {
+        Shard &shard = shardFor(userId);
+        QMutexLocker locker(&shard.mutex);
+        auto it = shard.carts.find(userId);
+        if (it == shard.carts.end() || !it->dirty) {
+            return true;
+        }
+        batch.insert(userId, toJson(it->lines));
+        it->dirty = false;
+    }
+
+    if (!Database::getInstance().replaceCarts(batch)) {
+        markDirty(batch.keys());
+        qWarning() << "❌ 购物车写回失败，用户ID:" << userId;
+        return false;
+    }
+    return true;
+}
+
+void CartService::flushDirty()
+{
+    QMutexLocker flushLocker(&m_flushMutex);
+
+    // 在各分片锁内只做快照，数据库写入不持有分片锁
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    QMap<int, QJsonArray> batch;
+    for (Shard &shard : m_shards) {
+        QMutexLocker locker(&shard.mutex);
+        for (auto it = shard.carts.begin(); it != shard.carts.end();) {
+            if (it->dirty) {
+                batch.insert(it.key(), toJson(it->lines));
+                it->dirty = false;
+                ++it;
+            } else if (nowMs - it->lastAccessMs > IDLE_EVICT_MS) {
+                it = shard.carts.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    if (batch.isEmpty()) {
+        return;
+    }
+
+    if (!Database::getInstance().replaceCarts(batch)) {
+        markDirty(batch.keys());
+        qWarning() << "❌ 购物车批量写回失败，下个周期重试，用户数:" << batch.size();
+    }
+}
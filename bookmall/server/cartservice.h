@@ -0,0 +1,91 @@
+#ifndef CARTSERVICE_H
+#define CARTSERVICE_H
+
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QJsonArray>
+
+class CartFlushThread;
+
+/**
+ * @brief 购物车服务（单例）：活跃用户的购物车常驻内存，按用户ID分片加锁
+ * @note 加购、改数量、移除只修改内存并标记为脏，后台线程每FLUSH_INTERVAL_MS毫秒把全部脏购物车
+ *       在一个事务中批量写回cart表；退出登录和下单时立即写回该用户的购物车。
+ *       cart表是唯一的持久化来源：用户首次访问时从表中加载，服务器崩溃最多丢失最后一个写回周期内的修改
+ */
+class CartService
+{
+public:
+    static CartService& getInstance();
+
+    enum {
+        SHARD_COUNT = 16,                // 分片数，不同用户的操作基本不会争用同一把锁
+        FLUSH_INTERVAL_MS = 300,         // 写回周期
+        IDLE_EVICT_MS = 30 * 60 * 1000,  // 已写回且这么久未访问的购物车移出内存
+        BOOK_INFO_TTL_MS = 60 * 1000,    // 图书名称/价格缓存有效期
+        BOOK_INFO_LIMIT = 50000          // 图书信息缓存上限
+    };
+
+    void start();  // 启动后台写回线程
+    void stop();   // 停止后台线程并写回全部脏购物车（服务器退出时调用）
+
+    bool addItem(int userId, const QString& bookId, int quantity);  // 已有该书时累加数量
+    bool updateQuantity(int userId, const QString& bookId, int quantity);  // 购物车中没有该书时返回false
+    bool removeItem(int userId, const QString& bookId);
+    bool items(int userId, QJsonArray* items);  // [{bookId, bookName, price, quantity}]，加载失败返回false
+
+    bool flushUser(int userId);  // 立即写回该用户的购物车（退出登录、下单）
+    void flushDirty();           // 写回全部脏购物车，并移出长时间未访问的购物车
+
+private:
+    CartService();
+    ~CartService();
+    CartService(const CartService&) = delete;
+    CartService& operator=(const CartService&) = delete;
+
+    struct CartLine {
+        QString bookId;
+        int quantity = 0;
+        QString addTime;  // 加入时间（"yyyy-MM-dd hh:mm:ss"），写回时保留
+    };
+
+    struct UserCart {
+        QVector<CartLine> lines;  // 按加入顺序
+        bool dirty = false;
+        qint64 lastAccessMs = 0;
+    };
+
+    struct Shard {
+        QMutex mutex;
+        QHash<int, UserCart> carts;
+    };
+
+    struct BookInfo {
+        QString title;
+        double price = 0.0;
+        qint64 fetchedMs = 0;
+    };
+
+    Shard& shardFor(int userId) { return m_shards[uint(userId) % SHARD_COUNT]; }
+
+    // 在分片锁内对用户购物车执行fn；未在内存中时先从cart表加载
+    template <typename Fn>
+    bool withCart(int userId, Fn fn);
+
+    static QJsonArray toJson(const QVector<CartLine>& lines);
+    void markDirty(const QList<int>& userIds);
+    void cacheBookInfo(const QJsonArray& books, qint64 nowMs);
+
+    Shard m_shards[SHARD_COUNT];
+    QMutex m_flushMutex;  // 写回串行执行，保证同一用户的快照按顺序落库
+    QReadWriteLock m_bookInfoLock;
+    QHash<QString, BookInfo> m_bookInfo;
+    CartFlushThread* m_flushThread = nullptr;
+};
+
+#endif // CARTSERVICE_H
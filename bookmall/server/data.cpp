@@ -4,6 +4,20 @@
 #include <QFile>
 #include <QTextStream>
 #include <QSqlRecord>
+#include <QSqlDriver>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QThread>
+#include <QThreadStorage>
+#include <QAtomicInt>
+#include <QPair>
+#include <QSet>
+#include <algorithm>
+#include "servermetrics.h"
+#include "sessionmanager.h"
+#include "groupcommit.h"
+#include "platformcounters.h"
 
 // #region agent log
 // 调试日志辅助函数
@@ -29,10 +43,96 @@ static void writeDebugLog(const QString& location, const QString& message, const
 // #endregion
 
 // ==========================================
-// Database类实现 - MySQL数据库管理
+// Database类实现 - MySQL / SQLite数据库管理
 // ==========================================
 
-Database::Database() : m_connected(false)
+// 带计时的数据库锁：等待锁的时间计入排队指标，持有锁的时间计入当前请求的数据库耗时
+// mutex为nullptr时不加锁，只计时（SQLite只读连接）
+class DbLocker
+{
+public:
+    explicit DbLocker(QMutex* mutex) : m_mutex(mutex)
+    {
+        if (m_mutex) {
+            ServerMetrics& metrics = ServerMetrics::getInstance();
+            metrics.dbWaitBegin();
+            QElapsedTimer waitTimer;
+            waitTimer.start();
+            m_mutex->lock();
+            metrics.dbWaitEnd(waitTimer.nsecsElapsed() / 1000);
+        }
+        m_held.start();
+    }
+
+    ~DbLocker()
+    {
+        const qint64 heldUs = m_held.nsecsElapsed() / 1000;
+        if (m_mutex) {
+            m_mutex->unlock();
+        }
+        ServerMetrics::getInstance().addDbTime(heldUs);
+    }
+
+private:
+    Q_DISABLE_COPY(DbLocker)
+    QMutex* m_mutex;
+    QElapsedTimer m_held;
+};
+
+// 只读查询的数据库访问：MySQL只有一个连接，仍然加写连接锁；
+// SQLite下使用当前线程独立的只读连接，WAL模式下读不阻塞写、写也不阻塞读
+class DbReadLocker : public DbLocker
+{
+public:
+    explicit DbReadLocker(Database* database)
+        : DbLocker(database->isSqlite() ? nullptr : &database->m_mutex)
+        , m_connection(database->readConnection())
+    {
+    }
+
+    QSqlDatabase connection() const { return m_connection; }
+
+private:
+    QSqlDatabase m_connection;
+};
+
+// SQLite的每线程只读连接：线程退出时由QThreadStorage析构并移除连接
+class SqliteReadConnection
+{
+public:
+    explicit SqliteReadConnection(const QString& path) : m_path(path)
+    {
+        static QAtomicInt counter;
+        m_name = QString("bookmall_read_%1").arg(counter.fetchAndAddRelaxed(1));
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", m_name);
+        db.setDatabaseName(path);
+        db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+        if (!db.open()) {
+            qWarning() << "❌ 打开SQLite只读连接失败:" << db.lastError().text();
+        }
+    }
+
+    ~SqliteReadConnection()
+    {
+        {
+            QSqlDatabase db = QSqlDatabase::database(m_name, false);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(m_name);
+    }
+
+    QString path() const { return m_path; }
+    QSqlDatabase database() const { return QSqlDatabase::database(m_name, false); }
+
+private:
+    Q_DISABLE_COPY(SqliteReadConnection)
+    QString m_path;
+    QString m_name;
+};
+
+static QThreadStorage<SqliteReadConnection*> s_sqliteReadConnections;
+
+Database::Database() : m_connected(false), m_backend(Backend::MySql)
 {
     qDebug() << "Database实例创建";
 }
@@ -51,13 +151,14 @@ Database& Database::getInstance()
 bool Database::initConnection(const QString& host, int port, const QString& dbName, 
                               const QString& username, const QString& password)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (m_connected) {
         qDebug() << "数据库已经连接";
         return true;
     }
     
+    m_backend = Backend::MySql;
     m_db = QSqlDatabase::addDatabase("QMYSQL");
     m_db.setHostName(host);
     m_db.setPort(port);
@@ -83,6 +184,123 @@ bool Database::initConnection(const QString& host, int port, const QString& dbNa
     return true;
 }
 
+bool Database::initSqliteConnection(const QString& filePath)
+{
+    DbLocker locker(&m_mutex);
+    
+    if (m_connected) {
+        qDebug() << "数据库已经连接";
+        return true;
+    }
+    
+    m_backend = Backend::Sqlite;
+    m_sqlitePath = filePath;
+    m_db = QSqlDatabase::addDatabase("QSQLITE", "bookmall_writer");
+    m_db.setDatabaseName(filePath);
+    m_db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+    
+    if (!m_db.open()) {
+        qCritical() << "❌ SQLite数据库打开失败:" << m_db.lastError().text();
+        return false;
+    }
+    
+    if (!applySqlitePragmas(m_db, false)) {
+        qCritical() << "❌ SQLite数据库设置WAL模式失败";
+        m_db.close();
+        return false;
+    }
+    
+    qDebug() << "✅ SQLite数据库已打开:" << filePath;
+    m_connected = true;
+    
+    // 创建表结构
+    if (!createTables()) {
+        qCritical() << "❌ 创建数据库表失败";
+        m_db.close();
+        m_connected = false;
+        return false;
+    }
+    
+    return true;
+}
+
+// SQLite连接参数：
+// - WAL：读写并发，写事务提交只追加WAL文件
+// - synchronous=NORMAL：WAL模式下只在检查点时fsync，断电最多丢失最后一次提交，不会损坏数据库
+// - 32MB页缓存、256MB内存映射、临时表放内存
+// - 只读连接设置query_only，防止误用于写操作
+bool Database::applySqlitePragmas(QSqlDatabase& db, bool readOnly)
+{
+    QSqlQuery query(db);
+    if (!readOnly) {
+        if (!query.exec("PRAGMA journal_mode=WAL") || !query.next()
+            || query.value(0).toString().toLower() != "wal") {
+            qWarning() << "设置journal_mode=WAL失败:" << query.lastError().text();
+            return false;
+        }
+        query.exec("PRAGMA wal_autocheckpoint=1000");
+    }
+    
+    const QStringList pragmas = {
+        "PRAGMA synchronous=NORMAL",
+        "PRAGMA temp_store=MEMORY",
+        "PRAGMA cache_size=-32000",
+        "PRAGMA mmap_size=268435456",
+        readOnly ? "PRAGMA query_only=1" : "PRAGMA foreign_keys=OFF"
+    };
+    for (const QString& pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            qWarning() << pragma << "执行失败:" << query.lastError().text();
+        }
+    }
+    return true;
+}
+
+// 只读查询使用的连接：SQLite下每个线程打开一个只读连接（线程池线程长期存在，连接随线程复用）
+QSqlDatabase Database::readConnection()
+{
+    if (!isSqlite()) {
+        return m_db;
+    }
+    
+    if (!s_sqliteReadConnections.hasLocalData()
+        || s_sqliteReadConnections.localData()->path() != m_sqlitePath) {
+        SqliteReadConnection* connection = new SqliteReadConnection(m_sqlitePath);
+        QSqlDatabase db = connection->database();
+        applySqlitePragmas(db, true);
+        s_sqliteReadConnections.setLocalData(connection);  // 会删除本线程之前的连接
+    }
+    return s_sqliteReadConnections.localData()->database();
+}
+
+// 把语句中的MySQL函数替换为SQLite写法；MySQL后端原样返回
+// 时间统一写成与MySQL DATETIME读出时相同的yyyy-MM-ddTHH:mm:ss格式
+QString Database::dialect(const QString& statement) const
+{
+    if (!isSqlite()) {
+        return statement;
+    }
+    
+    QString converted = statement;
+    converted.replace("NOW()", "strftime('%Y-%m-%dT%H:%M:%S', 'now', 'localtime')");
+    converted.replace("CURRENT_TIMESTAMP", "strftime('%Y-%m-%dT%H:%M:%S', 'now', 'localtime')");
+    converted.replace("CURDATE()", "date('now', 'localtime')");
+    converted.replace(" AS CHAR)", " AS TEXT)");
+    // ON DUPLICATE KEY UPDATE中的VALUES(col)对应SQLite upsert的excluded.col
+    static const QRegularExpression valuesRef("\\bVALUES\\((\\w+)\\)");
+    converted.replace(valuesRef, "excluded.\\1");
+    return converted;
+}
+
+// 插入冲突时更新：MySQL按任意唯一键冲突，SQLite需要指明冲突的唯一键字段
+QString Database::upsertClause(const QString& conflictColumns) const
+{
+    if (isSqlite()) {
+        return QString("ON CONFLICT(%1) DO UPDATE SET ").arg(conflictColumns);
+    }
+    return "ON DUPLICATE KEY UPDATE ";
+}
+
 bool Database::isConnected() const
 {
     return m_connected && m_db.isOpen();
@@ -90,7 +308,7 @@ bool Database::isConnected() const
 
 void Database::closeConnection()
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (m_connected) {
         m_db.close();
@@ -99,15 +317,228 @@ void Database::closeConnection()
     }
 }
 
+// ==========================================
+// 数据库结构迁移
+// ==========================================
+// 每个迁移步骤有唯一递增的版本号，执行成功后写入schema_version表。
+// 启动时只查询一次当前版本，已是最新版本则跳过全部建表/改表语句。
+// 迁移步骤必须幂等：没有schema_version表的旧库会从版本1开始重新执行一遍。
+
+const QList<Database::Migration>& Database::migrations()
+{
+    static const QList<Migration> steps = {
+        {1, "创建基础表结构", &Database::migrateCreateBaseTables},
+        {2, "users表补充字段", &Database::migrateUpgradeUsersTable},
+        {3, "sellers表补充字段", &Database::migrateUpgradeSellersTable},
+        {4, "books表补充字段", &Database::migrateUpgradeBooksTable},
+        {5, "初始化默认商家账号", &Database::migrateSeedDefaultSeller},
+        {6, "books表增加评分/收藏计数字段", &Database::migrateAddBookStatsColumns},
+        {7, "创建商家-客户索引表", &Database::migrateCreateSellerCustomers},
+        {8, "创建优惠券钱包表", &Database::migrateCreateCouponWallet},
+        {9, "创建聊天会话索引表", &Database::migrateCreateConversations},
+        {10, "创建订单-商家索引表", &Database::migrateCreateOrderMerchants},
+    };
+    return steps;
+}
+
+static bool isSqliteQuery(const QSqlQuery& query)
+{
+    return query.driver() && query.driver()->dbmsType() == QSqlDriver::SQLite;
+}
+
+// MySQL建表/加字段语句转换为SQLite语法：去掉COMMENT、表选项和AFTER，
+// 自增主键改为INTEGER PRIMARY KEY AUTOINCREMENT，UNIQUE KEY改为表级UNIQUE约束
+static QString toSqliteDdl(const QString& statement)
+{
+    QString ddl = statement;
+    ddl.replace(QRegularExpression("\\)\\s*ENGINE=[^\\n]*"), ")");
+    ddl.replace(QRegularExpression("\\s+COMMENT\\s*'[^']*'"), "");
+    ddl.replace(QRegularExpression("\\s+AFTER\\s+\\w+"), "");
+    ddl.replace(QRegularExpression("\\bINT\\s+AUTO_INCREMENT\\s+PRIMARY\\s+KEY"), "INTEGER PRIMARY KEY AUTOINCREMENT");
+    ddl.replace(QRegularExpression("\\bUNIQUE\\s+KEY\\s+\\w+\\s*\\("), "UNIQUE (");
+    ddl.replace("DEFAULT CURRENT_TIMESTAMP", "DEFAULT (strftime('%Y-%m-%dT%H:%M:%S', 'now', 'localtime'))");
+    return ddl;
+}
+
+// 一次查询取出表的全部字段（字段名 -> 大写数据类型），替代逐字段探测information_schema
+static QHash<QString, QString> tableColumns(QSqlQuery& query, const QString& table)
+{
+    QHash<QString, QString> columns;
+    if (isSqliteQuery(query)) {
+        // SQLite的类型是建表时写的原文（如VARCHAR(50)），去掉长度部分与MySQL的DATA_TYPE保持一致
+        if (query.exec(QString("PRAGMA table_info(%1)").arg(table))) {
+            while (query.next()) {
+                QString type = query.value("type").toString().toUpper();
+                columns.insert(query.value("name").toString(), type.left(type.indexOf('(')).trimmed());
+            }
+        }
+        return columns;
+    }
+    query.prepare("SELECT COLUMN_NAME, DATA_TYPE FROM information_schema.COLUMNS "
+                  "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = ?");
+    query.addBindValue(table);
+    if (query.exec()) {
+        while (query.next()) {
+            columns.insert(query.value(0).toString(), query.value(1).toString().toUpper());
+        }
+    }
+    return columns;
+}
+
+// 字段不存在时添加字段，添加成功后记入columns；字段已存在或添加成功返回true
+static bool addColumnIfMissing(QSqlQuery& query, QHash<QString, QString>& columns,
+                               const QString& table, const QString& column, const QString& definition)
+{
+    if (columns.contains(column)) {
+        return true;
+    }
+    QString statement = QString("ALTER TABLE %1 ADD COLUMN %2 %3").arg(table, column, definition);
+    if (isSqliteQuery(query)) {
+        statement = toSqliteDdl(statement);
+    }
+    if (!query.exec(statement)) {
+        qWarning() << "添加" << column << "字段失败:" << query.lastError().text();
+        return false;
+    }
+    qDebug() << "✓ 已添加" << column << "字段到" << table << "表";
+    columns.insert(column, definition.section(' ', 0, 0).section('(', 0, 0).toUpper());
+    return true;
+}
+
+// 执行迁移中的改表/回填语句，失败时记录日志并返回false
+static bool execMigrationStatement(QSqlQuery& query, const QString& statement)
+{
+    if (!query.exec(statement)) {
+        qWarning() << "迁移语句执行失败:" << statement << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+// 索引不存在时添加索引（SQLite的索引名加表名前缀，与execDdl一致）
+static bool addIndexIfMissing(QSqlQuery& query, const QString& table, const QString& index, const QString& columns)
+{
+    if (isSqliteQuery(query)) {
+        return query.exec(QString("CREATE INDEX IF NOT EXISTS %1_%2 ON %1 (%3)").arg(table, index, columns));
+    }
+    query.prepare("SELECT COUNT(*) FROM information_schema.STATISTICS "
+                  "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = ? AND INDEX_NAME = ?");
+    query.addBindValue(table);
+    query.addBindValue(index);
+    if (query.exec() && query.next() && query.value(0).toInt() > 0) {
+        return true;
+    }
+    if (!query.exec(QString("CREATE INDEX %1 ON %2 (%3)").arg(index, table, columns))) {
+        qWarning() << "添加索引" << index << "失败:" << query.lastError().text();
+        return false;
+    }
+    qDebug() << "✓ 已添加" << index << "索引到" << table << "表";
+    return true;
+}
+
+int Database::currentSchemaVersion(QSqlQuery& query)
+{
+    // schema_version表不存在时查询失败，视为版本0
+    if (query.exec("SELECT MAX(version) FROM schema_version") && query.next()) {
+        return query.value(0).toInt();
+    }
+    return 0;
+}
+
+// 执行建表语句：SQLite不支持CREATE TABLE内联INDEX，拆成单独的CREATE INDEX
+// SQLite的索引名在整个库内唯一，因此加上表名前缀
+bool Database::execDdl(QSqlQuery& query, const QString& statement)
+{
+    if (!isSqlite()) {
+        return query.exec(statement);
+    }
+    
+    QString ddl = toSqliteDdl(statement);
+    const QString table = QRegularExpression("CREATE TABLE IF NOT EXISTS (\\w+)").match(ddl).captured(1);
+    
+    QStringList indexStatements;
+    static const QRegularExpression inlineIndex(",\\s*INDEX\\s+(\\w+)\\s*\\(([^)]*)\\)");
+    QRegularExpressionMatchIterator it = inlineIndex.globalMatch(ddl);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        indexStatements << QString("CREATE INDEX IF NOT EXISTS %1_%2 ON %1 (%3)")
+                           .arg(table, match.captured(1), match.captured(2));
+    }
+    ddl.remove(inlineIndex);
+    
+    if (!query.exec(ddl)) {
+        return false;
+    }
+    for (const QString& indexStatement : indexStatements) {
+        if (!query.exec(indexStatement)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool Database::createTables()
 {
     QSqlQuery query(m_db);
     
-    qDebug() << "开始创建数据库表...";
+    const QList<Migration>& steps = migrations();
+    const int latestVersion = steps.isEmpty() ? 0 : steps.last().version;
+    const int currentVersion = currentSchemaVersion(query);
+    
+    if (currentVersion >= latestVersion) {
+        qDebug() << "✓ 数据库结构已是最新版本:" << currentVersion;
+        return true;
+    }
+    
+    qDebug() << "开始迁移数据库结构，当前版本:" << currentVersion << "目标版本:" << latestVersion;
+    
+    QString createSchemaVersionTable = R"(
+        CREATE TABLE IF NOT EXISTS schema_version (
+            version INT PRIMARY KEY COMMENT '迁移版本号',
+            description VARCHAR(200) COMMENT '迁移说明',
+            applied_at DATETIME DEFAULT CURRENT_TIMESTAMP COMMENT '执行时间'
+        ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='数据库结构版本表'
+    )";
+    
+    if (!execDdl(query, createSchemaVersionTable)) {
+        qCritical() << "创建schema_version表失败:" << query.lastError().text();
+        return false;
+    }
+    
+    for (const Migration& step : steps) {
+        if (step.version <= currentVersion) {
+            continue;
+        }
+        
+        qDebug() << "执行迁移" << step.version << ":" << step.description;
+        if (!(this->*step.apply)(query)) {
+            qCritical() << "迁移失败，版本:" << step.version;
+            return false;
+        }
+        
+        query.prepare("INSERT INTO schema_version (version, description) VALUES (?, ?)");
+        query.addBindValue(step.version);
+        query.addBindValue(QString(step.description));
+        if (!query.exec()) {
+            qCritical() << "记录迁移版本失败:" << query.lastError().text();
+            return false;
+        }
+    }
+    
+    qDebug() << "========================================";
+    qDebug() << "数据库结构迁移完成，当前版本:" << latestVersion;
+    qDebug() << "========================================";
+    
+    // 注意：示例图书数据初始化已移至窗口显示后异步执行，避免阻塞UI
     
-    // 1. 请求日志表 - 记录所有API请求
-    QString createRequestLogsTable = R"(
-        CREATE TABLE IF NOT EXISTS request_logs (
+    return true;
+}
+
+// 请求日志表结构：旧表request_logs和按天分表request_logs_yyyyMMdd相同
+static QString requestLogTableDdl(const QString& table)
+{
+    return QString(R"(
+        CREATE TABLE IF NOT EXISTS %1 (
             id INT AUTO_INCREMENT PRIMARY KEY COMMENT '日志ID',
             timestamp DATETIME DEFAULT CURRENT_TIMESTAMP COMMENT '请求时间',
             client_ip VARCHAR(50) COMMENT '客户端IP',
@@ -121,9 +552,14 @@ bool Database::createTables()
             INDEX idx_action (action),
             INDEX idx_category (category)
         ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='API请求日志表'
-    )";
-    
-    if (!query.exec(createRequestLogsTable)) {
+    )").arg(table);
+}
+
+// 迁移1：创建基础表结构
+bool Database::migrateCreateBaseTables(QSqlQuery& query)
+{
+    // 1. 请求日志表 - 记录所有API请求（现已按天分表写入，旧表保留供查询和归档）
+    if (!execDdl(query, requestLogTableDdl("request_logs"))) {
         qCritical() << "创建request_logs表失败:" << query.lastError().text();
         return false;
     }
@@ -148,206 +584,12 @@ bool Database::createTables()
         ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='买家用户表'
     )";
     
-    if (!query.exec(createUsersTable)) {
+    if (!execDdl(query, createUsersTable)) {
         qCritical() << "创建users表失败:" << query.lastError().text();
         return false;
     }
     qDebug() << "✓ users表创建成功";
     
-    // 检查并添加license_image_base64字段（如果表已存在但字段不存在）
-    query.prepare("SELECT COUNT(*) FROM information_schema.COLUMNS "
-                 "WHERE TABLE_SCHEMA = DATABASE() "
-                 "AND TABLE_NAME = 'users' "
-                 "AND COLUMN_NAME = 'license_image_base64'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        // 字段不存在，添加字段
-        QString addColumnSql = "ALTER TABLE users ADD COLUMN license_image_base64 TEXT COMMENT '营业执照图片(Base64编码)'";
-        if (query.exec(addColumnSql)) {
-            qDebug() << "✓ 已添加license_image_base64字段到users表";
-        } else {
-            qWarning() << "添加license_image_base64字段失败:" << query.lastError().text();
-        }
-    }
-    
-    // 检查并添加role字段（如果表已存在但字段不存在）
-    query.prepare("SELECT COUNT(*) FROM information_schema.COLUMNS "
-                 "WHERE TABLE_SCHEMA = DATABASE() "
-                 "AND TABLE_NAME = 'users' "
-                 "AND COLUMN_NAME = 'role'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        // 字段不存在，添加字段，默认值为1（买家）
-        QString addRoleSql = "ALTER TABLE users ADD COLUMN role TINYINT DEFAULT 1 COMMENT '用户身份：1-买家，2-卖家，0-买家申请成为卖家且在审核中'";
-        if (query.exec(addRoleSql)) {
-            qDebug() << "✓ 已添加role字段到users表";
-            // 更新现有用户的role值，默认为1（买家）
-            query.exec("UPDATE users SET role = 1 WHERE role IS NULL");
-        } else {
-            qWarning() << "添加role字段失败:" << query.lastError().text();
-        }
-    }
-    
-    // 检查并添加total_recharge字段（累计充值总额）
-    query.prepare("SELECT COUNT(*) FROM information_schema.COLUMNS "
-                 "WHERE TABLE_SCHEMA = DATABASE() "
-                 "AND TABLE_NAME = 'users' "
-                 "AND COLUMN_NAME = 'total_recharge'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        QString addTotalRechargeSql = "ALTER TABLE users ADD COLUMN total_recharge DECIMAL(10, 2) DEFAULT 0.00 COMMENT '累计充值总额' AFTER balance";
-        if (query.exec(addTotalRechargeSql)) {
-            qDebug() << "✓ 已添加total_recharge字段到users表";
-        } else {
-            qWarning() << "添加total_recharge字段失败:" << query.lastError().text();
-        }
-    }
-    
-    // 检查并添加member_level字段（会员等级）
-    query.prepare("SELECT COUNT(*) FROM information_schema.COLUMNS "
-                 "WHERE TABLE_SCHEMA = DATABASE() "
-                 "AND TABLE_NAME = 'users' "
-                 "AND COLUMN_NAME = 'member_level'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        QString addMemberLevelSql = "ALTER TABLE users ADD COLUMN member_level VARCHAR(20) DEFAULT '普通会员' COMMENT '会员等级：普通会员、银卡会员、金卡会员、铂金会员、钻石会员、黑钻会员' AFTER total_recharge";
-        if (query.exec(addMemberLevelSql)) {
-            qDebug() << "✓ 已添加member_level字段到users表";
-            // 初始化现有用户的会员等级
-            query.exec("UPDATE users SET member_level = '普通会员' WHERE member_level IS NULL");
-        } else {
-            qWarning() << "添加member_level字段失败:" << query.lastError().text();
-        }
-    }
-    
-    // 检查并添加points字段（积分）
-    query.prepare("SELECT COUNT(*) FROM information_schema.COLUMNS "
-                 "WHERE TABLE_SCHEMA = DATABASE() "
-                 "AND TABLE_NAME = 'users' "
-                 "AND COLUMN_NAME = 'points'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        QString addPointsSql = "ALTER TABLE users ADD COLUMN points INT DEFAULT 0 COMMENT '积分：每充值100元获得1积分' AFTER member_level";
-        if (query.exec(addPointsSql)) {
-            qDebug() << "✓ 已添加points字段到users表";
-        } else {
-            qWarning() << "添加points字段失败:" << query.lastError().text();
-        }
-    }
-    
-    // 注意：优惠券现在存储在user_coupons表中，不再使用users表的coupon_30和coupon_50字段
-    
-    // 检查并添加phone_number字段（如果表已存在但字段不存在）
-    query.prepare("SELECT COUNT(*) FROM information_schema.COLUMNS "
-                 "WHERE TABLE_SCHEMA = DATABASE() "
-                 "AND TABLE_NAME = 'users' "
-                 "AND COLUMN_NAME = 'phone_number'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        QString addPhoneSql = "ALTER TABLE users ADD COLUMN phone_number VARCHAR(20) COMMENT '电话号码' AFTER email";
-        if (query.exec(addPhoneSql)) {
-            qDebug() << "✓ 已添加phone_number字段到users表";
-        } else {
-            qWarning() << "添加phone_number字段失败:" << query.lastError().text();
-        }
-    }
-    
-    // 检查并添加address字段（如果表已存在但字段不存在）
-    query.prepare("SELECT COUNT(*) FROM information_schema.COLUMNS "
-                 "WHERE TABLE_SCHEMA = DATABASE() "
-                 "AND TABLE_NAME = 'users' "
-                 "AND COLUMN_NAME = 'address'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        QString addAddressSql = "ALTER TABLE users ADD COLUMN address VARCHAR(300) COMMENT '地址' AFTER phone_number";
-        if (query.exec(addAddressSql)) {
-            qDebug() << "✓ 已添加address字段到users表";
-        } else {
-            qWarning() << "添加address字段失败:" << query.lastError().text();
-        }
-    }
-    
-    // 检查并添加membership_level字段（如果表已存在但字段不存在）
-    query.prepare("SELECT COUNT(*) FROM information_schema.COLUMNS "
-                 "WHERE TABLE_SCHEMA = DATABASE() "
-                 "AND TABLE_NAME = 'users' "
-                 "AND COLUMN_NAME = 'membership_level'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        // 字段不存在，添加字段，类型为TINYINT，默认值为1
-        QString addLevelSql = "ALTER TABLE users ADD COLUMN membership_level TINYINT DEFAULT 1 COMMENT '会员等级：1-普通，2-银卡，3-金卡，4-白金，5-钻石'";
-        if (query.exec(addLevelSql)) {
-            qDebug() << "✓ 已添加membership_level字段到users表";
-            // 更新现有用户的membership_level值，默认为1
-            query.exec("UPDATE users SET membership_level = 1 WHERE membership_level IS NULL");
-        } else {
-            qWarning() << "添加membership_level字段失败:" << query.lastError().text();
-        }
-    } else {
-        // 字段已存在，检查是否为VARCHAR类型，如果是则转换为TINYINT
-        query.prepare("SELECT DATA_TYPE FROM information_schema.COLUMNS "
-                     "WHERE TABLE_SCHEMA = DATABASE() "
-                     "AND TABLE_NAME = 'users' "
-                     "AND COLUMN_NAME = 'membership_level'");
-        if (query.exec() && query.next()) {
-            QString dataType = query.value("DATA_TYPE").toString();
-            if (dataType.toUpper() == "VARCHAR") {
-                // 先将VARCHAR值转换为整数，然后修改字段类型
-                query.exec("UPDATE users SET membership_level = CASE "
-                          "WHEN membership_level = '普通' THEN 1 "
-                          "WHEN membership_level = '银卡' THEN 2 "
-                          "WHEN membership_level = '金卡' THEN 3 "
-                          "WHEN membership_level = '白金' THEN 4 "
-                          "WHEN membership_level = '钻石' THEN 5 "
-                          "ELSE 1 END "
-                          "WHERE membership_level IS NOT NULL");
-                
-                QString alterSql = "ALTER TABLE users MODIFY COLUMN membership_level TINYINT DEFAULT 1 COMMENT '会员等级：1-普通，2-银卡，3-金卡，4-白金，5-钻石'";
-                if (query.exec(alterSql)) {
-                    qDebug() << "✓ 已将membership_level字段类型从VARCHAR转换为TINYINT";
-                } else {
-                    qWarning() << "转换membership_level字段类型失败:" << query.lastError().text();
-                }
-            }
-        }
-    }
-    
-    // 如果存在旧的user_level字段，将其数据迁移到membership_level并删除旧字段
-    query.prepare("SELECT COUNT(*) FROM information_schema.COLUMNS "
-                 "WHERE TABLE_SCHEMA = DATABASE() "
-                 "AND TABLE_NAME = 'users' "
-                 "AND COLUMN_NAME = 'user_level'");
-    if (query.exec() && query.next() && query.value(0).toInt() > 0) {
-        // 检查membership_level是否存在
-        query.prepare("SELECT COUNT(*) FROM information_schema.COLUMNS "
-                     "WHERE TABLE_SCHEMA = DATABASE() "
-                     "AND TABLE_NAME = 'users' "
-                     "AND COLUMN_NAME = 'membership_level'");
-        if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-            // user_level存在但membership_level不存在，重命名字段并转换类型
-            query.exec("UPDATE users SET user_level = CASE "
-                      "WHEN user_level = '普通' THEN 1 "
-                      "WHEN user_level = '银卡' THEN 2 "
-                      "WHEN user_level = '金卡' THEN 3 "
-                      "WHEN user_level = '白金' THEN 4 "
-                      "WHEN user_level = '钻石' THEN 5 "
-                      "ELSE 1 END "
-                      "WHERE user_level IS NOT NULL");
-            
-            QString renameSql = "ALTER TABLE users CHANGE COLUMN user_level membership_level TINYINT DEFAULT 1 COMMENT '会员等级：1-普通，2-银卡，3-金卡，4-白金，5-钻石'";
-            if (query.exec(renameSql)) {
-                qDebug() << "✓ 已将user_level字段重命名为membership_level并转换为TINYINT";
-            } else {
-                qWarning() << "重命名user_level字段失败:" << query.lastError().text();
-            }
-        } else {
-            // 两个字段都存在，迁移数据后删除user_level
-            query.exec("UPDATE users SET membership_level = CASE "
-                      "WHEN user_level = '普通' THEN 1 "
-                      "WHEN user_level = '银卡' THEN 2 "
-                      "WHEN user_level = '金卡' THEN 3 "
-                      "WHEN user_level = '白金' THEN 4 "
-                      "WHEN user_level = '钻石' THEN 5 "
-                      "ELSE COALESCE(membership_level, 1) END "
-                      "WHERE user_level IS NOT NULL");
-            
-            query.exec("ALTER TABLE users DROP COLUMN user_level");
-            qDebug() << "✓ 已迁移user_level数据到membership_level并删除旧字段";
-        }
-    }
-    
     // 3. 商家表
     // sellers表中的字段与users表中除role字段外的字段一一对应
     QString createSellersTable = R"(
@@ -366,173 +608,34 @@ bool Database::createTables()
         ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='商家表'
     )";
     
-    if (!query.exec(createSellersTable)) {
+    if (!execDdl(query, createSellersTable)) {
         qCritical() << "创建sellers表失败:" << query.lastError().text();
         return false;
     }
     qDebug() << "✓ sellers表创建成功";
     
-    // 修改现有表结构：将contact改为email，并添加license_image_base64字段
-    // 检查是否存在contact字段，如果存在则重命名为email
-    query.prepare("SELECT COUNT(*) FROM INFORMATION_SCHEMA.COLUMNS "
-                  "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'sellers' AND COLUMN_NAME = 'contact'");
-    if (query.exec() && query.next() && query.value(0).toInt() > 0) {
-        // 如果存在contact字段，先重命名为email
-        if (!query.exec("ALTER TABLE sellers CHANGE COLUMN contact email VARCHAR(100) COMMENT '邮箱'")) {
-            qWarning() << "修改contact字段为email失败:" << query.lastError().text();
-        } else {
-            qDebug() << "✓ contact字段已重命名为email";
-        }
-    }
-    
-    // 检查是否存在license_image_base64字段，如果不存在则添加
-    query.prepare("SELECT COUNT(*) FROM INFORMATION_SCHEMA.COLUMNS "
-                  "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'sellers' AND COLUMN_NAME = 'license_image_base64'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        // 如果不存在license_image_base64字段，则添加
-        if (!query.exec("ALTER TABLE sellers ADD COLUMN license_image_base64 TEXT COMMENT '营业执照图片(Base64编码)' AFTER address")) {
-            qWarning() << "添加license_image_base64字段失败:" << query.lastError().text();
-        } else {
-            qDebug() << "✓ license_image_base64字段已添加";
-        }
-    }
+    // 卖家认证表
+    QString createSellerCertTable = R"(
+        CREATE TABLE IF NOT EXISTS seller_certifications (
+            cert_id INT AUTO_INCREMENT PRIMARY KEY COMMENT '认证ID',
+            user_id INT NOT NULL COMMENT '用户ID',
+            username VARCHAR(50) NOT NULL COMMENT '用户名',
+            password VARCHAR(100) NOT NULL COMMENT '密码',
+            email VARCHAR(100) COMMENT '邮箱',
+            license_image TEXT COMMENT '营业执照图片(Base64)',
+            status VARCHAR(20) DEFAULT '审核中' COMMENT '认证状态：审核中/已认证/已拒绝',
+            apply_time DATETIME DEFAULT CURRENT_TIMESTAMP COMMENT '申请时间',
+            approve_time DATETIME COMMENT '审核时间',
+            UNIQUE KEY unique_user_id (user_id),
+            INDEX idx_status (status)
+        ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='卖家认证表'
+    )";
     
-    // 检查是否存在phone_number字段，如果不存在则添加
-    query.prepare("SELECT COUNT(*) FROM INFORMATION_SCHEMA.COLUMNS "
-                  "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'sellers' AND COLUMN_NAME = 'phone_number'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        if (!query.exec("ALTER TABLE sellers ADD COLUMN phone_number VARCHAR(20) COMMENT '电话号码' AFTER email")) {
-            qWarning() << "添加phone_number字段失败:" << query.lastError().text();
-        } else {
-            qDebug() << "✓ phone_number字段已添加到sellers表";
-        }
-    }
-    
-    // 检查是否存在address字段，如果不存在则添加
-    query.prepare("SELECT COUNT(*) FROM INFORMATION_SCHEMA.COLUMNS "
-                  "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'sellers' AND COLUMN_NAME = 'address'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        if (!query.exec("ALTER TABLE sellers ADD COLUMN address VARCHAR(300) COMMENT '地址' AFTER phone_number")) {
-            qWarning() << "添加address字段失败:" << query.lastError().text();
-        } else {
-            qDebug() << "✓ address字段已添加到sellers表";
-        }
-    }
-    
-    // 检查是否存在balance字段，如果不存在则添加
-    query.prepare("SELECT COUNT(*) FROM INFORMATION_SCHEMA.COLUMNS "
-                  "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'sellers' AND COLUMN_NAME = 'balance'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        if (!query.exec("ALTER TABLE sellers ADD COLUMN balance DECIMAL(10, 2) DEFAULT 0.00 COMMENT '账户余额' AFTER address")) {
-            qWarning() << "添加balance字段失败:" << query.lastError().text();
-        } else {
-            qDebug() << "✓ balance字段已添加到sellers表";
-        }
-    }
-    
-    // 检查并添加total_recharge字段（累计充值总额）
-    query.prepare("SELECT COUNT(*) FROM information_schema.COLUMNS "
-                 "WHERE TABLE_SCHEMA = DATABASE() "
-                 "AND TABLE_NAME = 'sellers' "
-                 "AND COLUMN_NAME = 'total_recharge'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        QString addTotalRechargeSql = "ALTER TABLE sellers ADD COLUMN total_recharge DECIMAL(10, 2) DEFAULT 0.00 COMMENT '累计充值总额' AFTER balance";
-        if (query.exec(addTotalRechargeSql)) {
-            qDebug() << "✓ 已添加total_recharge字段到sellers表";
-        } else {
-            qWarning() << "添加total_recharge字段失败:" << query.lastError().text();
-        }
-    }
-    
-    // 检查并添加member_level字段（会员等级）
-    query.prepare("SELECT COUNT(*) FROM information_schema.COLUMNS "
-                 "WHERE TABLE_SCHEMA = DATABASE() "
-                 "AND TABLE_NAME = 'sellers' "
-                 "AND COLUMN_NAME = 'member_level'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        QString addMemberLevelSql = "ALTER TABLE sellers ADD COLUMN member_level VARCHAR(20) DEFAULT '普通会员' COMMENT '会员等级：普通会员、银卡会员、金卡会员、铂金会员、钻石会员、黑钻会员' AFTER total_recharge";
-        if (query.exec(addMemberLevelSql)) {
-            qDebug() << "✓ 已添加member_level字段到sellers表";
-            query.exec("UPDATE sellers SET member_level = '普通会员' WHERE member_level IS NULL");
-        } else {
-            qWarning() << "添加member_level字段失败:" << query.lastError().text();
-        }
-    }
-    
-    // 检查并添加points字段（积分）
-    query.prepare("SELECT COUNT(*) FROM information_schema.COLUMNS "
-                 "WHERE TABLE_SCHEMA = DATABASE() "
-                 "AND TABLE_NAME = 'sellers' "
-                 "AND COLUMN_NAME = 'points'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        QString addPointsSql = "ALTER TABLE sellers ADD COLUMN points INT DEFAULT 0 COMMENT '积分：每充值100元获得1积分' AFTER member_level";
-        if (query.exec(addPointsSql)) {
-            qDebug() << "✓ 已添加points字段到sellers表";
-        } else {
-            qWarning() << "添加points字段失败:" << query.lastError().text();
-        }
-    }
-    
-    // 卖家认证表
-    QString createSellerCertTable = R"(
-        CREATE TABLE IF NOT EXISTS seller_certifications (
-            cert_id INT AUTO_INCREMENT PRIMARY KEY COMMENT '认证ID',
-            user_id INT NOT NULL COMMENT '用户ID',
-            username VARCHAR(50) NOT NULL COMMENT '用户名',
-            password VARCHAR(100) NOT NULL COMMENT '密码',
-            email VARCHAR(100) COMMENT '邮箱',
-            license_image TEXT COMMENT '营业执照图片(Base64)',
-            status VARCHAR(20) DEFAULT '审核中' COMMENT '认证状态：审核中/已认证/已拒绝',
-            apply_time DATETIME DEFAULT CURRENT_TIMESTAMP COMMENT '申请时间',
-            approve_time DATETIME COMMENT '审核时间',
-            UNIQUE KEY unique_user_id (user_id),
-            INDEX idx_status (status)
-        ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='卖家认证表'
-    )";
-    
-    if (!query.exec(createSellerCertTable)) {
-        qCritical() << "创建seller_certifications表失败:" << query.lastError().text();
-        return false;
-    }
-    qDebug() << "✓ seller_certifications表创建成功";
-    
-    // 插入默认商家账号
-    // 由于卖家都是由买家认证而成的，所以初始化sellers表的时候，同时也要将同样的用户信息加入users表
-    query.prepare("SELECT COUNT(*) FROM sellers WHERE seller_name = 'seller'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        // 先检查users表中是否已存在该用户
-        query.prepare("SELECT COUNT(*) FROM users WHERE username = 'seller'");
-        bool userExists = false;
-        if (query.exec() && query.next()) {
-            userExists = query.value(0).toInt() > 0;
-        }
-        
-        // 如果users表中不存在，先添加到users表
-        if (!userExists) {
-            query.prepare("INSERT INTO users (username, password, email, phone_number, address, register_date, role) "
-                         "VALUES ('seller', '123456', 'seller@example.com', NULL, NULL, CURDATE(), 2)");
-            if (query.exec()) {
-                qDebug() << "✓ 默认商家账号已添加到users表 (seller/123456, role=2)";
-            } else {
-                qWarning() << "添加默认商家账号到users表失败:" << query.lastError().text();
-            }
-        } else {
-            // 如果已存在，更新role为2（卖家）
-            query.prepare("UPDATE users SET role = 2 WHERE username = 'seller'");
-            if (query.exec()) {
-                qDebug() << "✓ 已更新默认商家账号的role为2";
-            }
-        }
-        
-        // 然后添加到sellers表，包含所有字段（与users表除role外一一对应）
-        query.prepare("INSERT INTO sellers (seller_name, password, email, phone_number, address, balance, register_date, status) "
-                     "VALUES ('seller', '123456', 'seller@example.com', NULL, NULL, 0.00, CURDATE(), '正常')");
-        if (query.exec()) {
-            qDebug() << "✓ 默认商家账号创建成功 (seller/123456)";
-        } else {
-            qWarning() << "添加默认商家账号到sellers表失败:" << query.lastError().text();
-        }
+    if (!execDdl(query, createSellerCertTable)) {
+        qCritical() << "创建seller_certifications表失败:" << query.lastError().text();
+        return false;
     }
+    qDebug() << "✓ seller_certifications表创建成功";
     
     // 4. 图书表
     QString createBooksTable = R"(
@@ -554,90 +657,12 @@ bool Database::createTables()
         ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='图书表'
     )";
     
-    if (!query.exec(createBooksTable)) {
+    if (!execDdl(query, createBooksTable)) {
         qCritical() << "创建books表失败:" << query.lastError().text();
         return false;
     }
     qDebug() << "✓ books表创建成功";
     
-    // 修改现有表结构
-    // 检查是否存在category字段，如果存在则重命名为category1
-    query.prepare("SELECT COUNT(*) FROM INFORMATION_SCHEMA.COLUMNS "
-                  "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'books' AND COLUMN_NAME = 'category'");
-    if (query.exec() && query.next() && query.value(0).toInt() > 0) {
-        if (!query.exec("ALTER TABLE books CHANGE COLUMN category category1 VARCHAR(50) COMMENT '一级分类'")) {
-            qWarning() << "修改category字段为category1失败:" << query.lastError().text();
-        } else {
-            qDebug() << "✓ category字段已重命名为category1";
-        }
-    }
-    
-    // 检查是否存在category2字段，如果不存在则添加
-    query.prepare("SELECT COUNT(*) FROM INFORMATION_SCHEMA.COLUMNS "
-                  "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'books' AND COLUMN_NAME = 'category2'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        if (!query.exec("ALTER TABLE books ADD COLUMN category2 VARCHAR(50) COMMENT '二级分类' AFTER category1")) {
-            qWarning() << "添加category2字段失败:" << query.lastError().text();
-        } else {
-            qDebug() << "✓ category2字段已添加";
-        }
-    }
-    
-    // 检查是否存在merchant_id字段，如果不存在则添加
-    query.prepare("SELECT COUNT(*) FROM INFORMATION_SCHEMA.COLUMNS "
-                  "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'books' AND COLUMN_NAME = 'merchant_id'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        if (!query.exec("ALTER TABLE books ADD COLUMN merchant_id INT COMMENT '商家ID' AFTER category2")) {
-            qWarning() << "添加merchant_id字段失败:" << query.lastError().text();
-        } else {
-            qDebug() << "✓ merchant_id字段已添加";
-        }
-    }
-    
-    // 检查是否存在description字段，如果不存在则添加
-    query.prepare("SELECT COUNT(*) FROM INFORMATION_SCHEMA.COLUMNS "
-                  "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'books' AND COLUMN_NAME = 'description'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        if (!query.exec("ALTER TABLE books ADD COLUMN description TEXT COMMENT '书籍描述' AFTER cover_image")) {
-            qWarning() << "添加description字段失败:" << query.lastError().text();
-        } else {
-            qDebug() << "✓ description字段已添加";
-        }
-    }
-    
-    // 检查是否存在warning_stock字段，如果存在则删除
-    query.prepare("SELECT COUNT(*) FROM INFORMATION_SCHEMA.COLUMNS "
-                  "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'books' AND COLUMN_NAME = 'warning_stock'");
-    if (query.exec() && query.next() && query.value(0).toInt() > 0) {
-        if (!query.exec("ALTER TABLE books DROP COLUMN warning_stock")) {
-            qWarning() << "删除warning_stock字段失败:" << query.lastError().text();
-        } else {
-            qDebug() << "✓ warning_stock字段已删除";
-        }
-    }
-    
-    // 检查是否存在cost字段，如果存在则删除
-    query.prepare("SELECT COUNT(*) FROM INFORMATION_SCHEMA.COLUMNS "
-                  "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'books' AND COLUMN_NAME = 'cost'");
-    if (query.exec() && query.next() && query.value(0).toInt() > 0) {
-        if (!query.exec("ALTER TABLE books DROP COLUMN cost")) {
-            qWarning() << "删除cost字段失败:" << query.lastError().text();
-        } else {
-            qDebug() << "✓ cost字段已删除";
-        }
-    }
-    
-    // 检查是否存在cover_image字段，如果不存在则添加
-    query.prepare("SELECT COUNT(*) FROM INFORMATION_SCHEMA.COLUMNS "
-                  "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'books' AND COLUMN_NAME = 'cover_image'");
-    if (query.exec() && query.next() && query.value(0).toInt() == 0) {
-        if (!query.exec("ALTER TABLE books ADD COLUMN cover_image TEXT COMMENT '封面图片(Base64编码)' AFTER status")) {
-            qWarning() << "添加cover_image字段失败:" << query.lastError().text();
-        } else {
-            qDebug() << "✓ cover_image字段已添加";
-        }
-    }
-    
     // 5. 订单表
     QString createOrdersTable = R"(
         CREATE TABLE IF NOT EXISTS orders (
@@ -666,7 +691,7 @@ bool Database::createTables()
         ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='订单表'
     )";
     
-    if (!query.exec(createOrdersTable)) {
+    if (!execDdl(query, createOrdersTable)) {
         qCritical() << "创建orders表失败:" << query.lastError().text();
         return false;
     }
@@ -685,7 +710,7 @@ bool Database::createTables()
         ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='购物车表'
     )";
     
-    if (!query.exec(createCartTable)) {
+    if (!execDdl(query, createCartTable)) {
         qCritical() << "创建cart表失败:" << query.lastError().text();
         return false;
     }
@@ -704,7 +729,7 @@ bool Database::createTables()
         ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='收藏表'
     )";
     
-    if (!query.exec(createFavoritesTable)) {
+    if (!execDdl(query, createFavoritesTable)) {
         qCritical() << "创建favorites表失败:" << query.lastError().text();
         return false;
     }
@@ -724,7 +749,7 @@ bool Database::createTables()
         ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='会员表'
     )";
     
-    if (!query.exec(createMembersTable)) {
+    if (!execDdl(query, createMembersTable)) {
         qCritical() << "创建members表失败:" << query.lastError().text();
         return false;
     }
@@ -747,7 +772,7 @@ bool Database::createTables()
         ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='卖家申诉表'
     )";
     
-    if (!query.exec(createSellerAppealsTable)) {
+    if (!execDdl(query, createSellerAppealsTable)) {
         qCritical() << "创建seller_appeals表失败:" << query.lastError().text();
         return false;
     }
@@ -770,7 +795,7 @@ bool Database::createTables()
         ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='聊天消息表'
     )";
     
-    if (!query.exec(createChatMessagesTable)) {
+    if (!execDdl(query, createChatMessagesTable)) {
         qCritical() << "创建chat_messages表失败:" << query.lastError().text();
         return false;
     }
@@ -792,7 +817,7 @@ bool Database::createTables()
         ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='商品评论表'
     )";
     
-    if (!query.exec(createReviewsTable)) {
+    if (!execDdl(query, createReviewsTable)) {
         qCritical() << "创建reviews表失败:" << query.lastError().text();
         return false;
     }
@@ -815,189 +840,891 @@ bool Database::createTables()
         ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='用户优惠券表'
     )";
     
-    if (!query.exec(createUserCouponsTable)) {
+    if (!execDdl(query, createUserCouponsTable)) {
         qCritical() << "创建user_coupons表失败:" << query.lastError().text();
         return false;
     }
     qDebug() << "✓ user_coupons表创建成功";
     
-    qDebug() << "========================================";
-    qDebug() << "所有数据库表创建成功！";
-    qDebug() << "========================================";
-    
-    // 注意：示例图书数据初始化已移至窗口显示后异步执行，避免阻塞UI
-    
     return true;
 }
 
-// ==========================================
-// 请求日志功能
-// ==========================================
+// 迁移2：users表补充旧版本缺失的字段
+// 任一语句失败都返回false，不记录版本号，下次启动重新执行（已加的字段会跳过，回填语句可重复执行）
+bool Database::migrateUpgradeUsersTable(QSqlQuery& query)
+{
+    QHash<QString, QString> columns = tableColumns(query, "users");
+    
+    if (!addColumnIfMissing(query, columns, "users", "license_image_base64", "TEXT COMMENT '营业执照图片(Base64编码)'")
+        || !addColumnIfMissing(query, columns, "users", "role", "TINYINT DEFAULT 1 COMMENT '用户身份：1-买家，2-卖家，0-买家申请成为卖家且在审核中'")
+        // 更新现有用户的role值，默认为1（买家）
+        || !execMigrationStatement(query, "UPDATE users SET role = 1 WHERE role IS NULL")
+        || !addColumnIfMissing(query, columns, "users", "total_recharge", "DECIMAL(10, 2) DEFAULT 0.00 COMMENT '累计充值总额' AFTER balance")
+        || !addColumnIfMissing(query, columns, "users", "member_level", "VARCHAR(20) DEFAULT '普通会员' COMMENT '会员等级：普通会员、银卡会员、金卡会员、铂金会员、钻石会员、黑钻会员' AFTER total_recharge")
+        || !execMigrationStatement(query, "UPDATE users SET member_level = '普通会员' WHERE member_level IS NULL")
+        || !addColumnIfMissing(query, columns, "users", "points", "INT DEFAULT 0 COMMENT '积分：每充值100元获得1积分' AFTER member_level")
+        // 注意：优惠券现在存储在user_coupons表中，不再使用users表的coupon_30和coupon_50字段
+        || !addColumnIfMissing(query, columns, "users", "phone_number", "VARCHAR(20) COMMENT '电话号码' AFTER email")
+        || !addColumnIfMissing(query, columns, "users", "address", "VARCHAR(300) COMMENT '地址' AFTER phone_number")) {
+        return false;
+    }
+    
+    const QString levelCase = "CASE "
+                              "WHEN %1 = '普通' THEN 1 "
+                              "WHEN %1 = '银卡' THEN 2 "
+                              "WHEN %1 = '金卡' THEN 3 "
+                              "WHEN %1 = '白金' THEN 4 "
+                              "WHEN %1 = '钻石' THEN 5 "
+                              "ELSE %2 END";
+    const QString levelDefinition = "TINYINT DEFAULT 1 COMMENT '会员等级：1-普通，2-银卡，3-金卡，4-白金，5-钻石'";
+    
+    if (columns.contains("user_level")) {
+        // 存在旧的user_level字段，将其数据迁移到membership_level并删除旧字段
+        if (!columns.contains("membership_level")) {
+            // user_level存在但membership_level不存在，重命名字段并转换类型
+            if (!execMigrationStatement(query, "UPDATE users SET user_level = " + levelCase.arg("user_level", "1") +
+                                               " WHERE user_level IS NOT NULL")
+                || !execMigrationStatement(query, "ALTER TABLE users CHANGE COLUMN user_level membership_level " + levelDefinition)) {
+                return false;
+            }
+            qDebug() << "✓ 已将user_level字段重命名为membership_level并转换为TINYINT";
+        } else {
+            // 两个字段都存在，迁移数据后删除user_level
+            if (!execMigrationStatement(query, "UPDATE users SET membership_level = " + levelCase.arg("user_level", "COALESCE(membership_level, 1)") +
+                                               " WHERE user_level IS NOT NULL")
+                || !execMigrationStatement(query, "ALTER TABLE users DROP COLUMN user_level")) {
+                return false;
+            }
+            qDebug() << "✓ 已迁移user_level数据到membership_level并删除旧字段";
+        }
+    } else if (!columns.contains("membership_level")) {
+        if (!addColumnIfMissing(query, columns, "users", "membership_level", levelDefinition)
+            || !execMigrationStatement(query, "UPDATE users SET membership_level = 1 WHERE membership_level IS NULL")) {
+            return false;
+        }
+    } else if (columns.value("membership_level") == "VARCHAR") {
+        // 字段为VARCHAR类型，先将值转换为整数，然后修改字段类型
+        if (!execMigrationStatement(query, "UPDATE users SET membership_level = " + levelCase.arg("membership_level", "1") +
+                                           " WHERE membership_level IS NOT NULL")
+            || !execMigrationStatement(query, "ALTER TABLE users MODIFY COLUMN membership_level " + levelDefinition)) {
+            return false;
+        }
+        qDebug() << "✓ 已将membership_level字段类型从VARCHAR转换为TINYINT";
+    }
+    
+    return true;
+}
 
-bool Database::logRequest(const QString& clientIp, quint16 clientPort, 
-                         const QString& action, const QJsonObject& requestData,
-                         const QJsonObject& responseData, bool success, 
-                         const QString& category)
+// 迁移3：sellers表补充旧版本缺失的字段
+// sellers表中的字段与users表中除role字段外的字段一一对应
+bool Database::migrateUpgradeSellersTable(QSqlQuery& query)
 {
-    QMutexLocker locker(&m_mutex);
+    QHash<QString, QString> columns = tableColumns(query, "sellers");
     
-    if (!isConnected()) {
-        return false;
+    // 存在旧的contact字段则重命名为email
+    if (columns.contains("contact")) {
+        if (!execMigrationStatement(query, "ALTER TABLE sellers CHANGE COLUMN contact email VARCHAR(100) COMMENT '邮箱'")) {
+            return false;
+        }
+        qDebug() << "✓ contact字段已重命名为email";
+        columns.insert("email", "VARCHAR");
     }
     
-    QSqlQuery query(m_db);
-    query.prepare("INSERT INTO request_logs (client_ip, client_port, action, request_data, "
-                 "response_data, success, category) VALUES (?, ?, ?, ?, ?, ?, ?)");
+    // AFTER引用的字段必须已存在：先补phone_number、address，再补license_image_base64
+    return addColumnIfMissing(query, columns, "sellers", "phone_number", "VARCHAR(20) COMMENT '电话号码' AFTER email")
+        && addColumnIfMissing(query, columns, "sellers", "address", "VARCHAR(300) COMMENT '地址' AFTER phone_number")
+        && addColumnIfMissing(query, columns, "sellers", "license_image_base64", "TEXT COMMENT '营业执照图片(Base64编码)' AFTER address")
+        && addColumnIfMissing(query, columns, "sellers", "balance", "DECIMAL(10, 2) DEFAULT 0.00 COMMENT '账户余额' AFTER address")
+        && addColumnIfMissing(query, columns, "sellers", "total_recharge", "DECIMAL(10, 2) DEFAULT 0.00 COMMENT '累计充值总额' AFTER balance")
+        && addColumnIfMissing(query, columns, "sellers", "member_level", "VARCHAR(20) DEFAULT '普通会员' COMMENT '会员等级：普通会员、银卡会员、金卡会员、铂金会员、钻石会员、黑钻会员' AFTER total_recharge")
+        && execMigrationStatement(query, "UPDATE sellers SET member_level = '普通会员' WHERE member_level IS NULL")
+        && addColumnIfMissing(query, columns, "sellers", "points", "INT DEFAULT 0 COMMENT '积分：每充值100元获得1积分' AFTER member_level");
+}
+
+// 迁移4：books表补充/清理字段
+bool Database::migrateUpgradeBooksTable(QSqlQuery& query)
+{
+    QHash<QString, QString> columns = tableColumns(query, "books");
     
-    query.addBindValue(clientIp);
-    query.addBindValue(clientPort);
-    query.addBindValue(action);
-    query.addBindValue(QString(QJsonDocument(requestData).toJson(QJsonDocument::Compact)));
-    query.addBindValue(QString(QJsonDocument(responseData).toJson(QJsonDocument::Compact)));
-    query.addBindValue(success);
-    query.addBindValue(category);
+    // 存在旧的category字段则重命名为category1
+    if (columns.contains("category")) {
+        if (!execMigrationStatement(query, "ALTER TABLE books CHANGE COLUMN category category1 VARCHAR(50) COMMENT '一级分类'")) {
+            return false;
+        }
+        qDebug() << "✓ category字段已重命名为category1";
+        columns.insert("category1", "VARCHAR");
+    }
     
-    if (!query.exec()) {
-        qWarning() << "记录请求日志失败:" << query.lastError().text();
+    if (!addColumnIfMissing(query, columns, "books", "category2", "VARCHAR(50) COMMENT '二级分类' AFTER category1")
+        || !addColumnIfMissing(query, columns, "books", "merchant_id", "INT COMMENT '商家ID' AFTER category2")
+        || !addColumnIfMissing(query, columns, "books", "cover_image", "TEXT COMMENT '封面图片(Base64编码)' AFTER status")
+        || !addColumnIfMissing(query, columns, "books", "description", "TEXT COMMENT '书籍描述' AFTER cover_image")) {
         return false;
     }
     
+    // 删除已废弃的warning_stock、cost字段
+    const QStringList obsoleteColumns = {"warning_stock", "cost"};
+    for (const QString& column : obsoleteColumns) {
+        if (!columns.contains(column)) {
+            continue;
+        }
+        if (!execMigrationStatement(query, "ALTER TABLE books DROP COLUMN " + column)) {
+            return false;
+        }
+        qDebug() << "✓" << column << "字段已删除";
+    }
+    
     return true;
 }
 
-QJsonArray Database::getRequestLogs(int limit, const QString& category)
+// 迁移5：插入默认商家账号
+// 由于卖家都是由买家认证而成的，所以初始化sellers表的时候，同时也要将同样的用户信息加入users表
+bool Database::migrateSeedDefaultSeller(QSqlQuery& query)
 {
-    QMutexLocker locker(&m_mutex);
-    QJsonArray logs;
-    
-    if (!isConnected()) {
-        return logs;
+    query.prepare("SELECT COUNT(*) FROM sellers WHERE seller_name = 'seller'");
+    if (!query.exec() || !query.next()) {
+        qWarning() << "查询默认商家账号失败:" << query.lastError().text();
+        return false;
+    }
+    if (query.value(0).toInt() > 0) {
+        return true;
     }
     
-    QSqlQuery query(m_db);
-    QString sql = "SELECT * FROM request_logs ";
-    if (!category.isEmpty()) {
-        sql += "WHERE category = '" + category + "' ";
+    // 先检查users表中是否已存在该用户
+    query.prepare("SELECT COUNT(*) FROM users WHERE username = 'seller'");
+    if (!query.exec() || !query.next()) {
+        qWarning() << "查询默认商家用户失败:" << query.lastError().text();
+        return false;
     }
-    sql += "ORDER BY timestamp DESC LIMIT " + QString::number(limit);
+    const bool userExists = query.value(0).toInt() > 0;
     
-    if (!query.exec(sql)) {
-        qWarning() << "获取请求日志失败:" << query.lastError().text();
-        return logs;
+    // 如果users表中不存在，先添加到users表；如果已存在，更新role为2（卖家）
+    if (!userExists) {
+        query.prepare(dialect("INSERT INTO users (username, password, email, phone_number, address, register_date, role) "
+                              "VALUES ('seller', '123456', 'seller@example.com', NULL, NULL, CURDATE(), 2)"));
+    } else {
+        query.prepare("UPDATE users SET role = 2 WHERE username = 'seller'");
+    }
+    if (!query.exec()) {
+        qWarning() << "写入默认商家账号到users表失败:" << query.lastError().text();
+        return false;
     }
+    qDebug() << (userExists ? "✓ 已更新默认商家账号的role为2" : "✓ 默认商家账号已添加到users表 (seller/123456, role=2)");
     
-    while (query.next()) {
-        QJsonObject log;
-        log["id"] = query.value("id").toInt();
-        log["timestamp"] = query.value("timestamp").toString();
-        log["clientIp"] = query.value("client_ip").toString();
-        log["clientPort"] = query.value("client_port").toInt();
-        log["action"] = query.value("action").toString();
-        log["success"] = query.value("success").toBool();
-        log["category"] = query.value("category").toString();
-        logs.append(log);
+    // 然后添加到sellers表，包含所有字段（与users表除role外一一对应）
+    query.prepare(dialect("INSERT INTO sellers (seller_name, password, email, phone_number, address, balance, register_date, status) "
+                          "VALUES ('seller', '123456', 'seller@example.com', NULL, NULL, 0.00, CURDATE(), '正常')"));
+    if (!query.exec()) {
+        qWarning() << "添加默认商家账号到sellers表失败:" << query.lastError().text();
+        return false;
     }
+    qDebug() << "✓ 默认商家账号创建成功 (seller/123456)";
     
-    return logs;
+    return true;
 }
 
-// ==========================================
-// 用户相关
-// ==========================================
+// 图书评分/收藏计数：按reviews和favorites重新统计（后接WHERE限定范围）
+static const char* const kRecountBookStatsSql =
+    "UPDATE books SET "
+    "rating_sum = (SELECT COALESCE(SUM(rating), 0) FROM reviews WHERE reviews.book_id = books.isbn), "
+    "rating_count = (SELECT COUNT(*) FROM reviews WHERE reviews.book_id = books.isbn), "
+    "favorite_count = (SELECT COUNT(*) FROM favorites WHERE favorites.book_id = books.isbn)";
 
-bool Database::registerUser(const QString& username, const QString& password, const QString& email)
+// 迁移6：books表增加评分总分、评论数、收藏数字段，并按现有数据统计一次
+bool Database::migrateAddBookStatsColumns(QSqlQuery& query)
 {
-    QMutexLocker locker(&m_mutex);
-    
-    // #region agent log
-    writeDebugLog("data.cpp:330", "数据库注册函数入口", QJsonObject{{"username", username}, {"email", email}}, "G");
-    // #endregion
-    
-    if (!isConnected()) {
-        // #region agent log
-        writeDebugLog("data.cpp:335", "数据库未连接", QJsonObject{}, "G");
-        // #endregion
+    QHash<QString, QString> columns = tableColumns(query, "books");
+    if (!addColumnIfMissing(query, columns, "books", "rating_sum", "INT DEFAULT 0 COMMENT '评分总分（reviews.rating之和）'")
+        || !addColumnIfMissing(query, columns, "books", "rating_count", "INT DEFAULT 0 COMMENT '评论数'")
+        || !addColumnIfMissing(query, columns, "books", "favorite_count", "INT DEFAULT 0 COMMENT '收藏数'")) {
         return false;
     }
     
-    QSqlQuery query(m_db);
-    query.prepare("INSERT INTO users (username, password, email, phone_number, address, register_date, license_image_base64, role) "
-                 "VALUES (?, ?, ?, NULL, NULL, CURDATE(), NULL, 1)");
-    query.addBindValue(username);
-    query.addBindValue(password);
-    query.addBindValue(email.isEmpty() ? QString("%1@example.com").arg(username) : email);
-    
-    // #region agent log
-    writeDebugLog("data.cpp:345", "执行数据库插入前", QJsonObject{{"username", username}}, "G");
-    // #endregion
-    
-    if (!query.exec()) {
-        // #region agent log
-        writeDebugLog("data.cpp:347", "数据库插入失败", QJsonObject{{"username", username}, {"error", query.lastError().text()}}, "G");
-        // #endregion
-        qWarning() << "注册用户失败:" << query.lastError().text();
+    if (!query.exec(kRecountBookStatsSql)) {
+        qWarning() << "统计图书评分/收藏数失败:" << query.lastError().text();
         return false;
     }
-    
-    // #region agent log
-    writeDebugLog("data.cpp:351", "数据库插入成功", QJsonObject{{"username", username}}, "G");
-    // #endregion
-    qDebug() << "用户注册成功:" << username;
+    qDebug() << "✓ 图书评分/收藏计数已初始化";
     return true;
 }
 
-QJsonObject Database::loginUser(const QString& username, const QString& password)
+// 聊天会话的一方：发给客服的消息（receiver_id为NULL）对方记为管理员/客服
+static const int kAdminChatId = 999999;
+
+struct ChatParticipant {
+    int id;
+    QString type;
+    bool operator<(const ChatParticipant& other) const
+    {
+        return id != other.id ? id < other.id : type < other.type;
+    }
+};
+
+struct ConversationKey {
+    ChatParticipant owner;
+    ChatParticipant peer;
+    bool operator<(const ConversationKey& other) const
+    {
+        if (owner < other.owner || other.owner < owner) {
+            return owner < other.owner;
+        }
+        return peer < other.peer;
+    }
+};
+
+static ChatParticipant chatReceiver(const QVariant& receiverId, const QVariant& receiverType)
 {
-    QMutexLocker locker(&m_mutex);
-    QJsonObject result;
-    
-    // #region agent log
-    writeDebugLog("data.cpp:354", "数据库登录函数入口", QJsonObject{{"username", username}}, "H");
-    // #endregion
-    
-    if (!isConnected()) {
-        // #region agent log
-        writeDebugLog("data.cpp:360", "数据库未连接", QJsonObject{}, "H");
-        // #endregion
-        result["success"] = false;
-        result["message"] = "数据库未连接";
-        return result;
+    if (receiverId.isNull() || receiverId.toInt() <= 0 || receiverType.toString().isEmpty()) {
+        return {kAdminChatId, "admin"};
     }
-    
-    QSqlQuery query(m_db);
-    query.prepare("SELECT * FROM users WHERE username = ? AND password = ?");
-    query.addBindValue(username);
-    query.addBindValue(password);
-    
-    // #region agent log
-    writeDebugLog("data.cpp:369", "执行数据库查询前", QJsonObject{{"username", username}}, "H");
-    // #endregion
-    
-    if (!query.exec()) {
-        // #region agent log
-        writeDebugLog("data.cpp:371", "数据库查询失败", QJsonObject{{"username", username}, {"error", query.lastError().text()}}, "H");
-        // #endregion
-        qWarning() << "查询用户失败:" << query.lastError().text();
-        result["success"] = false;
-        result["message"] = "查询失败";
-        return result;
+    return {receiverId.toInt(), receiverType.toString()};
+}
+
+// 按商家拆分一笔订单的实付金额：各商家按订单项小计占比分摊（优惠券、会员折扣随之分摊），
+// 订单项没有merchantId时计入orders.merchant_id
+static QHash<int, double> splitOrderAmountByMerchant(const QString& itemsJson, int orderMerchantId, double totalAmount)
+{
+    QHash<int, double> subtotals;
+    double itemsTotal = 0.0;
+    const QJsonArray items = QJsonDocument::fromJson(itemsJson.toUtf8()).array();
+    for (const QJsonValue &itemValue : items) {
+        QJsonObject item = itemValue.toObject();
+        int merchantId = item.value("merchantId").toInt(orderMerchantId);
+        if (merchantId <= 0) {
+            continue;
+        }
+        double subtotal = item.value("price").toDouble() * item.value("quantity").toInt();
+        subtotals[merchantId] += subtotal;
+        itemsTotal += subtotal;
     }
-    
-    if (query.next()) {
-        // #region agent log
-        writeDebugLog("data.cpp:377", "数据库查询成功，找到用户", QJsonObject{{"username", username}, {"userId", query.value("user_id").toInt()}}, "H");
-        // #endregion
-        
-        // 允许被封禁的用户登录，但不限制其登录功能
-        // 封禁状态将在购买图书等功能中检查
-        
-        result["success"] = true;
-        result["message"] = "登录成功";
-        result["userId"] = query.value("user_id").toInt();
-        result["username"] = query.value("username").toString();
+
+    if (subtotals.isEmpty()) {
+        if (orderMerchantId > 0) {
+            subtotals[orderMerchantId] = totalAmount;
+        }
+        return subtotals;
+    }
+    if (itemsTotal > 0 && totalAmount >= 0) {
+        for (auto it = subtotals.begin(); it != subtotals.end(); ++it) {
+            it.value() = it.value() * totalAmount / itemsTotal;
+        }
+    }
+    return subtotals;
+}
+
+// 迁移7：商家-客户索引表，按已支付订单统计一次；之后在订单支付时增量维护
+bool Database::migrateCreateSellerCustomers(QSqlQuery& query)
+{
+    QString createSellerCustomersTable = R"(
+        CREATE TABLE IF NOT EXISTS seller_customers (
+            merchant_id INT NOT NULL COMMENT '商家ID',
+            user_id INT NOT NULL COMMENT '买家用户ID',
+            first_order DATETIME COMMENT '首次支付时间',
+            last_order DATETIME COMMENT '最近支付时间',
+            total_spent DECIMAL(12, 2) DEFAULT 0 COMMENT '在该商家的累计消费（按订单项分摊实付金额）',
+            order_count INT DEFAULT 0 COMMENT '在该商家的已支付订单数',
+            PRIMARY KEY (merchant_id, user_id),
+            INDEX idx_merchant_last_order (merchant_id, last_order),
+            INDEX idx_merchant_spent (merchant_id, total_spent)
+        ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='商家-客户索引'
+    )";
+    if (!execDdl(query, createSellerCustomersTable)) {
+        qCritical() << "创建seller_customers表失败:" << query.lastError().text();
+        return false;
+    }
+
+    struct Customer {
+        QDateTime firstOrder;
+        QDateTime lastOrder;
+        double totalSpent = 0.0;
+        int orderCount = 0;
+    };
+    QHash<QPair<int, int>, Customer> customers;
+
+    if (!query.exec("SELECT user_id, merchant_id, items, total_amount, COALESCE(pay_time, order_date) AS paid_at "
+                    "FROM orders WHERE user_id IS NOT NULL AND status IN ('已支付', '已发货', '已完成')")) {
+        qWarning() << "统计商家客户失败:" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        const int userId = query.value("user_id").toInt();
+        const QDateTime paidAt = query.value("paid_at").toDateTime();
+        const QHash<int, double> amounts = splitOrderAmountByMerchant(
+            query.value("items").toString(), query.value("merchant_id").toInt(), query.value("total_amount").toDouble());
+        for (auto it = amounts.constBegin(); it != amounts.constEnd(); ++it) {
+            Customer &customer = customers[qMakePair(it.key(), userId)];
+            if (!customer.firstOrder.isValid() || paidAt < customer.firstOrder) {
+                customer.firstOrder = paidAt;
+            }
+            if (!customer.lastOrder.isValid() || paidAt > customer.lastOrder) {
+                customer.lastOrder = paidAt;
+            }
+            customer.totalSpent += it.value();
+            ++customer.orderCount;
+        }
+    }
+
+    // 迁移可能重复执行：先清空再写入
+    if (!query.exec("DELETE FROM seller_customers")) {
+        qWarning() << "清空seller_customers失败:" << query.lastError().text();
+        return false;
+    }
+    const bool sqlite = isSqliteQuery(query);
+    query.prepare("INSERT INTO seller_customers (merchant_id, user_id, first_order, last_order, total_spent, order_count) "
+                  "VALUES (?, ?, ?, ?, ?, ?)");
+    for (auto it = customers.constBegin(); it != customers.constEnd(); ++it) {
+        const Customer &customer = it.value();
+        query.addBindValue(it.key().first);
+        query.addBindValue(it.key().second);
+        // SQLite中时间按ISO文本存储，与NOW()的转换结果格式一致
+        query.addBindValue(sqlite ? QVariant(customer.firstOrder.toString(Qt::ISODate)) : QVariant(customer.firstOrder));
+        query.addBindValue(sqlite ? QVariant(customer.lastOrder.toString(Qt::ISODate)) : QVariant(customer.lastOrder));
+        query.addBindValue(customer.totalSpent);
+        query.addBindValue(customer.orderCount);
+        if (!query.exec()) {
+            qWarning() << "写入seller_customers失败:" << query.lastError().text();
+            return false;
+        }
+    }
+    qDebug() << "✓ 商家-客户索引已初始化，共" << customers.size() << "条";
+    return true;
+}
+
+// 迁移8：优惠券钱包，按user_coupons中未使用的优惠券统计一次；之后在发放/使用/回滚时同一事务中维护
+bool Database::migrateCreateCouponWallet(QSqlQuery& query)
+{
+    QString createCouponWalletTable = R"(
+        CREATE TABLE IF NOT EXISTS coupon_wallet (
+            user_id INT NOT NULL COMMENT '用户ID',
+            coupon_value DECIMAL(10, 2) NOT NULL COMMENT '优惠券面额',
+            available INT NOT NULL DEFAULT 0 COMMENT '未使用张数',
+            PRIMARY KEY (user_id, coupon_value)
+        ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='优惠券钱包（按面额汇总）'
+    )";
+    if (!execDdl(query, createCouponWalletTable)) {
+        qCritical() << "创建coupon_wallet表失败:" << query.lastError().text();
+        return false;
+    }
+
+    // 迁移可能重复执行：先清空再统计
+    if (!query.exec("DELETE FROM coupon_wallet")
+        || !query.exec("INSERT INTO coupon_wallet (user_id, coupon_value, available) "
+                       "SELECT user_id, coupon_value, COUNT(*) FROM user_coupons "
+                       "WHERE status = '未使用' GROUP BY user_id, coupon_value")) {
+        qWarning() << "初始化优惠券钱包失败:" << query.lastError().text();
+        return false;
+    }
+    qDebug() << "✓ 优惠券钱包已初始化";
+    return true;
+}
+
+// 迁移9：聊天会话表，每个会话为双方各保存一行（本人 -> 对方），按聊天记录统计一次；之后在消息写入时同一事务中维护
+bool Database::migrateCreateConversations(QSqlQuery& query)
+{
+    QString createConversationsTable = R"(
+        CREATE TABLE IF NOT EXISTS conversations (
+            user_id INT NOT NULL COMMENT '会话所属用户ID（管理员/客服为999999）',
+            user_type VARCHAR(20) NOT NULL COMMENT '会话所属用户类型：buyer/seller/admin',
+            peer_id INT NOT NULL COMMENT '对方ID',
+            peer_type VARCHAR(20) NOT NULL COMMENT '对方类型：buyer/seller/admin',
+            last_message_id INT NOT NULL COMMENT '最近一条消息ID',
+            last_time DATETIME COMMENT '最近一条消息时间',
+            unread_count INT DEFAULT 0 COMMENT '所属用户未读的消息数',
+            PRIMARY KEY (user_id, user_type, peer_id, peer_type),
+            INDEX idx_user_recent (user_id, user_type, last_message_id)
+        ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='聊天会话索引（每个会话双方各一行）'
+    )";
+    if (!execDdl(query, createConversationsTable)) {
+        qCritical() << "创建conversations表失败:" << query.lastError().text();
+        return false;
+    }
+    // 按会话双方的keyset分页读取聊天记录
+    if (!addIndexIfMissing(query, "chat_messages", "idx_pair", "sender_id, sender_type, receiver_id, receiver_type, message_id")) {
+        return false;
+    }
+
+    struct Conversation {
+        qint64 lastMessageId = 0;
+        QVariant lastTime;
+    };
+    QMap<ConversationKey, Conversation> conversations;
+
+    if (!query.exec("SELECT message_id, sender_id, sender_type, receiver_id, receiver_type, send_time "
+                    "FROM chat_messages ORDER BY message_id")) {
+        qWarning() << "统计聊天会话失败:" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        const ChatParticipant sender = {query.value("sender_id").toInt(), query.value("sender_type").toString()};
+        const ChatParticipant receiver = chatReceiver(query.value("receiver_id"), query.value("receiver_type"));
+        for (const ConversationKey &key : {ConversationKey{sender, receiver}, ConversationKey{receiver, sender}}) {
+            Conversation &conversation = conversations[key];
+            conversation.lastMessageId = query.value("message_id").toLongLong();
+            conversation.lastTime = query.value("send_time");
+        }
+    }
+
+    // 迁移可能重复执行：先清空再写入；已有的历史消息视为已读
+    if (!query.exec("DELETE FROM conversations")) {
+        qWarning() << "清空conversations失败:" << query.lastError().text();
+        return false;
+    }
+    query.prepare("INSERT INTO conversations (user_id, user_type, peer_id, peer_type, last_message_id, last_time, unread_count) "
+                  "VALUES (?, ?, ?, ?, ?, ?, 0)");
+    for (auto it = conversations.constBegin(); it != conversations.constEnd(); ++it) {
+        query.addBindValue(it.key().owner.id);
+        query.addBindValue(it.key().owner.type);
+        query.addBindValue(it.key().peer.id);
+        query.addBindValue(it.key().peer.type);
+        query.addBindValue(it.value().lastMessageId);
+        query.addBindValue(it.value().lastTime);
+        if (!query.exec()) {
+            qWarning() << "写入conversations失败:" << query.lastError().text();
+            return false;
+        }
+    }
+    qDebug() << "✓ 聊天会话索引已初始化，共" << conversations.size() << "条";
+    return true;
+}
+
+// 订单涉及的商家：orders.merchant_id加上订单项中的merchantId（兼容merchant_id、sellerId字段名）
+static QSet<int> orderMerchantIds(const QJsonArray& items, int orderMerchantId)
+{
+    QSet<int> merchants;
+    if (orderMerchantId > 0) {
+        merchants.insert(orderMerchantId);
+    }
+    for (const QJsonValue &itemValue : items) {
+        const QJsonObject item = itemValue.toObject();
+        int merchantId = -1;
+        if (item.contains("merchantId")) {
+            merchantId = item.value("merchantId").toInt();
+        } else if (item.contains("merchant_id")) {
+            merchantId = item.value("merchant_id").toInt();
+        } else if (item.contains("sellerId")) {
+            merchantId = item.value("sellerId").toInt();
+        }
+        if (merchantId > 0) {
+            merchants.insert(merchantId);
+        }
+    }
+    return merchants;
+}
+
+// 写入一笔订单的订单-商家索引行
+static bool insertOrderMerchants(QSqlQuery& query, const QString& orderId, const QSet<int>& merchants,
+                                 const QVariant& orderDate)
+{
+    query.prepare("INSERT INTO order_merchants (merchant_id, order_id, order_date) VALUES (?, ?, ?)");
+    for (int merchantId : merchants) {
+        query.addBindValue(merchantId);
+        query.addBindValue(orderId);
+        query.addBindValue(orderDate);
+        if (!query.exec()) {
+            qWarning() << "写入order_merchants失败:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+// 迁移10：订单-商家索引表，按订单的merchant_id和订单项统计一次；之后在订单创建/删除时同一事务中维护。
+// 商家订单列表、分页和按状态统计都按这张表取范围，不再扫描全部订单解析items
+bool Database::migrateCreateOrderMerchants(QSqlQuery& query)
+{
+    QString createOrderMerchantsTable = R"(
+        CREATE TABLE IF NOT EXISTS order_merchants (
+            merchant_id INT NOT NULL COMMENT '商家ID',
+            order_id VARCHAR(50) NOT NULL COMMENT '订单ID',
+            order_date DATETIME COMMENT '下单时间（与orders.order_date相同，用于按时间分页）',
+            PRIMARY KEY (merchant_id, order_id),
+            INDEX idx_merchant_date (merchant_id, order_date),
+            INDEX idx_order (order_id)
+        ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='订单-商家索引（多商家订单每个商家一行）'
+    )";
+    if (!execDdl(query, createOrderMerchantsTable)) {
+        qCritical() << "创建order_merchants表失败:" << query.lastError().text();
+        return false;
+    }
+
+    struct OrderRow {
+        QString orderId;
+        QVariant orderDate;
+        QSet<int> merchants;
+    };
+    QList<OrderRow> rows;
+    if (!query.exec("SELECT order_id, merchant_id, order_date, items FROM orders")) {
+        qWarning() << "统计订单商家失败:" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        OrderRow row;
+        row.orderId = query.value("order_id").toString();
+        row.orderDate = query.value("order_date");
+        row.merchants = orderMerchantIds(QJsonDocument::fromJson(query.value("items").toString().toUtf8()).array(),
+                                         query.value("merchant_id").toInt());
+        rows.append(row);
+    }
+
+    // 迁移可能重复执行：先清空再写入
+    if (!query.exec("DELETE FROM order_merchants")) {
+        qWarning() << "清空order_merchants失败:" << query.lastError().text();
+        return false;
+    }
+    for (const OrderRow &row : rows) {
+        if (!insertOrderMerchants(query, row.orderId, row.merchants, row.orderDate)) {
+            return false;
+        }
+    }
+    qDebug() << "✓ 订单-商家索引已初始化，共" << rows.size() << "笔订单";
+    return true;
+}
+
+// ==========================================
+// 请求日志功能
+// ==========================================
+
+static const char* const kLegacyRequestLogTable = "request_logs";
+
+QString Database::requestLogPartitionName(const QDate& day)
+{
+    return QString("request_logs_%1").arg(day.toString("yyyyMMdd"));
+}
+
+QDate Database::requestLogPartitionDay(const QString& table)
+{
+    static const QRegularExpression pattern("^request_logs_(\\d{8})$");
+    QRegularExpressionMatch match = pattern.match(table);
+    return match.hasMatch() ? QDate::fromString(match.captured(1), "yyyyMMdd") : QDate();
+}
+
+// 表名会拼进SQL，只接受旧表和按天分表
+static bool isRequestLogTable(const QString& table)
+{
+    return table == kLegacyRequestLogTable || Database::requestLogPartitionDay(table).isValid();
+}
+
+bool Database::ensureRequestLogPartitionUnlocked(const QString& table)
+{
+    if (m_logPartitions.contains(table)) {
+        return true;
+    }
+    QSqlQuery query(m_db);
+    if (!execDdl(query, requestLogTableDdl(table))) {
+        qWarning() << "创建日志分表失败:" << table << query.lastError().text();
+        return false;
+    }
+    m_logPartitions.insert(table);
+    return true;
+}
+
+bool Database::logRequest(const QString& clientIp, quint16 clientPort, 
+                         const QString& action, const QJsonObject& requestData,
+                         const QJsonObject& responseData, bool success, 
+                         const QString& category)
+{
+    DbLocker locker(&m_mutex);
+    
+    if (!isConnected()) {
+        return false;
+    }
+    
+    // 写入当天的分表：插入只涉及一张小表，旧数据归档时直接删表
+    const QString table = requestLogPartitionName(QDate::currentDate());
+    if (!ensureRequestLogPartitionUnlocked(table)) {
+        return false;
+    }
+    
+    QSqlQuery query(m_db);
+    query.prepare("INSERT INTO " + table + " (client_ip, client_port, action, request_data, "
+                 "response_data, success, category) VALUES (?, ?, ?, ?, ?, ?, ?)");
+    
+    query.addBindValue(clientIp);
+    query.addBindValue(clientPort);
+    query.addBindValue(action);
+    query.addBindValue(QString(QJsonDocument(requestData).toJson(QJsonDocument::Compact)));
+    query.addBindValue(QString(QJsonDocument(responseData).toJson(QJsonDocument::Compact)));
+    query.addBindValue(success);
+    query.addBindValue(category);
+    
+    if (!query.exec()) {
+        qWarning() << "记录请求日志失败:" << query.lastError().text();
+        m_logPartitions.remove(table);  // 分表可能已被删除，下次重新确认
+        return false;
+    }
+    
+    return true;
+}
+
+QStringList Database::requestLogPartitions()
+{
+    DbReadLocker locker(this);
+    QStringList partitions;
+    
+    if (!isConnected()) {
+        return partitions;
+    }
+    
+    QSqlQuery query(locker.connection());
+    const QString sql = isSqlite()
+        ? "SELECT name FROM sqlite_master WHERE type = 'table' AND name LIKE 'request\\_logs\\_%' ESCAPE '\\'"
+        : "SHOW TABLES LIKE 'request\\_logs\\_%'";
+    if (!query.exec(sql)) {
+        qWarning() << "查询日志分表失败:" << query.lastError().text();
+        return partitions;
+    }
+    while (query.next()) {
+        QString table = query.value(0).toString();
+        if (requestLogPartitionDay(table).isValid()) {
+            partitions.append(table);
+        }
+    }
+    std::sort(partitions.begin(), partitions.end());  // 表名中的日期为yyyyMMdd，字符串顺序即日期顺序
+    return partitions;
+}
+
+QJsonArray Database::getRequestLogs(int limit, const QString& category, const QString& action)
+{
+    QJsonArray logs;
+    if (!isConnected() || limit <= 0) {
+        return logs;
+    }
+    
+    // 新的分表在前，旧表最后
+    QStringList tables = requestLogPartitions();
+    std::reverse(tables.begin(), tables.end());
+    tables.append(kLegacyRequestLogTable);
+    
+    QString where;
+    QVariantList bindValues;
+    if (!category.isEmpty()) {
+        where += (where.isEmpty() ? " WHERE " : " AND ") + QString("category = ?");
+        bindValues.append(category);
+    }
+    if (!action.isEmpty()) {
+        where += (where.isEmpty() ? " WHERE " : " AND ") + QString("action = ?");
+        bindValues.append(action);
+    }
+    
+    DbReadLocker locker(this);
+    QSqlQuery query(locker.connection());
+    for (const QString &table : tables) {
+        if (logs.size() >= limit) {
+            break;
+        }
+        // 分表内id顺序即时间顺序；旧表沿用timestamp索引
+        const QString order = table == kLegacyRequestLogTable ? "timestamp DESC" : "id DESC";
+        query.prepare("SELECT id, timestamp, client_ip, client_port, action, success, category FROM " + table
+                      + where + " ORDER BY " + order + " LIMIT ?");
+        for (const QVariant &value : bindValues) {
+            query.addBindValue(value);
+        }
+        query.addBindValue(limit - logs.size());
+        if (!query.exec()) {
+            qWarning() << "获取请求日志失败:" << table << query.lastError().text();
+            continue;
+        }
+        
+        while (query.next()) {
+            QJsonObject log;
+            log["id"] = query.value("id").toInt();
+            log["timestamp"] = query.value("timestamp").toString();
+            log["clientIp"] = query.value("client_ip").toString();
+            log["clientPort"] = query.value("client_port").toInt();
+            log["action"] = query.value("action").toString();
+            log["success"] = query.value("success").toBool();
+            log["category"] = query.value("category").toString();
+            log["partition"] = table;
+            logs.append(log);
+        }
+    }
+    
+    return logs;
+}
+
+QJsonArray Database::fetchRequestLogRows(const QString& table, qint64 afterId, int batchSize, const QDateTime& before, bool* ok)
+{
+    DbReadLocker locker(this);
+    QJsonArray rows;
+    if (ok) {
+        *ok = false;
+    }
+    
+    if (!isConnected() || !isRequestLogTable(table)) {
+        return rows;
+    }
+    
+    QSqlQuery query(locker.connection());
+    QString sql = "SELECT * FROM " + table + " WHERE id > ?";
+    if (before.isValid()) {
+        sql += " AND timestamp < ?";
+    }
+    sql += " ORDER BY id LIMIT ?";
+    query.prepare(sql);
+    query.addBindValue(afterId);
+    if (before.isValid()) {
+        query.addBindValue(isSqlite() ? QVariant(before.toString("yyyy-MM-dd HH:mm:ss")) : QVariant(before));
+    }
+    query.addBindValue(batchSize);
+    if (!query.exec()) {
+        qWarning() << "读取日志失败:" << table << query.lastError().text();
+        return rows;
+    }
+    if (ok) {
+        *ok = true;
+    }
+    
+    while (query.next()) {
+        QJsonObject row;
+        row["id"] = query.value("id").toLongLong();
+        row["timestamp"] = query.value("timestamp").toDateTime().toString(Qt::ISODate);
+        row["clientIp"] = query.value("client_ip").toString();
+        row["clientPort"] = query.value("client_port").toInt();
+        row["action"] = query.value("action").toString();
+        row["requestData"] = query.value("request_data").toString();
+        row["responseData"] = query.value("response_data").toString();
+        row["success"] = query.value("success").toBool();
+        row["category"] = query.value("category").toString();
+        rows.append(row);
+    }
+    return rows;
+}
+
+bool Database::deleteRequestLogRows(const QString& table, qint64 maxId, const QDateTime& before)
+{
+    DbLocker locker(&m_mutex);
+    
+    if (!isConnected() || !isRequestLogTable(table)) {
+        return false;
+    }
+    
+    QSqlQuery query(m_db);
+    query.prepare("DELETE FROM " + table + " WHERE id <= ? AND timestamp < ?");
+    query.addBindValue(maxId);
+    query.addBindValue(isSqlite() ? QVariant(before.toString("yyyy-MM-dd HH:mm:ss")) : QVariant(before));
+    if (!query.exec()) {
+        qWarning() << "删除已归档日志失败:" << table << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool Database::dropRequestLogPartition(const QString& table)
+{
+    DbLocker locker(&m_mutex);
+    
+    if (!isConnected() || !requestLogPartitionDay(table).isValid()) {
+        return false;
+    }
+    
+    QSqlQuery query(m_db);
+    if (!query.exec("DROP TABLE IF EXISTS " + table)) {
+        qWarning() << "删除日志分表失败:" << table << query.lastError().text();
+        return false;
+    }
+    m_logPartitions.remove(table);
+    return true;
+}
+
+// ==========================================
+// 用户相关
+// ==========================================
+
+bool Database::registerUser(const QString& username, const QString& password, const QString& email)
+{
+    DbLocker locker(&m_mutex);
+    
+    // #region agent log
+    writeDebugLog("data.cpp:330", "数据库注册函数入口", QJsonObject{{"username", username}, {"email", email}}, "G");
+    // #endregion
+    
+    if (!isConnected()) {
+        // #region agent log
+        writeDebugLog("data.cpp:335", "数据库未连接", QJsonObject{}, "G");
+        // #endregion
+        return false;
+    }
+    
+    QSqlQuery query(m_db);
+    query.prepare(dialect("INSERT INTO users (username, password, email, phone_number, address, register_date, license_image_base64, role) "
+                          "VALUES (?, ?, ?, NULL, NULL, CURDATE(), NULL, 1)"));
+    query.addBindValue(username);
+    query.addBindValue(password);
+    query.addBindValue(email.isEmpty() ? QString("%1@example.com").arg(username) : email);
+    
+    // #region agent log
+    writeDebugLog("data.cpp:345", "执行数据库插入前", QJsonObject{{"username", username}}, "G");
+    // #endregion
+    
+    if (!query.exec()) {
+        // #region agent log
+        writeDebugLog("data.cpp:347", "数据库插入失败", QJsonObject{{"username", username}, {"error", query.lastError().text()}}, "G");
+        // #endregion
+        qWarning() << "注册用户失败:" << query.lastError().text();
+        return false;
+    }
+    
+    // #region agent log
+    writeDebugLog("data.cpp:351", "数据库插入成功", QJsonObject{{"username", username}}, "G");
+    // #endregion
+    PlatformCounters::getInstance().userAdded(1);
+    qDebug() << "用户注册成功:" << username;
+    return true;
+}
+
+QJsonObject Database::loginUser(const QString& username, const QString& password)
+{
+    DbReadLocker locker(this);
+    QJsonObject result;
+    
+    // #region agent log
+    writeDebugLog("data.cpp:354", "数据库登录函数入口", QJsonObject{{"username", username}}, "H");
+    // #endregion
+    
+    if (!isConnected()) {
+        // #region agent log
+        writeDebugLog("data.cpp:360", "数据库未连接", QJsonObject{}, "H");
+        // #endregion
+        result["success"] = false;
+        result["message"] = "数据库未连接";
+        return result;
+    }
+    
+    QSqlQuery query(locker.connection());
+    query.prepare("SELECT * FROM users WHERE username = ? AND password = ?");
+    query.addBindValue(username);
+    query.addBindValue(password);
+    
+    // #region agent log
+    writeDebugLog("data.cpp:369", "执行数据库查询前", QJsonObject{{"username", username}}, "H");
+    // #endregion
+    
+    if (!query.exec()) {
+        // #region agent log
+        writeDebugLog("data.cpp:371", "数据库查询失败", QJsonObject{{"username", username}, {"error", query.lastError().text()}}, "H");
+        // #endregion
+        qWarning() << "查询用户失败:" << query.lastError().text();
+        result["success"] = false;
+        result["message"] = "查询失败";
+        return result;
+    }
+    
+    if (query.next()) {
+        // #region agent log
+        writeDebugLog("data.cpp:377", "数据库查询成功，找到用户", QJsonObject{{"username", username}, {"userId", query.value("user_id").toInt()}}, "H");
+        // #endregion
+        
+        // 允许被封禁的用户登录，但不限制其登录功能
+        // 封禁状态将在购买图书等功能中检查
+        
+        result["success"] = true;
+        result["message"] = "登录成功";
+        result["userId"] = query.value("user_id").toInt();
+        result["username"] = query.value("username").toString();
         result["email"] = query.value("email").toString();
         result["balance"] = query.value("balance").toDouble();
         result["role"] = query.value("role").toInt();
+        result["status"] = query.value("status").toString();
         result["userType"] = "buyer";
         // 返回电话和地址信息（直接读取字段值，即使为NULL也会返回空字符串）
         QString phone = query.value("phone_number").toString();
@@ -1032,29 +1759,12 @@ QJsonObject Database::loginUser(const QString& username, const QString& password
         result["memberDiscount"] = getMemberDiscount(memberLevel);  // 折扣率
         result["canParticipateLottery"] = (points >= 3);  // 是否可以参与抽奖（累计满3积分）
         
-        // 从user_coupons表获取优惠券数量（直接查询，避免死锁）
+        // 优惠券数量从钱包汇总表读取（沿用本函数的读连接，避免重复加锁）
         int userId = query.value("user_id").toInt();
-        int coupon30 = 0;
-        int coupon50 = 0;
-        
-        // 查询30元优惠券数量
-        QSqlQuery coupon30Query(m_db);
-        coupon30Query.prepare("SELECT COUNT(*) as count FROM user_coupons WHERE user_id = ? AND coupon_value = 30.0 AND status = '未使用'");
-        coupon30Query.addBindValue(userId);
-        if (coupon30Query.exec() && coupon30Query.next()) {
-            coupon30 = coupon30Query.value("count").toInt();
-        }
-        
-        // 查询50元优惠券数量
-        QSqlQuery coupon50Query(m_db);
-        coupon50Query.prepare("SELECT COUNT(*) as count FROM user_coupons WHERE user_id = ? AND coupon_value = 50.0 AND status = '未使用'");
-        coupon50Query.addBindValue(userId);
-        if (coupon50Query.exec() && coupon50Query.next()) {
-            coupon50 = coupon50Query.value("count").toInt();
-        }
-        
-        result["coupon30"] = coupon30;
-        result["coupon50"] = coupon50;
+        QJsonObject coupons = readCouponWallet(locker.connection(), userId);
+        result["coupons"] = coupons;
+        result["coupon30"] = coupons.value(couponKey(30)).toInt();  // 兼容旧客户端
+        result["coupon50"] = coupons.value(couponKey(50)).toInt();
         
         // 检查是否有营业执照图片
         QString licenseImage = query.value("license_image_base64").toString();
@@ -1063,7 +1773,7 @@ QJsonObject Database::loginUser(const QString& username, const QString& password
         }
         // 获取用户收藏的书籍列表（直接查询，避免死锁）
         QJsonArray favoriteBooks;
-        QSqlQuery favoriteQuery(m_db);
+        QSqlQuery favoriteQuery(locker.connection());
         favoriteQuery.prepare("SELECT book_id FROM favorites WHERE user_id = ? ORDER BY add_time DESC");
         favoriteQuery.addBindValue(userId);
         if (favoriteQuery.exec()) {
@@ -1086,7 +1796,7 @@ QJsonObject Database::loginUser(const QString& username, const QString& password
 
 bool Database::changePassword(int userId, const QString& oldPassword, const QString& newPassword)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         qWarning() << "数据库未连接";
@@ -1119,22 +1829,56 @@ bool Database::changePassword(int userId, const QString& oldPassword, const QStr
         qWarning() << "更新密码失败:" << query.lastError().text();
         return false;
     }
-    
-    qDebug() << "✓ 密码修改成功，用户ID:" << userId;
-    return true;
+    
+    qDebug() << "✓ 密码修改成功，用户ID:" << userId;
+    return true;
+}
+
+// 列表分页查询：limit>0时先用COUNT(*)统计总条数写入total，再在查询后追加LIMIT/OFFSET；
+// limit<=0时查询全部，total由调用方按实际行数填写
+static bool execPagedQuery(QSqlQuery& query, const QString& select, const QString& from, const QString& orderBy,
+                           const QVariantList& bindValues, int offset, int limit, int* total)
+{
+    if (limit > 0 && total) {
+        query.prepare("SELECT COUNT(*) " + from);
+        for (const QVariant &value : bindValues) {
+            query.addBindValue(value);
+        }
+        if (!query.exec() || !query.next()) {
+            return false;
+        }
+        *total = query.value(0).toInt();
+    }
+    
+    QString sql = select + " " + from + " " + orderBy;
+    if (limit > 0) {
+        sql += " LIMIT ? OFFSET ?";
+    }
+    query.prepare(sql);
+    for (const QVariant &value : bindValues) {
+        query.addBindValue(value);
+    }
+    if (limit > 0) {
+        query.addBindValue(limit);
+        query.addBindValue(qMax(0, offset));
+    }
+    return query.exec();
 }
 
-QJsonArray Database::getAllUsers()
+QJsonArray Database::getAllUsers(int offset, int limit, int* total)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray users;
+    if (total) {
+        *total = 0;
+    }
     
     if (!isConnected()) {
         return users;
     }
     
-    QSqlQuery query(m_db);
-    if (!query.exec("SELECT * FROM users ORDER BY user_id")) {
+    QSqlQuery query(locker.connection());
+    if (!execPagedQuery(query, "SELECT *", "FROM users", "ORDER BY user_id", {}, offset, limit, total)) {
         qWarning() << "查询用户列表失败:" << query.lastError().text();
         return users;
     }
@@ -1194,12 +1938,15 @@ QJsonArray Database::getAllUsers()
         users.append(user);
     }
     
+    if (total && limit <= 0) {
+        *total = users.size();
+    }
     return users;
 }
 
 QJsonObject Database::getUserById(int userId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonObject user;
     
     if (!isConnected()) {
@@ -1207,7 +1954,7 @@ QJsonObject Database::getUserById(int userId)
         return user;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     query.prepare("SELECT * FROM users WHERE user_id = ?");
     query.addBindValue(userId);
     
@@ -1255,28 +2002,11 @@ QJsonObject Database::getUserById(int userId)
         user["memberDiscount"] = getMemberDiscount(memberLevel);  // 折扣率
         user["canParticipateLottery"] = (points >= 3);  // 是否可以参与抽奖（累计满3积分）
         
-        // 从user_coupons表获取优惠券数量（直接查询，避免死锁）
-        int coupon30 = 0;
-        int coupon50 = 0;
-        
-        // 查询30元优惠券数量
-        QSqlQuery coupon30Query(m_db);
-        coupon30Query.prepare("SELECT COUNT(*) as count FROM user_coupons WHERE user_id = ? AND coupon_value = 30.0 AND status = '未使用'");
-        coupon30Query.addBindValue(userId);
-        if (coupon30Query.exec() && coupon30Query.next()) {
-            coupon30 = coupon30Query.value("count").toInt();
-        }
-        
-        // 查询50元优惠券数量
-        QSqlQuery coupon50Query(m_db);
-        coupon50Query.prepare("SELECT COUNT(*) as count FROM user_coupons WHERE user_id = ? AND coupon_value = 50.0 AND status = '未使用'");
-        coupon50Query.addBindValue(userId);
-        if (coupon50Query.exec() && coupon50Query.next()) {
-            coupon50 = coupon50Query.value("count").toInt();
-        }
-        
-        user["coupon30"] = coupon30;
-        user["coupon50"] = coupon50;
+        // 优惠券数量从钱包汇总表读取（沿用本函数的读连接，避免重复加锁）
+        QJsonObject coupons = readCouponWallet(locker.connection(), userId);
+        user["coupons"] = coupons;
+        user["coupon30"] = coupons.value(couponKey(30)).toInt();  // 兼容旧客户端
+        user["coupon50"] = coupons.value(couponKey(50)).toInt();
         
         // 保留向后兼容
         int membershipLevel = 1;
@@ -1292,7 +2022,7 @@ QJsonObject Database::getUserById(int userId)
     } else {
         qWarning() << "getUserById: 未找到用户，用户ID:" << userId;
         // 检查数据库中是否存在该用户
-        QSqlQuery checkQuery(m_db);
+        QSqlQuery checkQuery(locker.connection());
         checkQuery.prepare("SELECT COUNT(*) as count FROM users WHERE user_id = ?");
         checkQuery.addBindValue(userId);
         if (checkQuery.exec() && checkQuery.next()) {
@@ -1307,13 +2037,21 @@ QJsonObject Database::getUserById(int userId)
 
 bool Database::deleteUser(int userId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
     }
     
+    // 先读出角色，删除成功后按角色减少平台计数
     QSqlQuery query(m_db);
+    query.prepare("SELECT role FROM users WHERE user_id = ?");
+    query.addBindValue(userId);
+    int role = -1;
+    if (query.exec() && query.next()) {
+        role = query.value(0).toInt();
+    }
+    
     query.prepare("DELETE FROM users WHERE user_id = ?");
     query.addBindValue(userId);
     
@@ -1322,12 +2060,17 @@ bool Database::deleteUser(int userId)
         return false;
     }
     
-    return query.numRowsAffected() > 0;
+    SessionManager::getInstance().revokePrincipal("buyer", userId);
+    if (query.numRowsAffected() <= 0) {
+        return false;
+    }
+    PlatformCounters::getInstance().userRemoved(role);
+    return true;
 }
 
 bool Database::updateUserStatus(int userId, const QString& status)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -1355,6 +2098,7 @@ bool Database::updateUserStatus(int userId, const QString& status)
         qWarning() << "更新用户状态失败:" << query.lastError().text();
         return false;
     }
+    SessionManager::getInstance().publishStatus("buyer", userId, status);
     
     // 如果用户是商家（role = 2），同步更新商家状态
     if (role == 2 && !username.isEmpty()) {
@@ -1378,6 +2122,7 @@ bool Database::updateUserStatus(int userId, const QString& status)
                 
                 if (updateSellerQuery.exec()) {
                     qDebug() << "商家状态更新成功，sellerId:" << sellerId << "status:" << status;
+                    SessionManager::getInstance().publishStatus("seller", sellerId, status);
                     
                     // 如果封禁用户，将该商家的所有图书下架
                     if (status == "封禁") {
@@ -1428,7 +2173,7 @@ bool Database::updateUserStatus(int userId, const QString& status)
 
 bool Database::updateUserBalance(int userId, double balance)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -1450,7 +2195,7 @@ bool Database::updateUserBalance(int userId, double balance)
 
 bool Database::updateUserInfo(int userId, const QString& phone, const QString& email, const QString& address)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         qWarning() << "更新用户信息失败：数据库未连接";
@@ -1492,7 +2237,7 @@ bool Database::updateUserInfo(int userId, const QString& phone, const QString& e
 
 bool Database::updateUserMemberLevel(int userId, const QString& memberLevel)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         qWarning() << "更新会员等级失败：数据库未连接";
@@ -1525,12 +2270,13 @@ bool Database::updateUserMemberLevel(int userId, const QString& memberLevel)
     }
     
     qDebug() << "更新会员等级成功，用户ID:" << userId << "会员等级:" << memberLevel;
+    SessionManager::getInstance().publishMemberLevel("buyer", userId, memberLevel, getMemberDiscount(memberLevel));
     return true;
 }
 
 bool Database::rechargeUserBalance(int userId, double amount)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -1576,7 +2322,7 @@ bool Database::rechargeUserBalance(int userId, double amount)
 
 bool Database::deductUserBalance(int userId, double amount)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -1625,15 +2371,15 @@ bool Database::deductUserBalance(int userId, double amount)
 
 bool Database::registerSeller(const QString& sellerName, const QString& password, const QString& email)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
     }
     
     QSqlQuery query(m_db);
-    query.prepare("INSERT INTO sellers (seller_name, password, email, phone_number, address, balance, register_date) "
-                 "VALUES (?, ?, ?, NULL, NULL, 0.00, CURDATE())");
+    query.prepare(dialect("INSERT INTO sellers (seller_name, password, email, phone_number, address, balance, register_date) "
+                          "VALUES (?, ?, ?, NULL, NULL, 0.00, CURDATE())"));
     query.addBindValue(sellerName);
     query.addBindValue(password);
     query.addBindValue(email);
@@ -1643,12 +2389,13 @@ bool Database::registerSeller(const QString& sellerName, const QString& password
         return false;
     }
     
+    PlatformCounters::getInstance().sellerAdded();
     return true;
 }
 
 QJsonObject Database::loginSeller(const QString& sellerName, const QString& password)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonObject result;
     
     if (!isConnected()) {
@@ -1657,7 +2404,7 @@ QJsonObject Database::loginSeller(const QString& sellerName, const QString& pass
         return result;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     query.prepare("SELECT * FROM sellers WHERE seller_name = ? AND password = ?");
     query.addBindValue(sellerName);
     query.addBindValue(password);
@@ -1699,6 +2446,7 @@ QJsonObject Database::loginSeller(const QString& sellerName, const QString& pass
         result["userId"] = sellerId;  // 直接使用整数，JSON会自动序列化
         result["username"] = query.value("seller_name").toString();
         result["email"] = query.value("email").toString();
+        result["status"] = query.value("status").toString();
         result["userType"] = "seller";
         
         // 读取会员等级、累计充值总额和积分
@@ -1734,14 +2482,14 @@ QJsonObject Database::loginSeller(const QString& sellerName, const QString& pass
 
 QJsonArray Database::getAllSellers()
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray sellers;
     
     if (!isConnected()) {
         return sellers;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     if (!query.exec("SELECT * FROM sellers ORDER BY seller_id")) {
         qWarning() << "查询商家列表失败:" << query.lastError().text();
         return sellers;
@@ -1797,14 +2545,14 @@ QJsonArray Database::getAllSellers()
 
 QJsonObject Database::getSellerById(int sellerId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonObject seller;
     
     if (!isConnected()) {
         return seller;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     query.prepare("SELECT * FROM sellers WHERE seller_id = ?");
     query.addBindValue(sellerId);
     
@@ -1851,7 +2599,7 @@ QJsonObject Database::getSellerById(int sellerId)
 
 bool Database::deleteSeller(int sellerId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -1866,14 +2614,19 @@ bool Database::deleteSeller(int sellerId)
         return false;
     }
     
-    return query.numRowsAffected() > 0;
+    SessionManager::getInstance().revokePrincipal("seller", sellerId);
+    if (query.numRowsAffected() <= 0) {
+        return false;
+    }
+    PlatformCounters::getInstance().sellerRemoved();
+    return true;
 }
 
 bool Database::updateSellerStatus(int sellerId, const QString& status)
 {
     // 注意：如果从 updateUserStatus 调用，mutex 已经被锁定，这里不需要再次锁定
     // 但为了保持函数独立性，仍然使用 QMutexLocker（QMutex 应该是递归的）
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -1890,6 +2643,7 @@ bool Database::updateSellerStatus(int sellerId, const QString& status)
     }
     
     qDebug() << "商家状态更新成功，sellerId:" << sellerId << "status:" << status;
+    SessionManager::getInstance().publishStatus("seller", sellerId, status);
     
     // 如果解封商家，同步解封对应的用户，并恢复图书上架
     if (status == "正常") {
@@ -1911,6 +2665,7 @@ bool Database::updateSellerStatus(int sellerId, const QString& status)
                 int affectedRows = userQuery.numRowsAffected();
                 if (affectedRows > 0) {
                     qDebug() << "商家ID" << sellerId << "(" << sellerName << ")已解封，同步解封对应的用户";
+                    SessionManager::getInstance().publishStatusByUsername("buyer", sellerName, "正常");
                 } else {
                     qDebug() << "商家ID" << sellerId << "(" << sellerName << ")解封，但未找到对应的用户（可能用户不存在或不是商家）";
                 }
@@ -1940,7 +2695,7 @@ bool Database::updateBooksStatusBySellerId(int sellerId, const QString& status)
 {
     // 注意：如果从 updateUserStatus 或 updateSellerStatus 调用，mutex 已经被锁定
     // 但为了保持函数独立性，仍然使用 QMutexLocker（QMutex 应该是递归的）
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -1967,7 +2722,7 @@ bool Database::updateBooksStatusBySellerId(int sellerId, const QString& status)
 
 bool Database::addBook(const QJsonObject& book)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -2003,12 +2758,13 @@ bool Database::addBook(const QJsonObject& book)
         return false;
     }
     
+    PlatformCounters::getInstance().booksAdded();
     return true;
 }
 
 bool Database::updateBook(const QString& isbn, const QJsonObject& book)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -2085,7 +2841,7 @@ bool Database::updateBook(const QString& isbn, const QJsonObject& book)
 
 bool Database::deleteBook(const QString& isbn)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -2100,33 +2856,45 @@ bool Database::deleteBook(const QString& isbn)
         return false;
     }
     
-    return query.numRowsAffected() > 0;
+    if (query.numRowsAffected() <= 0) {
+        return false;
+    }
+    PlatformCounters::getInstance().bookRemoved();
+    return true;
+}
+
+// 由评分总分和评论数填写图书的评分字段
+static void setRatingFields(QJsonObject& book, int ratingSum, int ratingCount)
+{
+    double average = ratingCount > 0 ? double(ratingSum) / ratingCount : 0.0;
+    book["averageRating"] = average;
+    book["reviewCount"] = ratingCount;
+    book["hasRating"] = ratingCount > 0;
+    book["score"] = average;  // 兼容score字段
 }
 
-QJsonArray Database::getAllBooks()
+QJsonArray Database::getAllBooks(int offset, int limit, int* total)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray books;
+    if (total) {
+        *total = 0;
+    }
     
     if (!isConnected()) {
         return books;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     // 买家只能看到状态为"正常"的书籍（已审核通过的）
-    if (!query.exec("SELECT * FROM books WHERE status = '正常' ORDER BY isbn")) {
+    if (!execPagedQuery(query, "SELECT *", "FROM books WHERE status = '正常'", "ORDER BY isbn", {}, offset, limit, total)) {
         qWarning() << "查询图书列表失败:" << query.lastError().text();
         return books;
     }
     
-    // 先收集所有书籍ID和书籍数据
-    QList<QString> bookIds;
-    QMap<QString, QJsonObject> bookMap;
-    
     while (query.next()) {
         QJsonObject book;
-        QString bookId = query.value("isbn").toString();
-        book["isbn"] = bookId;
+        book["isbn"] = query.value("isbn").toString();
         book["title"] = query.value("title").toString();
         book["author"] = query.value("author").toString();
         book["category1"] = query.value("category1").toString();
@@ -2139,103 +2907,37 @@ QJsonArray Database::getAllBooks()
         book["description"] = query.value("description").toString();  // 书籍描述
         // 兼容旧数据：同时提供category字段（使用category1的值）
         book["category"] = query.value("category1").toString();
-        book["favoriteCount"] = 0;  // 初始化为0
-        
-        bookIds.append(bookId);
-        bookMap[bookId] = book;
-    }
-    
-    // 批量查询收藏量（使用单个查询优化性能）
-    if (!bookIds.isEmpty()) {
-        // 使用单个查询获取所有书籍的收藏数
-        QString countSql = "SELECT book_id, COUNT(*) as count FROM favorites WHERE book_id IN (";
-        QStringList placeholders;
-        for (int i = 0; i < bookIds.size(); ++i) {
-            placeholders.append("?");
-        }
-        countSql += placeholders.join(",") + ") GROUP BY book_id";
-        
-        QSqlQuery countQuery(m_db);
-        countQuery.prepare(countSql);
-        for (const QString &bookId : bookIds) {
-            countQuery.addBindValue(bookId);
-        }
-        
-        if (countQuery.exec()) {
-            while (countQuery.next()) {
-                QString bookId = countQuery.value("book_id").toString();
-                int count = countQuery.value("count").toInt();
-                if (bookMap.contains(bookId)) {
-                    bookMap[bookId]["favoriteCount"] = count;
-                }
-            }
-        } else {
-            qWarning() << "批量查询收藏量失败:" << countQuery.lastError().text();
-        }
-        
-        // 批量查询评分统计（使用单个查询优化性能）
-        QString ratingSql = "SELECT book_id, AVG(rating) as avg_rating, COUNT(*) as review_count "
-                           "FROM reviews WHERE book_id IN (";
-        ratingSql += placeholders.join(",") + ") GROUP BY book_id";
-        
-        QSqlQuery ratingQuery(m_db);
-        ratingQuery.prepare(ratingSql);
-        for (const QString &bookId : bookIds) {
-            ratingQuery.addBindValue(bookId);
-        }
+        // 收藏数和评分取books表中随写入维护的计数，不再对favorites/reviews做聚合查询
+        book["favoriteCount"] = query.value("favorite_count").toInt();
+        setRatingFields(book, query.value("rating_sum").toInt(), query.value("rating_count").toInt());
         
-        if (ratingQuery.exec()) {
-            while (ratingQuery.next()) {
-                QString bookId = ratingQuery.value("book_id").toString();
-                double avgRating = ratingQuery.value("avg_rating").toDouble();
-                int reviewCount = ratingQuery.value("review_count").toInt();
-                if (bookMap.contains(bookId)) {
-                    bookMap[bookId]["averageRating"] = avgRating;
-                    bookMap[bookId]["reviewCount"] = reviewCount;
-                    bookMap[bookId]["hasRating"] = true;
-                    bookMap[bookId]["score"] = avgRating;  // 兼容score字段
-                }
-            }
-        } else {
-            qWarning() << "批量查询评分统计失败:" << ratingQuery.lastError().text();
-        }
-        
-        // 为没有评分的商品设置默认值
-        for (const QString &bookId : bookIds) {
-            if (bookMap.contains(bookId) && !bookMap[bookId].contains("hasRating")) {
-                bookMap[bookId]["averageRating"] = 0.0;
-                bookMap[bookId]["reviewCount"] = 0;
-                bookMap[bookId]["hasRating"] = false;
-                bookMap[bookId]["score"] = 0.0;  // 兼容score字段
-            }
-        }
-    }
-    
-    // 将书籍添加到结果数组（保持原有顺序）
-    for (const QString &bookId : bookIds) {
-        books.append(bookMap[bookId]);
+        books.append(book);
     }
     
     qDebug() << "getAllBooks: 查询完成，书籍数量:" << books.size();
     
+    if (total && limit <= 0) {
+        *total = books.size();
+    }
     return books;
 }
 
-QJsonArray Database::getAllBooksForSeller(int sellerId)
+QJsonArray Database::getAllBooksForSeller(int sellerId, int offset, int limit, int* total)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray books;
+    if (total) {
+        *total = 0;
+    }
     
     if (!isConnected()) {
         return books;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     // 查询该卖家的所有书籍（不限制状态）
-    query.prepare("SELECT * FROM books WHERE merchant_id = ? ORDER BY isbn");
-    query.addBindValue(sellerId);
-    
-    if (!query.exec()) {
+    if (!execPagedQuery(query, "SELECT *", "FROM books WHERE merchant_id = ?", "ORDER BY isbn", {sellerId},
+                        offset, limit, total)) {
         qWarning() << "查询卖家图书列表失败:" << query.lastError().text();
         return books;
     }
@@ -2264,43 +2966,19 @@ QJsonArray Database::getAllBooksForSeller(int sellerId)
         book["coverImage"] = query.value("cover_image").toString();
         book["description"] = query.value("description").toString();  // 书籍描述
         book["category"] = query.value("category1").toString();  // 兼容旧数据
-        book["favoriteCount"] = 0;  // 初始化为0
+        book["favoriteCount"] = query.value("favorite_count").toInt();  // 随收藏写入维护的计数
         
         bookIds.append(bookId);
         bookMap[bookId] = book;
     }
     
-    // 批量查询收藏量（使用单个查询优化性能）
     if (!bookIds.isEmpty()) {
-        QString countSql = "SELECT book_id, COUNT(*) as count FROM favorites WHERE book_id IN (";
-        QStringList placeholders;
-        for (int i = 0; i < bookIds.size(); ++i) {
-            placeholders.append("?");
-        }
-        countSql += placeholders.join(",") + ") GROUP BY book_id";
-        
-        QSqlQuery countQuery(m_db);
-        countQuery.prepare(countSql);
-        for (const QString &bookId : bookIds) {
-            countQuery.addBindValue(bookId);
-        }
-        
-        if (countQuery.exec()) {
-            while (countQuery.next()) {
-                QString bookId = countQuery.value("book_id").toString();
-                int count = countQuery.value("count").toInt();
-                if (bookMap.contains(bookId)) {
-                    bookMap[bookId]["favoriteCount"] = count;
-                }
-            }
-        } else {
-            qWarning() << "批量查询收藏量失败:" << countQuery.lastError().text();
-        }
-        
         // 批量查询销量（从订单中统计）
-        // 查询该卖家的所有已支付订单，统计每个商品的销量
-        QSqlQuery salesQuery(m_db);
-        salesQuery.prepare("SELECT items FROM orders WHERE status IN ('已支付', '已发货', '已完成')");
+        // 只读取该卖家的已支付订单（按order_merchants取范围），统计每个商品的销量
+        QSqlQuery salesQuery(locker.connection());
+        salesQuery.prepare("SELECT o.items FROM order_merchants om JOIN orders o ON o.order_id = om.order_id "
+                           "WHERE om.merchant_id = ? AND o.status IN ('已支付', '已发货', '已完成')");
+        salesQuery.addBindValue(sellerId);
         
         if (salesQuery.exec()) {
             // 统计每个商品的销量
@@ -2364,19 +3042,22 @@ QJsonArray Database::getAllBooksForSeller(int sellerId)
     
     qDebug() << "getAllBooksForSeller: 查询完成，书籍数量:" << books.size();
     
+    if (total && limit <= 0) {
+        *total = books.size();
+    }
     return books;
 }
 
 QJsonArray Database::getPendingBooks()
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray books;
     
     if (!isConnected()) {
         return books;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     // 查询状态为"待审核"的书籍
     if (!query.exec("SELECT * FROM books WHERE status = '待审核' ORDER BY isbn")) {
         qWarning() << "查询待审核图书列表失败:" << query.lastError().text();
@@ -2410,7 +3091,7 @@ QJsonArray Database::getPendingBooks()
 
 bool Database::approveBook(const QString& isbn)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         qWarning() << "approveBook: 数据库未连接";
@@ -2454,7 +3135,7 @@ bool Database::approveBook(const QString& isbn)
 
 bool Database::rejectBook(const QString& isbn)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         qWarning() << "rejectBook: 数据库未连接";
@@ -2498,14 +3179,14 @@ bool Database::rejectBook(const QString& isbn)
 
 QJsonObject Database::getBook(const QString& isbn)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonObject book;
     
     if (!isConnected()) {
         return book;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     query.prepare("SELECT * FROM books WHERE isbn = ?");
     query.addBindValue(isbn);
     
@@ -2535,14 +3216,14 @@ QJsonObject Database::getBook(const QString& isbn)
 
 QJsonArray Database::searchBooks(const QString& keyword)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray books;
     
     if (!isConnected()) {
         return books;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     query.prepare("SELECT * FROM books WHERE title LIKE ? OR author LIKE ? OR category1 LIKE ? OR category2 LIKE ?");
     QString searchPattern = "%" + keyword + "%";
     query.addBindValue(searchPattern);
@@ -2581,7 +3262,7 @@ QJsonArray Database::searchBooks(const QString& keyword)
 
 QString Database::createOrder(const QJsonObject& order)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return QString();
@@ -2690,11 +3371,23 @@ QString Database::createOrder(const QJsonObject& order)
     query.addBindValue(order["remark"].toString());
     query.addBindValue(QString(QJsonDocument(order["items"].toArray()).toJson(QJsonDocument::Compact)));
     
+    // 订单和订单-商家索引在同一事务中写入
+    if (!m_db.transaction()) {
+        qWarning() << "开始创建订单事务失败:" << m_db.lastError().text();
+        return QString();
+    }
     if (!query.exec()) {
         qWarning() << "创建订单失败:" << query.lastError().text();
         qWarning() << "订单ID:" << orderId;
         qWarning() << "用户ID:" << order["userId"].toString();
         qWarning() << "订单数据:" << QJsonDocument(order).toJson(QJsonDocument::Compact);
+        m_db.rollback();
+        return QString();
+    }
+    if (!insertOrderMerchants(query, orderId, orderMerchantIds(order["items"].toArray(), merchantId), orderDate)
+        || !m_db.commit()) {
+        qWarning() << "提交创建订单事务失败:" << m_db.lastError().text();
+        m_db.rollback();
         return QString();
     }
     
@@ -2704,14 +3397,32 @@ QString Database::createOrder(const QJsonObject& order)
 
 bool Database::updateOrderStatus(const QString& orderId, const QString& status, const QString& paymentMethod, const QString& cancelReason, const QString& trackingNumber, double totalAmount)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         qWarning() << "数据库未连接，无法更新订单状态";
         return false;
     }
     
+    // 状态更新与商家-客户索引的累计在同一事务中，索引写入失败时状态也回滚，两者不会不一致
+    if (!m_db.transaction()) {
+        qWarning() << "开始订单状态事务失败:" << m_db.lastError().text();
+        return false;
+    }
+
     QSqlQuery query(m_db);
+
+    // 订单首次变为已支付时累计到商家-客户索引（重复支付请求不重复累计）
+    bool firstPayment = false;
+    if (status == "已支付") {
+        query.prepare("SELECT status FROM orders WHERE order_id = ?");
+        query.addBindValue(orderId);
+        if (query.exec() && query.next()) {
+            const QString previous = query.value(0).toString();
+            firstPayment = previous != "已支付" && previous != "已发货" && previous != "已完成";
+        }
+    }
+
     QString sql = "UPDATE orders SET status = ?";
     QList<QVariant> bindValues;
     bindValues.append(status);
@@ -2745,32 +3456,78 @@ bool Database::updateOrderStatus(const QString& orderId, const QString& status,
     sql += " WHERE order_id = ?";
     bindValues.append(orderId);
     
-    query.prepare(sql);
+    query.prepare(dialect(sql));
     for (const QVariant &value : bindValues) {
         query.addBindValue(value);
     }
     
     if (!query.exec()) {
         qWarning() << "更新订单状态失败，订单ID:" << orderId << "状态:" << status << "错误:" << query.lastError().text();
+        m_db.rollback();
         return false;
     }
     
     int affectedRows = query.numRowsAffected();
-    if (affectedRows > 0) {
-        qDebug() << "订单状态更新成功，订单ID:" << orderId << "状态:" << status << "影响行数:" << affectedRows;
-        if (status == "已发货" && !trackingNumber.isEmpty()) {
-            qDebug() << "物流单号已更新:" << trackingNumber;
-        }
-    } else {
+    if (affectedRows <= 0) {
         qWarning() << "订单状态更新失败：未找到订单，订单ID:" << orderId;
+        m_db.rollback();
+        return false;
+    }
+    
+    if (firstPayment && !recordSellerCustomersUnlocked(orderId)) {
+        qWarning() << "更新商家-客户索引失败，订单状态已回滚，订单ID:" << orderId;
+        m_db.rollback();
+        return false;
     }
     
-    return affectedRows > 0;
+    if (!m_db.commit()) {
+        qWarning() << "提交订单状态事务失败:" << m_db.lastError().text();
+        m_db.rollback();
+        return false;
+    }
+    
+    qDebug() << "订单状态更新成功，订单ID:" << orderId << "状态:" << status << "影响行数:" << affectedRows;
+    if (status == "已发货" && !trackingNumber.isEmpty()) {
+        qDebug() << "物流单号已更新:" << trackingNumber;
+    }
+    return true;
+}
+
+bool Database::recordSellerCustomersUnlocked(const QString& orderId)
+{
+    QSqlQuery query(m_db);
+    query.prepare("SELECT user_id, merchant_id, items, total_amount FROM orders WHERE order_id = ?");
+    query.addBindValue(orderId);
+    if (!query.exec() || !query.next()) {
+        return false;
+    }
+    const int userId = query.value("user_id").toInt();
+    if (userId <= 0) {
+        return true;
+    }
+    const QHash<int, double> amounts = splitOrderAmountByMerchant(
+        query.value("items").toString(), query.value("merchant_id").toInt(), query.value("total_amount").toDouble());
+
+    query.prepare(dialect("INSERT INTO seller_customers (merchant_id, user_id, first_order, last_order, total_spent, order_count) "
+                          "VALUES (?, ?, NOW(), NOW(), ?, 1) " +
+                          upsertClause("merchant_id, user_id") +
+                          "last_order = VALUES(last_order), total_spent = total_spent + VALUES(total_spent), "
+                          "order_count = order_count + 1"));
+    for (auto it = amounts.constBegin(); it != amounts.constEnd(); ++it) {
+        query.addBindValue(it.key());
+        query.addBindValue(userId);
+        query.addBindValue(it.value());
+        if (!query.exec()) {
+            qWarning() << "写入seller_customers失败:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
 }
 
 QJsonArray Database::getUserOrders(int userId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray orders;
     
     if (!isConnected()) {
@@ -2778,7 +3535,7 @@ QJsonArray Database::getUserOrders(int userId)
         return orders;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     // 使用标准的查询条件，查询user_id匹配的订单
     // 如果userId有效（>0），只查询匹配的订单；如果userId为0或无效，不查询任何订单
     if (userId > 0) {
@@ -2874,7 +3631,7 @@ QJsonArray Database::getUserOrders(int userId)
     
     // 如果没有找到订单，检查数据库中是否有该用户的订单（使用不同的查询方式）
     if (count == 0) {
-        QSqlQuery checkQuery(m_db);
+        QSqlQuery checkQuery(locker.connection());
         
         // 检查精确匹配
         checkQuery.prepare("SELECT COUNT(*) as count FROM orders WHERE user_id = ?");
@@ -2896,7 +3653,7 @@ QJsonArray Database::getUserOrders(int userId)
         if (exactCount > 0) {
             qWarning() << "getUserOrders: 数据库中存在" << exactCount << "个订单，但查询结果为空，用户ID:" << userId;
             // 尝试直接查询，看看是否有类型问题
-            checkQuery.prepare("SELECT order_id, user_id, CAST(user_id AS CHAR) as user_id_str FROM orders WHERE user_id = ? LIMIT 5");
+            checkQuery.prepare(dialect("SELECT order_id, user_id, CAST(user_id AS CHAR) as user_id_str FROM orders WHERE user_id = ? LIMIT 5"));
             checkQuery.addBindValue(userId);
             if (checkQuery.exec()) {
                 qDebug() << "getUserOrders: 直接查询结果:";
@@ -2935,17 +3692,20 @@ QJsonArray Database::getUserOrders(int userId)
     return orders;
 }
 
-QJsonArray Database::getAllOrders()
+QJsonArray Database::getAllOrders(int offset, int limit, int* total)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray orders;
+    if (total) {
+        *total = 0;
+    }
     
     if (!isConnected()) {
         return orders;
     }
     
-    QSqlQuery query(m_db);
-    if (!query.exec("SELECT * FROM orders ORDER BY order_date DESC")) {
+    QSqlQuery query(locker.connection());
+    if (!execPagedQuery(query, "SELECT *", "FROM orders", "ORDER BY order_date DESC, order_id", {}, offset, limit, total)) {
         qWarning() << "查询订单列表失败:" << query.lastError().text();
         return orders;
     }
@@ -2980,45 +3740,40 @@ QJsonArray Database::getAllOrders()
         orders.append(order);
     }
     
+    if (total && limit <= 0) {
+        *total = orders.size();
+    }
     return orders;
 }
 
-QJsonArray Database::getSellerOrders(int sellerId)
+QJsonArray Database::getSellerOrders(int sellerId, int offset, int limit, int* total)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray orders;
+    if (total) {
+        *total = 0;
+    }
     
     if (!isConnected()) {
         qWarning() << "getSellerOrders: 数据库未连接";
         return orders;
     }
     
-    qDebug() << "getSellerOrders: 开始查询商家订单，商家ID:" << sellerId;
-    
-    // 使用集合来避免重复添加订单
-    QSet<QString> addedOrderIds;
-    
-    // 方法1：先通过merchant_id字段快速筛选（如果订单只有一个商家）
-    QSqlQuery query(m_db);
-    query.prepare("SELECT * FROM orders WHERE merchant_id = ? ORDER BY order_date DESC");
-    query.addBindValue(sellerId);
-    
-    if (!query.exec()) {
+    // 订单范围取自order_merchants：merchant_id为该商家的订单，以及订单项中含该商家商品的多商家订单
+    QSqlQuery query(locker.connection());
+    if (!execPagedQuery(query, "SELECT o.*",
+                        "FROM order_merchants om JOIN orders o ON o.order_id = om.order_id WHERE om.merchant_id = ?",
+                        "ORDER BY om.order_date DESC, om.order_id", {sellerId}, offset, limit, total)) {
         qWarning() << "getSellerOrders: 查询商家订单失败:" << query.lastError().text();
         return orders;
     }
     
-    int method1Count = 0;
     while (query.next()) {
-        QString orderId = query.value("order_id").toString();
-        if (addedOrderIds.contains(orderId)) {
-            continue;  // 避免重复添加
-        }
-        
         QJsonObject order;
-        order["orderId"] = orderId;
+        order["orderId"] = query.value("order_id").toString();
         order["userId"] = query.value("user_id").toInt();
-        order["merchantId"] = query.value("merchant_id").toInt();
+        QVariant merchantIdValue = query.value("merchant_id");
+        order["merchantId"] = merchantIdValue.isNull() ? sellerId : merchantIdValue.toInt();
         order["customer"] = query.value("customer").toString();
         order["phone"] = query.value("phone").toString();
         order["totalAmount"] = query.value("total_amount").toDouble();
@@ -3035,163 +3790,176 @@ QJsonArray Database::getSellerOrders(int sellerId)
         order["remark"] = query.value("remark").toString();
         
         // 解析items JSON
-        QString itemsJson = query.value("items").toString();
-        if (!itemsJson.isEmpty()) {
-            QJsonDocument doc = QJsonDocument::fromJson(itemsJson.toUtf8());
-            if (doc.isArray()) {
-                order["items"] = doc.array();
-            } else {
-                order["items"] = QJsonArray();
-            }
-        } else {
-            order["items"] = QJsonArray();
-        }
+        QJsonDocument doc = QJsonDocument::fromJson(query.value("items").toString().toUtf8());
+        order["items"] = doc.isArray() ? doc.array() : QJsonArray();
         
         orders.append(order);
-        addedOrderIds.insert(orderId);
-        method1Count++;
     }
     
-    qDebug() << "getSellerOrders: 方法1找到" << method1Count << "个订单（通过merchant_id字段）";
-    
-    // 方法2：检查所有订单的items JSON，找出包含该商家商品但merchant_id字段不匹配或为NULL的订单
-    // （处理一个订单包含多个商家商品的情况，或者merchant_id未正确设置的情况）
-    QSqlQuery query2(m_db);
-    query2.prepare("SELECT * FROM orders WHERE merchant_id != ? OR merchant_id IS NULL ORDER BY order_date DESC");
-    query2.addBindValue(sellerId);
-    
-    if (!query2.exec()) {
-        qWarning() << "getSellerOrders: 查询混合订单失败:" << query2.lastError().text();
-        qDebug() << "getSellerOrders: 方法1已找到" << orders.size() << "个订单，返回结果";
-        return orders;
+    if (total && limit <= 0) {
+        *total = orders.size();
     }
+    return orders;
+}
+
+// 商家订单按状态汇总（订单数和订单金额），范围与getSellerOrders相同
+QJsonObject Database::getSellerOrderStatusTotals(int sellerId)
+{
+    DbReadLocker locker(this);
+    QJsonObject totals;
     
-    int method2Count = 0;
-    int method2MatchedCount = 0;
-    while (query2.next()) {
-        method2Count++;
-        QString orderId = query2.value("order_id").toString();
-        
-        // 跳过已经添加的订单
-        if (addedOrderIds.contains(orderId)) {
-            continue;
-        }
-        
-        // 解析items JSON，检查是否包含该商家的商品
-        QString itemsJson = query2.value("items").toString();
-        if (itemsJson.isEmpty()) {
-            continue;
-        }
-        
-        QJsonDocument doc = QJsonDocument::fromJson(itemsJson.toUtf8());
-        if (!doc.isArray()) {
-            continue;
-        }
-        
-        QJsonArray items = doc.array();
-        
-        // 检查订单项中是否有该商家的商品
-        bool hasSellerItem = false;
-        for (const QJsonValue &itemVal : items) {
-            QJsonObject item = itemVal.toObject();
-            // 检查多种可能的字段名：merchantId, merchant_id, sellerId
-            int itemMerchantId = -1;
-            if (item.contains("merchantId")) {
-                itemMerchantId = item["merchantId"].toInt();
-            } else if (item.contains("merchant_id")) {
-                itemMerchantId = item["merchant_id"].toInt();
-            } else if (item.contains("sellerId")) {
-                itemMerchantId = item["sellerId"].toInt();
-            }
-            
-            if (itemMerchantId == sellerId) {
-                hasSellerItem = true;
-                qDebug() << "getSellerOrders: 订单" << orderId << "包含商家" << sellerId << "的商品";
-                break;
-            }
-        }
-        
-        // 如果订单包含该商家的商品，添加到结果列表
-        if (hasSellerItem) {
-            QJsonObject order;
-            order["orderId"] = orderId;
-            order["userId"] = query2.value("user_id").toInt();
-            QVariant merchantIdValue = query2.value("merchant_id");
-            order["merchantId"] = (!merchantIdValue.isNull() && merchantIdValue.isValid()) ? merchantIdValue.toInt() : sellerId;
-            order["customer"] = query2.value("customer").toString();
-            order["phone"] = query2.value("phone").toString();
-            order["totalAmount"] = query2.value("total_amount").toDouble();
-            order["status"] = query2.value("status").toString();
-            order["paymentMethod"] = query2.value("payment_method").toString();
-            order["orderDate"] = query2.value("order_date").toString();
-            order["payTime"] = query2.value("pay_time").toString();
-            order["shipTime"] = query2.value("ship_time").toString();
-            order["cancelTime"] = query2.value("cancel_time").toString();
-            order["cancelReason"] = query2.value("cancel_reason").toString();
-            order["trackingNumber"] = query2.value("tracking_number").toString();
-            order["address"] = query2.value("address").toString();
-            order["operator"] = query2.value("operator").toString();
-            order["remark"] = query2.value("remark").toString();
-            order["items"] = items;
-            
-            orders.append(order);
-            addedOrderIds.insert(orderId);
-            method2MatchedCount++;
-        }
+    if (!isConnected() || sellerId <= 0) {
+        return totals;
     }
     
-    qDebug() << "getSellerOrders: 方法2检查了" << method2Count << "个订单，匹配" << method2MatchedCount << "个订单（通过items JSON）";
-    qDebug() << "getSellerOrders: 总共找到" << orders.size() << "个订单";
-    
-    // 如果没有找到订单，进行诊断
-    if (orders.isEmpty()) {
-        qDebug() << "getSellerOrders: 未找到订单，进行诊断查询";
-        
-        // 检查数据库中是否有订单
-        QSqlQuery diagQuery(m_db);
-        if (diagQuery.exec("SELECT COUNT(*) as count FROM orders")) {
-            if (diagQuery.next()) {
-                int totalOrders = diagQuery.value("count").toInt();
-                qDebug() << "getSellerOrders: 数据库中总订单数:" << totalOrders;
-            }
-        }
-        
-        // 检查merchant_id的分布
-        QSqlQuery merchantQuery(m_db);
-        if (merchantQuery.exec("SELECT DISTINCT merchant_id FROM orders WHERE merchant_id IS NOT NULL LIMIT 10")) {
-            qDebug() << "getSellerOrders: 数据库中的merchant_id分布:";
-            while (merchantQuery.next()) {
-                qDebug() << "  merchant_id:" << merchantQuery.value("merchant_id").toInt();
-            }
+    QSqlQuery query(locker.connection());
+    query.prepare("SELECT o.status, COUNT(*) AS count, COALESCE(SUM(o.total_amount), 0) AS amount "
+                  "FROM order_merchants om JOIN orders o ON o.order_id = om.order_id "
+                  "WHERE om.merchant_id = ? GROUP BY o.status");
+    query.addBindValue(sellerId);
+    if (!query.exec()) {
+        qWarning() << "查询商家订单状态汇总失败:" << query.lastError().text();
+        return totals;
+    }
+    while (query.next()) {
+        QJsonObject entry;
+        entry["count"] = query.value("count").toInt();
+        entry["amount"] = query.value("amount").toDouble();
+        totals[query.value("status").toString()] = entry;
+    }
+    return totals;
+}
+
+QJsonObject Database::getSellerCustomers(int merchantId, const QJsonObject& filters, int offset, int limit)
+{
+    DbReadLocker locker(this);
+    QJsonObject result;
+    QJsonArray members;
+
+    if (!isConnected()) {
+        result["members"] = members;
+        result["total"] = 0;
+        return result;
+    }
+
+    // 只返回状态正常的买家；条件都落在seller_customers的(merchant_id, ...)索引上，查询量只与该商家的客户数有关
+    QString from = " FROM seller_customers sc JOIN users u ON u.user_id = sc.user_id "
+                   "WHERE sc.merchant_id = ? AND u.role = 1 AND (u.status IS NULL OR u.status = '' OR u.status = '正常')";
+    QVariantList bindValues;
+    bindValues.append(merchantId);
+
+    const QString memberLevel = filters.value("memberLevel").toString();
+    if (!memberLevel.isEmpty()) {
+        from += " AND COALESCE(NULLIF(u.member_level, ''), '普通会员') = ?";
+        bindValues.append(memberLevel);
+    }
+    if (filters.contains("minSpent")) {
+        from += " AND sc.total_spent >= ?";
+        bindValues.append(filters.value("minSpent").toDouble());
+    }
+    if (filters.contains("maxSpent")) {
+        from += " AND sc.total_spent <= ?";
+        bindValues.append(filters.value("maxSpent").toDouble());
+    }
+    const int activeDays = filters.value("activeDays").toInt(0);
+    if (activeDays > 0) {
+        const QDateTime since = QDateTime::currentDateTime().addDays(-activeDays);
+        from += " AND sc.last_order >= ?";
+        bindValues.append(isSqlite() ? QVariant(since.toString(Qt::ISODate)) : QVariant(since));
+    }
+
+    QSqlQuery query(locker.connection());
+    int total = -1;
+    if (limit > 0) {
+        query.prepare("SELECT COUNT(*)" + from);
+        for (const QVariant &value : bindValues) {
+            query.addBindValue(value);
+        }
+        if (!query.exec() || !query.next()) {
+            qWarning() << "统计商家客户数失败:" << query.lastError().text();
+            result["members"] = members;
+            result["total"] = 0;
+            return result;
         }
+        total = query.value(0).toInt();
     }
-    
-    return orders;
+
+    QString sql = "SELECT sc.user_id, sc.first_order, sc.last_order, sc.total_spent, sc.order_count, "
+                  "u.username, u.email, u.register_date, u.member_level" + from +
+                  " ORDER BY sc.last_order DESC, sc.user_id";
+    if (limit > 0) {
+        sql += " LIMIT ? OFFSET ?";
+        bindValues.append(limit);
+        bindValues.append(qMax(0, offset));
+    }
+    query.prepare(sql);
+    for (const QVariant &value : bindValues) {
+        query.addBindValue(value);
+    }
+    if (!query.exec()) {
+        qWarning() << "查询商家客户失败:" << query.lastError().text();
+        result["members"] = members;
+        result["total"] = 0;
+        return result;
+    }
+
+    while (query.next()) {
+        QJsonObject member;
+        member["userId"] = query.value("user_id").toInt();
+        member["username"] = query.value("username").toString();
+        member["email"] = query.value("email").toString();
+        member["registerDate"] = query.value("register_date").toString();
+        QString level = query.value("member_level").toString();
+        member["memberLevel"] = level.isEmpty() ? QString("普通会员") : level;
+        member["firstOrder"] = query.value("first_order").toDateTime().toString("yyyy-MM-dd hh:mm:ss");
+        member["lastOrder"] = query.value("last_order").toDateTime().toString("yyyy-MM-dd hh:mm:ss");
+        member["totalSpent"] = query.value("total_spent").toDouble();
+        member["orderCount"] = query.value("order_count").toInt();
+        members.append(member);
+    }
+
+    result["members"] = members;
+    result["total"] = total >= 0 ? total : members.size();
+    return result;
 }
 
 bool Database::deleteOrder(const QString& orderId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
+    
+    if (!isConnected()) {
+        return false;
+    }
     
-    if (!isConnected()) {
+    if (!m_db.transaction()) {
+        qWarning() << "开始删除订单事务失败:" << m_db.lastError().text();
         return false;
     }
     
     QSqlQuery query(m_db);
     query.prepare("DELETE FROM orders WHERE order_id = ?");
     query.addBindValue(orderId);
-    
     if (!query.exec()) {
         qWarning() << "删除订单失败:" << query.lastError().text();
+        m_db.rollback();
         return false;
     }
+    const bool deleted = query.numRowsAffected() > 0;
     
-    return query.numRowsAffected() > 0;
+    query.prepare("DELETE FROM order_merchants WHERE order_id = ?");
+    query.addBindValue(orderId);
+    if (!query.exec() || !m_db.commit()) {
+        qWarning() << "删除订单-商家索引失败:" << query.lastError().text() << m_db.lastError().text();
+        m_db.rollback();
+        return false;
+    }
+    
+    return deleted;
 }
 
 QJsonObject Database::getOrder(const QString& orderId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonObject order;
     
     if (!isConnected()) {
@@ -3199,7 +3967,7 @@ QJsonObject Database::getOrder(const QString& orderId)
         return order;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     query.prepare("SELECT * FROM orders WHERE order_id = ?");
     query.addBindValue(orderId);
     
@@ -3242,234 +4010,771 @@ QJsonObject Database::getOrder(const QString& orderId)
     return order;
 }
 
-// ==========================================
-// 购物车相关
-// ==========================================
-
-bool Database::addToCart(int userId, const QString& bookId, int quantity)
+// ==========================================
+// 购物车相关
+// ==========================================
+
+bool Database::addToCart(int userId, const QString& bookId, int quantity)
+{
+    DbLocker locker(&m_mutex);
+    
+    if (!isConnected()) {
+        return false;
+    }
+    
+    QSqlQuery query(m_db);
+    query.prepare("INSERT INTO cart (user_id, book_id, quantity) VALUES (?, ?, ?) " +
+                  upsertClause("user_id, book_id") + "quantity = quantity + ?");
+    query.addBindValue(userId);
+    query.addBindValue(bookId);
+    query.addBindValue(quantity);
+    query.addBindValue(quantity);
+    
+    if (!query.exec()) {
+        qWarning() << "添加到购物车失败:" << query.lastError().text();
+        return false;
+    }
+    
+    return true;
+}
+
+QJsonArray Database::getCart(int userId, bool* ok)
+{
+    DbReadLocker locker(this);
+    QJsonArray cart;
+    
+    if (ok) {
+        *ok = false;
+    }
+    
+    if (!isConnected()) {
+        return cart;
+    }
+    
+    QSqlQuery query(locker.connection());
+    query.prepare("SELECT c.*, b.title, b.price FROM cart c "
+                 "LEFT JOIN books b ON c.book_id = b.isbn "
+                 "WHERE c.user_id = ? ORDER BY c.cart_id");
+    query.addBindValue(userId);
+    
+    if (!query.exec()) {
+        qWarning() << "查询购物车失败:" << query.lastError().text();
+        return cart;
+    }
+    
+    while (query.next()) {
+        QJsonObject item;
+        item["cartId"] = query.value("cart_id").toInt();
+        item["bookId"] = query.value("book_id").toString();
+        item["bookName"] = query.value("title").toString();
+        item["price"] = query.value("price").toDouble();
+        item["quantity"] = query.value("quantity").toInt();
+        item["addTime"] = query.value("add_time").toString().replace('T', ' ').left(19);
+        cart.append(item);
+    }
+    
+    if (ok) {
+        *ok = true;
+    }
+    return cart;
+}
+
+bool Database::updateCartQuantity(int userId, const QString& bookId, int quantity)
+{
+    DbLocker locker(&m_mutex);
+    
+    if (!isConnected()) {
+        return false;
+    }
+    
+    // 如果数量为0或负数，则删除该记录
+    if (quantity <= 0) {
+        return removeFromCart(userId, bookId);
+    }
+    
+    QSqlQuery query(m_db);
+    query.prepare("UPDATE cart SET quantity = ? WHERE user_id = ? AND book_id = ?");
+    query.addBindValue(quantity);
+    query.addBindValue(userId);
+    query.addBindValue(bookId);
+    
+    if (!query.exec()) {
+        qWarning() << "更新购物车数量失败:" << query.lastError().text();
+        return false;
+    }
+    
+    if (query.numRowsAffected() == 0) {
+        qWarning() << "未找到要更新的购物车项，用户ID:" << userId << "图书ID:" << bookId;
+        return false;
+    }
+    
+    qDebug() << "购物车数量更新成功，用户ID:" << userId << "图书ID:" << bookId << "新数量:" << quantity;
+    return true;
+}
+
+bool Database::removeFromCart(int userId, const QString& bookId)
+{
+    DbLocker locker(&m_mutex);
+    
+    if (!isConnected()) {
+        return false;
+    }
+    
+    QSqlQuery query(m_db);
+    query.prepare("DELETE FROM cart WHERE user_id = ? AND book_id = ?");
+    query.addBindValue(userId);
+    query.addBindValue(bookId);
+    
+    if (!query.exec()) {
+        qWarning() << "从购物车移除失败:" << query.lastError().text();
+        return false;
+    }
+    
+    qDebug() << "从购物车移除成功，用户ID:" << userId << "图书ID:" << bookId;
+    return true;
+}
+
+bool Database::clearCart(int userId)
+{
+    DbLocker locker(&m_mutex);
+    
+    if (!isConnected()) {
+        return false;
+    }
+    
+    QSqlQuery query(m_db);
+    query.prepare("DELETE FROM cart WHERE user_id = ?");
+    query.addBindValue(userId);
+    
+    if (!query.exec()) {
+        qWarning() << "清空购物车失败:" << query.lastError().text();
+        return false;
+    }
+    
+    return true;
+}
+
+bool Database::replaceCarts(const QMap<int, QJsonArray>& carts)
+{
+    DbLocker locker(&m_mutex);
+    
+    if (!isConnected()) {
+        return false;
+    }
+    
+    if (carts.isEmpty()) {
+        return true;
+    }
+    
+    QVariantList userIds;
+    QVariantList lineUserIds;
+    QVariantList lineBookIds;
+    QVariantList lineQuantities;
+    QVariantList lineAddTimes;
+    for (auto it = carts.constBegin(); it != carts.constEnd(); ++it) {
+        userIds << it.key();
+        for (const QJsonValue &lineVal : it.value()) {
+            QJsonObject line = lineVal.toObject();
+            lineUserIds << it.key();
+            lineBookIds << line["bookId"].toString();
+            lineQuantities << line["quantity"].toInt();
+            lineAddTimes << line["addTime"].toString();
+        }
+    }
+    
+    if (!m_db.transaction()) {
+        qWarning() << "开始购物车写回事务失败:" << m_db.lastError().text();
+        return false;
+    }
+    
+    // 先删除这些用户的全部记录，再按内存中的顺序插入（保留加入时间）
+    QSqlQuery deleteQuery(m_db);
+    deleteQuery.prepare("DELETE FROM cart WHERE user_id = ?");
+    deleteQuery.addBindValue(userIds);
+    bool success = deleteQuery.execBatch();
+    if (!success) {
+        qWarning() << "写回购物车（删除旧记录）失败:" << deleteQuery.lastError().text();
+    }
+    
+    if (success && !lineUserIds.isEmpty()) {
+        QSqlQuery insertQuery(m_db);
+        insertQuery.prepare("INSERT INTO cart (user_id, book_id, quantity, add_time) VALUES (?, ?, ?, ?)");
+        insertQuery.addBindValue(lineUserIds);
+        insertQuery.addBindValue(lineBookIds);
+        insertQuery.addBindValue(lineQuantities);
+        insertQuery.addBindValue(lineAddTimes);
+        success = insertQuery.execBatch();
+        if (!success) {
+            qWarning() << "写回购物车（插入记录）失败:" << insertQuery.lastError().text();
+        }
+    }
+    
+    if (!success || !m_db.commit()) {
+        if (success) {
+            qWarning() << "提交购物车写回事务失败:" << m_db.lastError().text();
+        }
+        m_db.rollback();
+        return false;
+    }
+    
+    return true;
+}
+
+QJsonArray Database::getBookBasics(const QStringList& isbns)
+{
+    DbReadLocker locker(this);
+    QJsonArray books;
+    
+    if (!isConnected() || isbns.isEmpty()) {
+        return books;
+    }
+    
+    QStringList placeholders;
+    for (int i = 0; i < isbns.size(); ++i) {
+        placeholders << "?";
+    }
+    
+    QSqlQuery query(locker.connection());
+    query.prepare("SELECT isbn, title, price FROM books WHERE isbn IN (" + placeholders.join(",") + ")");
+    for (const QString &isbn : isbns) {
+        query.addBindValue(isbn);
+    }
+    
+    if (!query.exec()) {
+        qWarning() << "批量查询图书信息失败:" << query.lastError().text();
+        return books;
+    }
+    
+    while (query.next()) {
+        QJsonObject book;
+        book["bookId"] = query.value("isbn").toString();
+        book["bookName"] = query.value("title").toString();
+        book["price"] = query.value("price").toDouble();
+        books.append(book);
+    }
+    
+    return books;
+}
+
+// ==========================================
+// 组提交
+// ==========================================
+
+// 每条多行语句最多合并的行数（SQLite单条语句的占位符数量有上限）
+static const int kMaxRowsPerStatement = 100;
+
+bool Database::execWriteRun(const QVector<PendingWrite>& writes, int begin, int end)
+{
+    const int rows = end - begin;
+    QStringList tuples;
+    QString sql;
+    switch (writes.at(begin).kind) {
+    case PendingWrite::ChatMessage:
+        for (int i = 0; i < rows; ++i) {
+            tuples << "(?, ?, ?, ?, ?)";
+        }
+        sql = "INSERT INTO chat_messages (sender_id, sender_type, receiver_id, receiver_type, message_content) "
+              "VALUES " + tuples.join(", ");
+        break;
+    case PendingWrite::AddFavorite:
+        for (int i = 0; i < rows; ++i) {
+            tuples << "(?, ?)";
+        }
+        sql = dialect("INSERT INTO favorites (user_id, book_id) VALUES " + tuples.join(", ") + " " +
+                      upsertClause("user_id, book_id") + "add_time = CURRENT_TIMESTAMP");
+        break;
+    case PendingWrite::RemoveFavorite:
+        for (int i = 0; i < rows; ++i) {
+            tuples << "(user_id = ? AND book_id = ?)";
+        }
+        sql = "DELETE FROM favorites WHERE " + tuples.join(" OR ");
+        break;
+    case PendingWrite::Review:
+        // 多行upsert用VALUES(col)引用本行的新值（SQLite下由dialect转换为excluded.col）
+        for (int i = 0; i < rows; ++i) {
+            tuples << "(?, ?, ?, ?, NOW())";
+        }
+        sql = dialect("INSERT INTO reviews (user_id, book_id, rating, comment, review_time) VALUES " + tuples.join(", ") + " " +
+                      upsertClause("user_id, book_id") + "rating = VALUES(rating), comment = VALUES(comment), review_time = NOW()");
+        break;
+    case PendingWrite::UserCoupon:
+        for (int i = 0; i < rows; ++i) {
+            tuples << "(?, ?, ?, '未使用', ?)";
+        }
+        sql = "INSERT INTO user_coupons (user_id, coupon_type, coupon_value, status, expire_time) "
+              "VALUES " + tuples.join(", ");
+        break;
+    }
+    
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    for (int i = begin; i < end; ++i) {
+        for (const QVariant &value : writes.at(i).values) {
+            query.addBindValue(value);
+        }
+    }
+    
+    if (!query.exec()) {
+        qWarning() << "组提交语句执行失败（类型" << writes.at(begin).kind << "，" << rows << "行）:" << query.lastError().text();
+        return false;
+    }
+    if (writes.at(begin).kind == PendingWrite::UserCoupon) {
+        return addToCouponWalletUnlocked(writes, begin, end);  // 与明细在同一事务中累加钱包
+    }
+    if (writes.at(begin).kind == PendingWrite::ChatMessage) {
+        // 多行INSERT后MySQL返回第一行的ID，SQLite返回最后一行的ID（SQLite写入独占，同一语句的ID连续）
+        const qint64 lastId = query.lastInsertId().toLongLong();
+        const qint64 firstId = isSqlite() ? lastId - (rows - 1) : lastId;
+        QVector<qint64> messageIds;
+        if (!readBackMessageIdsUnlocked(writes, begin, end, firstId, &messageIds)) {
+            return false;
+        }
+        return updateConversationsUnlocked(writes, begin, end, messageIds);
+    }
+    return true;
+}
+
+// MySQL的自增ID不保证连续（innodb_autoinc_lock_mode=2，或多个节点共用数据库时与其他写入交错），
+// 因此从本批第一行的ID起按ID顺序读回，依次与本批各行按发送方、接收方和内容匹配
+bool Database::readBackMessageIdsUnlocked(const QVector<PendingWrite>& writes, int begin, int end, qint64 firstMessageId, QVector<qint64>* messageIds)
+{
+    QSqlQuery query(m_db);
+    query.prepare("SELECT message_id, sender_id, sender_type, receiver_id, receiver_type, message_content "
+                  "FROM chat_messages WHERE message_id >= ? ORDER BY message_id");
+    query.addBindValue(firstMessageId);
+    if (!query.exec()) {
+        qWarning() << "读回聊天消息ID失败:" << query.lastError().text();
+        return false;
+    }
+    
+    messageIds->clear();
+    messageIds->reserve(end - begin);
+    int next = begin;
+    while (next < end && query.next()) {
+        const QVariantList &values = writes.at(next).values;
+        const ChatParticipant receiver = chatReceiver(values.at(2), values.at(3));
+        const ChatParticipant rowReceiver = chatReceiver(query.value("receiver_id"), query.value("receiver_type"));
+        if (query.value("sender_id").toInt() == values.at(0).toInt()
+            && query.value("sender_type").toString() == values.at(1).toString()
+            && rowReceiver.id == receiver.id && rowReceiver.type == receiver.type
+            && query.value("message_content").toString() == values.at(4).toString()) {
+            messageIds->append(query.value("message_id").toLongLong());
+            ++next;
+        }
+    }
+    if (next < end) {
+        qWarning() << "读回聊天消息ID失败：只匹配到" << (next - begin) << "/" << (end - begin) << "条";
+        return false;
+    }
+    return true;
+}
+
+bool Database::updateConversationsUnlocked(const QVector<PendingWrite>& writes, int begin, int end, const QVector<qint64>& messageIds)
+{
+    // 每条消息更新双方的会话行：最近消息都指向它，接收方未读数加一；同一批中相同的会话合并为一行
+    struct Update {
+        qint64 lastMessageId = 0;
+        int unread = 0;
+    };
+    QMap<ConversationKey, Update> updates;
+    for (int i = begin; i < end; ++i) {
+        const QVariantList &values = writes.at(i).values;
+        const ChatParticipant sender = {values.at(0).toInt(), values.at(1).toString()};
+        const ChatParticipant receiver = chatReceiver(values.at(2), values.at(3));
+        const qint64 messageId = messageIds.at(i - begin);
+        updates[ConversationKey{sender, receiver}].lastMessageId = messageId;
+        Update &received = updates[ConversationKey{receiver, sender}];
+        received.lastMessageId = messageId;
+        ++received.unread;
+    }
+    
+    QList<ConversationKey> keys = updates.keys();
+    for (int chunk = 0; chunk < keys.size(); chunk += kMaxRowsPerStatement) {
+        const int chunkEnd = qMin(keys.size(), chunk + kMaxRowsPerStatement);
+        QStringList tuples;
+        for (int i = chunk; i < chunkEnd; ++i) {
+            tuples << "(?, ?, ?, ?, ?, NOW(), ?)";
+        }
+        QSqlQuery query(m_db);
+        query.prepare(dialect("INSERT INTO conversations (user_id, user_type, peer_id, peer_type, last_message_id, last_time, unread_count) "
+                              "VALUES " + tuples.join(", ") + " " + upsertClause("user_id, user_type, peer_id, peer_type") +
+                              "last_message_id = VALUES(last_message_id), last_time = VALUES(last_time), "
+                              "unread_count = unread_count + VALUES(unread_count)"));
+        for (int i = chunk; i < chunkEnd; ++i) {
+            const ConversationKey &key = keys.at(i);
+            query.addBindValue(key.owner.id);
+            query.addBindValue(key.owner.type);
+            query.addBindValue(key.peer.id);
+            query.addBindValue(key.peer.type);
+            query.addBindValue(updates.value(key).lastMessageId);
+            query.addBindValue(updates.value(key).unread);
+        }
+        if (!query.exec()) {
+            qWarning() << "更新聊天会话失败:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Database::execWriteGroup(const QVector<PendingWrite>& writes, int begin, int end)
+{
+    if (!m_db.transaction()) {
+        qWarning() << "开始组提交事务失败:" << m_db.lastError().text();
+        return false;
+    }
+    
+    // 按提交顺序执行，相邻的同类写操作合并为一条语句（同一收藏先加后删的顺序不会被打乱）
+    bool success = true;
+    QSet<QString> touchedBooks;  // 评分或收藏数需要更新的图书
+    for (int runBegin = begin; success && runBegin < end;) {
+        int runEnd = runBegin + 1;
+        while (runEnd < end && runEnd - runBegin < kMaxRowsPerStatement
+               && writes.at(runEnd).kind == writes.at(runBegin).kind) {
+            ++runEnd;
+        }
+        success = execWriteRun(writes, runBegin, runEnd);
+        for (int i = runBegin; i < runEnd; ++i) {
+            PendingWrite::Kind kind = writes.at(i).kind;
+            if (kind == PendingWrite::AddFavorite || kind == PendingWrite::RemoveFavorite || kind == PendingWrite::Review) {
+                touchedBooks.insert(writes.at(i).values.at(1).toString());
+            }
+        }
+        runBegin = runEnd;
+    }
+    
+    // 同一事务内更新这些图书的评分总分/评论数/收藏数，读取时不再需要聚合查询
+    if (success && !touchedBooks.isEmpty()) {
+        QStringList placeholders;
+        for (int i = 0; i < touchedBooks.size(); ++i) {
+            placeholders << "?";
+        }
+        QSqlQuery statsQuery(m_db);
+        statsQuery.prepare(QString(kRecountBookStatsSql) + " WHERE isbn IN (" + placeholders.join(",") + ")");
+        for (const QString &isbn : touchedBooks) {
+            statsQuery.addBindValue(isbn);
+        }
+        success = statsQuery.exec();
+        if (!success) {
+            qWarning() << "更新图书评分/收藏数失败:" << statsQuery.lastError().text();
+        }
+    }
+    
+    if (success && m_db.commit()) {
+        return true;
+    }
+    if (success) {
+        qWarning() << "提交组提交事务失败:" << m_db.lastError().text();
+    }
+    m_db.rollback();
+    return false;
+}
+
+bool Database::commitWriteGroup(const QVector<PendingWrite>& writes, QVector<bool>* results)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
-    if (!isConnected()) {
-        return false;
+    results->fill(false, writes.size());
+    if (!isConnected() || writes.isEmpty()) {
+        return writes.isEmpty();
     }
     
-    QSqlQuery query(m_db);
-    query.prepare("INSERT INTO cart (user_id, book_id, quantity) VALUES (?, ?, ?) "
-                 "ON DUPLICATE KEY UPDATE quantity = quantity + ?");
-    query.addBindValue(userId);
-    query.addBindValue(bookId);
-    query.addBindValue(quantity);
-    query.addBindValue(quantity);
-    
-    if (!query.exec()) {
-        qWarning() << "添加到购物车失败:" << query.lastError().text();
+    if (execWriteGroup(writes, 0, writes.size())) {
+        results->fill(true);
+        return true;
+    }
+    if (writes.size() == 1) {
         return false;
     }
     
-    return true;
+    // 整组失败：逐个单独执行，每个调用方拿到自己的结果
+    qWarning() << "组提交失败，逐个重试" << writes.size() << "个写操作";
+    bool allSucceeded = true;
+    for (int i = 0; i < writes.size(); ++i) {
+        (*results)[i] = execWriteGroup(writes, i, i + 1);
+        allSucceeded = allSucceeded && (*results)[i];
+    }
+    return allSucceeded;
 }
 
-QJsonArray Database::getCart(int userId)
+// 校对图书的评分/收藏计数：按reviews和favorites重新统计，只更新与实际不一致的行
+// （后台定时执行，修正直接改库、删除用户/图书等未经组提交的变更造成的偏差）
+int Database::reconcileBookStats()
 {
-    QMutexLocker locker(&m_mutex);
-    QJsonArray cart;
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
-        return cart;
+        return -1;
     }
     
     QSqlQuery query(m_db);
-    query.prepare("SELECT c.*, b.title, b.price FROM cart c "
-                 "LEFT JOIN books b ON c.book_id = b.isbn "
-                 "WHERE c.user_id = ?");
-    query.addBindValue(userId);
-    
-    if (!query.exec()) {
-        qWarning() << "查询购物车失败:" << query.lastError().text();
-        return cart;
+    QString sql = QString(kRecountBookStatsSql) + " WHERE "
+        "rating_sum <> (SELECT COALESCE(SUM(rating), 0) FROM reviews WHERE reviews.book_id = books.isbn) "
+        "OR rating_count <> (SELECT COUNT(*) FROM reviews WHERE reviews.book_id = books.isbn) "
+        "OR favorite_count <> (SELECT COUNT(*) FROM favorites WHERE favorites.book_id = books.isbn) "
+        "OR rating_sum IS NULL OR rating_count IS NULL OR favorite_count IS NULL";
+    if (!query.exec(sql)) {
+        qWarning() << "❌ 校对图书评分/收藏计数失败:" << query.lastError().text();
+        return -1;
     }
     
-    while (query.next()) {
-        QJsonObject item;
-        item["cartId"] = query.value("cart_id").toInt();
-        item["bookId"] = query.value("book_id").toString();
-        item["bookName"] = query.value("title").toString();
-        item["price"] = query.value("price").toDouble();
-        item["quantity"] = query.value("quantity").toInt();
-        cart.append(item);
+    int fixed = query.numRowsAffected();
+    if (fixed > 0) {
+        qDebug() << "✓ 图书评分/收藏计数已校对，修正" << fixed << "本";
     }
-    
-    return cart;
+    return fixed;
 }
 
-bool Database::updateCartQuantity(int userId, const QString& bookId, int quantity)
+// ==========================================
+// 收藏相关
+// ==========================================
+
+bool Database::addFavorite(int userId, const QString& bookId)
 {
-    QMutexLocker locker(&m_mutex);
-    
     if (!isConnected()) {
         return false;
     }
     
-    // 如果数量为0或负数，则删除该记录
-    if (quantity <= 0) {
-        return removeFromCart(userId, bookId);
+    PendingWrite write;
+    write.kind = PendingWrite::AddFavorite;
+    write.values << userId << bookId;
+    if (!GroupCommitQueue::getInstance().execute(write)) {
+        qWarning() << "添加到收藏失败，用户ID:" << userId << "图书ID:" << bookId;
+        return false;
     }
     
-    QSqlQuery query(m_db);
-    query.prepare("UPDATE cart SET quantity = ? WHERE user_id = ? AND book_id = ?");
-    query.addBindValue(quantity);
-    query.addBindValue(userId);
-    query.addBindValue(bookId);
-    
-    if (!query.exec()) {
-        qWarning() << "更新购物车数量失败:" << query.lastError().text();
+    qDebug() << "添加到收藏成功，用户ID:" << userId << "图书ID:" << bookId;
+    return true;
+}
+
+bool Database::removeFavorite(int userId, const QString& bookId)
+{
+    if (!isConnected()) {
         return false;
     }
     
-    if (query.numRowsAffected() == 0) {
-        qWarning() << "未找到要更新的购物车项，用户ID:" << userId << "图书ID:" << bookId;
+    PendingWrite write;
+    write.kind = PendingWrite::RemoveFavorite;
+    write.values << userId << bookId;
+    if (!GroupCommitQueue::getInstance().execute(write)) {
+        qWarning() << "从收藏移除失败，用户ID:" << userId << "图书ID:" << bookId;
         return false;
     }
     
-    qDebug() << "购物车数量更新成功，用户ID:" << userId << "图书ID:" << bookId << "新数量:" << quantity;
+    qDebug() << "从收藏移除成功，用户ID:" << userId << "图书ID:" << bookId;
     return true;
 }
 
-bool Database::removeFromCart(int userId, const QString& bookId)
+QJsonArray Database::getUserFavorites(int userId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
+    QJsonArray favorites;
     
     if (!isConnected()) {
-        return false;
+        return favorites;
     }
     
-    QSqlQuery query(m_db);
-    query.prepare("DELETE FROM cart WHERE user_id = ? AND book_id = ?");
+    QSqlQuery query(locker.connection());
+    query.prepare("SELECT book_id FROM favorites WHERE user_id = ? ORDER BY add_time DESC");
     query.addBindValue(userId);
-    query.addBindValue(bookId);
     
     if (!query.exec()) {
-        qWarning() << "从购物车移除失败:" << query.lastError().text();
-        return false;
+        qWarning() << "查询收藏列表失败:" << query.lastError().text();
+        return favorites;
     }
     
-    qDebug() << "从购物车移除成功，用户ID:" << userId << "图书ID:" << bookId;
-    return true;
+    while (query.next()) {
+        favorites.append(query.value("book_id").toString());
+    }
+    
+    return favorites;
 }
 
-bool Database::clearCart(int userId)
+int Database::getBookFavoriteCount(const QString& bookId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     
     if (!isConnected()) {
-        return false;
+        return 0;
     }
     
-    QSqlQuery query(m_db);
-    query.prepare("DELETE FROM cart WHERE user_id = ?");
-    query.addBindValue(userId);
+    QSqlQuery query(locker.connection());
+    query.prepare("SELECT favorite_count FROM books WHERE isbn = ?");
+    query.addBindValue(bookId);
     
     if (!query.exec()) {
-        qWarning() << "清空购物车失败:" << query.lastError().text();
-        return false;
+        qWarning() << "查询收藏量失败:" << query.lastError().text();
+        return 0;
     }
     
-    return true;
+    return query.next() ? query.value("favorite_count").toInt() : 0;
 }
 
 // ==========================================
-// 收藏相关
+// 推荐相关
 // ==========================================
 
-bool Database::addFavorite(int userId, const QString& bookId)
+// 解析订单items JSON中的图书ID（同一订单内去重）
+static QStringList orderItemBookIds(const QString& itemsJson)
 {
-    QMutexLocker locker(&m_mutex);
-    
-    if (!isConnected()) {
-        return false;
+    QStringList bookIds;
+    QJsonDocument doc = QJsonDocument::fromJson(itemsJson.toUtf8());
+    if (!doc.isArray()) {
+        return bookIds;
     }
-    
-    QSqlQuery query(m_db);
-    query.prepare("INSERT INTO favorites (user_id, book_id) VALUES (?, ?) "
-                 "ON DUPLICATE KEY UPDATE add_time = CURRENT_TIMESTAMP");
-    query.addBindValue(userId);
-    query.addBindValue(bookId);
-    
-    if (!query.exec()) {
-        qWarning() << "添加到收藏失败:" << query.lastError().text();
-        return false;
+    for (const QJsonValue &itemVal : doc.array()) {
+        QString bookId = itemVal.toObject()["bookId"].toString();
+        if (!bookId.isEmpty() && !bookIds.contains(bookId)) {
+            bookIds.append(bookId);
+        }
     }
-    
-    qDebug() << "添加到收藏成功，用户ID:" << userId << "图书ID:" << bookId;
-    return true;
+    return bookIds;
 }
 
-bool Database::removeFavorite(int userId, const QString& bookId)
+QJsonArray Database::getInteractionEvents(const QString& sinceDate)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
+    QJsonArray events;
     
     if (!isConnected()) {
-        return false;
+        return events;
     }
     
-    QSqlQuery query(m_db);
-    query.prepare("DELETE FROM favorites WHERE user_id = ? AND book_id = ?");
-    query.addBindValue(userId);
-    query.addBindValue(bookId);
+    QSqlQuery query(locker.connection());
+    query.prepare("SELECT user_id, items, order_date FROM orders "
+                  "WHERE status <> '已取消' AND user_id IS NOT NULL AND order_date >= ?");
+    query.addBindValue(sinceDate);
     
     if (!query.exec()) {
-        qWarning() << "从收藏移除失败:" << query.lastError().text();
-        return false;
+        qWarning() << "查询推荐用订单失败:" << query.lastError().text();
+        return events;
     }
     
-    qDebug() << "从收藏移除成功，用户ID:" << userId << "图书ID:" << bookId;
-    return true;
+    while (query.next()) {
+        QStringList bookIds = orderItemBookIds(query.value("items").toString());
+        if (bookIds.isEmpty()) {
+            continue;
+        }
+        QJsonObject event;
+        event["userId"] = query.value("user_id").toInt();
+        event["type"] = "order";
+        event["date"] = query.value("order_date").toString().left(10);
+        event["bookIds"] = QJsonArray::fromStringList(bookIds);
+        events.append(event);
+    }
+    
+    QSqlQuery favQuery(locker.connection());
+    favQuery.prepare("SELECT user_id, book_id, add_time FROM favorites WHERE add_time >= ?");
+    favQuery.addBindValue(sinceDate);
+    
+    if (!favQuery.exec()) {
+        qWarning() << "查询推荐用收藏失败:" << favQuery.lastError().text();
+        return events;
+    }
+    
+    while (favQuery.next()) {
+        QJsonObject event;
+        event["userId"] = favQuery.value("user_id").toInt();
+        event["type"] = "favorite";
+        event["date"] = favQuery.value("add_time").toString().left(10);
+        event["bookIds"] = QJsonArray{favQuery.value("book_id").toString()};
+        events.append(event);
+    }
+    
+    return events;
 }
 
-QJsonArray Database::getUserFavorites(int userId)
+QStringList Database::getUserRecentBookIds(int userId, int limit)
 {
-    QMutexLocker locker(&m_mutex);
-    QJsonArray favorites;
+    DbReadLocker locker(this);
+    QStringList bookIds;
     
-    if (!isConnected()) {
-        return favorites;
+    if (!isConnected() || limit <= 0) {
+        return bookIds;
     }
     
-    QSqlQuery query(m_db);
-    query.prepare("SELECT book_id FROM favorites WHERE user_id = ? ORDER BY add_time DESC");
+    // (时间, 图书ID)；时间统一成"yyyy-MM-dd hh:mm:ss"便于比较（SQLite存储为ISO格式）
+    QList<QPair<QString, QString>> timeline;
+    
+    QSqlQuery query(locker.connection());
+    query.prepare("SELECT items, order_date FROM orders WHERE user_id = ? AND status <> '已取消' "
+                  "ORDER BY order_date DESC LIMIT ?");
     query.addBindValue(userId);
+    query.addBindValue(limit);
     
     if (!query.exec()) {
-        qWarning() << "查询收藏列表失败:" << query.lastError().text();
-        return favorites;
+        qWarning() << "查询用户最近订单失败:" << query.lastError().text();
+        return bookIds;
     }
     
     while (query.next()) {
-        favorites.append(query.value("book_id").toString());
+        QString time = query.value("order_date").toString().replace('T', ' ');
+        for (const QString &bookId : orderItemBookIds(query.value("items").toString())) {
+            timeline.append(qMakePair(time, bookId));
+        }
     }
     
-    return favorites;
+    QSqlQuery favQuery(locker.connection());
+    favQuery.prepare("SELECT book_id, add_time FROM favorites WHERE user_id = ? ORDER BY add_time DESC LIMIT ?");
+    favQuery.addBindValue(userId);
+    favQuery.addBindValue(limit);
+    
+    if (!favQuery.exec()) {
+        qWarning() << "查询用户最近收藏失败:" << favQuery.lastError().text();
+        return bookIds;
+    }
+    
+    while (favQuery.next()) {
+        timeline.append(qMakePair(favQuery.value("add_time").toString().replace('T', ' '),
+                                  favQuery.value("book_id").toString()));
+    }
+    
+    std::stable_sort(timeline.begin(), timeline.end(),
+                     [](const QPair<QString, QString> &a, const QPair<QString, QString> &b) {
+                         return a.first > b.first;
+                     });
+    
+    for (const auto &entry : timeline) {
+        if (!bookIds.contains(entry.second)) {
+            bookIds.append(entry.second);
+            if (bookIds.size() >= limit) {
+                break;
+            }
+        }
+    }
+    
+    return bookIds;
 }
 
-int Database::getBookFavoriteCount(const QString& bookId)
+QJsonArray Database::getBookSummaries()
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
+    QJsonArray books;
     
     if (!isConnected()) {
-        return 0;
+        return books;
     }
     
-    QSqlQuery query(m_db);
-    query.prepare("SELECT COUNT(*) as count FROM favorites WHERE book_id = ?");
-    query.addBindValue(bookId);
+    QSqlQuery query(locker.connection());
+    if (!query.exec("SELECT isbn, title, author, category1, category2, merchant_id, price "
+                    "FROM books WHERE status = '正常'")) {
+        qWarning() << "查询图书基本信息失败:" << query.lastError().text();
+        return books;
+    }
     
-    if (!query.exec() || !query.next()) {
-        qWarning() << "查询收藏量失败:" << query.lastError().text();
-        return 0;
+    while (query.next()) {
+        QJsonObject book;
+        book["bookId"] = query.value("isbn").toString();
+        book["bookName"] = query.value("title").toString();
+        book["author"] = query.value("author").toString();
+        book["category1"] = query.value("category1").toString();
+        book["category2"] = query.value("category2").toString();
+        book["merchantId"] = query.value("merchant_id").toInt();
+        book["price"] = query.value("price").toDouble();
+        books.append(book);
     }
     
-    return query.value("count").toInt();
+    return books;
 }
 
 // ==========================================
@@ -3478,7 +4783,7 @@ int Database::getBookFavoriteCount(const QString& bookId)
 
 bool Database::addMember(const QJsonObject& member)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -3505,7 +4810,7 @@ bool Database::addMember(const QJsonObject& member)
 
 bool Database::updateMember(const QString& cardNo, const QJsonObject& member)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -3558,7 +4863,7 @@ bool Database::updateMember(const QString& cardNo, const QJsonObject& member)
 
 bool Database::deleteMember(const QString& cardNo)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -3578,14 +4883,14 @@ bool Database::deleteMember(const QString& cardNo)
 
 QJsonArray Database::getAllMembers()
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray members;
     
     if (!isConnected()) {
         return members;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     if (!query.exec("SELECT * FROM members ORDER BY create_date DESC")) {
         qWarning() << "查询会员列表失败:" << query.lastError().text();
         return members;
@@ -3608,7 +4913,7 @@ QJsonArray Database::getAllMembers()
 
 bool Database::rechargeMember(const QString& cardNo, double amount)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -3634,7 +4939,7 @@ bool Database::rechargeMember(const QString& cardNo, double amount)
 // ===== 卖家申诉相关 =====
 bool Database::submitSellerAppeal(int sellerId, const QString& sellerName, const QString& appealReason)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -3658,14 +4963,14 @@ bool Database::submitSellerAppeal(int sellerId, const QString& sellerName, const
 
 QJsonObject Database::getSellerAppeal(int sellerId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonObject appeal;
     
     if (!isConnected()) {
         return appeal;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     query.prepare("SELECT * FROM seller_appeals WHERE seller_id = ? ORDER BY submit_time DESC LIMIT 1");
     query.addBindValue(sellerId);
     
@@ -3692,14 +4997,14 @@ QJsonObject Database::getSellerAppeal(int sellerId)
 
 QJsonArray Database::getAllAppeals(const QString& status)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray appeals;
     
     if (!isConnected()) {
         return appeals;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     QString sql = "SELECT * FROM seller_appeals";
     if (!status.isEmpty()) {
         sql += " WHERE status = ?";
@@ -3742,7 +5047,7 @@ bool Database::reviewSellerAppeal(int appealId, int reviewerId, const QString& s
     
     // 第一步：获取seller_id（如果需要解封），并更新申诉状态
     {
-        QMutexLocker locker(&m_mutex);
+        DbLocker locker(&m_mutex);
         
         if (!isConnected()) {
             return false;
@@ -3763,8 +5068,8 @@ bool Database::reviewSellerAppeal(int appealId, int reviewerId, const QString& s
         
         // 更新申诉状态
         QSqlQuery query(m_db);
-        query.prepare("UPDATE seller_appeals SET status = ?, reviewer_id = ?, review_time = NOW(), review_comment = ? "
-                     "WHERE appeal_id = ?");
+        query.prepare(dialect("UPDATE seller_appeals SET status = ?, reviewer_id = ?, review_time = NOW(), review_comment = ? "
+                              "WHERE appeal_id = ?"));
         query.addBindValue(status);
         query.addBindValue(reviewerId);
         query.addBindValue(reviewComment);
@@ -3795,69 +5100,63 @@ bool Database::reviewSellerAppeal(int appealId, int reviewerId, const QString& s
 
 QJsonObject Database::getSystemStats()
 {
-    QMutexLocker locker(&m_mutex);
-    QJsonObject stats;
+    if (!isConnected()) {
+        return QJsonObject();
+    }
+    return PlatformCounters::getInstance().systemStats();
+}
+
+// 计数事件都在写锁内发出：统计和写回计数也持有这把锁，中间不会插入已提交但未计入的写入，
+// 写回的就是精确值（只读连接做不到这一点，SQLite读连接与写入并行）
+bool Database::reconcilePlatformCounters(PlatformTotals& totals, int* drift)
+{
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
-        return stats;
+        return false;
     }
     
     QSqlQuery query(m_db);
     
-    // 统计用户数
-    if (query.exec("SELECT COUNT(*) FROM users")) {
-        if (query.next()) {
-            stats["totalUsers"] = query.value(0).toInt();
-        }
+    // 用户总数、买家数（role = 1）和申请卖家审核中的用户数（role = 0）一次扫描统计
+    if (!query.exec("SELECT COUNT(*), "
+                    "COALESCE(SUM(CASE WHEN role = 1 THEN 1 ELSE 0 END), 0), "
+                    "COALESCE(SUM(CASE WHEN role = 0 THEN 1 ELSE 0 END), 0) FROM users") || !query.next()) {
+        qWarning() << "统计用户数失败:" << query.lastError().text();
+        return false;
     }
+    totals.users = query.value(0).toInt();
+    totals.buyers = query.value(1).toInt();
+    totals.applicants = query.value(2).toInt();
     
-    // 统计买家数（role = 1）
-    if (query.exec("SELECT COUNT(*) FROM users WHERE role = 1")) {
-        if (query.next()) {
-            stats["totalBuyers"] = query.value(0).toInt();
-        }
+    if (!query.exec("SELECT COUNT(*) FROM sellers") || !query.next()) {
+        qWarning() << "统计商家数失败:" << query.lastError().text();
+        return false;
     }
+    totals.sellers = query.value(0).toInt();
     
-    // 统计商家数
-    if (query.exec("SELECT COUNT(*) FROM sellers")) {
-        if (query.next()) {
-            stats["totalSellers"] = query.value(0).toInt();
-        }
+    if (!query.exec("SELECT COUNT(*) FROM seller_certifications WHERE status = '待审核'") || !query.next()) {
+        qWarning() << "统计待审核认证数失败:" << query.lastError().text();
+        return false;
     }
+    totals.pendingCertifications = query.value(0).toInt();
     
-    // 统计待审核商家数（role = 0 或 seller_certifications表中status='待审核'）
-    int pendingSellers = 0;
-    // 方法1：从users表中统计role=0的用户
-    if (query.exec("SELECT COUNT(*) FROM users WHERE role = 0")) {
-        if (query.next()) {
-            pendingSellers += query.value(0).toInt();
-        }
-    }
-    // 方法2：从seller_certifications表中统计status='待审核'的记录
-    if (query.exec("SELECT COUNT(*) FROM seller_certifications WHERE status = '待审核'")) {
-        if (query.next()) {
-            int certPending = query.value(0).toInt();
-            // 取较大值，避免重复计算
-            if (certPending > pendingSellers) {
-                pendingSellers = certPending;
-            }
-        }
+    if (!query.exec("SELECT COUNT(*) FROM books") || !query.next()) {
+        qWarning() << "统计图书数失败:" << query.lastError().text();
+        return false;
     }
-    stats["pendingSellers"] = pendingSellers;
+    totals.books = query.value(0).toInt();
     
-    // 统计图书数
-    if (query.exec("SELECT COUNT(*) FROM books")) {
-        if (query.next()) {
-            stats["totalBooks"] = query.value(0).toInt();
-        }
+    const int corrected = PlatformCounters::getInstance().storeTotals(totals);
+    if (drift) {
+        *drift = corrected;
     }
-    
-    return stats;
+    return true;
 }
 
 QJsonObject Database::getSellerDashboardStats(int sellerId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonObject stats;
     
     if (!isConnected()) {
@@ -3868,7 +5167,7 @@ QJsonObject Database::getSellerDashboardStats(int sellerId)
         return stats;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     
     // 1. 计算总销售额和总订单数：该卖家的所有订单
     // 方法1：通过merchant_id字段快速统计
@@ -3888,7 +5187,7 @@ QJsonObject Database::getSellerDashboardStats(int sellerId)
     }
     
     // 方法2：检查items JSON中包含该卖家商品的订单（处理一个订单包含多个商家商品的情况）
-    QSqlQuery query2(m_db);
+    QSqlQuery query2(locker.connection());
     query2.prepare("SELECT order_id, total_amount, items FROM orders WHERE merchant_id != ? OR merchant_id IS NULL");
     query2.addBindValue(sellerId);
     if (query2.exec()) {
@@ -3937,39 +5236,132 @@ QJsonObject Database::getSellerDashboardStats(int sellerId)
         }
     }
     
-    // 3. 统计总图书数：该卖家的图书数量（状态为"正常"）
-    int totalBooks = 0;
-    query.prepare("SELECT COUNT(*) as count FROM books WHERE merchant_id = ? AND (status IS NULL OR status = '' OR status = '正常')");
+    // 3. 统计总图书数：该卖家的图书数量（状态为"正常"）
+    int totalBooks = 0;
+    query.prepare("SELECT COUNT(*) as count FROM books WHERE merchant_id = ? AND (status IS NULL OR status = '' OR status = '正常')");
+    query.addBindValue(sellerId);
+    if (query.exec() && query.next()) {
+        totalBooks = query.value("count").toInt();
+    }
+    
+    // 4. 统计总会员数：所有买家用户数量（role=1，状态为正常）
+    int totalMembers = 0;
+    query.prepare("SELECT COUNT(*) as count FROM users WHERE role = 1 AND (status IS NULL OR status = '' OR status = '正常')");
+    if (query.exec() && query.next()) {
+        totalMembers = query.value("count").toInt();
+    }
+    
+    stats["totalSales"] = totalSales;
+    stats["totalOrders"] = totalOrders;
+    stats["totalBooks"] = totalBooks;
+    stats["totalMembers"] = totalMembers;
+    
+    return stats;
+}
+
+// 仪表盘用的订单汇总：与getSellerOrders同口径（经order_merchants，含多商家订单），只做聚合不取明细
+// today 形如 "yyyy-MM-dd"；order_date 不早于它即为今日订单（MySQL按日期比较，SQLite的ISO文本按字典序比较）
+QJsonObject Database::getSellerOrderSummary(int sellerId, const QString& today)
+{
+    DbReadLocker locker(this);
+    QJsonObject summary;
+    
+    if (!isConnected() || sellerId <= 0) {
+        return summary;
+    }
+    
+    QSqlQuery query(locker.connection());
+    
+    QJsonObject statusCounts;
+    query.prepare("SELECT o.status, COUNT(*) AS count "
+                  "FROM order_merchants om JOIN orders o ON o.order_id = om.order_id "
+                  "WHERE om.merchant_id = ? GROUP BY o.status");
+    query.addBindValue(sellerId);
+    if (query.exec()) {
+        while (query.next()) {
+            statusCounts[query.value("status").toString()] = query.value("count").toInt();
+        }
+    } else {
+        qWarning() << "查询订单状态统计失败:" << query.lastError().text();
+    }
+    
+    int todayOrders = 0;
+    double todayRevenue = 0.0;
+    query.prepare("SELECT COUNT(*) AS count, COALESCE(SUM(o.total_amount), 0) AS amount "
+                  "FROM order_merchants om JOIN orders o ON o.order_id = om.order_id "
+                  "WHERE om.merchant_id = ? AND om.order_date >= ?");
+    query.addBindValue(sellerId);
+    query.addBindValue(today);
+    if (query.exec() && query.next()) {
+        todayOrders = query.value("count").toInt();
+        todayRevenue = query.value("amount").toDouble();
+    } else {
+        qWarning() << "查询今日订单统计失败:" << query.lastError().text();
+    }
+    
+    summary["statusCounts"] = statusCounts;
+    summary["todayOrders"] = todayOrders;
+    summary["todayRevenue"] = todayRevenue;
+    return summary;
+}
+
+// 仪表盘快照的版本键：只做按索引的聚合（商家订单按状态的数量/金额/最近下单时间、在售图书数、会员数），
+// 订单增删、状态流转、改价、上下架都会改变它；快照轮询先比对它，未变化时不再执行全量统计
+QString Database::getSellerDashboardVersion(int sellerId)
+{
+    DbReadLocker locker(this);
+    
+    if (!isConnected() || sellerId <= 0) {
+        return QString();
+    }
+    
+    QSqlQuery query(locker.connection());
+    QStringList parts;
+    
+    query.prepare("SELECT o.status, COUNT(*) AS count, COALESCE(SUM(o.total_amount), 0) AS amount, "
+                  "MAX(om.order_date) AS latest "
+                  "FROM order_merchants om JOIN orders o ON o.order_id = om.order_id "
+                  "WHERE om.merchant_id = ? GROUP BY o.status ORDER BY o.status");
     query.addBindValue(sellerId);
-    if (query.exec() && query.next()) {
-        totalBooks = query.value("count").toInt();
+    if (!query.exec()) {
+        qWarning() << "查询仪表盘版本失败:" << query.lastError().text();
+        return QString();
+    }
+    while (query.next()) {
+        parts << QString("%1:%2:%3:%4").arg(query.value("status").toString())
+                                       .arg(query.value("count").toInt())
+                                       .arg(query.value("amount").toDouble(), 0, 'f', 2)
+                                       .arg(query.value("latest").toString());
     }
     
-    // 4. 统计总会员数：所有买家用户数量（role=1，状态为正常）
-    int totalMembers = 0;
-    query.prepare("SELECT COUNT(*) as count FROM users WHERE role = 1 AND (status IS NULL OR status = '' OR status = '正常')");
-    if (query.exec() && query.next()) {
-        totalMembers = query.value("count").toInt();
+    query.prepare("SELECT COUNT(*) AS count FROM books WHERE merchant_id = ? AND (status IS NULL OR status = '' OR status = '正常')");
+    query.addBindValue(sellerId);
+    if (!query.exec() || !query.next()) {
+        qWarning() << "查询仪表盘版本失败:" << query.lastError().text();
+        return QString();
     }
+    parts << QString("books:%1").arg(query.value("count").toInt());
     
-    stats["totalSales"] = totalSales;
-    stats["totalOrders"] = totalOrders;
-    stats["totalBooks"] = totalBooks;
-    stats["totalMembers"] = totalMembers;
+    query.prepare("SELECT COUNT(*) AS count FROM users WHERE role = 1 AND (status IS NULL OR status = '' OR status = '正常')");
+    if (!query.exec() || !query.next()) {
+        qWarning() << "查询仪表盘版本失败:" << query.lastError().text();
+        return QString();
+    }
+    parts << QString("members:%1").arg(query.value("count").toInt());
     
-    return stats;
+    return parts.join('|');
 }
 
 QJsonArray Database::getSellerSalesReport(int sellerId, const QString& startDate, const QString& endDate)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray result;
     
     if (!isConnected() || sellerId <= 0) {
         return result;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     
     // 查询指定日期范围内的订单，按日期分组统计
     QString sql = "SELECT DATE(order_date) as date, COUNT(*) as count, COALESCE(SUM(total_amount), 0) as amount "
@@ -3993,7 +5385,7 @@ QJsonArray Database::getSellerSalesReport(int sellerId, const QString& startDate
     }
     
     // 如果merchant_id不匹配，还需要检查items JSON中包含该卖家商品的订单
-    QSqlQuery query2(m_db);
+    QSqlQuery query2(locker.connection());
     query2.prepare("SELECT order_id, DATE(order_date) as date, total_amount, items FROM orders "
                    "WHERE (merchant_id != ? OR merchant_id IS NULL) AND DATE(order_date) >= ? AND DATE(order_date) <= ?");
     query2.addBindValue(sellerId);
@@ -4092,14 +5484,14 @@ QJsonArray Database::getSellerSalesReport(int sellerId, const QString& startDate
 
 QJsonArray Database::getSellerInventoryReport(int sellerId, const QString& startDate, const QString& endDate)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray result;
     
     if (!isConnected() || sellerId <= 0) {
         return result;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     
     // 查询指定日期范围内有订单的图书，按分类统计库存变化
     // 这里统计的是当前库存状态，以及在该日期范围内有销售的图书
@@ -4137,7 +5529,7 @@ QJsonArray Database::getSellerInventoryReport(int sellerId, const QString& start
         // 如果JSON_CONTAINS不支持，使用简化查询
         qWarning() << "查询库存报表失败（尝试简化查询）:" << query.lastError().text();
         
-        QSqlQuery query2(m_db);
+        QSqlQuery query2(locker.connection());
         query2.prepare("SELECT category1, category2, COUNT(*) as book_count, SUM(stock) as total_stock "
                       "FROM books WHERE merchant_id = ? AND (status IS NULL OR status = '' OR status = '正常') "
                       "GROUP BY category1, category2 ORDER BY category1, category2");
@@ -4166,14 +5558,14 @@ QJsonArray Database::getSellerInventoryReport(int sellerId, const QString& start
 
 QJsonArray Database::getSellerMemberReport(int sellerId, const QString& startDate, const QString& endDate)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray result;
     
     if (!isConnected() || sellerId <= 0) {
         return result;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     
     // 查询指定日期范围内注册的会员，按会员等级分组统计
     // 如果register_date为NULL，则包含在统计中（兼容旧数据）
@@ -4206,7 +5598,7 @@ QJsonArray Database::getSellerMemberReport(int sellerId, const QString& startDat
 // 初始化示例图书数据
 bool Database::initSampleBooks()
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -4429,6 +5821,7 @@ bool Database::initSampleBooks()
     }
     
     qDebug() << "示例图书数据初始化完成，成功插入" << successCount << "本图书";
+    PlatformCounters::getInstance().booksAdded(successCount);
     return successCount > 0;
 }
 
@@ -4439,13 +5832,28 @@ bool Database::initSampleBooks()
 bool Database::applySellerCertification(int userId, const QString& username, const QString& password, 
                                        const QString& email, const QString& licenseImageBase64)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         qWarning() << "数据库未连接，无法保存营业执照图片";
         return false;
     }
     
+    // 读出原角色和原认证状态，用于更新平台计数
+    int oldRole = -1;
+    QString oldCertStatus;
+    QSqlQuery previousQuery(m_db);
+    previousQuery.prepare("SELECT role FROM users WHERE user_id = ?");
+    previousQuery.addBindValue(userId);
+    if (previousQuery.exec() && previousQuery.next()) {
+        oldRole = previousQuery.value(0).toInt();
+    }
+    previousQuery.prepare("SELECT status FROM seller_certifications WHERE user_id = ?");
+    previousQuery.addBindValue(userId);
+    if (previousQuery.exec() && previousQuery.next()) {
+        oldCertStatus = previousQuery.value(0).toString();
+    }
+    
     // 首先更新users表的license_image_base64字段和role字段
     // 将role设置为0表示"审核中"（买家申请成为卖家且在审核中）
     // 注意：无论用户之前是什么role，提交申请时都设置为0（审核中）
@@ -4467,21 +5875,23 @@ bool Database::applySellerCertification(int userId, const QString& username, con
     }
     
     qDebug() << "✓ 已更新users表的license_image_base64字段和role=0（审核中），用户ID:" << userId;
+    SessionManager::getInstance().publishRole(userId, 0);
+    PlatformCounters::getInstance().userRoleChanged(oldRole, 0);
     
     // 同时保存到seller_certifications表（用于审核流程）
     // 确保状态始终为"审核中"，即使之前有记录且状态是"已认证"
     QSqlQuery query(m_db);
-    // 使用 INSERT ... ON DUPLICATE KEY UPDATE 来处理重复申请
+    // 使用插入冲突时更新（upsert）来处理重复申请
     // 强制将status设置为"审核中"，确保不会因为之前的状态而错误显示
-    query.prepare("INSERT INTO seller_certifications (user_id, username, password, email, license_image, status, apply_time) "
-                 "VALUES (?, ?, ?, ?, ?, '审核中', CURRENT_TIMESTAMP) "
-                 "ON DUPLICATE KEY UPDATE "
-                 "username = VALUES(username), "
-                 "password = VALUES(password), "
-                 "email = VALUES(email), "
-                 "license_image = VALUES(license_image), "
-                 "status = '审核中', "
-                 "apply_time = CURRENT_TIMESTAMP");
+    query.prepare(dialect("INSERT INTO seller_certifications (user_id, username, password, email, license_image, status, apply_time) "
+                          "VALUES (?, ?, ?, ?, ?, '审核中', CURRENT_TIMESTAMP) " +
+                          upsertClause("user_id") +
+                          "username = VALUES(username), "
+                          "password = VALUES(password), "
+                          "email = VALUES(email), "
+                          "license_image = VALUES(license_image), "
+                          "status = '审核中', "
+                          "apply_time = CURRENT_TIMESTAMP"));
     query.addBindValue(userId);
     query.addBindValue(username);
     query.addBindValue(password);
@@ -4495,6 +5905,7 @@ bool Database::applySellerCertification(int userId, const QString& username, con
         qDebug() << "注意：users表已更新，但seller_certifications表更新失败";
     } else {
         qDebug() << "✓ 已保存到seller_certifications表，状态强制设置为'审核中'";
+        PlatformCounters::getInstance().certificationStatusChanged(oldCertStatus, "审核中");
     }
     
     qDebug() << "卖家认证申请已提交，用户ID:" << userId << "用户名:" << username << "状态:审核中";
@@ -4503,14 +5914,14 @@ bool Database::applySellerCertification(int userId, const QString& username, con
 
 QJsonObject Database::getSellerCertification(int userId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonObject result;
     
     if (!isConnected()) {
         return result;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     query.prepare("SELECT * FROM seller_certifications WHERE user_id = ?");
     query.addBindValue(userId);
     
@@ -4530,7 +5941,7 @@ QJsonObject Database::getSellerCertification(int userId)
         result["message"] = "已申请认证";
         
         // 从users表获取license_image_base64
-        QSqlQuery userQuery(m_db);
+        QSqlQuery userQuery(locker.connection());
         userQuery.prepare("SELECT license_image_base64 FROM users WHERE user_id = ?");
         userQuery.addBindValue(userId);
         if (userQuery.exec() && userQuery.next()) {
@@ -4546,14 +5957,14 @@ QJsonObject Database::getSellerCertification(int userId)
 
 QJsonArray Database::getPendingSellerCertifications()
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray result;
     
     if (!isConnected()) {
         return result;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     // 查询状态为"审核中"或"待审核"的认证申请
     query.prepare("SELECT * FROM seller_certifications WHERE status = '审核中' OR status = '待审核' ORDER BY apply_time DESC");
     
@@ -4572,7 +5983,7 @@ QJsonArray Database::getPendingSellerCertifications()
         cert["applyTime"] = query.value("apply_time").toString();
         
         // 从users表获取license_image_base64
-        QSqlQuery userQuery(m_db);
+        QSqlQuery userQuery(locker.connection());
         userQuery.prepare("SELECT license_image_base64 FROM users WHERE user_id = ?");
         userQuery.addBindValue(query.value("user_id").toInt());
         if (userQuery.exec() && userQuery.next()) {
@@ -4590,7 +6001,7 @@ QJsonArray Database::getPendingSellerCertifications()
 
 bool Database::approveSellerCertification(int userId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -4610,22 +6021,25 @@ bool Database::approveSellerCertification(int userId)
     QString password = query.value("password").toString();
     QString email = query.value("email").toString();
     QString licenseImageBase64 = query.value("license_image").toString();
+    QString oldCertStatus = query.value("status").toString();
     
-    // 从users表获取phone_number、address、balance、status
+    // 从users表获取phone_number、address、balance、status（role用于更新平台计数）
     QSqlQuery userQuery(m_db);
-    userQuery.prepare("SELECT phone_number, address, balance, status FROM users WHERE user_id = ?");
+    userQuery.prepare("SELECT phone_number, address, balance, status, role FROM users WHERE user_id = ?");
     userQuery.addBindValue(userId);
     
     QString phoneNumber;
     QString address;
     double balance = 0.0;
     QString userStatus = "正常";
+    int oldRole = -1;
     
     if (userQuery.exec() && userQuery.next()) {
         phoneNumber = userQuery.value("phone_number").toString();
         address = userQuery.value("address").toString();
         balance = userQuery.value("balance").toDouble();
         userStatus = userQuery.value("status").toString();
+        oldRole = userQuery.value("role").toInt();
     }
     
     // 更新users表的role为2（卖家）
@@ -4637,14 +6051,15 @@ bool Database::approveSellerCertification(int userId)
         qWarning() << "更新用户role失败:" << updateRoleQuery.lastError().text();
         return false;
     }
+    PlatformCounters::getInstance().userRoleChanged(oldRole, 2);
     
     // 将用户添加到卖家表，包含所有字段（与users表除role外一一对应）
     // 如果用户被封禁，商家状态也应设为"封禁"
     QString sellerStatus = (userStatus == "封禁") ? "封禁" : "正常";
     
     QSqlQuery insertQuery(m_db);
-    insertQuery.prepare("INSERT INTO sellers (seller_name, password, email, phone_number, address, balance, license_image_base64, register_date, status) "
-                       "VALUES (?, ?, ?, ?, ?, ?, ?, CURDATE(), ?)");
+    insertQuery.prepare(dialect("INSERT INTO sellers (seller_name, password, email, phone_number, address, balance, license_image_base64, register_date, status) "
+                                "VALUES (?, ?, ?, ?, ?, ?, ?, CURDATE(), ?)"));
     insertQuery.addBindValue(username);
     insertQuery.addBindValue(password);
     insertQuery.addBindValue(email);
@@ -4681,6 +6096,7 @@ bool Database::approveSellerCertification(int userId)
             return false;
         }
     } else {
+        PlatformCounters::getInstance().sellerAdded();
         // 如果用户被封禁，商家图书也应下架
         if (userStatus == "封禁") {
             int sellerId = insertQuery.lastInsertId().toInt();
@@ -4690,35 +6106,54 @@ bool Database::approveSellerCertification(int userId)
     
     // 更新认证状态为已认证
     QSqlQuery updateQuery(m_db);
-    updateQuery.prepare("UPDATE seller_certifications SET status = '已认证', approve_time = NOW() WHERE user_id = ?");
+    updateQuery.prepare(dialect("UPDATE seller_certifications SET status = '已认证', approve_time = NOW() WHERE user_id = ?"));
     updateQuery.addBindValue(userId);
     
     if (!updateQuery.exec()) {
         qWarning() << "更新认证状态失败:" << updateQuery.lastError().text();
         return false;
     }
+    PlatformCounters::getInstance().certificationStatusChanged(oldCertStatus, "已认证");
     
     qDebug() << "卖家认证审核通过，用户ID:" << userId << "用户名:" << username;
+    SessionManager::getInstance().publishRole(userId, 2);
     return true;
 }
 
 bool Database::rejectSellerCertification(int userId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
     }
     
-    // 更新认证状态为已拒绝
+    // 读出原认证状态和原角色，用于更新平台计数
     QSqlQuery query(m_db);
-    query.prepare("UPDATE seller_certifications SET status = '已拒绝', approve_time = NOW() WHERE user_id = ?");
+    QString oldCertStatus;
+    int oldRole = -1;
+    query.prepare("SELECT status FROM seller_certifications WHERE user_id = ?");
+    query.addBindValue(userId);
+    if (query.exec() && query.next()) {
+        oldCertStatus = query.value(0).toString();
+    }
+    query.prepare("SELECT role FROM users WHERE user_id = ?");
+    query.addBindValue(userId);
+    if (query.exec() && query.next()) {
+        oldRole = query.value(0).toInt();
+    }
+    
+    // 更新认证状态为已拒绝
+    query.prepare(dialect("UPDATE seller_certifications SET status = '已拒绝', approve_time = NOW() WHERE user_id = ?"));
     query.addBindValue(userId);
     
     if (!query.exec()) {
         qWarning() << "更新认证状态失败:" << query.lastError().text();
         return false;
     }
+    if (query.numRowsAffected() > 0) {
+        PlatformCounters::getInstance().certificationStatusChanged(oldCertStatus, "已拒绝");
+    }
     
     // 将users表的role改回1（买家）
     QSqlQuery updateRoleQuery(m_db);
@@ -4729,8 +6164,12 @@ bool Database::rejectSellerCertification(int userId)
         qWarning() << "更新用户role失败:" << updateRoleQuery.lastError().text();
         return false;
     }
+    if (updateRoleQuery.numRowsAffected() > 0) {
+        PlatformCounters::getInstance().userRoleChanged(oldRole, 1);
+    }
     
     qDebug() << "✓ 审核已拒绝，用户ID:" << userId << "，role已改回1（买家）";
+    SessionManager::getInstance().publishRole(userId, 1);
     return true;
 }
 
@@ -4740,8 +6179,6 @@ bool Database::rejectSellerCertification(int userId)
 
 bool Database::saveChatMessage(int senderId, const QString& senderType, int receiverId, const QString& receiverType, const QString& message)
 {
-    QMutexLocker locker(&m_mutex);
-    
     if (!isConnected()) {
         return false;
     }
@@ -4751,27 +6188,17 @@ bool Database::saveChatMessage(int senderId, const QString& senderType, int rece
         return false;
     }
     
-    QSqlQuery query(m_db);
-    query.prepare("INSERT INTO chat_messages (sender_id, sender_type, receiver_id, receiver_type, message_content) "
-                  "VALUES (?, ?, ?, ?, ?)");
-    query.addBindValue(senderId);
-    query.addBindValue(senderType);
+    PendingWrite write;
+    write.kind = PendingWrite::ChatMessage;
+    write.values << senderId << senderType;
     // receiverId为-1或0时，表示发送给所有管理员/客服，设置为NULL
-    if (receiverId > 0) {
-        query.addBindValue(receiverId);
-    } else {
-        query.addBindValue(QVariant());
-    }
+    write.values << (receiverId > 0 ? QVariant(receiverId) : QVariant());
     // receiverType为空时，表示发送给所有管理员/客服
-    if (!receiverType.isEmpty()) {
-        query.addBindValue(receiverType);
-    } else {
-        query.addBindValue(QVariant());
-    }
-    query.addBindValue(message);
+    write.values << (!receiverType.isEmpty() ? QVariant(receiverType) : QVariant());
+    write.values << message;
     
-    if (!query.exec()) {
-        qWarning() << "保存聊天消息失败:" << query.lastError().text();
+    if (!GroupCommitQueue::getInstance().execute(write)) {
+        qWarning() << "保存聊天消息失败，发送者ID:" << senderId << "类型:" << senderType;
         return false;
     }
     
@@ -4780,70 +6207,57 @@ bool Database::saveChatMessage(int senderId, const QString& senderType, int rece
     return true;
 }
 
-QJsonArray Database::getChatHistory(int userId, const QString& userType, int otherUserId, const QString& otherUserType)
+QJsonArray Database::getChatHistory(int userId, const QString& userType, int otherUserId, const QString& otherUserType,
+                                    int beforeId, int limit)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray messages;
     
     if (!isConnected()) {
         return messages;
     }
     
-    QSqlQuery query(m_db);
-    QString sql;
+    QString where;
+    QVariantList bindValues;
     
     if (otherUserId > 0 && !otherUserType.isEmpty()) {
         // 获取与特定用户的聊天记录（双向）
+        where = "((sender_id = ? AND sender_type = ? AND receiver_id = ? AND receiver_type = ?) "
+                "   OR (sender_id = ? AND sender_type = ? AND receiver_id = ? AND receiver_type = ?)";
+        bindValues << userId << userType << otherUserId << otherUserType
+                   << otherUserId << otherUserType << userId << userType;
         // 如果userId是管理员（999999），还需要包含对方用户发送给客服的消息（receiver_id IS NULL）
-        if (userId == 999999 && userType == "admin") {
-            // 管理员查看与特定用户的聊天：包含双向消息 + 用户发送给客服的消息
-            sql = "SELECT * FROM chat_messages "
-                  "WHERE ((sender_id = ? AND sender_type = ? AND receiver_id = ? AND receiver_type = ?) "
-                  "   OR (sender_id = ? AND sender_type = ? AND receiver_id = ? AND receiver_type = ?) "
-                  "   OR (sender_id = ? AND sender_type = ? AND receiver_id IS NULL AND receiver_type IS NULL)) "
-                  "ORDER BY send_time ASC";
-            query.prepare(sql);
-            query.addBindValue(userId);
-            query.addBindValue(userType);
-            query.addBindValue(otherUserId);
-            query.addBindValue(otherUserType);
-            query.addBindValue(otherUserId);
-            query.addBindValue(otherUserType);
-            query.addBindValue(userId);
-            query.addBindValue(userType);
-            query.addBindValue(otherUserId);
-            query.addBindValue(otherUserType);
-        } else {
-            // 普通用户之间的聊天记录（双向）
-            sql = "SELECT * FROM chat_messages "
-                  "WHERE ((sender_id = ? AND sender_type = ? AND receiver_id = ? AND receiver_type = ?) "
-                  "   OR (sender_id = ? AND sender_type = ? AND receiver_id = ? AND receiver_type = ?)) "
-                  "ORDER BY send_time ASC";
-            query.prepare(sql);
-            query.addBindValue(userId);
-            query.addBindValue(userType);
-            query.addBindValue(otherUserId);
-            query.addBindValue(otherUserType);
-            query.addBindValue(otherUserId);
-            query.addBindValue(otherUserType);
-            query.addBindValue(userId);
-            query.addBindValue(userType);
+        if (userId == kAdminChatId && userType == "admin") {
+            where += "   OR (sender_id = ? AND sender_type = ? AND receiver_id IS NULL AND receiver_type IS NULL)";
+            bindValues << otherUserId << otherUserType;
         }
+        where += ")";
     } else {
         // 获取所有与当前用户相关的聊天记录（包括发送和接收）
         // 对于买家/卖家发送给客服的消息（receiver_id IS NULL），也要包含在内
-        sql = "SELECT * FROM chat_messages "
-              "WHERE (sender_id = ? AND sender_type = ?) "
-              "   OR (receiver_id = ? AND receiver_type = ?) "
-              "   OR (sender_id = ? AND sender_type = ? AND receiver_id IS NULL AND receiver_type IS NULL) "
-              "ORDER BY send_time ASC";
-        query.prepare(sql);
-        query.addBindValue(userId);
-        query.addBindValue(userType);
-        query.addBindValue(userId);
-        query.addBindValue(userType);
-        query.addBindValue(userId);
-        query.addBindValue(userType);
+        where = "((sender_id = ? AND sender_type = ?) "
+                "   OR (receiver_id = ? AND receiver_type = ?) "
+                "   OR (sender_id = ? AND sender_type = ? AND receiver_id IS NULL AND receiver_type IS NULL))";
+        bindValues << userId << userType << userId << userType << userId << userType;
+    }
+    
+    // limit > 0 时按消息ID做keyset分页：取beforeId之前最新的limit条，翻页不随偏移量变慢
+    QString sql = "SELECT * FROM chat_messages WHERE " + where;
+    if (beforeId > 0) {
+        sql += " AND message_id < ?";
+        bindValues << beforeId;
+    }
+    if (limit > 0) {
+        sql += " ORDER BY message_id DESC LIMIT ?";
+        bindValues << limit;
+    } else {
+        sql += " ORDER BY send_time ASC";
+    }
+    
+    QSqlQuery query(locker.connection());
+    query.prepare(sql);
+    for (const QVariant &value : bindValues) {
+        query.addBindValue(value);
     }
     
     if (!query.exec()) {
@@ -4865,20 +6279,127 @@ QJsonArray Database::getChatHistory(int userId, const QString& userType, int oth
         messages.append(msg);
     }
     
+    // 分页查询按ID倒序取出，返回时仍按时间正序
+    if (limit > 0) {
+        QJsonArray ascending;
+        for (int i = messages.size() - 1; i >= 0; --i) {
+            ascending.append(messages.at(i));
+        }
+        messages = ascending;
+    }
+    
     qDebug() << "获取聊天历史，用户ID:" << userId << "类型:" << userType << "消息数量:" << messages.size();
     return messages;
 }
 
+QJsonObject Database::getConversations(int userId, const QString& userType, const QString& peerType, int offset, int limit)
+{
+    DbReadLocker locker(this);
+    QJsonObject result;
+    QJsonArray conversations;
+    
+    if (!isConnected()) {
+        result["conversations"] = conversations;
+        result["total"] = 0;
+        return result;
+    }
+    
+    QString where = "c.user_id = ? AND c.user_type = ?";
+    QVariantList bindValues;
+    bindValues << userId << userType;
+    if (!peerType.isEmpty()) {
+        where += " AND c.peer_type = ?";
+        bindValues << peerType;
+    }
+    
+    QSqlQuery query(locker.connection());
+    query.prepare("SELECT COUNT(*) FROM conversations c WHERE " + where);
+    for (const QVariant &value : bindValues) {
+        query.addBindValue(value);
+    }
+    int total = 0;
+    if (query.exec() && query.next()) {
+        total = query.value(0).toInt();
+    }
+    
+    // 按最近消息倒序走(user_id, user_type, last_message_id)索引；最近消息和对方名称按主键取
+    query.prepare("SELECT c.peer_id, c.peer_type, c.last_message_id, c.last_time, c.unread_count, "
+                  "m.message_content, m.sender_type, u.username, s.seller_name "
+                  "FROM conversations c "
+                  "LEFT JOIN chat_messages m ON m.message_id = c.last_message_id "
+                  "LEFT JOIN users u ON c.peer_type = 'buyer' AND u.user_id = c.peer_id "
+                  "LEFT JOIN sellers s ON c.peer_type = 'seller' AND s.seller_id = c.peer_id "
+                  "WHERE " + where + " ORDER BY c.last_message_id DESC LIMIT ? OFFSET ?");
+    for (const QVariant &value : bindValues) {
+        query.addBindValue(value);
+    }
+    query.addBindValue(limit);
+    query.addBindValue(offset);
+    
+    if (!query.exec()) {
+        qWarning() << "获取聊天会话失败:" << query.lastError().text();
+    } else {
+        while (query.next()) {
+            QJsonObject conversation;
+            const QString type = query.value("peer_type").toString();
+            conversation["peerId"] = query.value("peer_id").toInt();
+            conversation["peerType"] = type;
+            if (type == "buyer") {
+                conversation["peerName"] = query.value("username").toString();
+            } else if (type == "seller") {
+                conversation["peerName"] = query.value("seller_name").toString();
+            } else {
+                conversation["peerName"] = "客服";
+            }
+            conversation["lastMessageId"] = query.value("last_message_id").toInt();
+            conversation["lastTime"] = query.value("last_time").toString();
+            conversation["lastContent"] = query.value("message_content").toString().left(50);
+            conversation["lastSenderType"] = query.value("sender_type").toString();
+            conversation["unreadCount"] = query.value("unread_count").toInt();
+            conversations.append(conversation);
+        }
+    }
+    
+    result["conversations"] = conversations;
+    result["total"] = total;
+    result["offset"] = offset;
+    result["limit"] = limit;
+    result["hasMore"] = offset + conversations.size() < total;
+    return result;
+}
+
+bool Database::markConversationRead(int userId, const QString& userType, int peerId, const QString& peerType)
+{
+    DbLocker locker(&m_mutex);
+    
+    if (!isConnected()) {
+        return false;
+    }
+    
+    QSqlQuery query(m_db);
+    query.prepare("UPDATE conversations SET unread_count = 0 "
+                  "WHERE user_id = ? AND user_type = ? AND peer_id = ? AND peer_type = ? AND unread_count > 0");
+    query.addBindValue(userId);
+    query.addBindValue(userType);
+    query.addBindValue(peerId);
+    query.addBindValue(peerType);
+    if (!query.exec()) {
+        qWarning() << "标记会话已读失败:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
 QJsonArray Database::getAllChatMessagesForAdmin()
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray messages;
     
     if (!isConnected()) {
         return messages;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     query.prepare("SELECT * FROM chat_messages ORDER BY send_time DESC LIMIT 1000");
     
     if (!query.exec()) {
@@ -4951,7 +6472,7 @@ double Database::getMemberDiscount(const QString& memberLevel)
 
 bool Database::updateMemberLevel(int userId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     return updateMemberLevelUnlocked(userId);
 }
 
@@ -4990,6 +6511,7 @@ bool Database::updateMemberLevelUnlocked(int userId)
     }
     
     qDebug() << "会员等级已更新，用户ID:" << userId << "累计充值:" << totalRecharge << "会员等级:" << newMemberLevel;
+    SessionManager::getInstance().publishMemberLevel("buyer", userId, newMemberLevel, getMemberDiscount(newMemberLevel));
     return true;
 }
 
@@ -5003,7 +6525,7 @@ int Database::calculatePoints(double rechargeAmount)
 
 bool Database::addPoints(int userId, int points)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -5057,13 +6579,13 @@ bool Database::addPoints(int userId, int points)
 
 int Database::getUserPoints(int userId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     
     if (!isConnected()) {
         return 0;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     query.prepare("SELECT points FROM users WHERE user_id = ?");
     query.addBindValue(userId);
     
@@ -5086,7 +6608,7 @@ bool Database::canParticipateLottery(int userId)
 
 bool Database::rechargeSellerBalance(int sellerId, double amount)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
         return false;
@@ -5132,7 +6654,7 @@ bool Database::rechargeSellerBalance(int sellerId, double amount)
 
 bool Database::updateSellerMemberLevel(int sellerId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     return updateSellerMemberLevelUnlocked(sellerId);
 }
 
@@ -5171,6 +6693,7 @@ bool Database::updateSellerMemberLevelUnlocked(int sellerId)
     }
     
     qDebug() << "商家会员等级已更新，商家ID:" << sellerId << "累计充值:" << totalRecharge << "会员等级:" << newMemberLevel;
+    SessionManager::getInstance().publishMemberLevel("seller", sellerId, newMemberLevel, getMemberDiscount(newMemberLevel));
     return true;
 }
 
@@ -5178,8 +6701,6 @@ bool Database::updateSellerMemberLevelUnlocked(int sellerId)
 
 bool Database::addReview(int userId, const QString& bookId, int rating, const QString& comment)
 {
-    QMutexLocker locker(&m_mutex);
-    
     if (!isConnected()) {
         qWarning() << "数据库未连接，无法添加评论";
         return false;
@@ -5191,20 +6712,12 @@ bool Database::addReview(int userId, const QString& bookId, int rating, const QS
         return false;
     }
     
-    QSqlQuery query(m_db);
-    // 使用INSERT ... ON DUPLICATE KEY UPDATE，如果用户已评论过该商品，则更新评论
-    query.prepare("INSERT INTO reviews (user_id, book_id, rating, comment, review_time) "
-                  "VALUES (?, ?, ?, ?, NOW()) "
-                  "ON DUPLICATE KEY UPDATE rating = ?, comment = ?, review_time = NOW()");
-    query.addBindValue(userId);
-    query.addBindValue(bookId);
-    query.addBindValue(rating);
-    query.addBindValue(comment);
-    query.addBindValue(rating);
-    query.addBindValue(comment);
-    
-    if (!query.exec()) {
-        qWarning() << "添加评论失败:" << query.lastError().text();
+    // 插入冲突时更新（upsert），如果用户已评论过该商品，则更新评论
+    PendingWrite write;
+    write.kind = PendingWrite::Review;
+    write.values << userId << bookId << rating << comment;
+    if (!GroupCommitQueue::getInstance().execute(write)) {
+        qWarning() << "添加评论失败，用户ID:" << userId << "商品ID:" << bookId;
         return false;
     }
     
@@ -5214,14 +6727,14 @@ bool Database::addReview(int userId, const QString& bookId, int rating, const QS
 
 QJsonArray Database::getBookReviews(const QString& bookId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray reviews;
     
     if (!isConnected()) {
         return reviews;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     query.prepare("SELECT r.*, u.username FROM reviews r "
                   "LEFT JOIN users u ON r.user_id = u.user_id "
                   "WHERE r.book_id = ? ORDER BY r.review_time DESC");
@@ -5251,7 +6764,7 @@ QJsonArray Database::getBookReviews(const QString& bookId)
 
 QJsonObject Database::getBookRatingStats(const QString& bookId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonObject stats;
     
     if (!isConnected()) {
@@ -5261,9 +6774,9 @@ QJsonObject Database::getBookRatingStats(const QString& bookId)
         return stats;
     }
     
-    QSqlQuery query(m_db);
-    query.prepare("SELECT AVG(rating) as avg_rating, COUNT(*) as review_count "
-                  "FROM reviews WHERE book_id = ?");
+    QSqlQuery query(locker.connection());
+    // 评分总分和评论数随评论写入维护在books表中
+    query.prepare("SELECT rating_sum, rating_count FROM books WHERE isbn = ?");
     query.addBindValue(bookId);
     
     if (!query.exec() || !query.next()) {
@@ -5273,8 +6786,8 @@ QJsonObject Database::getBookRatingStats(const QString& bookId)
         return stats;
     }
     
-    int reviewCount = query.value("review_count").toInt();
-    double avgRating = query.value("avg_rating").toDouble();
+    int reviewCount = query.value("rating_count").toInt();
+    double avgRating = reviewCount > 0 ? query.value("rating_sum").toDouble() / reviewCount : 0.0;
     
     stats["averageRating"] = avgRating;
     stats["reviewCount"] = reviewCount;
@@ -5286,13 +6799,13 @@ QJsonObject Database::getBookRatingStats(const QString& bookId)
 
 bool Database::hasUserReviewedBook(int userId, const QString& bookId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     
     if (!isConnected()) {
         return false;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     query.prepare("SELECT COUNT(*) FROM reviews WHERE user_id = ? AND book_id = ?");
     query.addBindValue(userId);
     query.addBindValue(bookId);
@@ -5306,14 +6819,14 @@ bool Database::hasUserReviewedBook(int userId, const QString& bookId)
 
 bool Database::hasUserPurchasedBook(int userId, const QString& bookId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     
     if (!isConnected()) {
         return false;
     }
     
     // 查询用户的订单，检查订单中的items JSON是否包含该商品
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     query.prepare("SELECT items FROM orders WHERE user_id = ? AND status IN ('已支付', '已发货', '已完成')");
     query.addBindValue(userId);
     
@@ -5349,7 +6862,7 @@ bool Database::hasUserPurchasedBook(int userId, const QString& bookId)
 
 QJsonArray Database::getSellerReviews(int sellerId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray reviews;
     
     if (!isConnected()) {
@@ -5357,7 +6870,7 @@ QJsonArray Database::getSellerReviews(int sellerId)
     }
     
     // 通过JOIN查询：从reviews表关联books表，获取该卖家的所有商品评论
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     query.prepare("SELECT r.*, u.username, b.title as book_title, b.isbn as book_isbn "
                   "FROM reviews r "
                   "LEFT JOIN users u ON r.user_id = u.user_id "
@@ -5392,45 +6905,16 @@ QJsonArray Database::getSellerReviews(int sellerId)
 // ===== 抽奖和奖品相关函数 =====
 
 
-bool Database::addUserCoupon(int userId, double couponValue)
-{
-    QMutexLocker locker(&m_mutex);
-    
-    if (!isConnected()) {
-        qWarning() << "数据库未连接，无法添加优惠券";
-        return false;
-    }
-    
-    QSqlQuery query(m_db);
-    QString couponType = QString("%1元优惠券").arg(couponValue, 0, 'f', 0);
-    QDateTime expireTime = QDateTime::currentDateTime().addDays(30);  // 30天后过期
-    
-    query.prepare("INSERT INTO user_coupons (user_id, coupon_type, coupon_value, status, expire_time) "
-                  "VALUES (?, ?, ?, '未使用', ?)");
-    query.addBindValue(userId);
-    query.addBindValue(couponType);
-    query.addBindValue(couponValue);
-    query.addBindValue(expireTime.toString("yyyy-MM-dd hh:mm:ss"));
-    
-    if (!query.exec()) {
-        qWarning() << "添加用户优惠券失败:" << query.lastError().text();
-        return false;
-    }
-    
-    qDebug() << "添加用户优惠券成功，用户ID:" << userId << "优惠券面额:" << couponValue;
-    return true;
-}
-
 QJsonArray Database::getUserCoupons(int userId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     QJsonArray coupons;
     
     if (!isConnected()) {
         return coupons;
     }
     
-    QSqlQuery query(m_db);
+    QSqlQuery query(locker.connection());
     query.prepare("SELECT * FROM user_coupons WHERE user_id = ? ORDER BY obtain_time DESC");
     query.addBindValue(userId);
     
@@ -5458,227 +6942,313 @@ QJsonArray Database::getUserCoupons(int userId)
 }
 
 
-// ===== 优惠券相关函数（直接存储在users表中）=====
+// ===== 优惠券钱包 =====
 
-bool Database::addCoupon30(int userId, int count)
+QString Database::couponKey(double couponValue)
 {
-    // 将30元优惠券存入user_coupons表
-    for (int i = 0; i < count; i++) {
-        if (!addUserCoupon(userId, 30.0)) {
-            qWarning() << "添加30元优惠券失败，用户ID:" << userId;
-            return false;
-        }
-    }
-    qDebug() << "添加30元优惠券成功，用户ID:" << userId << "数量:" << count;
-    return true;
+    return QString::number(couponValue);
 }
 
-bool Database::addCoupon50(int userId, int count)
+// 发放一张优惠券的写操作（30天后过期）
+static PendingWrite couponIssueWrite(int userId, double couponValue)
 {
-    // 将50元优惠券存入user_coupons表
-    for (int i = 0; i < count; i++) {
-        if (!addUserCoupon(userId, 50.0)) {
-            qWarning() << "添加50元优惠券失败，用户ID:" << userId;
-            return false;
-        }
-    }
-    qDebug() << "添加50元优惠券成功，用户ID:" << userId << "数量:" << count;
-    return true;
+    QString couponType = QString("%1元优惠券").arg(Database::couponKey(couponValue));
+    QDateTime expireTime = QDateTime::currentDateTime().addDays(30);
+    
+    PendingWrite write;
+    write.kind = PendingWrite::UserCoupon;
+    write.values << userId << couponType << couponValue << expireTime.toString("yyyy-MM-dd hh:mm:ss");
+    return write;
 }
 
-bool Database::useCoupon30(int userId, int count, const QString& orderId)
+bool Database::issueCoupons(int userId, double couponValue, int count)
 {
-    QMutexLocker locker(&m_mutex);
-    
     if (!isConnected()) {
-        qWarning() << "数据库未连接，无法使用30元优惠券";
+        qWarning() << "数据库未连接，无法发放优惠券";
         return false;
     }
-    
-    // 先检查优惠券数量是否足够（直接查询，避免调用需要锁的函数）
-    QSqlQuery checkQuery(m_db);
-    checkQuery.prepare("SELECT COUNT(*) as count FROM user_coupons WHERE user_id = ? AND coupon_value = 30.0 AND status = '未使用'");
-    checkQuery.addBindValue(userId);
-    int currentCount = 0;
-    if (checkQuery.exec() && checkQuery.next()) {
-        currentCount = checkQuery.value("count").toInt();
-    }
-    if (currentCount < count) {
-        qWarning() << "30元优惠券数量不足，当前:" << currentCount << "需要:" << count;
+    if (couponValue <= 0 || count <= 0) {
         return false;
     }
     
-    // 从user_coupons表中选择未使用的30元优惠券并标记为已使用
-    QSqlQuery query(m_db);
-    QString sql = "UPDATE user_coupons SET status = '已使用', use_time = NOW()";
-    if (!orderId.isEmpty()) {
-        sql += ", order_id = ?";
+    // 每张券一个写操作，由组提交合并为一条多行INSERT，并在同一事务中累加coupon_wallet
+    const PendingWrite write = couponIssueWrite(userId, couponValue);
+    std::vector<std::future<bool>> results;
+    for (int i = 0; i < count; ++i) {
+        results.push_back(GroupCommitQueue::getInstance().submit(write));
     }
-    sql += " WHERE user_id = ? AND coupon_value = 30.0 AND status = '未使用' LIMIT ?";
-    
-    query.prepare(sql);
-    if (!orderId.isEmpty()) {
-        query.addBindValue(orderId);
+    bool success = true;
+    for (std::future<bool> &result : results) {
+        success = result.get() && success;
     }
-    query.addBindValue(userId);
-    query.addBindValue(count);
     
-    if (!query.exec()) {
-        qWarning() << "使用30元优惠券失败:" << query.lastError().text();
+    if (!success) {
+        qWarning() << "发放优惠券失败，用户ID:" << userId << "面额:" << couponValue << "数量:" << count;
         return false;
     }
+    qDebug() << "发放优惠券成功，用户ID:" << userId << "面额:" << couponValue << "数量:" << count;
+    return true;
+}
+
+bool Database::addToCouponWalletUnlocked(const QVector<PendingWrite>& writes, int begin, int end)
+{
+    // 同一批中相同(用户, 面额)的券合并为一行
+    QMap<QPair<int, double>, int> issued;
+    for (int i = begin; i < end; ++i) {
+        const QVariantList &values = writes.at(i).values;
+        ++issued[qMakePair(values.at(0).toInt(), values.at(2).toDouble())];
+    }
     
-    // 检查是否真的更新了记录
-    int affectedRows = query.numRowsAffected();
-    if (affectedRows < count) {
-        qWarning() << "使用30元优惠券失败：只更新了" << affectedRows << "条记录，需要" << count;
+    QStringList tuples;
+    for (int i = 0; i < issued.size(); ++i) {
+        tuples << "(?, ?, ?)";
+    }
+    QSqlQuery query(m_db);
+    query.prepare(dialect("INSERT INTO coupon_wallet (user_id, coupon_value, available) VALUES " + tuples.join(", ") + " " +
+                          upsertClause("user_id, coupon_value") + "available = available + VALUES(available)"));
+    for (auto it = issued.constBegin(); it != issued.constEnd(); ++it) {
+        query.addBindValue(it.key().first);
+        query.addBindValue(it.key().second);
+        query.addBindValue(it.value());
+    }
+    if (!query.exec()) {
+        qWarning() << "更新优惠券钱包失败:" << query.lastError().text();
         return false;
     }
-    
-    qDebug() << "使用30元优惠券成功，用户ID:" << userId << "数量:" << count << "订单ID:" << orderId << "更新记录数:" << affectedRows;
     return true;
 }
 
-bool Database::useCoupon50(int userId, int count, const QString& orderId)
+bool Database::redeemCoupon(int userId, double couponValue, const QString& orderId, int count)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
-        qWarning() << "数据库未连接，无法使用50元优惠券";
+        qWarning() << "数据库未连接，无法使用优惠券";
+        return false;
+    }
+    if (count <= 0) {
         return false;
     }
     
-    // 先检查优惠券数量是否足够（直接查询，避免调用需要锁的函数）
-    QSqlQuery checkQuery(m_db);
-    checkQuery.prepare("SELECT COUNT(*) as count FROM user_coupons WHERE user_id = ? AND coupon_value = 50.0 AND status = '未使用'");
-    checkQuery.addBindValue(userId);
-    int currentCount = 0;
-    if (checkQuery.exec() && checkQuery.next()) {
-        currentCount = checkQuery.value("count").toInt();
+    if (!m_db.transaction()) {
+        qWarning() << "开始优惠券事务失败:" << m_db.lastError().text();
+        return false;
     }
-    if (currentCount < count) {
-        qWarning() << "50元优惠券数量不足，当前:" << currentCount << "需要:" << count;
+    
+    // 带条件扣减钱包余额：张数不足时不更新任何行，不再先COUNT(*)
+    QSqlQuery walletQuery(m_db);
+    walletQuery.prepare("UPDATE coupon_wallet SET available = available - ? "
+                        "WHERE user_id = ? AND coupon_value = ? AND available >= ?");
+    walletQuery.addBindValue(count);
+    walletQuery.addBindValue(userId);
+    walletQuery.addBindValue(couponValue);
+    walletQuery.addBindValue(count);
+    if (!walletQuery.exec() || walletQuery.numRowsAffected() != 1) {
+        qWarning() << couponKey(couponValue) << "元优惠券数量不足，用户ID:" << userId << "需要:" << count
+                   << walletQuery.lastError().text();
+        m_db.rollback();
         return false;
     }
     
-    // 从user_coupons表中选择未使用的50元优惠券并标记为已使用
+    // 从user_coupons表中选择未使用的优惠券并标记为已使用
     QSqlQuery query(m_db);
     QString sql = "UPDATE user_coupons SET status = '已使用', use_time = NOW()";
     if (!orderId.isEmpty()) {
         sql += ", order_id = ?";
     }
-    sql += " WHERE user_id = ? AND coupon_value = 50.0 AND status = '未使用' LIMIT ?";
+    // UPDATE ... LIMIT不是标准SQL（SQLite不支持），改为按coupon_id子查询选出要使用的优惠券
+    sql += " WHERE coupon_id IN (SELECT coupon_id FROM (SELECT coupon_id FROM user_coupons "
+           "WHERE user_id = ? AND coupon_value = ? AND status = '未使用' ORDER BY coupon_id LIMIT ?) AS picked)";
     
-    query.prepare(sql);
+    query.prepare(dialect(sql));
     if (!orderId.isEmpty()) {
         query.addBindValue(orderId);
     }
     query.addBindValue(userId);
+    query.addBindValue(couponValue);
     query.addBindValue(count);
     
-    if (!query.exec()) {
-        qWarning() << "使用50元优惠券失败:" << query.lastError().text();
+    if (!query.exec() || query.numRowsAffected() < count) {
+        qWarning() << "使用优惠券失败：钱包与优惠券明细不一致，用户ID:" << userId << "面额:" << couponValue
+                   << query.lastError().text();
+        m_db.rollback();
         return false;
     }
     
-    // 检查是否真的更新了记录
-    int affectedRows = query.numRowsAffected();
-    if (affectedRows < count) {
-        qWarning() << "使用50元优惠券失败：只更新了" << affectedRows << "条记录，需要" << count;
+    if (!m_db.commit()) {
+        qWarning() << "提交优惠券事务失败:" << m_db.lastError().text();
+        m_db.rollback();
         return false;
     }
     
-    qDebug() << "使用50元优惠券成功，用户ID:" << userId << "数量:" << count << "订单ID:" << orderId << "更新记录数:" << affectedRows;
+    qDebug() << "使用优惠券成功，用户ID:" << userId << "面额:" << couponValue << "数量:" << count << "订单ID:" << orderId;
     return true;
 }
 
-int Database::getCoupon30Count(int userId)
+bool Database::rollbackCoupon(int userId, double couponValue, const QString& orderId)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
     
     if (!isConnected()) {
-        return 0;
+        qWarning() << "数据库未连接，无法回滚优惠券";
+        return false;
+    }
+    
+    if (!m_db.transaction()) {
+        qWarning() << "开始优惠券事务失败:" << m_db.lastError().text();
+        return false;
     }
     
-    // 从user_coupons表查询未使用的30元优惠券数量
+    // 将该订单使用的优惠券改回未使用状态，恢复的张数加回钱包
     QSqlQuery query(m_db);
-    query.prepare("SELECT COUNT(*) as count FROM user_coupons WHERE user_id = ? AND coupon_value = 30.0 AND status = '未使用'");
+    query.prepare("UPDATE user_coupons SET status = '未使用', use_time = NULL, order_id = NULL "
+                  "WHERE user_id = ? AND coupon_value = ? AND status = '已使用' AND order_id = ?");
     query.addBindValue(userId);
+    query.addBindValue(couponValue);
+    query.addBindValue(orderId);
+    if (!query.exec()) {
+        qWarning() << "回滚优惠券失败:" << query.lastError().text();
+        m_db.rollback();
+        return false;
+    }
+    
+    const int restored = query.numRowsAffected();
+    if (restored > 0) {
+        QSqlQuery walletQuery(m_db);
+        walletQuery.prepare(dialect("INSERT INTO coupon_wallet (user_id, coupon_value, available) VALUES (?, ?, ?) " +
+                                    upsertClause("user_id, coupon_value") + "available = available + VALUES(available)"));
+        walletQuery.addBindValue(userId);
+        walletQuery.addBindValue(couponValue);
+        walletQuery.addBindValue(restored);
+        if (!walletQuery.exec()) {
+            qWarning() << "回滚优惠券钱包失败:" << walletQuery.lastError().text();
+            m_db.rollback();
+            return false;
+        }
+    }
     
-    if (!query.exec() || !query.next()) {
-        return 0;
+    if (!m_db.commit()) {
+        qWarning() << "提交优惠券事务失败:" << m_db.lastError().text();
+        m_db.rollback();
+        return false;
     }
     
-    return query.value("count").toInt();
+    qDebug() << "回滚优惠券成功，用户ID:" << userId << "面额:" << couponValue << "订单ID:" << orderId << "张数:" << restored;
+    return true;
 }
 
-int Database::getCoupon50Count(int userId)
+int Database::couponBalance(int userId, double couponValue)
 {
-    QMutexLocker locker(&m_mutex);
+    DbReadLocker locker(this);
     
     if (!isConnected()) {
         return 0;
     }
     
-    // 从user_coupons表查询未使用的50元优惠券数量
-    QSqlQuery query(m_db);
-    query.prepare("SELECT COUNT(*) as count FROM user_coupons WHERE user_id = ? AND coupon_value = 50.0 AND status = '未使用'");
+    QSqlQuery query(locker.connection());
+    query.prepare("SELECT available FROM coupon_wallet WHERE user_id = ? AND coupon_value = ?");
     query.addBindValue(userId);
+    query.addBindValue(couponValue);
     
     if (!query.exec() || !query.next()) {
         return 0;
     }
     
-    return query.value("count").toInt();
+    return query.value(0).toInt();
 }
 
-bool Database::rollbackCoupon30(int userId, const QString& orderId)
+QJsonObject Database::readCouponWallet(const QSqlDatabase& connection, int userId)
 {
-    QMutexLocker locker(&m_mutex);
-    
-    if (!isConnected()) {
-        qWarning() << "数据库未连接，无法回滚30元优惠券";
-        return false;
-    }
-    
-    // 将已使用的优惠券改回未使用状态
-    QSqlQuery query(m_db);
-    query.prepare("UPDATE user_coupons SET status = '未使用', use_time = NULL, order_id = NULL "
-                  "WHERE user_id = ? AND coupon_value = 30.0 AND status = '已使用' AND order_id = ? LIMIT 1");
+    QJsonObject wallet;
+    QSqlQuery query(connection);
+    query.prepare("SELECT coupon_value, available FROM coupon_wallet WHERE user_id = ? AND available > 0");
     query.addBindValue(userId);
-    query.addBindValue(orderId);
-    
     if (!query.exec()) {
-        qWarning() << "回滚30元优惠券失败:" << query.lastError().text();
-        return false;
+        qWarning() << "查询优惠券钱包失败:" << query.lastError().text();
+        return wallet;
+    }
+    while (query.next()) {
+        wallet[couponKey(query.value(0).toDouble())] = query.value(1).toInt();
+    }
+    return wallet;
+}
+
+QJsonObject Database::couponWallet(int userId)
+{
+    DbReadLocker locker(this);
+    
+    if (!isConnected()) {
+        return QJsonObject();
     }
     
-    qDebug() << "回滚30元优惠券成功，用户ID:" << userId << "订单ID:" << orderId;
-    return true;
+    return readCouponWallet(locker.connection(), userId);
 }
 
-bool Database::rollbackCoupon50(int userId, const QString& orderId)
+// ===== 抽奖结算 =====
+
+QJsonObject Database::settleLotteryDraw(int userId, int costPoints, double couponValue)
 {
-    QMutexLocker locker(&m_mutex);
+    DbLocker locker(&m_mutex);
+    QJsonObject result;
+    result["success"] = false;
     
     if (!isConnected()) {
-        qWarning() << "数据库未连接，无法回滚50元优惠券";
-        return false;
+        result["message"] = "数据库未连接";
+        return result;
+    }
+    
+    if (!m_db.transaction()) {
+        qWarning() << "开始抽奖事务失败:" << m_db.lastError().text();
+        result["message"] = "抽奖失败，请稍后重试";
+        return result;
     }
     
-    // 将已使用的优惠券改回未使用状态
+    // 带条件扣积分：积分不足时不更新任何行，不需要先查询
     QSqlQuery query(m_db);
-    query.prepare("UPDATE user_coupons SET status = '未使用', use_time = NULL, order_id = NULL "
-                  "WHERE user_id = ? AND coupon_value = 50.0 AND status = '已使用' AND order_id = ? LIMIT 1");
+    query.prepare("UPDATE users SET points = points - ? WHERE user_id = ? AND points >= ?");
+    query.addBindValue(costPoints);
     query.addBindValue(userId);
-    query.addBindValue(orderId);
-    
+    query.addBindValue(costPoints);
     if (!query.exec()) {
-        qWarning() << "回滚50元优惠券失败:" << query.lastError().text();
-        return false;
+        qWarning() << "扣除抽奖积分失败，用户ID:" << userId << query.lastError().text();
+        m_db.rollback();
+        result["message"] = "扣除积分失败";
+        return result;
     }
+    const bool debited = query.numRowsAffected() == 1;
     
-    qDebug() << "回滚50元优惠券成功，用户ID:" << userId << "订单ID:" << orderId;
-    return true;
+    // 奖品为优惠券时在同一事务中写入明细并累加钱包
+    if (debited && couponValue > 0) {
+        const QVector<PendingWrite> writes = {couponIssueWrite(userId, couponValue)};
+        if (!execWriteRun(writes, 0, 1)) {
+            m_db.rollback();
+            result["message"] = "添加优惠券失败";
+            return result;
+        }
+    }
+    
+    query.prepare("SELECT points FROM users WHERE user_id = ?");
+    query.addBindValue(userId);
+    const int points = query.exec() && query.next() ? query.value(0).toInt() : 0;
+    result["points"] = points;
+    
+    if (!debited) {
+        m_db.rollback();
+        result["insufficientPoints"] = true;
+        result["message"] = "积分不足";
+        return result;
+    }
+    
+    result["coupons"] = readCouponWallet(m_db, userId);
+    if (!m_db.commit()) {
+        qWarning() << "提交抽奖事务失败:" << m_db.lastError().text();
+        m_db.rollback();
+        result.remove("coupons");
+        result["message"] = "抽奖失败，请稍后重试";
+        return result;
+    }
+    
+    result["success"] = true;
+    return result;
 }
 
@@ -10,21 +10,64 @@
 #include <QJsonDocument>
 #include <QString>
 #include <QMutex>
+#include <QList>
+#include <QStringList>
+#include <QMap>
+#include <QVector>
+#include <QVariantList>
+#include <QSet>
+#include <QDate>
+
+// 可合并提交的单行写操作：由GroupCommitQueue收集，Database::commitWriteGroup在一个事务中执行
+struct PendingWrite {
+    enum Kind {
+        ChatMessage,     // values: senderId, senderType, receiverId(NULL=管理员/客服), receiverType, message
+        AddFavorite,     // values: userId, bookId
+        RemoveFavorite,  // values: userId, bookId
+        Review,          // values: userId, bookId, rating, comment
+        UserCoupon       // values: userId, couponType, couponValue, expireTime
+    };
+    Kind kind = ChatMessage;
+    QVariantList values;  // 与该类语句单行占位符的顺序一致
+};
+
+// 平台总量（管理员系统统计）：由Database::reconcilePlatformCounters从数据库统计，供PlatformCounters校对
+struct PlatformTotals {
+    int users = 0;
+    int buyers = 0;                 // users.role = 1
+    int applicants = 0;             // users.role = 0（申请成为卖家、审核中）
+    int sellers = 0;
+    int pendingCertifications = 0;  // seller_certifications.status = '待审核'
+    int books = 0;
+};
 
 // --- 数据库管理类（单例模式）---
+// 存储后端可以是远程MySQL，也可以是本地嵌入式SQLite（无MySQL时完整运行）
 class Database
 {
 public:
+    // 存储后端类型
+    enum class Backend {
+        MySql,   // 远程MySQL（单连接，所有操作串行）
+        Sqlite   // 本地SQLite文件（WAL模式，单写连接 + 每个线程独立的读连接）
+    };
+    
     // 获取单例实例
     static Database& getInstance();
     
-    // 初始化数据库连接
+    // 初始化MySQL数据库连接
     bool initConnection(const QString& host = "49.232.145.193",
                        int port = 3306,
                        const QString& dbName = "test_db",
                        const QString& username = "root01",
                        const QString& password = "123456");
     
+    // 初始化本地SQLite数据库（文件不存在时自动创建并建表）
+    bool initSqliteConnection(const QString& filePath);
+    
+    // 当前使用的存储后端
+    Backend backend() const { return m_backend; }
+    
     // 检查是否已连接
     bool isConnected() const;
     
@@ -32,16 +75,27 @@ public:
     void closeConnection();
     
     // ===== 请求日志功能 =====
+    // 按天分表：request_logs_yyyyMMdd，超过保留期的分表由RequestLogArchive压缩归档后删除；
+    // 分表之前的request_logs旧表仍参与查询，其中的旧数据按天逐批归档
     bool logRequest(const QString& clientIp, quint16 clientPort,
                    const QString& action, const QJsonObject& requestData,
                    const QJsonObject& responseData, bool success, 
-                   const QString& category);
-    QJsonArray getRequestLogs(int limit = 100, const QString& category = "");
+                   const QString& category);  // 写入当天的分表
+    // 从当天的分表开始按时间倒序查询在线日志，最后查旧表；category/action为空表示不过滤
+    QJsonArray getRequestLogs(int limit = 100, const QString& category = "", const QString& action = "");
+    QStringList requestLogPartitions();  // 在线的按天分表，按日期升序
+    // 归档用：按id升序读取id > afterId的完整日志行（含请求/响应JSON），before有效时只读该时间之前的行；ok区分没有数据和查询失败
+    QJsonArray fetchRequestLogRows(const QString& table, qint64 afterId, int batchSize, const QDateTime& before = QDateTime(), bool* ok = nullptr);
+    bool deleteRequestLogRows(const QString& table, qint64 maxId, const QDateTime& before);  // 删除旧表中已归档的行
+    bool dropRequestLogPartition(const QString& table);
+    static QString requestLogPartitionName(const QDate& day);
+    static QDate requestLogPartitionDay(const QString& table);  // 不是按天分表时返回无效日期
     
     // ===== 用户相关 =====
     bool registerUser(const QString& username, const QString& password, const QString& email);
     QJsonObject loginUser(const QString& username, const QString& password);
-    QJsonArray getAllUsers();
+    // 列表分页：limit>0时只取[offset, offset+limit)这一段并用COUNT(*)统计总条数写入total；limit<=0返回全部
+    QJsonArray getAllUsers(int offset = 0, int limit = 0, int* total = nullptr);
     QJsonObject getUserById(int userId);  // 根据用户ID获取单个用户信息
     bool deleteUser(int userId);
     bool updateUserBalance(int userId, double balance);
@@ -64,19 +118,21 @@ public:
     int getUserPoints(int userId);  // 获取用户积分
     bool canParticipateLottery(int userId);  // 检查用户是否可以参与抽奖（累计满3积分）
     
-    // ===== 优惠券相关 =====
-    bool addCoupon30(int userId, int count = 1);  // 增加30元优惠券（存入user_coupons表）
-    bool addCoupon50(int userId, int count = 1);  // 增加50元优惠券（存入user_coupons表）
-    bool useCoupon30(int userId, int count = 1, const QString& orderId = "");  // 使用30元优惠券（更新user_coupons表状态）
-    bool useCoupon50(int userId, int count = 1, const QString& orderId = "");  // 使用50元优惠券（更新user_coupons表状态）
-    bool rollbackCoupon30(int userId, const QString& orderId);  // 回滚30元优惠券使用
-    bool rollbackCoupon50(int userId, const QString& orderId);  // 回滚50元优惠券使用
-    int getCoupon30Count(int userId);  // 获取30元优惠券数量（从user_coupons表查询）
-    int getCoupon50Count(int userId);  // 获取50元优惠券数量（从user_coupons表查询）
+    // ===== 优惠券钱包 =====
+    // coupon_wallet按(用户, 面额)记录未使用张数，与user_coupons的发放/使用/回滚在同一事务中更新，
+    // 查询余额只读一行主键；新增面额不需要新增方法
+    bool issueCoupons(int userId, double couponValue, int count = 1);  // 发放优惠券（经组提交写入user_coupons并累加钱包）
+    bool redeemCoupon(int userId, double couponValue, const QString& orderId, int count = 1);  // 使用优惠券，余额不足时返回false
+    bool rollbackCoupon(int userId, double couponValue, const QString& orderId);  // 回滚该订单使用的该面额优惠券
+    int couponBalance(int userId, double couponValue);  // 某面额的可用张数
+    QJsonObject couponWallet(int userId);  // 各面额的可用张数，如 {"30": 2, "50": 1}
+    static QString couponKey(double couponValue);  // 面额在钱包JSON中的键
     
     // ===== 抽奖和奖品相关 =====
-    bool addUserCoupon(int userId, double couponValue);  // 添加用户优惠券到user_coupons表
     QJsonArray getUserCoupons(int userId);  // 获取用户的优惠券列表
+    // 一次抽奖的结算：在一个事务中扣costPoints积分、couponValue > 0时发放该面额优惠券，并读回剩余积分和钱包；
+    // 返回success、points、coupons，积分不足时success为false且insufficientPoints为true（不做任何修改）
+    QJsonObject settleLotteryDraw(int userId, int costPoints, double couponValue);
     
     // ===== 商家相关 =====
     bool registerSeller(const QString& sellerName, const QString& password, const QString& email);
@@ -102,8 +158,8 @@ public:
     bool addBook(const QJsonObject& book);
     bool updateBook(const QString& isbn, const QJsonObject& book);
     bool deleteBook(const QString& isbn);
-    QJsonArray getAllBooks();  // 买家使用：只返回状态为"正常"的书籍
-    QJsonArray getAllBooksForSeller(int sellerId);  // 卖家使用：返回该卖家的所有书籍（包括待审核等所有状态）
+    QJsonArray getAllBooks(int offset = 0, int limit = 0, int* total = nullptr);  // 买家使用：只返回状态为"正常"的书籍
+    QJsonArray getAllBooksForSeller(int sellerId, int offset = 0, int limit = 0, int* total = nullptr);  // 卖家使用：返回该卖家的所有书籍（包括待审核等所有状态）
     QJsonObject getBook(const QString& isbn);
     QJsonArray searchBooks(const QString& keyword);
     QJsonArray getPendingBooks();  // 获取待审核的书籍列表
@@ -114,17 +170,29 @@ public:
     QString createOrder(const QJsonObject& order);
     bool updateOrderStatus(const QString& orderId, const QString& status, const QString& paymentMethod = "", const QString& cancelReason = "", const QString& trackingNumber = "", double totalAmount = -1.0);
     QJsonArray getUserOrders(int userId);
-    QJsonArray getAllOrders();
-    QJsonArray getSellerOrders(int sellerId);  // 根据商家ID获取订单（通过解析items JSON中的merchantId）
+    QJsonArray getAllOrders(int offset = 0, int limit = 0, int* total = nullptr);
+    QJsonArray getSellerOrders(int sellerId, int offset = 0, int limit = 0, int* total = nullptr);  // 商家的订单：按order_merchants索引，含多商家订单
+    QJsonObject getSellerOrderStatusTotals(int sellerId);  // 商家订单按状态的 {count, amount}，与getSellerOrders同口径
+    // 商家的客户（在该商家买过书的买家）：按最近下单时间倒序分页，limit<=0返回全部
+    // filters可含 memberLevel、minSpent、maxSpent、activeDays（最近N天内下过单）
+    QJsonObject getSellerCustomers(int merchantId, const QJsonObject& filters, int offset, int limit);
     bool deleteOrder(const QString& orderId);
     QJsonObject getOrder(const QString& orderId);
     
     // ===== 购物车相关 =====
     bool addToCart(int userId, const QString& bookId, int quantity);
-    QJsonArray getCart(int userId);
+    QJsonArray getCart(int userId, bool* ok = nullptr);  // ok返回查询是否成功（区分空购物车和查询失败）
     bool updateCartQuantity(int userId, const QString& bookId, int quantity);
     bool removeFromCart(int userId, const QString& bookId);
     bool clearCart(int userId);
+    bool replaceCarts(const QMap<int, QJsonArray>& carts);  // CartService批量写回：单个事务内用给定内容替换这些用户的购物车
+    QJsonArray getBookBasics(const QStringList& isbns);  // 批量获取图书名称和价格：[{bookId, bookName, price}]
+    
+    // ===== 组提交 =====
+    // 在一个事务中执行一组写操作（相邻的同类操作合并为一条多行语句），同时更新受影响图书的评分/收藏计数，
+    // results与writes一一对应。整组失败时回滚并逐个单独执行，一个写操作出错不影响同组的其他调用方
+    bool commitWriteGroup(const QVector<PendingWrite>& writes, QVector<bool>* results);
+    int reconcileBookStats();  // 按reviews/favorites校对books表的评分/收藏计数，返回修正的图书数（失败返回-1）
     
     // ===== 收藏相关 =====
     bool addFavorite(int userId, const QString& bookId);
@@ -132,6 +200,11 @@ public:
     QJsonArray getUserFavorites(int userId);
     int getBookFavoriteCount(const QString& bookId);
     
+    // ===== 推荐相关（RecommendEngine使用）=====
+    QJsonArray getInteractionEvents(const QString& sinceDate);  // 自sinceDate起的下单（未取消）和收藏行为：[{userId, type, date, bookIds}]
+    QStringList getUserRecentBookIds(int userId, int limit);  // 用户最近购买/收藏的图书ID（按时间倒序、去重）
+    QJsonArray getBookSummaries();  // 在售图书的基本信息（不含封面和描述）
+    
     // ===== 会员相关 =====
     bool addMember(const QJsonObject& member);
     bool updateMember(const QString& cardNo, const QJsonObject& member);
@@ -140,9 +213,12 @@ public:
     bool rechargeMember(const QString& cardNo, double amount);
     
     // ===== 统计相关 =====
-    QJsonObject getSystemStats();
+    QJsonObject getSystemStats();  // 读PlatformCounters中的计数，不扫表
+    bool reconcilePlatformCounters(PlatformTotals& totals, int* drift);  // 在写锁内扫表统计平台总量并写入PlatformCounters
     QJsonObject getSellerDashboardStats(int sellerId);  // 获取卖家统计报表数据
     QJsonArray getSellerSalesReport(int sellerId, const QString& startDate, const QString& endDate);  // 获取销售报表数据
+    QJsonObject getSellerOrderSummary(int sellerId, const QString& today);  // 订单按状态计数及今日订单数/金额（聚合查询，不取明细）
+    QString getSellerDashboardVersion(int sellerId);  // 仪表盘快照的廉价版本键，未变化时可跳过全量统计
     QJsonArray getSellerInventoryReport(int sellerId, const QString& startDate, const QString& endDate);  // 获取库存报表数据
     QJsonArray getSellerMemberReport(int sellerId, const QString& startDate, const QString& endDate);  // 获取会员报表数据
     
@@ -154,8 +230,14 @@ public:
     
     // ===== 聊天相关 =====
     bool saveChatMessage(int senderId, const QString& senderType, int receiverId, const QString& receiverType, const QString& message);
-    QJsonArray getChatHistory(int userId, const QString& userType, int otherUserId = -1, const QString& otherUserType = "");
+    // limit > 0 时按消息ID分页：返回beforeId（0为最新）之前的最多limit条，仍按时间正序
+    QJsonArray getChatHistory(int userId, const QString& userType, int otherUserId = -1, const QString& otherUserType = "",
+                              int beforeId = 0, int limit = 0);
     QJsonArray getAllChatMessagesForAdmin();  // 管理员获取所有聊天记录
+    // 会话列表：conversations表中本人的会话按最近消息倒序分页，peerType为空表示不过滤对方类型；
+    // 返回conversations（peerId、peerType、peerName、lastContent、unreadCount等）和total
+    QJsonObject getConversations(int userId, const QString& userType, const QString& peerType, int offset, int limit);
+    bool markConversationRead(int userId, const QString& userType, int peerId, const QString& peerType);  // 清零本人在该会话的未读数
     
     // ===== 评论相关 =====
     bool addReview(int userId, const QString& bookId, int rating, const QString& comment);  // 添加评论
@@ -174,11 +256,51 @@ private:
     Database(const Database&) = delete;
     Database& operator=(const Database&) = delete;
     
-    bool createTables();
+    friend class DbReadLocker;
+    
+    // ===== 存储后端适配 =====
+    bool isSqlite() const { return m_backend == Backend::Sqlite; }
+    bool applySqlitePragmas(QSqlDatabase& db, bool readOnly);
+    QSqlDatabase readConnection();  // 只读查询使用的连接：SQLite为当前线程独立连接，MySQL为m_db
+    QString dialect(const QString& statement) const;  // 将语句中的MySQL函数转换为当前后端的写法
+    QString upsertClause(const QString& conflictColumns) const;  // 插入冲突时更新的子句
+    bool execDdl(QSqlQuery& query, const QString& statement);  // 执行建表语句（SQLite下拆分内联索引）
+    bool execWriteRun(const QVector<PendingWrite>& writes, int begin, int end);  // 用一条语句执行[begin, end)的同类写操作（调用方持有m_mutex）
+    bool execWriteGroup(const QVector<PendingWrite>& writes, int begin, int end);  // 在一个事务中执行[begin, end)并更新相关图书的计数
+    bool recordSellerCustomersUnlocked(const QString& orderId);  // 订单支付后累计到seller_customers（调用方持有m_mutex）
+    bool ensureRequestLogPartitionUnlocked(const QString& table);  // 分表不存在时创建（调用方持有m_mutex）
+    bool addToCouponWalletUnlocked(const QVector<PendingWrite>& writes, int begin, int end);  // 组提交发放的优惠券计入钱包（调用方持有m_mutex）
+    static QJsonObject readCouponWallet(const QSqlDatabase& connection, int userId);
+    bool readBackMessageIdsUnlocked(const QVector<PendingWrite>& writes, int begin, int end, qint64 firstMessageId, QVector<qint64>* messageIds);  // 读回刚插入的消息ID（调用方持有m_mutex）
+    bool updateConversationsUnlocked(const QVector<PendingWrite>& writes, int begin, int end, const QVector<qint64>& messageIds);  // 新消息更新双方会话行（调用方持有m_mutex）
+    
+    // ===== 数据库结构迁移 =====
+    // 迁移步骤：版本号递增，apply必须幂等
+    struct Migration {
+        int version;
+        const char* description;
+        bool (Database::*apply)(QSqlQuery& query);
+    };
+    static const QList<Migration>& migrations();
+    int currentSchemaVersion(QSqlQuery& query);
+    bool createTables();  // 按schema_version执行未完成的迁移步骤
+    bool migrateCreateBaseTables(QSqlQuery& query);
+    bool migrateUpgradeUsersTable(QSqlQuery& query);
+    bool migrateUpgradeSellersTable(QSqlQuery& query);
+    bool migrateUpgradeBooksTable(QSqlQuery& query);
+    bool migrateSeedDefaultSeller(QSqlQuery& query);
+    bool migrateAddBookStatsColumns(QSqlQuery& query);
+    bool migrateCreateSellerCustomers(QSqlQuery& query);
+    bool migrateCreateCouponWallet(QSqlQuery& query);
+    bool migrateCreateConversations(QSqlQuery& query);
+    bool migrateCreateOrderMerchants(QSqlQuery& query);
     
-    QSqlDatabase m_db;
+    QSqlDatabase m_db;  // 写连接（MySQL下也用于读）
     bool m_connected;
-    QMutex m_mutex;
+    QMutex m_mutex;     // 写连接锁：同一时间只有一个线程使用m_db
+    Backend m_backend;
+    QString m_sqlitePath;
+    QSet<QString> m_logPartitions;  // 已确认存在的日志分表（受m_mutex保护）
 };
 
 #endif // DATABASE_H
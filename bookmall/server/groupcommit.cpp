@@ -0,0 +1,144 @@
+#include "groupcommit.h"
+#include <QThread>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QDebug>
+
+// 后台提交线程：执行GroupCommitQueue::run()
+class GroupCommitThread : public QThread
+{
+protected:
+    void run() override
+    {
+        GroupCommitQueue::getInstance().run();
+    }
+};
+
+GroupCommitQueue::GroupCommitQueue()
+{
+}
+
+GroupCommitQueue::~GroupCommitQueue()
+{
+    stop();
+}
+
+GroupCommitQueue& GroupCommitQueue::getInstance()
+{
+    static GroupCommitQueue instance;
+    return instance;
+}
+
+void GroupCommitQueue::start()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_thread) {
+        return;
+    }
+    m_stop = false;
+    m_thread = new GroupCommitThread;
+    m_thread->start();
+    qDebug() << "✓ 组提交线程已启动，凑批等待" << GATHER_MS << "ms，单批最多" << MAX_GROUP_SIZE << "个写操作";
+}
+
+void GroupCommitQueue::stop()
+{
+    GroupCommitThread* thread = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_thread) {
+            return;
+        }
+        m_stop = true;
+        m_wakeup.wakeAll();
+        thread = m_thread;
+    }
+
+    // 后台线程把队列中剩余的写操作提交完才退出
+    thread->wait();
+    delete thread;
+
+    QMutexLocker locker(&m_mutex);
+    m_thread = nullptr;
+}
+
+std::future<bool> GroupCommitQueue::submit(const PendingWrite& write)
+{
+    Entry entry;
+    entry.write = write;
+    std::future<bool> result = entry.result.get_future();
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_thread && !m_stop) {
+            m_pending.push_back(std::move(entry));
+            // 队列由空变为非空时唤醒后台线程开始凑批；凑满一批时让它立即提交
+            if (m_pending.size() == 1 || m_pending.size() >= MAX_GROUP_SIZE) {
+                m_wakeup.wakeAll();
+            }
+            return result;
+        }
+    }
+
+    // 后台线程未运行（启动前、退出中）：在调用线程单独提交
+    std::vector<Entry> single;
+    single.push_back(std::move(entry));
+    commit(single);
+    return result;
+}
+
+void GroupCommitQueue::run()
+{
+    QMutexLocker locker(&m_mutex);
+    for (;;) {
+        while (m_pending.empty() && !m_stop) {
+            m_wakeup.wait(&m_mutex);
+        }
+        if (m_pending.empty()) {
+            break;  // 已要求停止且队列已清空
+        }
+
+        // 第一个写操作到达后最多再等GATHER_MS毫秒，让并发的写操作进入同一批
+        QElapsedTimer gather;
+        gather.start();
+        while (!m_stop && m_pending.size() < size_t(MAX_GROUP_SIZE)) {
+            const qint64 remaining = GATHER_MS - gather.elapsed();
+            if (remaining <= 0) {
+                break;
+            }
+            m_wakeup.wait(&m_mutex, static_cast<unsigned long>(remaining));
+        }
+
+        std::vector<Entry> group;
+        if (m_pending.size() <= size_t(MAX_GROUP_SIZE)) {
+            group.swap(m_pending);
+        } else {
+            group.reserve(MAX_GROUP_SIZE);
+            for (int i = 0; i < MAX_GROUP_SIZE; ++i) {
+                group.push_back(std::move(m_pending[i]));
+            }
+            m_pending.erase(m_pending.begin(), m_pending.begin() + MAX_GROUP_SIZE);
+        }
+
+        locker.unlock();
+        commit(group);
+        locker.relock();
+    }
+}
+
+void GroupCommitQueue::commit(std::vector<Entry>& entries)
+{
+    QVector<PendingWrite> writes;
+    writes.reserve(int(entries.size()));
+    for (const Entry &entry : entries) {
+        writes.append(entry.write);
+    }
+
+    QVector<bool> results;
+    Database::getInstance().commitWriteGroup(writes, &results);
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        entries[i].result.set_value(results.value(int(i), false));
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef GROUPCOMMIT_H
+#define GROUPCOMMIT_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <future>
+#include <vector>
+#include "data.h"
+
+class GroupCommitThread;
+
+/**
+ * @brief 组提交队列（单例）：合并高频的单行写入（聊天消息、收藏、评论、优惠券）
+ * @note 各工作线程提交写操作后拿到一个future；后台线程收到第一个写操作后最多再等GATHER_MS毫秒，
+ *       把这段时间内到达的写操作交给Database::commitWriteGroup在一个事务中以多行语句执行，
+ *       一次提交只付出一次落盘开销。未启动时submit直接在调用线程单独提交
+ */
+class GroupCommitQueue
+{
+public:
+    static GroupCommitQueue& getInstance();
+
+    enum {
+        GATHER_MS = 2,         // 凑批等待时间
+        MAX_GROUP_SIZE = 256   // 单个事务最多包含的写操作数
+    };
+
+    void start();  // 启动后台提交线程
+    void stop();   // 停止后台线程，队列中剩余的写操作全部提交后返回（服务器退出时调用）
+
+    std::future<bool> submit(const PendingWrite& write);
+    bool execute(const PendingWrite& write) { return submit(write).get(); }  // 提交并等待结果
+
+private:
+    GroupCommitQueue();
+    ~GroupCommitQueue();
+    GroupCommitQueue(const GroupCommitQueue&) = delete;
+    GroupCommitQueue& operator=(const GroupCommitQueue&) = delete;
+
+    friend class GroupCommitThread;
+
+    struct Entry {
+        PendingWrite write;
+        std::promise<bool> result;
+    };
+
+    void run();  // 后台线程主循环
+    static void commit(std::vector<Entry>& entries);
+
+    QMutex m_mutex;
+    QWaitCondition m_wakeup;
+    std::vector<Entry> m_pending;
+    bool m_running = false;
+    bool m_stop = false;
+    GroupCommitThread* m_thread = nullptr;
+};
+
+#endif // GROUPCOMMIT_H
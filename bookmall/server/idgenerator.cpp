@@ -0,0 +1,45 @@
+#include "idgenerator.h"
+#include <QDateTime>
+#include <QDebug>
+
+IdGenerator::IdGenerator() : m_nodeId(0), m_last(0)
+{
+    bool ok = false;
+    int nodeId = qEnvironmentVariableIntValue("BOOKMALL_NODE_ID", &ok);
+    if (ok && nodeId >= 0 && nodeId <= MAX_NODE_ID) {
+        m_nodeId = nodeId;
+    } else if (qEnvironmentVariableIsSet("BOOKMALL_NODE_ID")) {
+        qWarning() << "❌ BOOKMALL_NODE_ID 无效，应为0 -" << int(MAX_NODE_ID) << "，使用节点号0";
+    }
+    qDebug() << "✓ ID生成器节点号:" << m_nodeId;
+}
+
+IdGenerator& IdGenerator::getInstance()
+{
+    static IdGenerator instance;
+    return instance;
+}
+
+qint64 IdGenerator::nextId()
+{
+    const quint64 now = quint64(qMax<qint64>(0, QDateTime::currentMSecsSinceEpoch() - EPOCH_MS));
+    const quint64 candidate = now << SEQUENCE_BITS;
+
+    quint64 last = m_last.load();
+    quint64 next;
+    do {
+        // 进入新的毫秒时序号归零；同一毫秒或时钟回拨时在上一个值上加一，序号用完自然进位到下一毫秒
+        next = candidate > last ? candidate : last + 1;
+    } while (!m_last.testAndSetOrdered(last, next, last));
+
+    const quint64 millis = next >> SEQUENCE_BITS;
+    const quint64 sequence = next & ((quint64(1) << SEQUENCE_BITS) - 1);
+    return qint64((millis << (NODE_BITS + SEQUENCE_BITS))
+                  | (quint64(m_nodeId) << SEQUENCE_BITS)
+                  | sequence);
+}
+
+QString IdGenerator::nextId(const QString &prefix)
+{
+    return prefix + QString("%1").arg(nextId(), 19, 10, QChar('0'));
+}
@@ -0,0 +1,41 @@
+#ifndef IDGENERATOR_H
+#define IDGENERATOR_H
+
+#include <QAtomicInteger>
+#include <QString>
+
+/**
+ * @brief 64位唯一ID生成器（单例，Snowflake布局）
+ * @note 高41位为自EPOCH_MS起的毫秒数，中间10位为节点号，低12位为毫秒内序号。
+ *       毫秒数和序号合在一个原子变量中以CAS递增，无锁且在本节点内严格单调；同一毫秒内序号用完
+ *       或系统时钟回拨时在上一个ID基础上继续递增，不会重复也不会等待。
+ *       节点号通过环境变量 BOOKMALL_NODE_ID（0-1023）配置，多台服务器共用一个数据库时必须各不相同
+ */
+class IdGenerator
+{
+public:
+    static IdGenerator& getInstance();
+
+    enum {
+        NODE_BITS = 10,
+        SEQUENCE_BITS = 12,
+        MAX_NODE_ID = (1 << NODE_BITS) - 1
+    };
+    static const qint64 EPOCH_MS = 1704067200000LL;  // 2024-01-01 00:00:00 UTC
+
+    qint64 nextId();
+    // 带前缀的字符串ID：数字部分补零到19位，字符串顺序与生成顺序一致
+    QString nextId(const QString &prefix);
+
+    int nodeId() const { return m_nodeId; }
+
+private:
+    IdGenerator();
+    IdGenerator(const IdGenerator&) = delete;
+    IdGenerator& operator=(const IdGenerator&) = delete;
+
+    int m_nodeId;
+    QAtomicInteger<quint64> m_last;  // 最近一次分配的（毫秒数 << SEQUENCE_BITS | 序号）
+};
+
+#endif // IDGENERATOR_H
@@ -0,0 +1,135 @@
+#include "lotteryservice.h"
+#include "data.h"
+#include <QRandomGenerator>
+#include <QThreadStorage>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDebug>
+
+// 每个工作线程一个随机数生成器，线程退出时由QThreadStorage释放
+static QThreadStorage<QRandomGenerator*> s_generators;
+
+LotteryService::LotteryService() : m_totalWeight(0)
+{
+    QString path = QString::fromLocal8Bit(qgetenv("BOOKMALL_LOTTERY_PRIZES"));
+    if (!path.isEmpty()) {
+        m_prizes = loadPrizes(path);
+        if (m_prizes.isEmpty()) {
+            qWarning() << "❌ 抽奖奖品表无效，使用默认奖品:" << path;
+        } else {
+            qDebug() << "✓ 已加载抽奖奖品表:" << path << "共" << m_prizes.size() << "项";
+        }
+    }
+    if (m_prizes.isEmpty()) {
+        m_prizes = defaultPrizes();
+    }
+    for (const LotteryPrize &prize : m_prizes) {
+        m_totalWeight += quint32(prize.weight);
+    }
+}
+
+LotteryService& LotteryService::getInstance()
+{
+    static LotteryService instance;
+    return instance;
+}
+
+QList<LotteryPrize> LotteryService::defaultPrizes()
+{
+    LotteryPrize coupon30;
+    coupon30.name = "30元优惠券";
+    coupon30.couponValue = 30.0;
+    LotteryPrize coupon50;
+    coupon50.name = "50元优惠券";
+    coupon50.couponValue = 50.0;
+    LotteryPrize none;
+    none.name = "谢谢参与";
+    return {coupon30, coupon50, none};
+}
+
+QList<LotteryPrize> LotteryService::loadPrizes(const QString& path)
+{
+    QList<LotteryPrize> prizes;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return prizes;
+    }
+
+    qint64 totalWeight = 0;
+    const QJsonArray items = QJsonDocument::fromJson(file.readAll()).array();
+    for (const QJsonValue &item : items) {
+        const QJsonObject object = item.toObject();
+        LotteryPrize prize;
+        prize.name = object.value("name").toString();
+        prize.couponValue = object.value("couponValue").toDouble();
+        prize.weight = object.value("weight").toInt(1);
+        if (prize.name.isEmpty() || prize.couponValue < 0 || prize.weight < 0) {
+            return QList<LotteryPrize>();  // 有一项无效时整表不用，避免概率与配置不符
+        }
+        if (prize.weight > 0) {
+            totalWeight += prize.weight;
+            prizes.append(prize);
+        }
+    }
+    if (totalWeight <= 0 || totalWeight > 0x7fffffff) {
+        return QList<LotteryPrize>();
+    }
+    return prizes;
+}
+
+QRandomGenerator& LotteryService::threadGenerator()
+{
+    if (!s_generators.hasLocalData()) {
+        quint32 seed[4];
+        QRandomGenerator::system()->fillRange(seed);
+        s_generators.setLocalData(new QRandomGenerator(seed, seed + 4));
+    }
+    return *s_generators.localData();
+}
+
+const LotteryPrize& LotteryService::pick() const
+{
+    // bounded()在[0, 总权重)内均匀取值，落在哪一段即抽中哪一项
+    quint32 value = threadGenerator().bounded(m_totalWeight);
+    for (const LotteryPrize &prize : m_prizes) {
+        if (value < quint32(prize.weight)) {
+            return prize;
+        }
+        value -= quint32(prize.weight);
+    }
+    return m_prizes.last();
+}
+
+QJsonObject LotteryService::draw(int userId)
+{
+    QJsonObject response;
+
+    // 先在内存中抽出奖品，扣积分、发券和读回结果在同一事务中完成；积分不足时整次抽奖作废
+    const LotteryPrize &prize = pick();
+    QJsonObject result = Database::getInstance().settleLotteryDraw(userId, COST_POINTS, prize.couponValue);
+    const int points = result.value("points").toInt();
+
+    if (!result.value("success").toBool()) {
+        response["success"] = false;
+        if (result.value("insufficientPoints").toBool()) {
+            response["message"] = QString("积分不足，无法参与抽奖。当前积分：%1，需要%2积分才能参与抽奖")
+                                  .arg(points).arg(int(COST_POINTS));
+        } else {
+            response["message"] = result.value("message").toString();
+        }
+        return response;
+    }
+
+    const QJsonObject coupons = result.value("coupons").toObject();
+    response["success"] = true;
+    response["message"] = "抽奖成功";
+    response["prize"] = prize.name;
+    response["remainingPoints"] = points;
+    response["coupons"] = coupons;
+    response["coupon30"] = coupons.value(Database::couponKey(30)).toInt();  // 兼容旧客户端
+    response["coupon50"] = coupons.value(Database::couponKey(50)).toInt();
+
+    qDebug() << "用户ID:" << userId << "参与抽奖，获得奖品:" << prize.name << "剩余积分:" << points;
+    return response;
+}
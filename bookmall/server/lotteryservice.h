@@ -0,0 +1,53 @@
+#ifndef LOTTERYSERVICE_H
+#define LOTTERYSERVICE_H
+
+#include <QList>
+#include <QString>
+#include <QJsonObject>
+
+// 奖品表中的一项：couponValue为0表示不发券（如“谢谢参与”），weight为相对权重
+struct LotteryPrize {
+    QString name;
+    double couponValue = 0.0;
+    int weight = 1;
+};
+
+class QRandomGenerator;
+
+/**
+ * @brief 积分抽奖（单例）
+ * @note 每个工作线程使用自己的QRandomGenerator（首次使用时从系统熵源取种子），抽奖时不加锁，
+ *       也不再在并发线程中反复重置全局种子；按权重用bounded()均匀取值，各奖品的概率与权重成正比。
+ *       抽中后由Database::settleLotteryDraw在一个事务中扣积分、发券并读回剩余积分和优惠券数量。
+ *       奖品表默认三项等概率（30元优惠券、50元优惠券、谢谢参与），可通过环境变量
+ *       BOOKMALL_LOTTERY_PRIZES指定JSON文件替换，格式：[{"name": "30元优惠券", "couponValue": 30, "weight": 1}, ...]
+ */
+class LotteryService
+{
+public:
+    static LotteryService& getInstance();
+
+    enum {
+        COST_POINTS = 3  // 每次抽奖消耗的积分（客户端按3积分显示）
+    };
+
+    // 抽奖并结算，返回给客户端的响应（success、message、prize、remainingPoints、coupons等）
+    QJsonObject draw(int userId);
+
+    const QList<LotteryPrize>& prizes() const { return m_prizes; }
+
+private:
+    LotteryService();
+    LotteryService(const LotteryService&) = delete;
+    LotteryService& operator=(const LotteryService&) = delete;
+
+    static QList<LotteryPrize> defaultPrizes();
+    static QList<LotteryPrize> loadPrizes(const QString& path);  // 文件无效时返回空列表
+    static QRandomGenerator& threadGenerator();
+    const LotteryPrize& pick() const;
+
+    QList<LotteryPrize> m_prizes;  // 构造后只读，各线程无需加锁
+    quint32 m_totalWeight;
+};
+
+#endif // LOTTERYSERVICE_H
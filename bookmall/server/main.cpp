@@ -1,5 +1,5 @@
 #include "serverwindow.h"
-#include "data.h"  // MySQL数据库支持
+#include "servercore.h"
 #include <QApplication>
 #include <QMessageBox>
 #include <QDebug>
@@ -7,43 +7,50 @@
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
-    
-    qDebug() << "========================================";
-    qDebug() << "服务器启动 - 数据库模式";
-    qDebug() << "========================================";
-    
-    // 连接到远程数据库
-    // 数据库服务器: 49.232.145.193:3306 (MySQL默认端口)
-    // TCP服务器端口: 8888 (客户端连接端口)
-    if (!Database::getInstance().initConnection(
-            "49.232.145.193",  // 数据库服务器IP
-            3306,              // MySQL端口
-            "test_db",         // 数据库名
-            "root01",          // 用户名
-            "123456")           // 密码
-        ) {
-        QMessageBox::warning(nullptr, "数据库提示", 
+    const QStringList arguments = a.arguments();
+
+    // 监控模式：Server --monitor http://host:9188 ，只显示其他服务器进程（如bookmall-serverd）的运行指标
+    int monitorIndex = arguments.indexOf("--monitor");
+    if (monitorIndex >= 0) {
+        QUrl url = QUrl::fromUserInput(arguments.value(monitorIndex + 1, "http://127.0.0.1:9188"));
+        ServerWindow w(nullptr, url);
+        w.show();
+        return a.exec();
+    }
+
+    // 配置文件：--config <path>、环境变量 BOOKMALL_CONFIG 或程序目录下的bookmall-server.ini（不存在时使用默认配置）
+    // 仍支持环境变量 BOOKMALL_STORAGE=sqlite 和 BOOKMALL_SQLITE_PATH
+    ServerConfig config = ServerConfig::load(ServerConfig::resolvePath(arguments));
+    config.applyToEnvironment();
+
+    ServerCore core(config);
+    ServerCore::StorageBackend backend = core.initStorage();
+    if (backend == ServerCore::SqliteStorage && config.storage != "sqlite") {
+        QMessageBox::warning(nullptr, "数据库提示",
             "无法连接到MySQL数据库！\n\n"
-            "服务器: 49.232.145.193:3306\n"
-            "数据库: test_db\n"
-            "用户: root01\n\n"
+            "服务器: " + QString("%1:%2").arg(config.dbHost).arg(config.dbPort) + "\n"
+            "数据库: " + config.dbName + "\n"
+            "用户: " + config.dbUser + "\n\n"
             "可能原因:\n"
             "1. MySQL驱动未安装 (libmysql.dll)\n"
             "2. 数据库服务器未运行\n"
             "3. 网络连接问题\n"
             "4. 用户名密码错误\n\n"
+            "程序将使用本地SQLite数据库运行：\n" + config.sqlitePath);
+    } else if (backend == ServerCore::MemoryStorage) {
+        QMessageBox::warning(nullptr, "数据库提示",
+            "无法连接到MySQL数据库，本地SQLite数据库也无法打开！\n\n"
+            "SQLite文件: " + config.sqlitePath + "\n\n"
             "程序将使用内存模式运行。");
-        qDebug() << "❌ 数据库连接失败，切换到内存模式";
-    } else {
-        qDebug() << "✅ 数据库连接成功！";
-        qDebug() << "✅ 数据库服务器: 49.232.145.193:3306";
-        qDebug() << "✅ 数据库名称: test_db";
-        qDebug() << "✅ 请求日志功能已启用";
     }
-    
-    qDebug() << "========================================";
-    
-    ServerWindow w;
+
+    ServerWindow w(&core);
+    core.startMetrics();
+    core.startMaintenance();
     w.show();
-    return a.exec();
+    int ret = a.exec();
+
+    // 退出前停止接入、等待连接处理完毕，写回全部未落库的购物车并提交剩余的写操作
+    core.drain();
+    return ret;
 }
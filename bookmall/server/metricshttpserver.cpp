@@ -0,0 +1,70 @@
+#include "metricshttpserver.h"
+#include "servermetrics.h"
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QJsonDocument>
+
+MetricsHttpServer::MetricsHttpServer(QObject *parent)
+    : QTcpServer(parent)
+{
+    connect(this, &QTcpServer::newConnection, this, &MetricsHttpServer::onNewConnection);
+}
+
+bool MetricsHttpServer::start(quint16 port, const QHostAddress &address)
+{
+    return listen(address, port);
+}
+
+void MetricsHttpServer::onNewConnection()
+{
+    while (QTcpSocket* socket = nextPendingConnection()) {
+        connect(socket, &QTcpSocket::readyRead, this, &MetricsHttpServer::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, socket, &QTcpSocket::deleteLater);
+    }
+}
+
+// 只解析请求行；请求头在收到空行之前不处理，避免半包
+void MetricsHttpServer::onReadyRead()
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket) return;
+
+    QByteArray buffer = socket->property("httpBuffer").toByteArray() + socket->readAll();
+    if (!buffer.contains("\r\n\r\n")) {
+        if (buffer.size() > 8192) {
+            sendResponse(socket, "431 Request Header Fields Too Large", "text/plain", "too large\n");
+        } else {
+            socket->setProperty("httpBuffer", buffer);
+        }
+        return;
+    }
+
+    QList<QByteArray> requestLine = buffer.left(buffer.indexOf("\r\n")).split(' ');
+    QByteArray method = requestLine.value(0);
+    QByteArray path = requestLine.value(1);
+
+    if (method != "GET") {
+        sendResponse(socket, "405 Method Not Allowed", "text/plain", "method not allowed\n");
+    } else if (path == "/metrics") {
+        sendResponse(socket, "200 OK", "text/plain; version=0.0.4; charset=utf-8",
+                     ServerMetrics::getInstance().prometheusText());
+    } else if (path == "/metrics.json") {
+        sendResponse(socket, "200 OK", "application/json; charset=utf-8",
+                     QJsonDocument(ServerMetrics::getInstance().snapshot()).toJson(QJsonDocument::Compact));
+    } else {
+        sendResponse(socket, "404 Not Found", "text/plain", "not found\n");
+    }
+}
+
+void MetricsHttpServer::sendResponse(QTcpSocket *socket, const QByteArray &status,
+                                     const QByteArray &contentType, const QByteArray &body)
+{
+    QByteArray response;
+    response += "HTTP/1.1 " + status + "\r\n";
+    response += "Content-Type: " + contentType + "\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += "Connection: close\r\n\r\n";
+    response += body;
+    socket->write(response);
+    socket->disconnectFromHost();
+}
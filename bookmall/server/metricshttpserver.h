@@ -0,0 +1,33 @@
+#ifndef METRICSHTTPSERVER_H
+#define METRICSHTTPSERVER_H
+
+#include <QTcpServer>
+#include <QHostAddress>
+
+class QTcpSocket;
+
+/**
+ * @brief 本地指标端口：以HTTP GET /metrics 输出Prometheus文本格式的服务器指标，
+ *        GET /metrics.json 输出与adminGetServerMetrics相同的JSON（供服务器监控窗口读取）
+ * @note 默认只监听127.0.0.1，不对外暴露；业务请求仍走TCP_PORT上的JSON协议
+ */
+class MetricsHttpServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsHttpServer(QObject *parent = nullptr);
+
+    // 启动监听（默认127.0.0.1:9188）
+    bool start(quint16 port = 9188, const QHostAddress &address = QHostAddress::LocalHost);
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    void sendResponse(QTcpSocket* socket, const QByteArray& status,
+                      const QByteArray& contentType, const QByteArray& body);
+};
+
+#endif // METRICSHTTPSERVER_H
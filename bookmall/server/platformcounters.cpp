@@ -0,0 +1,133 @@
+#include "platformcounters.h"
+#include "data.h"
+#include <QDebug>
+
+static const QString kPendingCertificationStatus = "待审核";
+
+PlatformCounters::PlatformCounters()
+{
+}
+
+PlatformCounters& PlatformCounters::getInstance()
+{
+    static PlatformCounters instance;
+    return instance;
+}
+
+QAtomicInt* PlatformCounters::roleCounter(int role)
+{
+    switch (role) {
+    case 0:
+        return &m_applicants;
+    case 1:
+        return &m_buyers;
+    default:
+        return nullptr;  // 卖家等其他角色不单独计数
+    }
+}
+
+void PlatformCounters::userAdded(int role)
+{
+    m_users.ref();
+    if (QAtomicInt *counter = roleCounter(role)) {
+        counter->ref();
+    }
+}
+
+void PlatformCounters::userRemoved(int role)
+{
+    m_users.deref();
+    if (QAtomicInt *counter = roleCounter(role)) {
+        counter->deref();
+    }
+}
+
+void PlatformCounters::userRoleChanged(int oldRole, int newRole)
+{
+    if (oldRole == newRole) {
+        return;
+    }
+    if (QAtomicInt *counter = roleCounter(oldRole)) {
+        counter->deref();
+    }
+    if (QAtomicInt *counter = roleCounter(newRole)) {
+        counter->ref();
+    }
+}
+
+void PlatformCounters::certificationStatusChanged(const QString& oldStatus, const QString& newStatus)
+{
+    const bool wasPending = oldStatus == kPendingCertificationStatus;
+    const bool isPending = newStatus == kPendingCertificationStatus;
+    if (wasPending && !isPending) {
+        m_pendingCertifications.deref();
+    } else if (!wasPending && isPending) {
+        m_pendingCertifications.ref();
+    }
+}
+
+void PlatformCounters::sellerAdded()
+{
+    m_sellers.ref();
+}
+
+void PlatformCounters::sellerRemoved()
+{
+    m_sellers.deref();
+}
+
+void PlatformCounters::booksAdded(int count)
+{
+    m_books.fetchAndAddOrdered(count);
+}
+
+void PlatformCounters::bookRemoved()
+{
+    m_books.deref();
+}
+
+bool PlatformCounters::reconcile()
+{
+    QMutexLocker locker(&m_reconcileMutex);
+
+    PlatformTotals totals;
+    int drift = 0;
+    if (!Database::getInstance().reconcilePlatformCounters(totals, &drift)) {
+        qWarning() << "❌ 平台计数校对失败：统计查询出错";
+        return false;
+    }
+
+    if (m_loaded.testAndSetOrdered(0, 1)) {
+        qDebug() << "✓ 平台计数已加载：用户" << totals.users << "商家" << totals.sellers << "图书" << totals.books;
+    } else if (drift > 0) {
+        qDebug() << "平台计数校对完成，修正偏差" << drift;
+    }
+    return true;
+}
+
+int PlatformCounters::storeTotals(const PlatformTotals& totals)
+{
+    return qAbs(m_users.fetchAndStoreOrdered(totals.users) - totals.users)
+           + qAbs(m_buyers.fetchAndStoreOrdered(totals.buyers) - totals.buyers)
+           + qAbs(m_applicants.fetchAndStoreOrdered(totals.applicants) - totals.applicants)
+           + qAbs(m_sellers.fetchAndStoreOrdered(totals.sellers) - totals.sellers)
+           + qAbs(m_pendingCertifications.fetchAndStoreOrdered(totals.pendingCertifications) - totals.pendingCertifications)
+           + qAbs(m_books.fetchAndStoreOrdered(totals.books) - totals.books);
+}
+
+QJsonObject PlatformCounters::systemStats()
+{
+    // 启动后的首次校对还没完成时，先同步统计一次
+    if (!isLoaded()) {
+        reconcile();
+    }
+
+    QJsonObject stats;
+    stats["totalUsers"] = m_users.loadAcquire();
+    stats["totalBuyers"] = m_buyers.loadAcquire();
+    stats["totalSellers"] = m_sellers.loadAcquire();
+    // 待审核商家：role=0的用户和“待审核”的认证记录是同一批申请的两种来源，取较大值避免重复计算
+    stats["pendingSellers"] = qMax(m_applicants.loadAcquire(), m_pendingCertifications.loadAcquire());
+    stats["totalBooks"] = m_books.loadAcquire();
+    return stats;
+}
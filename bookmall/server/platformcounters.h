@@ -0,0 +1,67 @@
+#ifndef PLATFORMCOUNTERS_H
+#define PLATFORMCOUNTERS_H
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QJsonObject>
+#include <QString>
+
+struct PlatformTotals;
+
+/**
+ * @brief 平台计数（单例），管理员系统统计直接读内存中的计数
+ * @note 注册、删除用户，申请/通过/拒绝卖家认证，增删商家和图书时，Database在同一把写锁内调用
+ *       对应的事件方法增减计数；ServerCore启动后和每RECONCILE_INTERVAL_MINUTES分钟在后台线程
+ *       调用reconcile()按数据库COUNT校对一次（迁移、手工改库等不经过事件的变更在校对时修正），
+ *       统计和写回在同一把写锁内完成，期间不会有事件到达。
+ *       systemStats()只读原子计数，不访问数据库，不占用数据库锁。
+ */
+class PlatformCounters
+{
+public:
+    static PlatformCounters& getInstance();
+
+    enum {
+        RECONCILE_INTERVAL_MINUTES = 10
+    };
+
+    // 用户事件（role：0=申请卖家审核中，1=买家，2=卖家；role未知时传-1）
+    void userAdded(int role);
+    void userRemoved(int role);
+    void userRoleChanged(int oldRole, int newRole);
+
+    // 卖家认证状态变化（只有“待审核”计入待审核商家数）
+    void certificationStatusChanged(const QString& oldStatus, const QString& newStatus);
+
+    void sellerAdded();
+    void sellerRemoved();
+    void booksAdded(int count = 1);
+    void bookRemoved();
+
+    // 按数据库重新统计并修正计数；失败返回false（计数保持不变）
+    bool reconcile();
+    // 用统计值覆盖计数，返回修正的偏差总和（Database在写锁内调用）
+    int storeTotals(const PlatformTotals& totals);
+    bool isLoaded() const { return m_loaded.loadAcquire() != 0; }
+
+    // 管理员系统统计：totalUsers、totalBuyers、totalSellers、pendingSellers、totalBooks
+    QJsonObject systemStats();
+
+private:
+    PlatformCounters();
+    PlatformCounters(const PlatformCounters&) = delete;
+    PlatformCounters& operator=(const PlatformCounters&) = delete;
+
+    QAtomicInt* roleCounter(int role);
+
+    QAtomicInt m_users;
+    QAtomicInt m_buyers;
+    QAtomicInt m_applicants;
+    QAtomicInt m_sellers;
+    QAtomicInt m_pendingCertifications;
+    QAtomicInt m_books;
+    QAtomicInt m_loaded;
+    QMutex m_reconcileMutex;  // 同一时间只做一次校对
+};
+
+#endif // PLATFORMCOUNTERS_H
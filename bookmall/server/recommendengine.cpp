@@ -0,0 +1,272 @@
+#include "recommendengine.h"
+#include "data.h"
+#include "threadpool.h"
+#include <QDate>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+// 收藏表达的购买意愿弱于下单，行为权重打折
+static const double kFavoriteWeight = 0.5;
+// 用户越早的行为对推荐的影响越小：第i本最近图书的权重为 kRecencyDecay^i
+static const double kRecencyDecay = 0.9;
+
+// 后台重建任务（在后台维护线程池中执行）
+class RecommendRebuildTask : public Task
+{
+public:
+    void run() override
+    {
+        RecommendEngine::getInstance().rebuild();
+    }
+};
+
+// 只保留得分最高的n项（得分相同按图书ID排序，结果稳定）
+static void keepTop(QVector<QPair<QString, double>> &list, int n)
+{
+    auto byScore = [](const QPair<QString, double> &a, const QPair<QString, double> &b) {
+        return a.second > b.second || (a.second == b.second && a.first < b.first);
+    };
+    if (list.size() > n) {
+        std::partial_sort(list.begin(), list.begin() + n, list.end(), byScore);
+        list.resize(n);
+    } else {
+        std::sort(list.begin(), list.end(), byScore);
+    }
+}
+
+RecommendEngine::RecommendEngine() : m_rebuilding(0)
+{
+}
+
+RecommendEngine& RecommendEngine::getInstance()
+{
+    static RecommendEngine instance;
+    return instance;
+}
+
+void RecommendEngine::scheduleRebuild()
+{
+    if (!m_rebuilding.testAndSetOrdered(0, 1)) {
+        return;  // 上一次重建尚未完成
+    }
+    if (!ThreadPool::getInstance().addBackgroundTask("recommendRebuild", new RecommendRebuildTask)) {
+        m_rebuilding.storeRelease(0);  // 上一个重建任务刚结束、尚未释放，本次跳过
+    }
+}
+
+void RecommendEngine::rebuild()
+{
+    Database &db = Database::getInstance();
+    if (!db.isConnected()) {
+        m_rebuilding.storeRelease(0);
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const QDate today = QDate::currentDate();
+    QJsonArray events = db.getInteractionEvents(today.addDays(-HISTORY_DAYS).toString("yyyy-MM-dd"));
+    QJsonArray bookArray = db.getBookSummaries();
+
+    QHash<QString, QJsonObject> books;
+    books.reserve(bookArray.size());
+    for (const QJsonValue &value : bookArray) {
+        QJsonObject book = value.toObject();
+        books.insert(book["bookId"].toString(), book);
+    }
+
+    // 1. 用户 -> (图书 -> 行为权重)，以及每本书的衰减热度
+    QHash<int, QHash<QString, double>> userItems;
+    QHash<QString, double> popularity;
+    for (const QJsonValue &value : events) {
+        QJsonObject event = value.toObject();
+        QDate date = QDate::fromString(event["date"].toString(), "yyyy-MM-dd");
+        int age = date.isValid() ? int(qMax(qint64(0), date.daysTo(today))) : int(HISTORY_DAYS);
+        double weight = std::pow(0.5, double(age) / HALF_LIFE_DAYS);
+        if (event["type"].toString() == "favorite") {
+            weight *= kFavoriteWeight;
+        }
+
+        QHash<QString, double> &items = userItems[event["userId"].toInt()];
+        for (const QJsonValue &bookVal : event["bookIds"].toArray()) {
+            QString bookId = bookVal.toString();
+            popularity[bookId] += weight;
+            double &itemWeight = items[bookId];
+            itemWeight = qMax(itemWeight, weight);
+        }
+    }
+
+    // 2. 图书两两共现：同一用户的两本书按较小的行为权重计一次
+    QHash<QString, QHash<QString, double>> cooccur;
+    for (auto user = userItems.constBegin(); user != userItems.constEnd(); ++user) {
+        QVector<ScoredBook> items;
+        items.reserve(user.value().size());
+        for (auto it = user.value().constBegin(); it != user.value().constEnd(); ++it) {
+            items.append(qMakePair(it.key(), it.value()));
+        }
+        keepTop(items, MAX_ITEMS_PER_USER);
+
+        for (int i = 0; i < items.size(); ++i) {
+            for (int j = i + 1; j < items.size(); ++j) {
+                double weight = qMin(items.at(i).second, items.at(j).second);
+                cooccur[items.at(i).first][items.at(j).first] += weight;
+                cooccur[items.at(j).first][items.at(i).first] += weight;
+            }
+        }
+    }
+
+    // 3. 每本书的相似图书：共现按两本书热度归一化，避免热门书出现在所有列表里
+    QHash<QString, QVector<ScoredBook>> neighbors;
+    neighbors.reserve(cooccur.size());
+    for (auto it = cooccur.constBegin(); it != cooccur.constEnd(); ++it) {
+        const double popA = popularity.value(it.key());
+        QVector<ScoredBook> list;
+        list.reserve(it.value().size());
+        for (auto other = it.value().constBegin(); other != it.value().constEnd(); ++other) {
+            if (!books.contains(other.key())) {
+                continue;  // 已下架或待审核的图书不推荐
+            }
+            double norm = std::sqrt(popA * popularity.value(other.key()));
+            if (norm > 0) {
+                list.append(qMakePair(other.key(), other.value() / norm));
+            }
+        }
+        keepTop(list, NEIGHBORS_PER_BOOK);
+        if (!list.isEmpty()) {
+            neighbors.insert(it.key(), list);
+        }
+    }
+
+    // 4. 热门榜
+    QVector<ScoredBook> popular;
+    for (auto it = popularity.constBegin(); it != popularity.constEnd(); ++it) {
+        if (books.contains(it.key())) {
+            popular.append(qMakePair(it.key(), it.value()));
+        }
+    }
+    keepTop(popular, POPULAR_SIZE);
+
+    const int neighborLists = neighbors.size();
+    {
+        QWriteLocker locker(&m_lock);
+        m_neighbors.swap(neighbors);
+        m_popular.swap(popular);
+        m_books.swap(books);
+    }
+    m_rebuilding.storeRelease(0);
+
+    qDebug() << "✓ 推荐数据已重建：行为" << events.size() << "条，用户" << userItems.size()
+             << "个，相似列表" << neighborLists << "个，耗时" << timer.elapsed() << "ms";
+}
+
+void RecommendEngine::recordInteraction(int userId, const QStringList &bookIds)
+{
+    if (userId <= 0 || bookIds.isEmpty()) {
+        return;
+    }
+
+    QWriteLocker locker(&m_lock);
+    auto it = m_userRecent.find(userId);
+    if (it == m_userRecent.end()) {
+        return;  // 未缓存：下次请求时从数据库读取，已包含本次行为
+    }
+
+    QStringList &recent = it.value();
+    for (int i = bookIds.size() - 1; i >= 0; --i) {
+        recent.removeAll(bookIds.at(i));
+        recent.prepend(bookIds.at(i));
+    }
+    while (recent.size() > RECENT_ITEMS) {
+        recent.removeLast();
+    }
+}
+
+QStringList RecommendEngine::userRecentBooks(int userId)
+{
+    {
+        QReadLocker locker(&m_lock);
+        auto it = m_userRecent.constFind(userId);
+        if (it != m_userRecent.constEnd()) {
+            return it.value();
+        }
+    }
+
+    // 查询数据库时不持有引擎锁
+    QStringList recent = Database::getInstance().getUserRecentBookIds(userId, RECENT_ITEMS);
+
+    QWriteLocker locker(&m_lock);
+    if (!m_userRecent.contains(userId)) {
+        if (m_userRecent.size() >= USER_CACHE_LIMIT) {
+            m_userRecent.clear();
+        }
+        m_userRecent.insert(userId, recent);
+    }
+    return m_userRecent.value(userId);
+}
+
+QJsonArray RecommendEngine::recommend(int userId, int k)
+{
+    k = qBound(1, k, int(MAX_RESULTS));
+
+    QStringList recent = userId > 0 ? userRecentBooks(userId) : QStringList();
+    QSet<QString> excluded;  // 已购买/收藏过的和已选中的
+    for (const QString &bookId : recent) {
+        excluded.insert(bookId);
+    }
+
+    QReadLocker locker(&m_lock);
+
+    // 合并最近图书的相似列表
+    QHash<QString, double> scores;
+    double recency = 1.0;
+    for (const QString &bookId : recent) {
+        auto it = m_neighbors.constFind(bookId);
+        if (it != m_neighbors.constEnd()) {
+            for (const ScoredBook &neighbor : it.value()) {
+                if (!excluded.contains(neighbor.first)) {
+                    scores[neighbor.first] += recency * neighbor.second;
+                }
+            }
+        }
+        recency *= kRecencyDecay;
+    }
+
+    QVector<ScoredBook> ranked;
+    ranked.reserve(scores.size());
+    for (auto it = scores.constBegin(); it != scores.constEnd(); ++it) {
+        ranked.append(qMakePair(it.key(), it.value()));
+    }
+    keepTop(ranked, k);
+
+    QJsonArray result;
+    for (const ScoredBook &entry : ranked) {
+        QJsonObject item = m_books.value(entry.first);
+        item["score"] = entry.second;
+        item["reason"] = "similar";
+        result.append(item);
+        excluded.insert(entry.first);
+    }
+
+    // 相似推荐不足k本时用热门榜补齐（新用户只有热门）
+    for (const ScoredBook &entry : m_popular) {
+        if (result.size() >= k) {
+            break;
+        }
+        if (excluded.contains(entry.first)) {
+            continue;
+        }
+        QJsonObject item = m_books.value(entry.first);
+        item["score"] = entry.second;
+        item["reason"] = "popular";
+        result.append(item);
+        excluded.insert(entry.first);
+    }
+
+    return result;
+}
@@ -0,0 +1,69 @@
+#ifndef RECOMMENDENGINE_H
+#define RECOMMENDENGINE_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+#include <QPair>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QReadWriteLock>
+#include <QAtomicInt>
+
+/**
+ * @brief 个性化推荐引擎（单例）
+ * @note 离线构建（后台线程定时执行rebuild）：
+ *         - 按用户聚合近HISTORY_DAYS天的下单和收藏行为，行为权重随时间指数衰减（半衰期HALF_LIFE_DAYS天）
+ *         - 统计图书两两共现（同一用户买过/收藏过），按 共现 / sqrt(热度a × 热度b) 归一化，
+ *           每本书只在内存中保留得分最高的NEIGHBORS_PER_BOOK本相似图书
+ *         - 全站按衰减热度排出热门榜，用于新用户和补齐
+ *       在线服务（getRecommendations动作）：取用户最近的RECENT_ITEMS本书，合并它们的相似列表取前K本，
+ *       排除已购买/收藏过的；下单和收藏成功后通过recordInteraction增量更新用户最近行为
+ */
+class RecommendEngine
+{
+public:
+    static RecommendEngine& getInstance();
+
+    enum {
+        NEIGHBORS_PER_BOOK = 20,   // 每本书保留的相似图书数
+        POPULAR_SIZE = 100,        // 热门榜长度
+        RECENT_ITEMS = 20,         // 参与推荐的用户最近图书数
+        MAX_ITEMS_PER_USER = 50,   // 统计共现时每个用户最多取的图书数（避免重度用户产生过多图书对）
+        HISTORY_DAYS = 180,        // 参与构建的行为时间窗口
+        HALF_LIFE_DAYS = 30,       // 行为权重的半衰期
+        USER_CACHE_LIMIT = 10000,  // 用户最近行为缓存上限
+        MAX_RESULTS = 50           // 单次请求最多返回的推荐数
+    };
+
+    // 提交一次后台重建（已有重建在执行时忽略）
+    void scheduleRebuild();
+    // 从数据库重建相似图书表和热门榜（在调用线程同步执行）
+    void rebuild();
+
+    // 下单/收藏成功后调用：记入用户最近行为，下次请求立即生效（共现在下次重建时更新）
+    void recordInteraction(int userId, const QStringList &bookIds);
+
+    // 为用户推荐k本图书：[{bookId, bookName, author, price, category1, category2, merchantId, score, reason}]
+    QJsonArray recommend(int userId, int k);
+
+private:
+    RecommendEngine();
+    RecommendEngine(const RecommendEngine&) = delete;
+    RecommendEngine& operator=(const RecommendEngine&) = delete;
+
+    typedef QPair<QString, double> ScoredBook;  // (图书ID, 得分)
+
+    QStringList userRecentBooks(int userId);
+
+    mutable QReadWriteLock m_lock;
+    QHash<QString, QVector<ScoredBook>> m_neighbors;  // 图书ID -> 相似图书（得分从高到低）
+    QVector<ScoredBook> m_popular;                    // 热门榜（衰减热度从高到低）
+    QHash<QString, QJsonObject> m_books;              // 在售图书基本信息（不在其中的图书不推荐）
+    QHash<int, QStringList> m_userRecent;             // 用户ID -> 最近图书（懒加载，按时间倒序）
+
+    QAtomicInt m_rebuilding;
+};
+
+#endif // RECOMMENDENGINE_H
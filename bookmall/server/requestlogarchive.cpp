@@ -0,0 +1,343 @@
+#include "requestlogarchive.h"
+#include "data.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QMap>
+#include <QVector>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+#include <functional>
+
+// 读取正整数环境变量（允许0），未设置或无效时返回默认值
+static int envDays(const char* name, int defaultValue)
+{
+    bool ok = false;
+    int value = qEnvironmentVariableIntValue(name, &ok);
+    return ok && value >= 0 ? value : defaultValue;
+}
+
+// 修改index.json中某一天的条目
+static QJsonObject dayEntry(const QJsonObject& index, const QString& dayKey)
+{
+    return index.value("days").toObject().value(dayKey).toObject();
+}
+
+static void setDayEntry(QJsonObject& index, const QString& dayKey, const QJsonObject& entry)
+{
+    QJsonObject days = index.value("days").toObject();
+    days[dayKey] = entry;
+    index["days"] = days;
+}
+
+static void setSourceProgress(QJsonObject& index, const QString& dayKey, const QString& source, qint64 lastId)
+{
+    QJsonObject entry = dayEntry(index, dayKey);
+    QJsonObject sources = entry.value("sources").toObject();
+    sources[source] = double(lastId);
+    entry["sources"] = sources;
+    setDayEntry(index, dayKey, entry);
+}
+
+RequestLogArchive::RequestLogArchive()
+{
+    m_hotDays = qMax(1, envDays("BOOKMALL_LOG_HOT_DAYS", DEFAULT_HOT_DAYS));
+    m_archiveDays = envDays("BOOKMALL_LOG_ARCHIVE_DAYS", DEFAULT_ARCHIVE_DAYS);
+    m_dir = QString::fromLocal8Bit(qgetenv("BOOKMALL_LOG_ARCHIVE_DIR"));
+    if (m_dir.isEmpty()) {
+        m_dir = QCoreApplication::applicationDirPath() + "/request_log_archive";
+    }
+}
+
+RequestLogArchive& RequestLogArchive::getInstance()
+{
+    static RequestLogArchive instance;
+    return instance;
+}
+
+QString RequestLogArchive::dayFilePath(const QDate& day) const
+{
+    return m_dir + "/" + Database::requestLogPartitionName(day) + ".log.z";
+}
+
+QJsonObject RequestLogArchive::loadIndex() const
+{
+    QFile file(m_dir + "/index.json");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QJsonObject();
+    }
+    return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+bool RequestLogArchive::saveIndex(const QJsonObject& index) const
+{
+    // 整体替换写入，中途失败不会留下半个索引文件
+    QSaveFile file(m_dir + "/index.json");
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "❌ 无法写入日志归档索引:" << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(index).toJson(QJsonDocument::Indented));
+    return file.commit();
+}
+
+int RequestLogArchive::runRetention()
+{
+    QMutexLocker locker(&m_mutex);
+    Database& db = Database::getInstance();
+    if (!db.isConnected()) {
+        return 0;
+    }
+    if (!QDir().mkpath(m_dir)) {
+        qWarning() << "❌ 无法创建日志归档目录:" << m_dir;
+        return 0;
+    }
+
+    QJsonObject index = loadIndex();
+    const QDate cutoff = QDate::currentDate().addDays(-m_hotDays);  // 早于这一天的日志归档
+    int archived = 0;
+
+    for (const QString &table : db.requestLogPartitions()) {
+        const QDate day = Database::requestLogPartitionDay(table);
+        if (day >= cutoff) {
+            break;  // 分表按日期升序
+        }
+        int rows = archiveTable(table, day, index);
+        if (rows < 0) {
+            continue;  // 归档失败的分表保留，下次重试
+        }
+        archived += rows;
+        db.dropRequestLogPartition(table);
+    }
+
+    int legacyRows = archiveLegacyRows(QDateTime(cutoff, QTime(0, 0)), index);
+    if (legacyRows > 0) {
+        archived += legacyRows;
+    }
+
+    purgeExpired(index);
+    saveIndex(index);
+
+    if (archived > 0) {
+        qDebug() << "✓ 请求日志已归档" << archived << "条，归档目录:" << m_dir;
+    }
+    return archived;
+}
+
+int RequestLogArchive::archiveTable(const QString& table, const QDate& day, QJsonObject& index)
+{
+    const QString dayKey = day.toString("yyyyMMdd");
+    // 从上次归档到的id继续，中断后重跑不会重复写入
+    qint64 afterId = qint64(dayEntry(index, dayKey).value("sources").toObject().value(table).toDouble());
+    int total = 0;
+
+    for (;;) {
+        bool ok = false;
+        QJsonArray rows = Database::getInstance().fetchRequestLogRows(table, afterId, FETCH_BATCH_ROWS, QDateTime(), &ok);
+        if (!ok) {
+            return -1;
+        }
+        if (rows.isEmpty()) {
+            break;
+        }
+        if (!appendRows(day, rows, index)) {
+            return -1;
+        }
+        afterId = qint64(rows.last().toObject().value("id").toDouble());
+        setSourceProgress(index, dayKey, table, afterId);
+        if (!saveIndex(index)) {
+            return -1;
+        }
+        total += rows.size();
+        if (rows.size() < FETCH_BATCH_ROWS) {
+            break;
+        }
+    }
+    return total;
+}
+
+int RequestLogArchive::archiveLegacyRows(const QDateTime& before, QJsonObject& index)
+{
+    static const QString legacyTable = "request_logs";
+    qint64 afterId = qint64(index.value("legacyLastId").toDouble());
+    int total = 0;
+
+    for (;;) {
+        bool ok = false;
+        QJsonArray rows = Database::getInstance().fetchRequestLogRows(legacyTable, afterId, FETCH_BATCH_ROWS, before, &ok);
+        if (!ok) {
+            return -1;
+        }
+        if (rows.isEmpty()) {
+            break;
+        }
+
+        // 旧表不分天：按请求时间拆到各天的归档文件。中途失败时丢弃本批对索引的修改，
+        // 已写入的块在下次追加前被截掉，与legacyLastId保持一致
+        const QJsonObject indexBefore = index;
+        QMap<QDate, QJsonArray> byDay;
+        for (const QJsonValue &row : rows) {
+            QDate day = QDateTime::fromString(row.toObject().value("timestamp").toString(), Qt::ISODate).date();
+            if (!day.isValid()) {
+                day = before.date().addDays(-1);
+            }
+            byDay[day].append(row);
+        }
+        for (auto it = byDay.constBegin(); it != byDay.constEnd(); ++it) {
+            if (!appendRows(it.key(), it.value(), index)) {
+                index = indexBefore;
+                return -1;
+            }
+        }
+
+        afterId = qint64(rows.last().toObject().value("id").toDouble());
+        index["legacyLastId"] = double(afterId);
+        if (!saveIndex(index)) {
+            return -1;
+        }
+        Database::getInstance().deleteRequestLogRows(legacyTable, afterId, before);
+        total += rows.size();
+        if (rows.size() < FETCH_BATCH_ROWS) {
+            break;
+        }
+    }
+    return total;
+}
+
+bool RequestLogArchive::appendRows(const QDate& day, const QJsonArray& rows, QJsonObject& index)
+{
+    const QString dayKey = day.toString("yyyyMMdd");
+    QJsonObject entry = dayEntry(index, dayKey);
+    const qint64 committedBytes = qint64(entry.value("bytes").toDouble());
+
+    QFile file(dayFilePath(day));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "❌ 无法打开日志归档文件:" << file.fileName() << file.errorString();
+        return false;
+    }
+    // 文件比索引记录的长，说明上次写完块后没来得及保存索引：截掉这些块，本批会重新写入
+    if (file.size() > committedBytes) {
+        qWarning() << "日志归档文件有未确认的数据，截回" << committedBytes << "字节:" << file.fileName();
+        if (!file.resize(committedBytes) || !file.seek(committedBytes)) {
+            qWarning() << "❌ 截断日志归档文件失败:" << file.fileName() << file.errorString();
+            return false;
+        }
+    }
+
+    // 每块：4字节大端长度 + qCompress压缩的JSON Lines
+    int blocks = 0;
+    for (int begin = 0; begin < rows.size(); begin += ROWS_PER_BLOCK) {
+        QByteArray lines;
+        const int end = qMin(rows.size(), begin + int(ROWS_PER_BLOCK));
+        for (int i = begin; i < end; ++i) {
+            lines += QJsonDocument(rows.at(i).toObject()).toJson(QJsonDocument::Compact);
+            lines += '\n';
+        }
+        const QByteArray block = qCompress(lines, 9);
+        uchar header[4];
+        qToBigEndian<quint32>(quint32(block.size()), header);
+        if (file.write(reinterpret_cast<const char*>(header), 4) != 4 || file.write(block) != block.size()) {
+            qWarning() << "❌ 写入日志归档文件失败:" << file.fileName() << file.errorString();
+            return false;
+        }
+        ++blocks;
+    }
+    if (!file.flush()) {
+        return false;
+    }
+
+    entry["rows"] = entry.value("rows").toInt() + rows.size();
+    entry["blocks"] = entry.value("blocks").toInt() + blocks;
+    entry["bytes"] = double(file.size());
+    setDayEntry(index, dayKey, entry);
+    return true;
+}
+
+void RequestLogArchive::purgeExpired(QJsonObject& index)
+{
+    if (m_archiveDays <= 0) {
+        return;  // 永久保留
+    }
+    const QDate cutoff = QDate::currentDate().addDays(-m_archiveDays);
+    QJsonObject days = index.value("days").toObject();
+    for (const QString &dayKey : days.keys()) {
+        const QDate day = QDate::fromString(dayKey, "yyyyMMdd");
+        if (day.isValid() && day < cutoff) {
+            QFile::remove(dayFilePath(day));
+            days.remove(dayKey);
+            qDebug() << "已删除过期的日志归档:" << dayKey;
+        }
+    }
+    index["days"] = days;
+}
+
+QJsonArray RequestLogArchive::search(int limit, const QString& category, const QString& action)
+{
+    QMutexLocker locker(&m_mutex);
+    QJsonArray logs;
+    if (limit <= 0) {
+        return logs;
+    }
+
+    // 索引中的日期键为yyyyMMdd，倒序即从最近的一天开始
+    const QJsonObject days = loadIndex().value("days").toObject();
+    QStringList dayKeys = days.keys();
+    std::sort(dayKeys.begin(), dayKeys.end(), std::greater<QString>());
+
+    for (const QString &dayKey : dayKeys) {
+        QFile file(dayFilePath(QDate::fromString(dayKey, "yyyyMMdd")));
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        // 只读索引已确认的部分，末尾未确认或不完整的块（写入中断）不参与查询
+        const qint64 committedBytes = qMin(file.size(), qint64(days.value(dayKey).toObject().value("bytes").toDouble()));
+
+        // 块内和块间都按id升序：先只读块头得到各块位置，再从最后一块开始逐块解压，够limit条即停止
+        QVector<QPair<qint64, quint32>> blocks;
+        qint64 pos = 0;
+        uchar header[4];
+        while (pos + 4 <= committedBytes && file.seek(pos) && file.read(reinterpret_cast<char*>(header), 4) == 4) {
+            const quint32 length = qFromBigEndian<quint32>(header);
+            if (pos + 4 + qint64(length) > committedBytes) {
+                break;
+            }
+            blocks.append(qMakePair(pos + 4, length));
+            pos += 4 + qint64(length);
+        }
+
+        for (int b = blocks.size() - 1; b >= 0 && logs.size() < limit; --b) {
+            if (!file.seek(blocks.at(b).first)) {
+                break;
+            }
+            const QByteArray lines = qUncompress(file.read(blocks.at(b).second));
+            const QList<QByteArray> rows = lines.split('\n');
+            for (int i = rows.size() - 1; i >= 0 && logs.size() < limit; --i) {
+                if (rows.at(i).isEmpty()) {
+                    continue;
+                }
+                const QJsonObject row = QJsonDocument::fromJson(rows.at(i)).object();
+                if ((!category.isEmpty() && row.value("category").toString() != category)
+                    || (!action.isEmpty() && row.value("action").toString() != action)) {
+                    continue;
+                }
+                QJsonObject log;
+                log["id"] = row.value("id");
+                log["timestamp"] = row.value("timestamp");
+                log["clientIp"] = row.value("clientIp");
+                log["clientPort"] = row.value("clientPort");
+                log["action"] = row.value("action");
+                log["success"] = row.value("success");
+                log["category"] = row.value("category");
+                log["partition"] = "archive:" + dayKey;
+                logs.append(log);
+            }
+        }
+        if (logs.size() >= limit) {
+            break;
+        }
+    }
+    return logs;
+}
@@ -0,0 +1,62 @@
+#ifndef REQUESTLOGARCHIVE_H
+#define REQUESTLOGARCHIVE_H
+
+#include <QMutex>
+#include <QDate>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+
+/**
+ * @brief 请求日志保留与归档（单例）
+ * @note 请求日志按天分表写入（见Database::logRequest）。runRetention把超过hotDays天的分表
+ *       逐批读出，以压缩块追加到归档目录下的 request_logs_yyyyMMdd.log.z，完成后删除分表；
+ *       分表之前的request_logs旧表按天拆分后同样归档并删除。超过archiveDays天的归档文件被删除。
+ *       归档目录下的index.json记录每天的行数、块数、已确认的文件长度和各来源表已归档到的id；
+ *       追加前先把文件截回索引记录的长度，中断在写块与写索引之间时重跑不会重复归档。
+ *       配置：BOOKMALL_LOG_HOT_DAYS（默认7）、BOOKMALL_LOG_ARCHIVE_DAYS（默认180，0为永久保留）、
+ *       BOOKMALL_LOG_ARCHIVE_DIR（默认程序目录下的request_log_archive）
+ */
+class RequestLogArchive
+{
+public:
+    static RequestLogArchive& getInstance();
+
+    enum {
+        DEFAULT_HOT_DAYS = 7,
+        DEFAULT_ARCHIVE_DAYS = 180,
+        FETCH_BATCH_ROWS = 2000,   // 每次从数据库读取的行数
+        ROWS_PER_BLOCK = 500       // 每个压缩块包含的行数
+    };
+
+    QString archiveDir() const { return m_dir; }
+    int hotDays() const { return m_hotDays; }
+    int archiveDays() const { return m_archiveDays; }
+
+    // 归档并删除过期的日志分表和旧表数据，清理过期归档文件；返回本次归档的行数（后台任务中调用）
+    int runRetention();
+
+    // 在归档文件中从最近的一天开始按时间倒序逐块查找，够limit条即停止；category/action为空表示不过滤
+    QJsonArray search(int limit, const QString& category, const QString& action);
+
+private:
+    RequestLogArchive();
+    RequestLogArchive(const RequestLogArchive&) = delete;
+    RequestLogArchive& operator=(const RequestLogArchive&) = delete;
+
+    int archiveTable(const QString& table, const QDate& day, QJsonObject& index);   // 归档一张按天分表
+    int archiveLegacyRows(const QDateTime& before, QJsonObject& index);              // 归档旧表中before之前的行
+    bool appendRows(const QDate& day, const QJsonArray& rows, QJsonObject& index);   // rows按id升序
+    void purgeExpired(QJsonObject& index);
+
+    QString dayFilePath(const QDate& day) const;
+    QJsonObject loadIndex() const;
+    bool saveIndex(const QJsonObject& index) const;
+
+    QMutex m_mutex;  // 归档和查询互斥（归档文件只追加，但查询期间不能删除文件）
+    QString m_dir;
+    int m_hotDays;
+    int m_archiveDays;
+};
+
+#endif // REQUESTLOGARCHIVE_H
@@ -0,0 +1,120 @@
+#include "serverconfig.h"
+#include <QCoreApplication>
+#include <QSettings>
+#include <QFileInfo>
+#include <QDebug>
+
+QString ServerConfig::resolvePath(const QStringList &arguments)
+{
+    int index = arguments.indexOf("--config");
+    if (index >= 0 && index + 1 < arguments.size()) {
+        return arguments.at(index + 1);
+    }
+    QString path = QString::fromLocal8Bit(qgetenv("BOOKMALL_CONFIG"));
+    if (!path.isEmpty()) {
+        return path;
+    }
+    return QCoreApplication::applicationDirPath() + "/bookmall-server.ini";
+}
+
+ServerConfig ServerConfig::load(const QString &path)
+{
+    ServerConfig config;
+
+    if (!QFileInfo::exists(path)) {
+        qDebug() << "配置文件不存在，使用默认配置:" << path;
+    } else {
+        QSettings ini(path, QSettings::IniFormat);
+        ini.setIniCodec("UTF-8");
+
+        ini.beginGroup("server");
+        config.listenAddress = ini.value("listen_address", config.listenAddress).toString();
+        config.tcpPort = quint16(ini.value("tcp_port", config.tcpPort).toUInt());
+        config.metricsAddress = ini.value("metrics_address", config.metricsAddress).toString();
+        config.metricsPort = quint16(ini.value("metrics_port", config.metricsPort).toUInt());
+        config.acceptThreads = ini.value("accept_threads", config.acceptThreads).toInt();
+        config.drainTimeoutSec = ini.value("drain_timeout_sec", config.drainTimeoutSec).toInt();
+        config.logRequests = ini.value("log_requests", config.logRequests).toBool();
+        ini.endGroup();
+
+        ini.beginGroup("database");
+        config.storage = ini.value("storage", config.storage).toString().toLower();
+        config.dbHost = ini.value("host", config.dbHost).toString();
+        config.dbPort = ini.value("port", config.dbPort).toInt();
+        config.dbName = ini.value("name", config.dbName).toString();
+        config.dbUser = ini.value("user", config.dbUser).toString();
+        config.dbPassword = ini.value("password", config.dbPassword).toString();
+        config.sqlitePath = ini.value("sqlite_path", config.sqlitePath).toString();
+        ini.endGroup();
+
+        ini.beginGroup("pool");
+        config.workerThreads = ini.value("worker_threads", config.workerThreads).toInt();
+        config.taskQueueLimit = ini.value("task_queue_limit", config.taskQueueLimit).toInt();
+        config.taskQueueWaitMs = ini.value("task_queue_wait_ms", config.taskQueueWaitMs).toInt();
+        ini.endGroup();
+
+        config.nodeId = ini.value("node/node_id", config.nodeId).toInt();
+
+        ini.beginGroup("logs");
+        config.logHotDays = ini.value("hot_days", config.logHotDays).toInt();
+        config.logArchiveDays = ini.value("archive_days", config.logArchiveDays).toInt();
+        config.logArchiveDir = ini.value("archive_dir", config.logArchiveDir).toString();
+        ini.endGroup();
+
+        config.lotteryPrizesFile = ini.value("lottery/prizes_file", config.lotteryPrizesFile).toString();
+
+        ini.beginGroup("capture");
+        config.captureFile = ini.value("file", config.captureFile).toString();
+        config.captureMaxMb = ini.value("max_mb", config.captureMaxMb).toInt();
+        ini.endGroup();
+
+        if (ini.status() != QSettings::NoError) {
+            qWarning() << "❌ 配置文件格式错误，部分配置使用默认值:" << path;
+        } else {
+            qDebug() << "✓ 已加载配置文件:" << path;
+        }
+    }
+
+    // 原有的环境变量仍然有效，优先于配置文件
+    if (qgetenv("BOOKMALL_STORAGE").toLower() == "sqlite") {
+        config.storage = "sqlite";
+    }
+    QString sqlitePath = QString::fromLocal8Bit(qgetenv("BOOKMALL_SQLITE_PATH"));
+    if (!sqlitePath.isEmpty()) {
+        config.sqlitePath = sqlitePath;
+    }
+    if (config.sqlitePath.isEmpty()) {
+        config.sqlitePath = QCoreApplication::applicationDirPath() + "/bookmall.db";
+    }
+    return config;
+}
+
+// 环境变量未设置且配置值有效时写入
+static void setDefaultEnv(const char *name, int value, int minValue)
+{
+    if (value >= minValue && !qEnvironmentVariableIsSet(name)) {
+        qputenv(name, QByteArray::number(value));
+    }
+}
+
+static void setDefaultEnv(const char *name, const QString &value)
+{
+    if (!value.isEmpty() && !qEnvironmentVariableIsSet(name)) {
+        qputenv(name, value.toLocal8Bit());
+    }
+}
+
+void ServerConfig::applyToEnvironment() const
+{
+    setDefaultEnv("BOOKMALL_WORKER_THREADS", workerThreads, 1);
+    setDefaultEnv("BOOKMALL_TASK_QUEUE_LIMIT", taskQueueLimit, 1);
+    setDefaultEnv("BOOKMALL_TASK_QUEUE_WAIT_MS", taskQueueWaitMs, 1);
+    setDefaultEnv("BOOKMALL_ACCEPT_THREADS", acceptThreads, 1);
+    setDefaultEnv("BOOKMALL_NODE_ID", nodeId, 0);
+    setDefaultEnv("BOOKMALL_LOG_HOT_DAYS", logHotDays, 1);
+    setDefaultEnv("BOOKMALL_LOG_ARCHIVE_DAYS", logArchiveDays, 0);
+    setDefaultEnv("BOOKMALL_LOG_ARCHIVE_DIR", logArchiveDir);
+    setDefaultEnv("BOOKMALL_LOTTERY_PRIZES", lotteryPrizesFile);
+    setDefaultEnv("BOOKMALL_CAPTURE_FILE", captureFile);
+    setDefaultEnv("BOOKMALL_CAPTURE_MAX_MB", captureMaxMb, 1);
+}
@@ -0,0 +1,60 @@
+#ifndef SERVERCONFIG_H
+#define SERVERCONFIG_H
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief 服务器配置：监听地址、数据库、线程池和接入线程等
+ * @note 从INI文件读取（示例见 bookmall-server.ini.example），文件不存在时全部使用默认值。
+ *       BOOKMALL_STORAGE、BOOKMALL_SQLITE_PATH和线程数等既有环境变量仍然有效，并且优先于配置文件
+ */
+struct ServerConfig
+{
+    // [server]
+    QString listenAddress = "any";   // any 或具体IP
+    quint16 tcpPort = 8888;
+    QString metricsAddress = "127.0.0.1";
+    quint16 metricsPort = 9188;
+    int acceptThreads = 0;           // 0表示使用默认值，下同
+    int drainTimeoutSec = 30;        // 退出时等待已有连接处理完的最长时间
+    bool logRequests = false;        // 无界面运行时是否把每个请求的日志输出到标准输出
+
+    // [database]
+    QString storage = "auto";        // auto：先连MySQL，失败时用SQLite；sqlite：只用SQLite
+    QString dbHost = "49.232.145.193";
+    int dbPort = 3306;
+    QString dbName = "test_db";
+    QString dbUser = "root01";
+    QString dbPassword = "123456";
+    QString sqlitePath;              // 为空时使用程序目录下的bookmall.db
+
+    // [pool]
+    int workerThreads = 0;
+    int taskQueueLimit = 0;
+    int taskQueueWaitMs = 0;         // 连接排队时限（毫秒），0表示使用默认值
+
+    // [node]
+    int nodeId = -1;
+
+    // [logs]
+    int logHotDays = -1;             // 请求日志在数据库中保留的天数，-1表示使用默认值
+    int logArchiveDays = -1;         // 归档文件保留天数，0为永久保留
+    QString logArchiveDir;
+
+    // [lottery]
+    QString lotteryPrizesFile;       // 抽奖奖品表JSON文件，为空时使用默认奖品
+
+    // [capture]
+    QString captureFile;             // 流量录制文件，为空时不录制（供bookmall-bench --replay回放）
+    int captureMaxMb = 0;            // 录制文件大小上限（MB），0表示使用默认值
+
+    // 配置文件路径：命令行 --config <path>，其次环境变量 BOOKMALL_CONFIG，最后为程序目录下的bookmall-server.ini
+    static QString resolvePath(const QStringList &arguments);
+    static ServerConfig load(const QString &path);
+
+    // 把线程数等写入对应的环境变量（已设置的环境变量保持不变），须在线程池等单例首次使用前调用
+    void applyToEnvironment() const;
+};
+
+#endif // SERVERCONFIG_H
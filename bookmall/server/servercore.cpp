@@ -0,0 +1,240 @@
+#include "servercore.h"
+#include "data.h"
+#include "cartservice.h"
+#include "groupcommit.h"
+#include "recommendengine.h"
+#include "threadpool.h"
+#include "requestlogarchive.h"
+#include "platformcounters.h"
+#include "trafficcapture.h"
+#include <QTimer>
+#include <QMetaMethod>
+#include <QDebug>
+
+// 图书评分/收藏计数校对任务（在后台维护线程池中执行）
+class BookStatsReconcileTask : public Task
+{
+public:
+    void run() override
+    {
+        Database::getInstance().reconcileBookStats();
+    }
+};
+
+// 请求日志保留任务：归档并删除过期的日志分表（在后台维护线程池中执行）
+class RequestLogRetentionTask : public Task
+{
+public:
+    void run() override
+    {
+        RequestLogArchive::getInstance().runRetention();
+    }
+};
+
+// 平台计数校对任务：按数据库COUNT修正管理员系统统计使用的内存计数（在后台维护线程池中执行）
+class PlatformCountersReconcileTask : public Task
+{
+public:
+    void run() override
+    {
+        PlatformCounters::getInstance().reconcile();
+    }
+};
+
+ServerCore::ServerCore(const ServerConfig &config, QObject *parent)
+    : QObject(parent), m_config(config)
+{
+    m_listeners = new TcpListenerGroup(this);
+    connect(m_listeners, &TcpListenerGroup::dataReceived, this, &ServerCore::dataReceived);
+    connect(m_listeners, &TcpListenerGroup::logGenerated, this, &ServerCore::logGenerated);
+    m_metricsServer = new MetricsHttpServer(this);
+}
+
+ServerCore::~ServerCore()
+{
+    drain();
+}
+
+ServerCore::StorageBackend ServerCore::initStorage()
+{
+    qDebug() << "========================================";
+    qDebug() << "服务器启动 - 数据库模式";
+    qDebug() << "========================================";
+
+    // 存储后端：默认连接MySQL，连接失败时使用本地SQLite文件；storage=sqlite时直接使用SQLite
+    const bool sqliteOnly = m_config.storage == "sqlite";
+    bool mysqlConnected = false;
+    if (!sqliteOnly) {
+        mysqlConnected = Database::getInstance().initConnection(
+            m_config.dbHost, m_config.dbPort, m_config.dbName, m_config.dbUser, m_config.dbPassword);
+    }
+
+    StorageBackend backend;
+    if (mysqlConnected) {
+        qDebug() << "✅ 数据库连接成功！";
+        qDebug() << "✅ 数据库服务器:" << QString("%1:%2").arg(m_config.dbHost).arg(m_config.dbPort);
+        qDebug() << "✅ 数据库名称:" << m_config.dbName;
+        qDebug() << "✅ 请求日志功能已启用";
+        backend = MySqlStorage;
+    } else if (Database::getInstance().initSqliteConnection(m_config.sqlitePath)) {
+        if (!sqliteOnly) {
+            qDebug() << "❌ MySQL连接失败，切换到本地SQLite数据库";
+        }
+        qDebug() << "✅ 本地SQLite数据库:" << m_config.sqlitePath;
+        qDebug() << "✅ 请求日志功能已启用";
+        backend = SqliteStorage;
+    } else {
+        qDebug() << "❌ 数据库连接失败，切换到内存模式";
+        backend = MemoryStorage;
+    }
+
+    qDebug() << "========================================";
+
+    // 购物车写回线程：加购/改数量/移除先改内存，每300ms批量写回cart表
+    // 组提交线程：聊天、收藏、评论、优惠券等单行写入凑批后在一个事务中提交
+    if (Database::getInstance().isConnected()) {
+        CartService::getInstance().start();
+        GroupCommitQueue::getInstance().start();
+    }
+    return backend;
+}
+
+bool ServerCore::startMetrics()
+{
+    // 本地指标端口，供Prometheus抓取和服务器监控窗口读取
+    QHostAddress address(m_config.metricsAddress);
+    if (address.isNull()) {
+        address = QHostAddress::LocalHost;
+    }
+    if (m_metricsServer->start(m_config.metricsPort, address)) {
+        emit logGenerated(QString("指标端口已启动：http://%1:%2/metrics")
+                          .arg(address.toString()).arg(m_config.metricsPort));
+        return true;
+    }
+    m_error = m_metricsServer->errorString();
+    emit logGenerated("指标端口启动失败：" + m_error);
+    return false;
+}
+
+void ServerCore::startMaintenance()
+{
+    // 启动后异步初始化示例图书数据（不阻塞界面和接入）
+    QTimer::singleShot(500, this, [this]() {
+        if (Database::getInstance().isConnected()) {
+            emit logGenerated("正在初始化示例图书数据...");
+            bool success = Database::getInstance().initSampleBooks();
+            if (success) {
+                emit logGenerated("示例图书数据初始化完成");
+            } else {
+                emit logGenerated("示例图书数据初始化失败或已存在数据");
+            }
+            // 首次构建推荐数据（后台线程）
+            RecommendEngine::getInstance().scheduleRebuild();
+            // 启动时先归档一次过期的请求日志
+            ThreadPool::getInstance().addBackgroundTask("requestLogRetention", new RequestLogRetentionTask);
+            // 加载平台计数（示例图书已初始化，之后的增减由写入路径的事件维护）
+            ThreadPool::getInstance().addBackgroundTask("platformCountersReconcile", new PlatformCountersReconcileTask);
+        }
+    });
+
+    // 推荐数据定时重建：相似图书表和热门榜每10分钟从订单和收藏重新统计一次
+    QTimer *recommendTimer = new QTimer(this);
+    recommendTimer->setInterval(10 * 60 * 1000);
+    connect(recommendTimer, &QTimer::timeout, this, []() {
+        if (Database::getInstance().isConnected()) {
+            RecommendEngine::getInstance().scheduleRebuild();
+        }
+    });
+    recommendTimer->start();
+
+    // 图书评分/收藏计数每小时按reviews和favorites校对一次（写入时已在同一事务中更新，这里只修正偏差）
+    QTimer *bookStatsTimer = new QTimer(this);
+    bookStatsTimer->setInterval(60 * 60 * 1000);
+    connect(bookStatsTimer, &QTimer::timeout, this, []() {
+        if (Database::getInstance().isConnected()) {
+            ThreadPool::getInstance().addBackgroundTask("bookStatsReconcile", new BookStatsReconcileTask);
+        }
+    });
+    bookStatsTimer->start();
+
+    // 请求日志每小时检查一次：超过保留天数的分表压缩归档后删除，过期的归档文件删除
+    QTimer *logRetentionTimer = new QTimer(this);
+    logRetentionTimer->setInterval(60 * 60 * 1000);
+    connect(logRetentionTimer, &QTimer::timeout, this, []() {
+        if (Database::getInstance().isConnected()) {
+            ThreadPool::getInstance().addBackgroundTask("requestLogRetention", new RequestLogRetentionTask);
+        }
+    });
+    logRetentionTimer->start();
+
+    // 平台计数定时按数据库校对一次，修正迁移、手工改库等不经过写入事件的变更
+    QTimer *countersTimer = new QTimer(this);
+    countersTimer->setInterval(PlatformCounters::RECONCILE_INTERVAL_MINUTES * 60 * 1000);
+    connect(countersTimer, &QTimer::timeout, this, []() {
+        if (Database::getInstance().isConnected()) {
+            ThreadPool::getInstance().addBackgroundTask("platformCountersReconcile", new PlatformCountersReconcileTask);
+        }
+    });
+    countersTimer->start();
+}
+
+bool ServerCore::startListening()
+{
+    QHostAddress address = QHostAddress::Any;
+    if (!m_config.listenAddress.isEmpty() && m_config.listenAddress.toLower() != "any") {
+        address = QHostAddress(m_config.listenAddress);
+        if (address.isNull()) {
+            m_error = "监听地址无效：" + m_config.listenAddress;
+            return false;
+        }
+    }
+
+    TcpFileTask::setDraining(false);
+    m_listeners->setLogForwarding(isSignalConnected(QMetaMethod::fromSignal(&ServerCore::logGenerated))
+                                  || isSignalConnected(QMetaMethod::fromSignal(&ServerCore::dataReceived)));
+    if (!m_listeners->start(address, m_config.tcpPort)) {
+        m_error = m_listeners->errorString();
+        return false;
+    }
+    return true;
+}
+
+void ServerCore::stopListening()
+{
+    m_listeners->stop();
+}
+
+bool ServerCore::isListening() const
+{
+    return m_listeners->isListening();
+}
+
+int ServerCore::acceptorCount() const
+{
+    return m_listeners->acceptorCount();
+}
+
+bool ServerCore::drain()
+{
+    if (m_drained) {
+        return true;
+    }
+    m_drained = true;
+
+    m_listeners->stop();
+    m_metricsServer->close();
+
+    TcpFileTask::setDraining(true);
+    const bool finished = ThreadPool::getInstance().waitForDone(qMax(0, m_config.drainTimeoutSec) * 1000);
+    if (finished) {
+        qDebug() << "✓ 所有连接已处理完毕";
+    } else {
+        qWarning() << "❌ 等待连接处理超时（" << m_config.drainTimeoutSec << "秒），仍有任务在执行";
+    }
+
+    // 退出前写回全部未落库的购物车，并提交队列中剩余的写操作
+    CartService::getInstance().stop();
+    GroupCommitQueue::getInstance().stop();
+    TrafficCapture::getInstance().stop();
+    return finished;
+}
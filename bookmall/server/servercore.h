@@ -0,0 +1,54 @@
+#ifndef SERVERCORE_H
+#define SERVERCORE_H
+
+#include <QObject>
+#include "serverconfig.h"
+#include "tcpserver.h"
+#include "metricshttpserver.h"
+
+/**
+ * @brief 服务器运行核心：数据库、后台写回线程、TCP接入、指标端口和定时维护任务
+ * @note 图形界面版（Server）和无界面守护进程（bookmall-serverd）共用，
+ *       界面只订阅日志信号并控制启停，不参与请求处理
+ */
+class ServerCore : public QObject
+{
+    Q_OBJECT
+public:
+    enum StorageBackend {
+        MySqlStorage,
+        SqliteStorage,
+        MemoryStorage    // 数据库都无法连接
+    };
+
+    explicit ServerCore(const ServerConfig &config, QObject *parent = nullptr);
+    ~ServerCore() override;
+
+    const ServerConfig& config() const { return m_config; }
+
+    // 按配置连接数据库（MySQL失败时改用SQLite），连接成功后启动购物车写回和组提交线程
+    StorageBackend initStorage();
+    bool startMetrics();
+    void startMaintenance();  // 初始化示例数据、首次构建推荐数据，并启动定时重建和计数校对
+    bool startListening();
+    void stopListening();
+    bool isListening() const;
+    int acceptorCount() const;
+    QString errorString() const { return m_error; }
+
+    // 优雅退出：停止接受新连接，等待已有连接处理完当前请求（最多drainTimeoutSec秒），再写回缓存数据
+    bool drain();
+
+signals:
+    void dataReceived(const QString& clientIp, quint16 clientPort, const QString& data);
+    void logGenerated(const QString& log);
+
+private:
+    ServerConfig m_config;
+    TcpListenerGroup* m_listeners;
+    MetricsHttpServer* m_metricsServer;
+    QString m_error;
+    bool m_drained = false;
+};
+
+#endif // SERVERCORE_H
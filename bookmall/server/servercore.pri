@@ -0,0 +1,43 @@
+# 服务器核心：图形界面版（Server.pro）和无界面版（serverd.pro）共用的源文件
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/threadpool.cpp \
+    $$PWD/tcpserver.cpp \
+    $$PWD/clientthreadfactory.cpp \
+    $$PWD/data.cpp \
+    $$PWD/latencyhistogram.cpp \
+    $$PWD/servermetrics.cpp \
+    $$PWD/metricshttpserver.cpp \
+    $$PWD/sessionmanager.cpp \
+    $$PWD/recommendengine.cpp \
+    $$PWD/cartservice.cpp \
+    $$PWD/groupcommit.cpp \
+    $$PWD/idgenerator.cpp \
+    $$PWD/serverconfig.cpp \
+    $$PWD/servercore.cpp \
+    $$PWD/requestlogarchive.cpp \
+    $$PWD/lotteryservice.cpp \
+    $$PWD/platformcounters.cpp \
+    $$PWD/trafficcapture.cpp
+
+HEADERS += \
+    $$PWD/threadpool.h \
+    $$PWD/tcpserver.h \
+    $$PWD/clientthreadfactory.h \
+    $$PWD/data.h \
+    $$PWD/latencyhistogram.h \
+    $$PWD/servermetrics.h \
+    $$PWD/metricshttpserver.h \
+    $$PWD/sessionmanager.h \
+    $$PWD/recommendengine.h \
+    $$PWD/cartservice.h \
+    $$PWD/groupcommit.h \
+    $$PWD/idgenerator.h \
+    $$PWD/serverconfig.h \
+    $$PWD/servercore.h \
+    $$PWD/requestlogarchive.h \
+    $$PWD/lotteryservice.h \
+    $$PWD/platformcounters.h \
+    $$PWD/trafficcapture.h
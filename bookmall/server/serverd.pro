@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# bookmall-serverd：无界面服务器（QCoreApplication），用于没有图形环境的Linux服务器
+#
+#-------------------------------------------------
+
+QT       = core network sql
+
+TARGET = bookmall-serverd
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(servercore.pri)
+
+SOURCES += \
+    serverdmain.cpp
+
+DISTFILES += \
+    bookmall-server.ini.example
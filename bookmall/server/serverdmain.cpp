@@ -0,0 +1,80 @@
+#include "servercore.h"
+#include <QCoreApplication>
+#include <QSocketNotifier>
+#include <QDebug>
+#ifdef Q_OS_UNIX
+#include <csignal>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// bookmall-serverd：无界面服务器，启动后立即监听，收到SIGTERM/SIGINT时排空连接后退出
+
+#ifdef Q_OS_UNIX
+static int s_signalFds[2] = { -1, -1 };
+
+// 信号处理函数中只写管道，退出流程在事件循环中执行
+static void onTerminateSignal(int)
+{
+    char byte = 1;
+    ssize_t written = ::write(s_signalFds[0], &byte, sizeof(byte));
+    Q_UNUSED(written);
+}
+
+static bool installTerminateHandler(QCoreApplication *app)
+{
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, s_signalFds) != 0) {
+        return false;
+    }
+    QSocketNotifier *notifier = new QSocketNotifier(s_signalFds[1], QSocketNotifier::Read, app);
+    QObject::connect(notifier, &QSocketNotifier::activated, app, [notifier]() {
+        notifier->setEnabled(false);
+        char byte;
+        ssize_t received = ::read(s_signalFds[1], &byte, sizeof(byte));
+        Q_UNUSED(received);
+        qDebug() << "收到退出信号，停止接受新连接并等待现有连接处理完毕";
+        QCoreApplication::quit();
+    });
+
+    struct sigaction action;
+    action.sa_handler = onTerminateSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    return sigaction(SIGTERM, &action, nullptr) == 0 && sigaction(SIGINT, &action, nullptr) == 0;
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("bookmall-serverd");
+
+    ServerConfig config = ServerConfig::load(ServerConfig::resolvePath(app.arguments()));
+    config.applyToEnvironment();
+
+#ifdef Q_OS_UNIX
+    if (!installTerminateHandler(&app)) {
+        qWarning() << "❌ 无法安装SIGTERM处理函数，退出时不会排空连接";
+    }
+#endif
+
+    ServerCore core(config);
+    core.initStorage();
+    if (config.logRequests) {
+        QObject::connect(&core, &ServerCore::logGenerated, [](const QString &log) {
+            qInfo().noquote() << log;
+        });
+    }
+    core.startMetrics();
+    core.startMaintenance();
+
+    if (!core.startListening()) {
+        qCritical().noquote() << "❌ TCP服务启动失败：" << core.errorString();
+        return 1;
+    }
+    qInfo().noquote() << QString("✓ bookmall-serverd 已启动，端口%1，接入线程数%2")
+                         .arg(config.tcpPort).arg(core.acceptorCount());
+
+    int ret = app.exec();
+    return core.drain() ? ret : 2;
+}
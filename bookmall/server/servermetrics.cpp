@@ -0,0 +1,248 @@
+#include "servermetrics.h"
+#include "threadpool.h"
+#include <QJsonArray>
+#include <QMutexLocker>
+#include <QTextStream>
+
+// 当前线程正在处理的请求累计的数据库耗时（每个连接任务独占一个工作线程）及请求嵌套层数
+static thread_local qint64 t_requestDbUs = 0;
+static thread_local int t_requestDepth = 0;
+
+// 动作名来自客户端，限制不同动作的数量，避免恶意请求撑大统计表
+static const int kMaxTrackedActions = 200;
+
+ServerMetrics::ServerMetrics()
+    : m_bytesIn(0), m_bytesOut(0), m_totalConnections(0),
+      m_activeConnections(0), m_dbWaiters(0), m_queuedTasks(0),
+      m_rejectedTasks(0), m_shedRequests(0)
+{
+    m_uptime.start();
+}
+
+ServerMetrics& ServerMetrics::getInstance()
+{
+    static ServerMetrics instance;
+    return instance;
+}
+
+qint64 ServerMetrics::beginRequest()
+{
+    const qint64 outerDbUs = t_requestDepth++ > 0 ? t_requestDbUs : 0;
+    t_requestDbUs = 0;
+    return outerDbUs;
+}
+
+qint64 ServerMetrics::endRequest(const QString& action, qint64 totalUs, bool success, qint64 outerDbUs)
+{
+    const qint64 dbUs = qMin(t_requestDbUs, totalUs);
+    t_requestDbUs = --t_requestDepth > 0 ? outerDbUs + t_requestDbUs : 0;
+
+    QMutexLocker locker(&m_mutex);
+    QString key = action.isEmpty() ? QString("unknown") : action;
+    if (!m_actions.contains(key) && m_actions.size() >= kMaxTrackedActions) {
+        key = "other";
+    }
+    ActionMetrics& metrics = m_actions[key];
+    metrics.latency.record(totalUs);
+    metrics.dbUs += dbUs;
+    metrics.handlerUs += totalUs - dbUs;
+    if (!success) {
+        ++metrics.errors;
+    }
+    return dbUs;
+}
+
+void ServerMetrics::dbWaitBegin()
+{
+    m_dbWaiters.ref();
+}
+
+void ServerMetrics::dbWaitEnd(qint64 waitUs)
+{
+    m_dbWaiters.deref();
+    QMutexLocker locker(&m_mutex);
+    m_dbLockWait.record(waitUs);
+}
+
+void ServerMetrics::addDbTime(qint64 us)
+{
+    t_requestDbUs += us;
+}
+
+void ServerMetrics::connectionOpened()
+{
+    m_activeConnections.ref();
+    m_totalConnections.fetchAndAddRelaxed(1);
+}
+
+void ServerMetrics::connectionClosed()
+{
+    m_activeConnections.deref();
+}
+
+void ServerMetrics::addBytesIn(qint64 bytes)
+{
+    m_bytesIn.fetchAndAddRelaxed(bytes);
+}
+
+void ServerMetrics::addBytesOut(qint64 bytes)
+{
+    m_bytesOut.fetchAndAddRelaxed(bytes);
+}
+
+void ServerMetrics::taskQueued()
+{
+    m_queuedTasks.ref();
+}
+
+void ServerMetrics::taskStarted(qint64 queueWaitUs)
+{
+    m_queuedTasks.deref();
+    QMutexLocker locker(&m_mutex);
+    m_taskQueueWait.record(queueWaitUs);
+}
+
+void ServerMetrics::taskRejected()
+{
+    m_rejectedTasks.fetchAndAddRelaxed(1);
+}
+
+void ServerMetrics::requestShed()
+{
+    m_shedRequests.fetchAndAddRelaxed(1);
+}
+
+QJsonObject ServerMetrics::snapshot() const
+{
+    QJsonObject result;
+    result["uptimeSec"] = double(m_uptime.elapsed() / 1000);
+
+    QJsonObject connections;
+    connections["active"] = m_activeConnections.load();
+    connections["total"] = double(m_totalConnections.load());
+    result["connections"] = connections;
+
+    QJsonObject bytes;
+    bytes["in"] = double(m_bytesIn.load());
+    bytes["out"] = double(m_bytesOut.load());
+    result["bytes"] = bytes;
+
+    ThreadPool& pool = ThreadPool::getInstance();
+    QJsonObject threadPool;
+    threadPool["activeThreads"] = pool.activeThreadCount();
+    threadPool["maxThreads"] = pool.maxThreadCount();
+    threadPool["queued"] = m_queuedTasks.load();
+    threadPool["queueLimit"] = pool.queueLimit();
+    threadPool["rejected"] = double(m_rejectedTasks.load());
+    threadPool["shedRequests"] = double(m_shedRequests.load());
+
+    QJsonObject db;
+    db["lockWaiters"] = m_dbWaiters.load();
+
+    QJsonArray actions;
+    {
+        QMutexLocker locker(&m_mutex);
+        threadPool["queueWaitUs"] = m_taskQueueWait.toJson();
+        db["lockWaitUs"] = m_dbLockWait.toJson();
+        for (auto it = m_actions.constBegin(); it != m_actions.constEnd(); ++it) {
+            const ActionMetrics& metrics = it.value();
+            QJsonObject obj;
+            obj["action"] = it.key();
+            obj["count"] = double(metrics.latency.count());
+            obj["errors"] = double(metrics.errors);
+            obj["dbTimeUs"] = double(metrics.dbUs);
+            obj["handlerTimeUs"] = double(metrics.handlerUs);
+            obj["latencyUs"] = metrics.latency.toJson();
+            actions.append(obj);
+        }
+    }
+    result["threadPool"] = threadPool;
+    result["db"] = db;
+    result["actions"] = actions;
+    return result;
+}
+
+// Prometheus标签值转义（动作名来自客户端）
+static QString escapeLabel(QString value)
+{
+    return value.replace("\\", "\\\\").replace("\"", "\\\"").replace("\n", "\\n");
+}
+
+// 输出一个summary类型指标：分位数 + _sum + _count（单位：秒）
+static void writeSummary(QTextStream& out, const QString& name, const QString& labels,
+                         const LatencyHistogram& histogram)
+{
+    const QString prefix = labels.isEmpty() ? QString("{") : QString("{%1,").arg(labels);
+    const double quantiles[] = {0.5, 0.95, 0.99, 0.999};
+    for (double q : quantiles) {
+        out << name << prefix << "quantile=\"" << q << "\"} "
+            << histogram.percentile(q * 100.0) / 1e6 << "\n";
+    }
+    const QString suffix = labels.isEmpty() ? QString() : QString("{%1}").arg(labels);
+    out << name << "_sum" << suffix << " " << histogram.mean() * histogram.count() / 1e6 << "\n";
+    out << name << "_count" << suffix << " " << histogram.count() << "\n";
+}
+
+QByteArray ServerMetrics::prometheusText() const
+{
+    QByteArray text;
+    QTextStream out(&text);
+    out.setCodec("UTF-8");
+
+    out << "# HELP bookmall_uptime_seconds 服务器运行时长\n"
+        << "# TYPE bookmall_uptime_seconds gauge\n"
+        << "bookmall_uptime_seconds " << m_uptime.elapsed() / 1000 << "\n";
+    out << "# TYPE bookmall_active_connections gauge\n"
+        << "bookmall_active_connections " << m_activeConnections.load() << "\n";
+    out << "# TYPE bookmall_connections_total counter\n"
+        << "bookmall_connections_total " << m_totalConnections.load() << "\n";
+    out << "# TYPE bookmall_received_bytes_total counter\n"
+        << "bookmall_received_bytes_total " << m_bytesIn.load() << "\n";
+    out << "# TYPE bookmall_sent_bytes_total counter\n"
+        << "bookmall_sent_bytes_total " << m_bytesOut.load() << "\n";
+
+    ThreadPool& pool = ThreadPool::getInstance();
+    out << "# TYPE bookmall_threadpool_active_threads gauge\n"
+        << "bookmall_threadpool_active_threads " << pool.activeThreadCount() << "\n";
+    out << "# TYPE bookmall_threadpool_max_threads gauge\n"
+        << "bookmall_threadpool_max_threads " << pool.maxThreadCount() << "\n";
+    out << "# TYPE bookmall_threadpool_queued_tasks gauge\n"
+        << "bookmall_threadpool_queued_tasks " << m_queuedTasks.load() << "\n";
+    out << "# TYPE bookmall_threadpool_queue_limit gauge\n"
+        << "bookmall_threadpool_queue_limit " << pool.queueLimit() << "\n";
+    out << "# HELP bookmall_threadpool_rejected_total 排队已满时拒绝的连接数\n"
+        << "# TYPE bookmall_threadpool_rejected_total counter\n"
+        << "bookmall_threadpool_rejected_total " << m_rejectedTasks.load() << "\n";
+    out << "# HELP bookmall_shed_requests_total 过载时拒绝的低优先级请求数\n"
+        << "# TYPE bookmall_shed_requests_total counter\n"
+        << "bookmall_shed_requests_total " << m_shedRequests.load() << "\n";
+    out << "# TYPE bookmall_db_lock_waiters gauge\n"
+        << "bookmall_db_lock_waiters " << m_dbWaiters.load() << "\n";
+
+    QMutexLocker locker(&m_mutex);
+    out << "# TYPE bookmall_threadpool_queue_wait_seconds summary\n";
+    writeSummary(out, "bookmall_threadpool_queue_wait_seconds", QString(), m_taskQueueWait);
+    out << "# TYPE bookmall_db_lock_wait_seconds summary\n";
+    writeSummary(out, "bookmall_db_lock_wait_seconds", QString(), m_dbLockWait);
+
+    out << "# HELP bookmall_request_duration_seconds 请求总耗时（按动作）\n"
+        << "# TYPE bookmall_request_duration_seconds summary\n";
+    for (auto it = m_actions.constBegin(); it != m_actions.constEnd(); ++it) {
+        writeSummary(out, "bookmall_request_duration_seconds",
+                     QString("action=\"%1\"").arg(escapeLabel(it.key())), it.value().latency);
+    }
+    out << "# TYPE bookmall_request_errors_total counter\n";
+    for (auto it = m_actions.constBegin(); it != m_actions.constEnd(); ++it) {
+        out << "bookmall_request_errors_total{action=\"" << escapeLabel(it.key()) << "\"} " << it.value().errors << "\n";
+    }
+    out << "# TYPE bookmall_request_db_seconds_total counter\n";
+    for (auto it = m_actions.constBegin(); it != m_actions.constEnd(); ++it) {
+        out << "bookmall_request_db_seconds_total{action=\"" << escapeLabel(it.key()) << "\"} " << it.value().dbUs / 1e6 << "\n";
+    }
+    out << "# TYPE bookmall_request_handler_seconds_total counter\n";
+    for (auto it = m_actions.constBegin(); it != m_actions.constEnd(); ++it) {
+        out << "bookmall_request_handler_seconds_total{action=\"" << escapeLabel(it.key()) << "\"} " << it.value().handlerUs / 1e6 << "\n";
+    }
+    out.flush();
+    return text;
+}
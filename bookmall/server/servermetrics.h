@@ -0,0 +1,77 @@
+#ifndef SERVERMETRICS_H
+#define SERVERMETRICS_H
+
+#include <QMutex>
+#include <QHash>
+#include <QString>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include "latencyhistogram.h"
+
+/**
+ * @brief 服务器运行指标（单例）：按请求动作统计次数、错误数、延迟直方图和数据库耗时，
+ *        以及连接数、收发字节数、线程池和数据库锁的排队情况
+ * @note 通过adminGetServerMetrics动作返回JSON快照，或通过本地指标端口输出Prometheus文本格式
+ */
+class ServerMetrics
+{
+public:
+    static ServerMetrics& getInstance();
+
+    // ===== 请求计时（processJsonRequest调用）=====
+    // 请求可以嵌套（批量请求的子请求在同一线程执行）：beginRequest返回外层请求已累计的数据库耗时，
+    // endRequest恢复它并把本请求的数据库耗时并入外层；返回本请求的数据库耗时
+    qint64 beginRequest();
+    qint64 endRequest(const QString& action, qint64 totalUs, bool success, qint64 outerDbUs);
+
+    // ===== 数据库计时（Database加锁/解锁时调用）=====
+    void dbWaitBegin();
+    void dbWaitEnd(qint64 waitUs);
+    void addDbTime(qint64 us);  // 累加到当前线程正在处理的请求
+
+    // ===== 连接与流量 =====
+    void connectionOpened();
+    void connectionClosed();
+    void addBytesIn(qint64 bytes);
+    void addBytesOut(qint64 bytes);
+
+    // ===== 线程池 =====
+    void taskQueued();
+    void taskStarted(qint64 queueWaitUs);
+    void taskRejected();  // 排队已满，新连接被拒绝
+    void requestShed();   // 过载时拒绝的低优先级请求
+    int dbLockWaiters() const { return m_dbWaiters.load(); }
+
+    QJsonObject snapshot() const;       // adminGetServerMetrics返回的数据
+    QByteArray prometheusText() const;  // Prometheus文本格式（text/plain; version=0.0.4）
+
+private:
+    ServerMetrics();
+    ServerMetrics(const ServerMetrics&) = delete;
+    ServerMetrics& operator=(const ServerMetrics&) = delete;
+
+    struct ActionMetrics {
+        quint64 errors = 0;
+        qint64 dbUs = 0;       // 累计数据库耗时（持有数据库锁的时间）
+        qint64 handlerUs = 0;  // 累计业务处理耗时（总耗时 - 数据库耗时）
+        LatencyHistogram latency;
+    };
+
+    mutable QMutex m_mutex;
+    QHash<QString, ActionMetrics> m_actions;
+    LatencyHistogram m_dbLockWait;   // 等待数据库锁的时间
+    LatencyHistogram m_taskQueueWait;  // 连接任务在线程池队列中的等待时间
+
+    QAtomicInteger<qint64> m_bytesIn;
+    QAtomicInteger<qint64> m_bytesOut;
+    QAtomicInteger<qint64> m_totalConnections;
+    QAtomicInt m_activeConnections;
+    QAtomicInt m_dbWaiters;
+    QAtomicInt m_queuedTasks;
+    QAtomicInteger<qint64> m_rejectedTasks;
+    QAtomicInteger<qint64> m_shedRequests;
+    QElapsedTimer m_uptime;
+};
+
+#endif // SERVERMETRICS_H
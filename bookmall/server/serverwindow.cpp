@@ -1,37 +1,45 @@
 #include "serverwindow.h"
 #include "ui_serverwindow.h"
-#include "data.h"
 #include <QTime>
 #include <QTimer>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QJsonDocument>
+#include <QJsonObject>
 
-// 服务器窗口构造函数：初始化UI和服务器实例
-ServerWindow::ServerWindow(QWidget *parent)
+// 服务器窗口构造函数：初始化UI，连接服务器日志或启动远程监控
+ServerWindow::ServerWindow(ServerCore *core, const QUrl &monitorUrl, QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::ServerWindow)
+    , m_core(core)
+    , m_monitorUrl(monitorUrl)
 {
     ui->setupUi(this);
-    this->setWindowTitle("TCP服务器");
-    // 初始化服务器实例
-    m_tcpServer = new TcpServer(this);
 
-    connect(m_tcpServer, &TcpServer::dataReceived, this, [this](const QString& ip, quint16 port, const QString& data) {
-           appendLog(QString("收到来自 [%1:%2] 的数据：%3").arg(ip).arg(port).arg(data));
-           // 在这里处理登录请求等业务逻辑
-       });
-       connect(m_tcpServer, &TcpServer::logGenerated, this, &ServerWindow::appendLog);
-    
-    // 窗口显示后，异步初始化示例图书数据（避免阻塞UI）
-    QTimer::singleShot(500, this, [this]() {
-        if (Database::getInstance().isConnected()) {
-            appendLog("正在初始化示例图书数据...");
-            bool success = Database::getInstance().initSampleBooks();
-            if (success) {
-                appendLog("示例图书数据初始化完成");
-            } else {
-                appendLog("示例图书数据初始化失败或已存在数据");
-            }
-        }
-    });
+    if (m_core) {
+        this->setWindowTitle("TCP服务器");
+        connect(m_core, &ServerCore::dataReceived, this, [this](const QString& ip, quint16 port, const QString& data) {
+               appendLog(QString("收到来自 [%1:%2] 的数据：%3").arg(ip).arg(port).arg(data));
+               // 在这里处理登录请求等业务逻辑
+           });
+        connect(m_core, &ServerCore::logGenerated, this, &ServerWindow::appendLog);
+        return;
+    }
+
+    // 监控模式：服务器运行在其他进程（如bookmall-serverd），窗口只显示其运行指标
+    this->setWindowTitle("TCP服务器监控");
+    ui->startTcpBtn->setEnabled(false);
+    ui->tcpStatusLabel->setText("监控：" + m_monitorUrl.toString());
+    appendLog("监控服务器指标：" + m_monitorUrl.toString());
+
+    m_network = new QNetworkAccessManager(this);
+    connect(m_network, &QNetworkAccessManager::finished, this, &ServerWindow::onMetricsReply);
+    QTimer *pollTimer = new QTimer(this);
+    pollTimer->setInterval(2000);
+    connect(pollTimer, &QTimer::timeout, this, &ServerWindow::pollMetrics);
+    pollTimer->start();
+    pollMetrics();
 }
 
 // 析构函数：释放UI资源
@@ -49,18 +57,21 @@ void ServerWindow::appendLog(const QString &log)
 // TCP服务启动/停止按钮点击事件
 void ServerWindow::on_startTcpBtn_clicked()
 {
+    if (!m_core) {
+        return;
+    }
     if (!m_tcpRunning) {
-        // 启动TCP服务：监听所有网卡的TCP_PORT端口
-        if (m_tcpServer->listen(QHostAddress::Any, TCP_PORT)) {
+        // 启动TCP服务：按配置的地址和端口监听
+        if (m_core->startListening()) {
             m_tcpRunning = true;
-            ui->tcpStatusLabel->setText("TCP服务：运行中（端口8888）");
+            ui->tcpStatusLabel->setText(QString("TCP服务：运行中（端口%1）").arg(m_core->config().tcpPort));
             ui->startTcpBtn->setText("停止TCP");
-            appendLog("TCP文件传输服务启动成功");
+            appendLog(QString("TCP文件传输服务启动成功，接入线程数：%1").arg(m_core->acceptorCount()));
         } else {
-            appendLog("TCP服务启动失败：" + m_tcpServer->errorString());
+            appendLog("TCP服务启动失败：" + m_core->errorString());
         }
     } else {
-        m_tcpServer->close();
+        m_core->stopListening();
         m_tcpRunning = false;
         ui->tcpStatusLabel->setText("TCP服务：已停止");
         ui->startTcpBtn->setText("启动TCP");
@@ -90,3 +101,40 @@ void ServerWindow::onClientReadyRead()
     // 可选：回复客户端
     clientSocket->write("服务器已接收数据");
 }
+
+void ServerWindow::pollMetrics()
+{
+    QUrl url = m_monitorUrl;
+    url.setPath("/metrics.json");
+    m_network->get(QNetworkRequest(url));
+}
+
+void ServerWindow::onMetricsReply(QNetworkReply *reply)
+{
+    reply->deleteLater();
+    if (reply->error() != QNetworkReply::NoError) {
+        if (m_monitorReachable) {
+            appendLog("无法读取服务器指标：" + reply->errorString());
+        }
+        m_monitorReachable = false;
+        ui->tcpStatusLabel->setText("监控：" + m_monitorUrl.toString() + "（无法连接）");
+        return;
+    }
+    if (!m_monitorReachable) {
+        appendLog("已重新连接到服务器指标端口");
+    }
+    m_monitorReachable = true;
+
+    QJsonObject metrics = QJsonDocument::fromJson(reply->readAll()).object();
+    QJsonObject connections = metrics.value("connections").toObject();
+    QJsonObject pool = metrics.value("threadPool").toObject();
+    ui->tcpStatusLabel->setText(QString("监控：%1  运行%2秒  连接%3  线程%4/%5  排队%6/%7  拒绝%8")
+                                .arg(m_monitorUrl.toString())
+                                .arg(qint64(metrics.value("uptimeSec").toDouble()))
+                                .arg(connections.value("active").toInt())
+                                .arg(pool.value("activeThreads").toInt())
+                                .arg(pool.value("maxThreads").toInt())
+                                .arg(pool.value("queued").toInt())
+                                .arg(pool.value("queueLimit").toInt())
+                                .arg(qint64(pool.value("rejected").toDouble())));
+}
@@ -2,19 +2,25 @@
 #define SERVERWINDOW_H
 
 #include <QMainWindow>
-#include "tcpserver.h"
+#include <QUrl>
+#include "servercore.h"
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class ServerWindow; }
 QT_END_NAMESPACE
 
 // 服务器主窗口：显示服务状态和运行日志
+// core不为空时控制本进程内的服务器；为空时作为监控窗口，定时读取monitorUrl指向的指标端口（/metrics.json）
 class ServerWindow : public QMainWindow
 {
     Q_OBJECT
 
 public:
-    ServerWindow(QWidget *parent = nullptr);
+    explicit ServerWindow(ServerCore *core, const QUrl &monitorUrl = QUrl(), QWidget *parent = nullptr);
     ~ServerWindow();
 
 private slots:
@@ -25,12 +31,18 @@ private slots:
 
     void onClientReadyRead();
 
+    // 监控模式：请求和显示远程服务器指标
+    void pollMetrics();
+    void onMetricsReply(QNetworkReply *reply);
+
 private:
     Ui::ServerWindow *ui;  // UI界面对象
-    TcpServer* m_tcpServer;  // TCP服务器实例
+    ServerCore* m_core;    // 本进程内的服务器（监控模式为空）
     bool m_tcpRunning = false;  // TCP服务运行状态
-    // 对应端口
-    const int TCP_PORT = 8888;
+
+    QUrl m_monitorUrl;
+    QNetworkAccessManager* m_network = nullptr;
+    bool m_monitorReachable = true;  // 上次读取指标是否成功（只在状态变化时写日志）
 };
 
 #endif // SERVERWINDOW_H
@@ -0,0 +1,167 @@
+#include "sessionmanager.h"
+#include <QDateTime>
+#include <QRandomGenerator>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QDebug>
+
+// 会话有效期：登录后12小时，过期后需要重新登录
+static const qint64 kSessionTtlMs = 12LL * 60 * 60 * 1000;
+
+SessionManager::SessionManager() : m_generation(0)
+{
+}
+
+SessionManager& SessionManager::getInstance()
+{
+    static SessionManager instance;
+    return instance;
+}
+
+QString SessionManager::principalKey(const QString& userType, int principalId)
+{
+    return userType + ":" + QString::number(principalId);
+}
+
+QString SessionManager::createSession(const Session& session)
+{
+    // 128位随机token，十六进制编码
+    quint32 words[4];
+    QRandomGenerator::system()->fillRange(words);
+    QString token;
+    for (quint32 word : words) {
+        token += QString("%1").arg(word, 8, 16, QLatin1Char('0'));
+    }
+
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    Session stored = session;
+    stored.token = token;
+    stored.createdMs = nowMs;
+
+    QWriteLocker locker(&m_lock);
+    purgeExpiredLocked(nowMs);
+    m_sessions.insert(token, stored);
+    m_principalTokens[principalKey(stored.userType, stored.principalId)].insert(token);
+    return token;
+}
+
+bool SessionManager::resolve(const QString& token, Session* session) const
+{
+    if (token.isEmpty()) {
+        return false;
+    }
+
+    QReadLocker locker(&m_lock);
+    auto it = m_sessions.constFind(token);
+    if (it == m_sessions.constEnd()) {
+        return false;
+    }
+    if (QDateTime::currentMSecsSinceEpoch() - it->createdMs > kSessionTtlMs) {
+        return false;  // 过期会话在下次登录时清理
+    }
+    *session = it.value();
+    return true;
+}
+
+void SessionManager::removeSession(const QString& token)
+{
+    QWriteLocker locker(&m_lock);
+    removeSessionLocked(token);
+    m_generation.fetchAndAddRelaxed(1);
+}
+
+void SessionManager::removeSessionLocked(const QString& token)
+{
+    auto it = m_sessions.find(token);
+    if (it == m_sessions.end()) {
+        return;
+    }
+    const QString key = principalKey(it->userType, it->principalId);
+    m_sessions.erase(it);
+    auto tokens = m_principalTokens.find(key);
+    if (tokens != m_principalTokens.end()) {
+        tokens->remove(token);
+        if (tokens->isEmpty()) {
+            m_principalTokens.erase(tokens);
+        }
+    }
+}
+
+void SessionManager::purgeExpiredLocked(qint64 nowMs)
+{
+    QStringList expired;
+    for (auto it = m_sessions.constBegin(); it != m_sessions.constEnd(); ++it) {
+        if (nowMs - it->createdMs > kSessionTtlMs) {
+            expired.append(it.key());
+        }
+    }
+    for (const QString& token : expired) {
+        removeSessionLocked(token);
+    }
+}
+
+void SessionManager::publishStatus(const QString& userType, int principalId, const QString& status)
+{
+    QWriteLocker locker(&m_lock);
+    const QSet<QString> tokens = m_principalTokens.value(principalKey(userType, principalId));
+    for (const QString& token : tokens) {
+        m_sessions[token].status = status;
+    }
+    if (!tokens.isEmpty()) {
+        qDebug() << "会话状态已更新:" << userType << principalId << status << "在线会话数:" << tokens.size();
+        m_generation.fetchAndAddRelaxed(1);
+    }
+}
+
+void SessionManager::publishStatusByUsername(const QString& userType, const QString& username, const QString& status)
+{
+    QWriteLocker locker(&m_lock);
+    bool changed = false;
+    for (auto it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+        if (it->userType == userType && it->username == username) {
+            it->status = status;
+            changed = true;
+        }
+    }
+    if (changed) {
+        m_generation.fetchAndAddRelaxed(1);
+    }
+}
+
+void SessionManager::publishRole(int userId, int role)
+{
+    QWriteLocker locker(&m_lock);
+    const QSet<QString> tokens = m_principalTokens.value(principalKey("buyer", userId));
+    for (const QString& token : tokens) {
+        m_sessions[token].role = role;
+    }
+    if (!tokens.isEmpty()) {
+        m_generation.fetchAndAddRelaxed(1);
+    }
+}
+
+void SessionManager::publishMemberLevel(const QString& userType, int principalId,
+                                        const QString& memberLevel, double memberDiscount)
+{
+    QWriteLocker locker(&m_lock);
+    const QSet<QString> tokens = m_principalTokens.value(principalKey(userType, principalId));
+    for (const QString& token : tokens) {
+        m_sessions[token].memberLevel = memberLevel;
+        m_sessions[token].memberDiscount = memberDiscount;
+    }
+    if (!tokens.isEmpty()) {
+        m_generation.fetchAndAddRelaxed(1);
+    }
+}
+
+void SessionManager::revokePrincipal(const QString& userType, int principalId)
+{
+    QWriteLocker locker(&m_lock);
+    const QSet<QString> tokens = m_principalTokens.take(principalKey(userType, principalId));
+    for (const QString& token : tokens) {
+        m_sessions.remove(token);
+    }
+    if (!tokens.isEmpty()) {
+        m_generation.fetchAndAddRelaxed(1);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef SESSIONMANAGER_H
+#define SESSIONMANAGER_H
+
+#include <QString>
+#include <QHash>
+#include <QSet>
+#include <QReadWriteLock>
+#include <QAtomicInteger>
+
+// 登录会话：登录时从数据库读取一次身份信息，之后的鉴权只读会话
+struct Session
+{
+    QString token;
+    int principalId = -1;    // 买家为user_id，商家为seller_id
+    QString userType;        // buyer / seller / admin
+    QString username;
+    int role = 1;            // users.role：1-买家，2-卖家，0-卖家认证审核中
+    QString status;          // 正常 / 封禁 / 已删除
+    QString memberLevel;
+    double memberDiscount = 1.0;
+    qint64 createdMs = 0;
+
+    bool isValid() const { return !token.isEmpty(); }
+    bool isBanned() const { return status == "封禁" || status == "已删除"; }
+    bool isPrincipal(const QString& type, int id) const { return isValid() && userType == type && principalId == id; }
+};
+
+/**
+ * @brief 会话管理（单例）：登录后发放不透明token，缓存身份、角色、状态和会员等级
+ * @note 管理员封禁/解封、角色变更、会员等级变化时由Database调用publish*推送到在线会话，
+ *       每次推送递增generation，连接上缓存的会话副本据此判断是否需要重新读取
+ */
+class SessionManager
+{
+public:
+    static SessionManager& getInstance();
+
+    QString createSession(const Session& session);  // 返回新token
+    bool resolve(const QString& token, Session* session) const;  // token无效或过期返回false
+    void removeSession(const QString& token);
+    quint64 generation() const { return m_generation.load(); }
+
+    // ===== 失效广播 =====
+    void publishStatus(const QString& userType, int principalId, const QString& status);
+    void publishStatusByUsername(const QString& userType, const QString& username, const QString& status);
+    void publishRole(int userId, int role);
+    void publishMemberLevel(const QString& userType, int principalId, const QString& memberLevel, double memberDiscount);
+    void revokePrincipal(const QString& userType, int principalId);  // 账号删除后注销其全部会话
+
+private:
+    SessionManager();
+    SessionManager(const SessionManager&) = delete;
+    SessionManager& operator=(const SessionManager&) = delete;
+
+    static QString principalKey(const QString& userType, int principalId);
+    void removeSessionLocked(const QString& token);
+    void purgeExpiredLocked(qint64 nowMs);
+
+    mutable QReadWriteLock m_lock;
+    QHash<QString, Session> m_sessions;               // token -> 会话
+    QHash<QString, QSet<QString>> m_principalTokens;  // "buyer:12" -> 该账号的全部token
+    QAtomicInteger<quint64> m_generation;
+};
+
+#endif // SESSIONMANAGER_H
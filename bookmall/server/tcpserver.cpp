@@ -1,6 +1,12 @@
 #include "tcpserver.h"
-#include "clientthreadfactory.h"  // 新增：包含线程工厂头文件
 #include "data.h"  // MySQL数据库支持
+#include "servermetrics.h"
+#include "recommendengine.h"
+#include "cartservice.h"
+#include "idgenerator.h"
+#include "requestlogarchive.h"
+#include "lotteryservice.h"
+#include "trafficcapture.h"
 #include <QMutex>
 #include <QWaitCondition>
 #include <QDateTime>
@@ -8,7 +14,19 @@
 #include <QFile>
 #include <QTextStream>
 #include <QSet>
+#include <QElapsedTimer>
+#include <QCryptographicHash>
+#include <QThreadPool>
+#include <QSemaphore>
+#include <QThread>
 #include <cstdlib>
+#include <cstring>
+#ifdef Q_OS_UNIX
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
 
 // #region agent log
 // 调试日志辅助函数
@@ -40,6 +58,68 @@ static void writeDebugLog(const QString& location, const QString& message, const
 static void ensureAdminDataInited();
 static void ensureSellerBooksInited();
 
+// 列表分页：请求带 limit(>0) 时数据库查询只取 [offset, offset+limit) 这一段，响应附带 offset/limit/hasMore，
+// total 为完整条数；不带 limit 的请求返回全部数据，老客户端不受影响
+static void setPageInfo(QJsonObject &resp, int offset, int limit, int pageSize, int total)
+{
+    if (limit <= 0) {
+        return;
+    }
+    resp["offset"] = offset;
+    resp["limit"] = limit;
+    resp["hasMore"] = offset + pageSize < total;
+}
+
+// 编码一帧响应：4字节大端长度 + JSON
+static QByteArray encodeFrame(const QJsonObject &response)
+{
+    QByteArray payload = QJsonDocument(response).toJson(QJsonDocument::Compact);
+
+    QByteArray frame;
+    QDataStream ds(&frame, QIODevice::WriteOnly);
+    ds.setByteOrder(QDataStream::BigEndian);
+    ds << (quint32)payload.size();
+    frame.append(payload);
+    return frame;
+}
+
+// 过载响应：客户端收到后按retryAfterMs等待再重试
+static QJsonObject serverBusyResponse()
+{
+    QJsonObject response;
+    response["success"] = false;
+    response["message"] = "服务器繁忙，请稍后重试";
+    response["serverBusy"] = true;
+    response["retryAfterMs"] = ThreadPool::getInstance().retryAfterMs();
+    return response;
+}
+
+// 等待数据库锁的线程数达到该值时视为过载
+static const int kShedDbLockWaiters = 8;
+
+// 连接空闲时每次等待新请求的时长
+static const int kIdlePollMs = 1000;
+
+static QAtomicInt s_draining(0);
+
+void TcpFileTask::setDraining(bool draining)
+{
+    s_draining.store(draining ? 1 : 0);
+}
+
+bool TcpFileTask::isDraining()
+{
+    return s_draining.load() != 0;
+}
+
+// 浏览类请求：过载时最先拒绝，把线程和数据库让给管理端、下单和支付等请求
+static bool isSheddableAction(const QString &action)
+{
+    return action == "getAllBooks" || action == "searchBooks" || action == "getBook"
+           || action == "getRecommendations" || action == "getBookReviews"
+           || action == "getBookRatingStats" || action == "getSellerReviews";
+}
+
 TcpServer::TcpServer(QObject *parent) : QTcpServer(parent)
 {
     // 构造函数：初始化TCP服务器，暂无额外逻辑
@@ -57,7 +137,7 @@ TcpServer::TcpServer(QObject *parent) : QTcpServer(parent)
 
 // TCP文件传输任务构造函数：保存客户端套接字描述符
 TcpFileTask::TcpFileTask(qintptr socketDescriptor, QObject *parent)
-    : Task(), m_socketDescriptor(socketDescriptor), m_currentSellerId(-1), m_currentUserType("")
+    : Task(), m_socketDescriptor(socketDescriptor), m_currentSellerId(-1), m_currentUserType(""), m_sessionGeneration(0)
 {
     Q_UNUSED(parent);  // 标记未使用的参数，消除编译器警告
 }
@@ -65,6 +145,13 @@ TcpFileTask::TcpFileTask(qintptr socketDescriptor, QObject *parent)
 // 任务执行逻辑：处理JSON格式的TCP请求（长度前缀协议）
 void TcpFileTask::run()
 {
+    // 活跃连接计数：覆盖run()的所有返回路径
+    struct ConnectionGauge {
+        ConnectionGauge() { ServerMetrics::getInstance().connectionOpened(); }
+        ~ConnectionGauge() { ServerMetrics::getInstance().connectionClosed(); }
+    } connectionGauge;
+    Q_UNUSED(connectionGauge);
+
     QTcpSocket socket;
     if (!socket.setSocketDescriptor(m_socketDescriptor)) {
         qDebug() << "TCP套接字初始化失败：" << socket.errorString();
@@ -77,19 +164,29 @@ void TcpFileTask::run()
     emit logGenerated("TCP客户端连接：" + m_clientIp + ":" + QString::number(m_clientPort));
     emit dataReceived(m_clientIp, m_clientPort, "客户端已连接");
 
+    // 流量录制（BOOKMALL_CAPTURE_FILE）：未启用时captureId为0，后续录制调用直接返回
+    TrafficCapture &capture = TrafficCapture::getInstance();
+    const quint32 captureId = capture.connectionOpened();
+
     QByteArray recvBuffer;  // 接收缓冲区，用于处理分片数据
 
     // 长连接模式：持续处理客户端请求
     while (socket.state() == QAbstractSocket::ConnectedState) {
-        // 等待客户端发送请求，超时时间30秒
-        if (!socket.waitForReadyRead(30000)) {
+        // 服务器排空时，已收到的请求都处理完后断开
+        if (recvBuffer.isEmpty() && isDraining()) {
+            break;
+        }
+        // 等待客户端发送请求，按kIdlePollMs分段等待以便及时发现排空
+        if (!socket.waitForReadyRead(kIdlePollMs)) {
             if (socket.state() != QAbstractSocket::ConnectedState) {
                 break;
             }
             continue;  // 超时但连接正常，继续等待
         }
 
-        recvBuffer += socket.readAll();
+        QByteArray chunk = socket.readAll();
+        ServerMetrics::getInstance().addBytesIn(chunk.size());
+        recvBuffer += chunk;
 
         // 解析长度前缀协议：4字节大端长度 + JSON payload
         while (recvBuffer.size() >= 4) {
@@ -102,6 +199,7 @@ void TcpFileTask::run()
             // 防御：检查payload长度是否合理（最大10MB）
             if (payloadLen > 10 * 1024 * 1024) {
                 emit logGenerated("错误：客户端 [" + m_clientIp + "] 发送的payload长度过大:" + QString::number(payloadLen));
+                capture.connectionClosed(captureId);
                 socket.close();
                 return;
             }
@@ -115,6 +213,7 @@ void TcpFileTask::run()
             // 提取JSON payload
             QByteArray payload = recvBuffer.mid(4, payloadLen);
             recvBuffer = recvBuffer.mid(4 + payloadLen);  // 移除已处理的数据
+            const qint64 receivedUs = captureId ? capture.nowUs() : 0;
 
             // 解析JSON
             QJsonParseError error;
@@ -126,6 +225,7 @@ void TcpFileTask::run()
                 errorResponse["success"] = false;
                 errorResponse["message"] = "JSON格式错误";
                 sendJsonResponse(socket, errorResponse);
+                capture.requestHandled(captureId, receivedUs, payload, errorResponse);
                 continue;
             }
 
@@ -136,31 +236,284 @@ void TcpFileTask::run()
             // 处理请求并发送响应
             QJsonObject response = processJsonRequest(request);
             sendJsonResponse(socket, response);
+            capture.requestHandled(captureId, receivedUs, payload, response);
 
             emit logGenerated("已向客户端 [" + m_clientIp + "] 返回响应: " + action);
         }
     }
 
     emit logGenerated("TCP客户端断开连接：" + m_clientIp);
+    capture.connectionClosed(captureId);
     socket.disconnectFromHost();
 }
 
+void TcpFileTask::runExpired()
+{
+    QTcpSocket socket;
+    if (!socket.setSocketDescriptor(m_socketDescriptor)) {
+        return;
+    }
+    sendJsonResponse(socket, serverBusyResponse());
+    socket.disconnectFromHost();
+    if (socket.state() != QAbstractSocket::UnconnectedState) {
+        socket.waitForDisconnected(1000);  // 等待繁忙响应写完
+    }
+    emit logGenerated("连接排队超时，已回复繁忙并断开：" + socket.peerAddress().toString());
+}
+
 void TcpServer::incomingConnection(qintptr socketDescriptor)
 {
-    Task* task = ClientThreadFactory::getInstance().createThread(ProtocolType::TCP, socketDescriptor);
-    if (task != nullptr) {
-        // 将任务转换为TcpFileTask，连接信号
-        TcpFileTask* tcpTask = dynamic_cast<TcpFileTask*>(task);
-        if (tcpTask) {
-            connect(tcpTask, &TcpFileTask::dataReceived, this, &TcpServer::dataReceived, Qt::QueuedConnection);
-            connect(tcpTask, &TcpFileTask::logGenerated, this, &TcpServer::logGenerated, Qt::QueuedConnection);
+    // 运行在接入线程：直接创建连接任务交给线程池。任务的日志信号直接连到监听组（排队送往界面），
+    // 不经过TcpServer：排空时接入线程已结束、TcpServer已销毁，任务仍在处理剩余请求
+    TcpFileTask* task = new TcpFileTask(socketDescriptor);
+    if (m_logSink) {
+        connect(task, &TcpFileTask::dataReceived, m_logSink, &TcpListenerGroup::dataReceived);
+        connect(task, &TcpFileTask::logGenerated, m_logSink, &TcpListenerGroup::logGenerated);
+    }
+
+    // 准入控制：排队已满时不再排队等待，立即回复繁忙并断开，客户端按retryAfterMs重试。
+    // 连接按先进先出排队；管理端、下单和支付优先于浏览的分流在请求层完成（见isSheddableAction）
+    if (!ThreadPool::getInstance().tryAddTask(task)) {
+        delete task;
+        QTcpSocket *socket = new QTcpSocket(this);
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        if (socket->setSocketDescriptor(socketDescriptor)) {
+            QByteArray frame = encodeFrame(serverBusyResponse());
+            socket->write(frame);
+            ServerMetrics::getInstance().addBytesOut(frame.size());
+            socket->disconnectFromHost();  // 待发送数据写完后断开
+        } else {
+            socket->deleteLater();
+        }
+        emit logGenerated("线程池排队已满，拒绝新连接");
+    }
+}
+
+// 打开一个设置了SO_REUSEPORT的监听套接字（优先IPv4/IPv6双栈），失败返回-1
+static int openReusePortSocket(const QHostAddress &address, quint16 port)
+{
+#if defined(Q_OS_UNIX) && defined(SO_REUSEPORT)
+    const bool any = address == QHostAddress::Any;
+    bool ipv6 = any || address.protocol() == QAbstractSocket::IPv6Protocol;
+    int fd = ipv6 ? ::socket(AF_INET6, SOCK_STREAM, 0) : -1;
+    if (fd < 0) {
+        if (!any && ipv6) {
+            return -1;
+        }
+        ipv6 = false;
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return -1;
+        }
+    }
+
+    int on = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+
+    int rc;
+    if (ipv6) {
+        int v6only = any ? 0 : 1;
+        ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &v6only, sizeof(v6only));
+        sockaddr_in6 addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin6_family = AF_INET6;
+        if (any) {
+            addr.sin6_addr = in6addr_any;
+        } else {
+            Q_IPV6ADDR ip6 = address.toIPv6Address();
+            std::memcpy(&addr.sin6_addr, &ip6, sizeof(addr.sin6_addr));
+        }
+        addr.sin6_port = htons(port);
+        rc = ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    } else {
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(any ? INADDR_ANY : address.toIPv4Address());
+        addr.sin_port = htons(port);
+        rc = ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    }
+
+    if (rc != 0 || ::listen(fd, SOMAXCONN) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+#else
+    Q_UNUSED(address);
+    Q_UNUSED(port);
+    return -1;
+#endif
+}
+
+void TcpServer::setListenParams(const QHostAddress &address, quint16 port, bool reusePort)
+{
+    m_listenAddress = address;
+    m_listenPort = port;
+    m_reusePort = reusePort;
+}
+
+bool TcpServer::startListening()
+{
+    if (!m_reusePort) {
+        return listen(m_listenAddress, m_listenPort);
+    }
+
+    int fd = openReusePortSocket(m_listenAddress, m_listenPort);
+    if (fd < 0) {
+        return false;
+    }
+    // 交给QTcpServer接管：已处于监听状态的描述符，由本线程的事件循环接受连接
+    if (!setSocketDescriptor(fd)) {
+#ifdef Q_OS_UNIX
+        ::close(fd);
+#endif
+        return false;
+    }
+    return true;
+}
+
+TcpListenerGroup::TcpListenerGroup(QObject *parent) : QObject(parent)
+{
+}
+
+TcpListenerGroup::~TcpListenerGroup()
+{
+    stop();
+}
+
+bool TcpListenerGroup::reusePortSupported()
+{
+#if defined(Q_OS_UNIX) && defined(SO_REUSEPORT)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool TcpListenerGroup::start(const QHostAddress &address, quint16 port)
+{
+    if (isListening()) {
+        return true;
+    }
+    m_error.clear();
+
+    bool ok = false;
+    int count = qEnvironmentVariableIntValue("BOOKMALL_ACCEPT_THREADS", &ok);
+    if (!ok || count <= 0) {
+        count = qBound(1, QThread::idealThreadCount(), int(MAX_ACCEPT_THREADS));
+    }
+
+    bool reusePort = reusePortSupported();
+    if (!reusePort) {
+        count = 1;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        if (startAcceptor(i, address, port, reusePort)) {
+            continue;
         }
-        ThreadPool::getInstance().addTask(task);
+        if (i == 0 && reusePort) {
+            // 内核不支持SO_REUSEPORT等情况：退化为单个普通监听套接字
+            qWarning() << "❌ SO_REUSEPORT监听失败，改用单个接入线程:" << m_error;
+            reusePort = false;
+            count = 1;
+            if (startAcceptor(0, address, port, false)) {
+                break;
+            }
+        }
+        stop();
+        return false;
+    }
+
+    qDebug() << "✓ TCP监听" << address.toString() << "端口" << port << "接入线程数:" << m_acceptors.size()
+             << (reusePort ? "(SO_REUSEPORT)" : "");
+    return true;
+}
+
+bool TcpListenerGroup::startAcceptor(int index, const QHostAddress &address, quint16 port, bool reusePort)
+{
+    QThread* thread = new QThread;
+    thread->setObjectName(QString("tcp-acceptor-%1").arg(index));
+    TcpServer* server = new TcpServer;
+    server->setListenParams(address, port, reusePort);
+    server->moveToThread(thread);
+    connect(thread, &QThread::finished, server, &QObject::deleteLater);
+    if (m_forwardLogs) {
+        server->setLogSink(this);
+        connect(server, &TcpServer::dataReceived, this, &TcpListenerGroup::dataReceived);
+        connect(server, &TcpServer::logGenerated, this, &TcpListenerGroup::logGenerated);
+    }
+    thread->start();
+
+    // 监听套接字的事件通知器必须在接入线程中创建，因此在该线程中执行监听
+    bool listening = false;
+    QMetaObject::invokeMethod(server, "startListening", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(bool, listening));
+    if (!listening) {
+        m_error = server->errorString();
+        if (m_error.isEmpty()) {
+            m_error = QString("无法监听端口%1").arg(port);
+        }
+        thread->quit();
+        thread->wait();
+        delete thread;
+        return false;
+    }
+
+    Acceptor acceptor;
+    acceptor.thread = thread;
+    acceptor.server = server;
+    m_acceptors.append(acceptor);
+    return true;
+}
+
+void TcpListenerGroup::stop()
+{
+    // 结束接入线程的事件循环，监听套接字随TcpServer在线程结束时销毁；已建立的连接由线程池中的任务继续处理，
+    // 其日志直接发往本对象（由ServerCore持有，存活到线程池排空之后）
+    for (const Acceptor &acceptor : m_acceptors) {
+        acceptor.thread->quit();
+    }
+    for (const Acceptor &acceptor : m_acceptors) {
+        acceptor.thread->wait();
+        delete acceptor.thread;
+    }
+    m_acceptors.clear();
+}
+
+// 处理JSON格式的请求：记录每个动作的耗时、数据库耗时和成功状态；过载时直接拒绝浏览类请求
+QJsonObject TcpFileTask::processJsonRequest(const QJsonObject &request, qint64 *dbUs)
+{
+    ServerMetrics& metrics = ServerMetrics::getInstance();
+    const qint64 outerDbUs = metrics.beginRequest();
+    QElapsedTimer timer;
+    timer.start();
+
+    QJsonObject response;
+    const QString action = request.value("action").toString();
+    if (isSheddableAction(action)
+        && (ThreadPool::getInstance().isOverloaded() || metrics.dbLockWaiters() >= kShedDbLockWaiters)) {
+        metrics.requestShed();
+        response = serverBusyResponse();
+    } else {
+        response = dispatchJsonRequest(request);
     }
+
+    const qint64 requestDbUs = metrics.endRequest(action, timer.nsecsElapsed() / 1000,
+                                                  response.value("success").toBool(), outerDbUs);
+    if (dbUs) {
+        *dbUs = requestDbUs;
+    }
+    return response;
 }
 
-// 处理JSON格式的请求
-QJsonObject TcpFileTask::processJsonRequest(const QJsonObject &request)
+// 按action分发请求到对应的处理函数
+QJsonObject TcpFileTask::dispatchJsonRequest(const QJsonObject &request)
 {
     QString action = request.value("action").toString();
     QString category = "unknown"; // 请求分类
@@ -180,16 +533,38 @@ QJsonObject TcpFileTask::processJsonRequest(const QJsonObject &request)
         category = "cart";
     }
     
+    // 客户端心跳：只确认连接可用，不校验会话、不写请求日志
+    if (action == "ping") {
+        QJsonObject pong;
+        pong["success"] = true;
+        pong["message"] = "pong";
+        return pong;
+    }
+    
+    // 请求携带token时校验会话；token失效直接拒绝。未携带token的旧客户端按原逻辑处理
+    const bool isLoginAction = (action == "login" || action == "register" || action == "adminLogin");
+    QJsonObject sessionError;
+    if (!isLoginAction && !refreshSession(request.value("token").toString(), &sessionError)) {
+        return sessionError;
+    }
+    if (!isLoginAction && !authorizeRequest(action, request, &sessionError)) {
+        return sessionError;
+    }
+    
     QJsonObject response;
 
     if (action == "login") {
         response = handleLogin(request);
+    } else if (action == "logout") {
+        return handleLogout(request);
     } else if (action == "register") {
         response = handleRegister(request);
     } else if (action == "changePassword") {
         response = handleChangePassword(request);
     } else if (action == "updateUserInfo") {
         response = handleUpdateUserInfo(request);
+    } else if (action == "batch") {
+        return handleBatch(request);
     } else if (action == "getAllBooks") {
         return handleGetAllBooks(request);
     } else if (action == "getBook") {
@@ -208,6 +583,8 @@ QJsonObject TcpFileTask::processJsonRequest(const QJsonObject &request)
         return handleAddFavorite(request);
     } else if (action == "removeFavorite") {
         return handleRemoveFavorite(request);
+    } else if (action == "getRecommendations") {
+        return handleGetRecommendations(request);
     } else if (action == "createOrder") {
         return handleCreateOrder(request);
     } else if (action == "getUserOrders") {
@@ -222,6 +599,10 @@ QJsonObject TcpFileTask::processJsonRequest(const QJsonObject &request)
         return handleSendChatMessage(request);
     } else if (action == "getChatHistory") {
         return handleGetChatHistory(request);
+    } else if (action == "getConversations") {
+        return handleGetConversations(request);
+    } else if (action == "markConversationRead") {
+        return handleMarkConversationRead(request);
     } else if (action == "addReview") {
         return handleAddReview(request);
     } else if (action == "getBookReviews") {
@@ -268,6 +649,8 @@ QJsonObject TcpFileTask::processJsonRequest(const QJsonObject &request)
         return handleSellerRechargeMember(request);
     } else if (action == "sellerDashboardStats") {
         return handleSellerDashboardStats(request);
+    } else if (action == "sellerDashboardSnapshot") {
+        return handleSellerDashboardSnapshot(request);
     } else if (action == "sellerGetSystemSettings") {
         return handleSellerGetSystemSettings(request);
     } else if (action == "sellerUpdateSystemSettings") {
@@ -330,6 +713,8 @@ QJsonObject TcpFileTask::processJsonRequest(const QJsonObject &request)
         response = handleAdminGetSystemStats(request);
     } else if (action == "adminGetRequestLogs") {
         response = handleAdminGetRequestLogs(request);
+    } else if (action == "adminGetServerMetrics") {
+        return handleAdminGetServerMetrics(request);
     } else {
         response["success"] = false;
         response["message"] = "未知的请求类型: " + action;
@@ -353,6 +738,175 @@ QJsonObject TcpFileTask::processJsonRequest(const QJsonObject &request)
     return response;
 }
 
+// ===== 批量请求 =====
+
+// 批量子请求专用线程池：连接任务会长期占用服务器线程池，子请求提交到那里可能一直排不到线程
+class BatchThreadPool : public QThreadPool
+{
+public:
+    BatchThreadPool()
+    {
+        setMaxThreadCount(qMax(2, QThread::idealThreadCount()));
+    }
+};
+
+static QThreadPool& batchThreadPool()
+{
+    static BatchThreadPool pool;
+    return pool;
+}
+
+// 会改变连接会话的动作不能放进批量请求
+static bool isSessionAction(const QString &action)
+{
+    return action == "login" || action == "register" || action == "adminLogin"
+           || action == "logout" || action == "batch";
+}
+
+// 只读查询：不修改连接状态，同一批中相邻的只读子请求可以并行执行
+static bool isReadOnlyAction(const QString &action)
+{
+    return action.startsWith("get") || action.startsWith("search")
+           || action.startsWith("sellerGet") || action.startsWith("adminGet")
+           || action == "sellerDashboardStats" || action == "sellerDashboardSnapshot";
+}
+
+void TcpFileTask::copyPrincipalFrom(const TcpFileTask &owner)
+{
+    m_clientIp = owner.m_clientIp;
+    m_clientPort = owner.m_clientPort;
+    m_currentSellerId = owner.m_currentSellerId;
+    m_currentUserType = owner.m_currentUserType;
+    m_session = owner.m_session;
+    m_sessionGeneration = owner.m_sessionGeneration;
+}
+
+// 在批量线程池中执行一个子请求，完成后释放信号量。
+// 子请求在自己的上下文中执行：构造时（提交前，在连接线程中）复制连接的身份和会话，
+// 池线程不读写连接对象的字段；日志信号转发到连接对象的信号
+class TcpFileTask::BatchItemTask : public QRunnable
+{
+public:
+    BatchItemTask(TcpFileTask *owner, const QJsonObject &request, QJsonObject *response, qint64 *dbUs, QSemaphore *done)
+        : m_context(-1), m_request(request), m_response(response), m_dbUs(dbUs), m_done(done)
+    {
+        m_context.copyPrincipalFrom(*owner);
+        m_context.moveToThread(nullptr);  // 在池线程中使用和销毁，不绑定任何线程
+        QObject::connect(&m_context, &TcpFileTask::logGenerated, owner, &TcpFileTask::logGenerated, Qt::DirectConnection);
+        QObject::connect(&m_context, &TcpFileTask::dataReceived, owner, &TcpFileTask::dataReceived, Qt::DirectConnection);
+    }
+
+    void run() override
+    {
+        *m_response = m_context.processJsonRequest(m_request, m_dbUs);
+        m_done->release();
+    }
+
+private:
+    TcpFileTask m_context;
+    QJsonObject m_request;
+    QJsonObject *m_response;
+    qint64 *m_dbUs;
+    QSemaphore *m_done;
+};
+
+// 执行一段子请求：多个时除第一个外提交到批量线程池，第一个在当前线程执行，全部完成后返回
+void TcpFileTask::runBatchStage(const QVector<QJsonObject> &items, const QVector<int> &stage, QVector<QJsonObject> *results)
+{
+    if (stage.isEmpty()) {
+        return;
+    }
+
+    QSemaphore done;
+    QVector<qint64> pooledDbUs(stage.size(), 0);
+    for (int i = 1; i < stage.size(); ++i) {
+        int index = stage.at(i);
+        batchThreadPool().start(new BatchItemTask(this, items.at(index), &(*results)[index], &pooledDbUs[i], &done));
+    }
+    // 当前线程执行的子请求是嵌套请求，其数据库耗时由endRequest并入批量请求
+    (*results)[stage.first()] = processJsonRequest(items.at(stage.first()));
+    done.acquire(stage.size() - 1);
+
+    // 池线程中子请求的数据库耗时也计入批量请求
+    qint64 pooledTotal = 0;
+    for (qint64 us : pooledDbUs) {
+        pooledTotal += us;
+    }
+    ServerMetrics::getInstance().addDbTime(pooledTotal);
+}
+
+// 批量请求：requests为子请求数组，子请求沿用批量请求已校验的会话。
+// 按顺序分段执行：相邻的只读查询为一段并行执行，其他请求各自单独一段，保证写操作之后的查询能看到结果。
+// 返回 responses: [{action, success, response}]，与requests一一对应
+QJsonObject TcpFileTask::handleBatch(const QJsonObject &request)
+{
+    QJsonObject response;
+    QJsonArray requests = request.value("requests").toArray();
+    if (requests.isEmpty()) {
+        response["success"] = false;
+        response["message"] = "批量请求不能为空";
+        return response;
+    }
+    if (requests.size() > MAX_BATCH_ITEMS) {
+        response["success"] = false;
+        response["message"] = QString("批量请求最多包含%1个子请求").arg(int(MAX_BATCH_ITEMS));
+        return response;
+    }
+
+    const int count = requests.size();
+    QVector<QJsonObject> items(count);
+    QVector<QJsonObject> results(count);
+    QVector<bool> rejected(count, false);
+    for (int i = 0; i < count; ++i) {
+        QJsonObject item = requests.at(i).toObject();
+        QString action = item.value("action").toString();
+        if (action.isEmpty() || isSessionAction(action)) {
+            results[i]["success"] = false;
+            results[i]["message"] = "批量请求中不支持该操作: " + action;
+            rejected[i] = true;
+            continue;
+        }
+        // 不带token：并行执行的子请求不能各自刷新连接的会话缓存
+        item.remove("token");
+        items[i] = item;
+    }
+
+    int next = 0;
+    while (next < count) {
+        QVector<int> stage;
+        if (!rejected.at(next) && !isReadOnlyAction(items.at(next).value("action").toString())) {
+            stage.append(next++);
+        } else {
+            while (next < count && (rejected.at(next) || isReadOnlyAction(items.at(next).value("action").toString()))) {
+                if (!rejected.at(next)) {
+                    stage.append(next);
+                }
+                ++next;
+            }
+        }
+        runBatchStage(items, stage, &results);
+    }
+
+    QJsonArray responses;
+    int succeeded = 0;
+    for (int i = 0; i < count; ++i) {
+        bool ok = results.at(i).value("success").toBool();
+        if (ok) {
+            ++succeeded;
+        }
+        QJsonObject entry;
+        entry["action"] = requests.at(i).toObject().value("action").toString();
+        entry["success"] = ok;
+        entry["response"] = results.at(i);
+        responses.append(entry);
+    }
+
+    response["success"] = true;
+    response["message"] = QString("批量请求完成：%1/%2 成功").arg(succeeded).arg(count);
+    response["responses"] = responses;
+    return response;
+}
+
 // ===== 卖家端：内存书库（线程安全）=====
 // ===== 卖家端全局变量 =====
 static QMutex g_sellerBooksMutex;
@@ -395,11 +949,15 @@ QJsonObject TcpFileTask::handleSellerGetBooks(const QJsonObject &request)
     // 从数据库加载该商家的图书
     if (Database::getInstance().isConnected()) {
         int merchantId = sellerId.toInt();
-        // 使用专门的方法获取该卖家的所有书籍（包括待审核等所有状态）
-        QJsonArray sellerBooks = Database::getInstance().getAllBooksForSeller(merchantId);
+        // 使用专门的方法获取该卖家的书籍（包括待审核等所有状态），带limit时在查询中分页
+        const int limit = request.value("limit").toInt(0);
+        const int offset = qMax(0, request.value("offset").toInt(0));
+        int total = 0;
+        QJsonArray sellerBooks = Database::getInstance().getAllBooksForSeller(merchantId, offset, limit, &total);
         
         resp["books"] = sellerBooks;
-        resp["total"] = sellerBooks.size();
+        resp["total"] = total;
+        setPageInfo(resp, offset, limit, sellerBooks.size(), total);
     } else {
         resp["success"] = false;
         resp["message"] = "数据库未连接";
@@ -485,19 +1043,7 @@ QJsonObject TcpFileTask::handleSellerAddBook(const QJsonObject &request)
     // 使用数据库保存
     if (Database::getInstance().isConnected()) {
         // 检查商家状态，如果被封禁则不允许添加图书
-        QJsonArray sellersArray = Database::getInstance().getAllSellers();
-        bool sellerBanned = false;
-        for (const QJsonValue &sellerVal : sellersArray) {
-            QJsonObject seller = sellerVal.toObject();
-            if (seller.value("sellerId").toInt() == sellerId) {
-                QString sellerStatus = seller.value("status").toString();
-                if (sellerStatus == "封禁") {
-                    sellerBanned = true;
-                }
-                break;
-            }
-        }
-        if (sellerBanned) {
+        if (isPrincipalBanned("seller", sellerId)) {
             QJsonObject resp;
             resp["success"] = false;
             resp["message"] = "您的账号已被封禁，无法添加图书";
@@ -622,19 +1168,7 @@ QJsonObject TcpFileTask::handleSellerUpdateBook(const QJsonObject &request)
     if (Database::getInstance().isConnected()) {
         // 检查商家状态，如果被封禁则不允许更新图书
         if (sellerId > 0) {
-            QJsonArray sellersArray = Database::getInstance().getAllSellers();
-            bool sellerBanned = false;
-            for (const QJsonValue &sellerVal : sellersArray) {
-                QJsonObject seller = sellerVal.toObject();
-                if (seller.value("sellerId").toInt() == sellerId) {
-                    QString sellerStatus = seller.value("status").toString();
-                    if (sellerStatus == "封禁") {
-                        sellerBanned = true;
-                    }
-                    break;
-                }
-            }
-            if (sellerBanned) {
+            if (isPrincipalBanned("seller", sellerId)) {
                 QJsonObject resp;
                 resp["success"] = false;
                 resp["message"] = "您的账号已被封禁，无法更新图书";
@@ -769,19 +1303,7 @@ QJsonObject TcpFileTask::handleSellerDeleteBook(const QJsonObject &request)
     if (Database::getInstance().isConnected()) {
         // 检查商家状态，如果被封禁则不允许删除图书
         if (sellerId > 0) {
-            QJsonArray sellersArray = Database::getInstance().getAllSellers();
-            bool sellerBanned = false;
-            for (const QJsonValue &sellerVal : sellersArray) {
-                QJsonObject seller = sellerVal.toObject();
-                if (seller.value("sellerId").toInt() == sellerId) {
-                    QString sellerStatus = seller.value("status").toString();
-                    if (sellerStatus == "封禁") {
-                        sellerBanned = true;
-                    }
-                    break;
-                }
-            }
-            if (sellerBanned) {
+            if (isPrincipalBanned("seller", sellerId)) {
                 QJsonObject resp;
                 resp["success"] = false;
                 resp["message"] = "您的账号已被封禁，无法删除图书";
@@ -853,7 +1375,7 @@ QJsonObject TcpFileTask::handleSellerDeleteBook(const QJsonObject &request)
 // 订单字段示例：orderId/customer/phone/amount/status/payment/createTime/address/operator/remark
 static QString genOrderId()
 {
-    return QString("SELLER%1").arg(QDateTime::currentMSecsSinceEpoch());
+    return IdGenerator::getInstance().nextId("SELLER");
 }
 
 QJsonObject TcpFileTask::handleSellerGetOrders(const QJsonObject &request)
@@ -886,38 +1408,44 @@ QJsonObject TcpFileTask::handleSellerGetOrders(const QJsonObject &request)
 #if USE_DATABASE
     // 从数据库读取订单
     if (Database::getInstance().isConnected()) {
-        QJsonArray orders = Database::getInstance().getSellerOrders(sellerId);
+        // 订单明细在查询中分页；汇总字段覆盖全部订单，由按状态聚合的查询得到
+        const int limit = request.value("limit").toInt(0);
+        const int offset = qMax(0, request.value("offset").toInt(0));
+        int totalOrders = 0;
+        QJsonArray orders = Database::getInstance().getSellerOrders(sellerId, offset, limit, &totalOrders);
         
         double totalSales = 0.0;
-        int totalOrders = 0;
         int paidOrders = 0;
         int shippedOrders = 0;
         int cancelledOrders = 0;
+        QJsonObject statusCounts;  // 按状态计数（覆盖全部订单，分页时客户端据此统计）
         
-        for (const QJsonValue &orderVal : orders) {
-            QJsonObject order = orderVal.toObject();
-            totalOrders++;
-            
-            QString status = order["status"].toString();
+        const QJsonObject statusTotals = Database::getInstance().getSellerOrderStatusTotals(sellerId);
+        for (auto it = statusTotals.constBegin(); it != statusTotals.constEnd(); ++it) {
+            const QString status = it.key();
+            const int count = it.value().toObject().value("count").toInt();
+            statusCounts[status] = count;
             if (status == "已支付" || status == "已发货") {
-                totalSales += order["totalAmount"].toDouble();
-                paidOrders++;
+                totalSales += it.value().toObject().value("amount").toDouble();
+                paidOrders += count;
             }
             if (status == "已发货") {
-                shippedOrders++;
+                shippedOrders = count;
             }
             if (status == "已取消") {
-                cancelledOrders++;
+                cancelledOrders = count;
             }
         }
         
         resp["success"] = true;
         resp["orders"] = orders;
         resp["total"] = totalOrders;
+        setPageInfo(resp, offset, limit, orders.size(), totalOrders);
         resp["totalSales"] = totalSales;
         resp["paidOrders"] = paidOrders;
         resp["shippedOrders"] = shippedOrders;
         resp["cancelledOrders"] = cancelledOrders;
+        resp["statusCounts"] = statusCounts;
         return resp;
     } else {
         resp["success"] = false;
@@ -934,6 +1462,7 @@ QJsonObject TcpFileTask::handleSellerGetOrders(const QJsonObject &request)
     int paidOrders = 0;
     int shippedOrders = 0;
     int cancelledOrders = 0;
+    QJsonObject statusCounts;
     
     for (const auto &o : g_sellerOrders) {
         // 检查订单项中是否包含该商家的商品
@@ -954,6 +1483,7 @@ QJsonObject TcpFileTask::handleSellerGetOrders(const QJsonObject &request)
             totalOrders++;
             
             QString status = o["status"].toString();
+            statusCounts[status] = statusCounts.value(status).toInt() + 1;
             if (status == "已支付" || status == "已发货") {
                 totalSales += o["totalAmount"].toDouble();
                 paidOrders++;
@@ -974,6 +1504,7 @@ QJsonObject TcpFileTask::handleSellerGetOrders(const QJsonObject &request)
     resp["paidOrders"] = paidOrders;
     resp["shippedOrders"] = shippedOrders;
     resp["cancelledOrders"] = cancelledOrders;
+    resp["statusCounts"] = statusCounts;
     return resp;
 #endif
 }
@@ -1123,14 +1654,14 @@ QJsonObject TcpFileTask::handleSellerDeleteOrder(const QJsonObject &request)
 #endif
 }
 
-// ===== 卖家会员（内存模拟）=====
+// ===== 卖家会员 =====
+// 数据库模式返回在本店下过单的买家（seller_customers索引），支持分页（offset/limit）和筛选：
+// memberLevel、minSpent、maxSpent、activeDays（最近N天内下过单）
 QJsonObject TcpFileTask::handleSellerGetMembers(const QJsonObject &request)
 {
-    Q_UNUSED(request);
     QJsonObject resp;
     
 #if USE_DATABASE
-    // 使用数据库获取所有买家用户（role=1）及其会员等级
     if (!Database::getInstance().isConnected()) {
         resp["success"] = false;
         resp["message"] = "数据库未连接";
@@ -1139,70 +1670,46 @@ QJsonObject TcpFileTask::handleSellerGetMembers(const QJsonObject &request)
         return resp;
     }
     
-    // 获取当前登录的卖家ID
-    int currentSellerId = m_currentSellerId;
+    // 自动从当前登录会话获取商家ID
+    int sellerId = -1;
+    if (m_currentSellerId > 0 && m_currentUserType == "seller") {
+        sellerId = m_currentSellerId;
+    } else {
+        sellerId = request.value("sellerId").toVariant().toInt();
+    }
+    if (sellerId <= 0) {
+        resp["success"] = false;
+        resp["message"] = "请先登录商家账号";
+        return resp;
+    }
     
-    // 获取所有用户
-    QJsonArray allUsers = Database::getInstance().getAllUsers();
+    const int limit = request.value("limit").toInt(0);
+    const int offset = qMax(0, request.value("offset").toInt(0));
+    QJsonObject customers = Database::getInstance().getSellerCustomers(sellerId, request, offset, limit);
     
     QJsonArray members;
-    
-    // 只处理users表中role=1的买家用户
-    for (const QJsonValue &userValue : allUsers) {
-        QJsonObject user = userValue.toObject();
-        int userId = user["userId"].toInt();
-        int role = user["role"].toInt();
-        QString status = user["status"].toString();
-        
-        // 只返回买家用户（role = 1）
-        if (role != 1) {
-            continue;
-        }
+    for (const QJsonValue &memberValue : customers.value("members").toArray()) {
+        QJsonObject member = memberValue.toObject();
+        member["role"] = 1;  // 买家
+        // 卖家不能看到会员余额，不返回balance字段
         
-        // 排除当前登录的卖家自己（如果当前卖家ID在users表中且role=1，也要排除）
-        if (userId == currentSellerId) {
-            continue;
-        }
+        // 保留向后兼容的membershipLevel字段（数字1-5），根据memberLevel映射
+        QString memberLevel = member["memberLevel"].toString();
+        int membershipLevel = 1;
+        if (memberLevel == "银卡会员") membershipLevel = 2;
+        else if (memberLevel == "金卡会员") membershipLevel = 3;
+        else if (memberLevel == "白金会员") membershipLevel = 4;
+        else if (memberLevel == "钻石会员") membershipLevel = 5;
+        member["membershipLevel"] = membershipLevel;
         
-        // 只返回状态为"正常"的用户（排除已删除的用户）
-        if (status.isEmpty() || status == "正常") {
-            QJsonObject member;
-            member["userId"] = userId;
-            member["username"] = user["username"];
-            member["email"] = user["email"];
-            // 卖家不能看到会员余额，不返回balance字段
-            member["registerDate"] = user["registerDate"];
-            member["role"] = 1;  // 买家
-            
-            // 使用member_level字段（字符串类型）
-            QString memberLevel = user["memberLevel"].toString();
-            // 确保memberLevel不为空，如果为空则设置为默认值
-            if (memberLevel.isEmpty() || memberLevel.isNull()) {
-                memberLevel = "普通会员";
-            }
-            member["memberLevel"] = memberLevel;
-            
-            // 保留向后兼容的membershipLevel字段（数字1-5）
-            if (user.contains("membershipLevel")) {
-                member["membershipLevel"] = user["membershipLevel"];
-            } else {
-                // 如果没有membershipLevel，根据memberLevel映射
-                int membershipLevel = 1;
-                if (memberLevel == "普通会员") membershipLevel = 1;
-                else if (memberLevel == "银卡会员") membershipLevel = 2;
-                else if (memberLevel == "金卡会员") membershipLevel = 3;
-                else if (memberLevel == "白金会员") membershipLevel = 4;
-                else if (memberLevel == "钻石会员") membershipLevel = 5;
-                member["membershipLevel"] = membershipLevel;
-            }
-            
-            members.append(member);
-        }
+        members.append(member);
     }
     
+    const int total = customers.value("total").toInt();
     resp["success"] = true;
     resp["members"] = members;
-    resp["total"] = members.size();
+    resp["total"] = total;
+    setPageInfo(resp, offset, limit, members.size(), total);
 #else
     // 使用内存存储（原有逻辑）
     QMutexLocker locker(&g_sellerMembersMutex);
@@ -1467,6 +1974,99 @@ QJsonObject TcpFileTask::handleSellerDashboardStats(const QJsonObject &request)
     return resp;
 }
 
+// 仪表盘快照：统计卡片、订单状态计数、今日数据和近7天销售曲线一次返回，并附带etag（内容摘要）
+// 客户端带上上次的etag请求，内容没变时只回 notModified，定时刷新只有一个很小的响应帧
+QJsonObject TcpFileTask::handleSellerDashboardSnapshot(const QJsonObject &request)
+{
+    QJsonObject resp;
+
+#if USE_DATABASE
+    if (!Database::getInstance().isConnected()) {
+        resp["success"] = false;
+        resp["message"] = "数据库未连接";
+        return resp;
+    }
+
+    // 获取当前登录的卖家ID
+    int sellerId = -1;
+    if (m_currentSellerId > 0 && m_currentUserType == "seller") {
+        sellerId = m_currentSellerId;
+    } else {
+        QString sellerIdStr = request.value("sellerId").toString();
+        if (!sellerIdStr.isEmpty()) {
+            bool ok;
+            sellerId = sellerIdStr.toInt(&ok);
+            if (!ok || sellerId <= 0) {
+                resp["success"] = false;
+                resp["message"] = "无效的卖家ID";
+                return resp;
+            }
+        }
+    }
+
+    if (sellerId <= 0) {
+        resp["success"] = false;
+        resp["message"] = "卖家ID不能为空";
+        return resp;
+    }
+
+    Database &db = Database::getInstance();
+    QDate today = QDate::currentDate();
+    QDate chartStart = today.addDays(-6);  // 含今天共7天
+    QString todayStr = today.toString("yyyy-MM-dd");
+
+    // etag取自廉价的版本键（加上日期，跨天后今日数据和图表窗口都会变）；
+    // 客户端每5秒轮询，版本未变时直接返回notModified，不再跑全量统计和销售报表
+    QString version = db.getSellerDashboardVersion(sellerId);
+    QString etag;
+    if (!version.isEmpty()) {
+        QByteArray digest = QCryptographicHash::hash((todayStr + "|" + version).toUtf8(),
+                                                     QCryptographicHash::Md5);
+        etag = QString::fromLatin1(digest.toHex().left(16));
+        if (request.value("etag").toString() == etag) {
+            resp["success"] = true;
+            resp["etag"] = etag;
+            resp["notModified"] = true;
+            return resp;
+        }
+    }
+
+    QJsonObject summary = db.getSellerOrderSummary(sellerId, todayStr);
+
+    // 近7天销售额，没有订单的日期补0
+    QMap<QString, double> amountByDate;
+    QJsonArray report = db.getSellerSalesReport(sellerId, chartStart.toString("yyyy-MM-dd"), todayStr);
+    for (const QJsonValue &value : report) {
+        QJsonObject item = value.toObject();
+        amountByDate[item["date"].toString()] += item["amount"].toDouble();
+    }
+    QJsonArray chart;
+    for (int i = 0; i < 7; ++i) {
+        QString date = chartStart.addDays(i).toString("yyyy-MM-dd");
+        QJsonObject point;
+        point["date"] = date;
+        point["amount"] = amountByDate.value(date, 0.0);
+        chart.append(point);
+    }
+
+    QJsonObject snapshot;
+    snapshot["stats"] = db.getSellerDashboardStats(sellerId);
+    snapshot["statusCounts"] = summary["statusCounts"];
+    snapshot["todayOrders"] = summary["todayOrders"];
+    snapshot["todayRevenue"] = summary["todayRevenue"];
+    snapshot["chart"] = chart;
+
+    resp["success"] = true;
+    resp["etag"] = etag;  // 版本键查询失败时为空，客户端下次仍会拿到完整快照
+    resp["notModified"] = false;
+    resp["snapshot"] = snapshot;
+#else
+    resp["success"] = false;
+    resp["message"] = "仪表盘快照需要数据库支持";
+#endif
+    return resp;
+}
+
 QJsonObject TcpFileTask::handleSellerGetSystemSettings(const QJsonObject &request)
 {
     Q_UNUSED(request);
@@ -1700,17 +2300,141 @@ void TcpFileTask::sendJsonResponse(QTcpSocket &socket, const QJsonObject &respon
         return;
     }
 
-    QJsonDocument doc(response);
-    QByteArray payload = doc.toJson(QJsonDocument::Compact);
-
-    QByteArray frame;
-    QDataStream ds(&frame, QIODevice::WriteOnly);
-    ds.setByteOrder(QDataStream::BigEndian);
-    ds << (quint32)payload.size();
-    frame.append(payload);
-
+    QByteArray frame = encodeFrame(response);
     socket.write(frame);
     socket.flush();
+    ServerMetrics::getInstance().addBytesOut(frame.size());
+}
+
+// 校验请求携带的token：与缓存的会话相同且没有新的失效广播时直接使用缓存（不加锁、不查数据库）
+bool TcpFileTask::refreshSession(const QString &token, QJsonObject *error)
+{
+    if (token.isEmpty()) {
+        return true;
+    }
+    
+    SessionManager& sessions = SessionManager::getInstance();
+    const quint64 generation = sessions.generation();
+    if (token == m_session.token && generation == m_sessionGeneration) {
+        return true;
+    }
+    
+    Session session;
+    if (!sessions.resolve(token, &session)) {
+        m_session = Session();
+        (*error)["success"] = false;
+        (*error)["message"] = "登录已过期，请重新登录";
+        (*error)["sessionExpired"] = true;
+        return false;
+    }
+    
+    m_session = session;
+    m_sessionGeneration = generation;
+    m_currentUserType = session.userType;
+    m_currentSellerId = session.userType == "seller" ? session.principalId : -1;
+    return true;
+}
+
+// 登录成功后创建会话：身份、角色、状态和会员等级取自登录结果，token随响应返回
+void TcpFileTask::attachSession(QJsonObject &loginResponse)
+{
+    Session session;
+    session.principalId = loginResponse.value("userId").toInt();
+    session.userType = loginResponse.value("userType").toString();
+    session.username = loginResponse.value("username").toString();
+    session.role = loginResponse.value("role").toInt(session.userType == "seller" ? 2 : 1);
+    session.status = loginResponse.value("status").toString("正常");
+    session.memberLevel = loginResponse.value("memberLevel").toString("普通会员");
+    session.memberDiscount = loginResponse.contains("memberDiscount")
+                             ? loginResponse.value("memberDiscount").toDouble()
+                             : Database::getInstance().getMemberDiscount(session.memberLevel);
+    
+    session.token = SessionManager::getInstance().createSession(session);
+    m_session = session;
+    m_sessionGeneration = SessionManager::getInstance().generation();
+    loginResponse["token"] = session.token;
+}
+
+static bool isChatAction(const QString &action)
+{
+    return action == "sendChatMessage" || action == "getChatHistory"
+           || action == "getConversations" || action == "markConversationRead";
+}
+
+// 请求鉴权：admin开头的操作和以管理员身份收发聊天消息需要管理员会话（不带token也不放行）；
+// 已有会话时，请求中的本人字段必须是会话本人：买家的userId、商家端操作的sellerId、聊天的发送方/查询方。
+// 管理员会话不受限制；商家端操作中的userId是会员ID，不做比较
+bool TcpFileTask::authorizeRequest(const QString &action, const QJsonObject &request, QJsonObject *error)
+{
+    const bool chat = isChatAction(action);
+    const QString typeKey = action == "sendChatMessage" ? "senderType" : "userType";
+    const QString idKey = action == "sendChatMessage" ? "senderId" : "userId";
+    const QString chatType = chat ? request.value(typeKey).toString() : QString();
+    
+    bool allowed = true;
+    if (action.startsWith("admin") || chatType == "admin") {
+        allowed = m_session.isValid() && m_session.userType == "admin";
+    } else if (!m_session.isValid() || m_session.userType == "admin") {
+        allowed = true;  // 未携带token的旧客户端按原逻辑处理
+    } else if (chat) {
+        allowed = m_session.isPrincipal(chatType, request.value(idKey).toVariant().toInt());
+    } else if (action.startsWith("seller")) {
+        allowed = m_session.userType == "seller"
+                  && (!request.contains("sellerId")
+                      || request.value("sellerId").toVariant().toInt() == m_session.principalId);
+    } else if (request.contains("userId")) {
+        allowed = m_session.isPrincipal("buyer", request.value("userId").toVariant().toInt());
+    }
+    
+    if (!allowed) {
+        qWarning() << "❌ 拒绝越权请求:" << action << "会话:" << m_session.userType << m_session.principalId;
+        (*error)["success"] = false;
+        (*error)["message"] = action.startsWith("admin") || chatType == "admin"
+                              ? "需要管理员登录" : "无权操作其他账号的数据";
+        (*error)["forbidden"] = true;
+    }
+    return allowed;
+}
+
+// 是否被封禁：当前连接的会话就是该账号时直接读会话缓存，否则查询单个账号
+bool TcpFileTask::isPrincipalBanned(const QString &userType, int principalId)
+{
+    if (m_session.isPrincipal(userType, principalId)) {
+        return m_session.isBanned();
+    }
+    
+#if USE_DATABASE
+    if (Database::getInstance().isConnected()) {
+        QJsonObject principal = userType == "seller"
+                                ? Database::getInstance().getSellerById(principalId)
+                                : Database::getInstance().getUserById(principalId);
+        return principal.value("status").toString() == "封禁";
+    }
+#endif
+    return false;
+}
+
+// 退出登录：注销token
+QJsonObject TcpFileTask::handleLogout(const QJsonObject &request)
+{
+    QString token = request.value("token").toString();
+    if (!token.isEmpty()) {
+        SessionManager::getInstance().removeSession(token);
+    }
+    if (token == m_session.token) {
+        // 退出登录时立即写回该买家的购物车
+        if (m_session.userType == "buyer") {
+            CartService::getInstance().flushUser(m_session.principalId);
+        }
+        m_session = Session();
+        m_currentSellerId = -1;
+        m_currentUserType = "";
+    }
+    
+    QJsonObject response;
+    response["success"] = true;
+    response["message"] = "已退出登录";
+    return response;
 }
 
 // 处理登录请求
@@ -1804,6 +2528,7 @@ QJsonObject TcpFileTask::handleLogin(const QJsonObject &request)
         } else {
             m_currentSellerId = -1;
         }
+        attachSession(response);
     }
     
     qDebug() << "========================================";
@@ -1903,6 +2628,8 @@ QJsonObject TcpFileTask::handleLogin(const QJsonObject &request)
         // 登录失败，清除保存的用户信息
         m_currentSellerId = -1;
         m_currentUserType = "";
+    } else {
+        attachSession(response);
     }
     
     qDebug() << "========================================";
@@ -2752,22 +3479,14 @@ QJsonObject TcpFileTask::handleAddToCart(const QJsonObject &request)
     }
     
     // 检查用户是否被封禁
-    QJsonArray usersArray = Database::getInstance().getAllUsers();
-    for (const QJsonValue &userVal : usersArray) {
-        QJsonObject user = userVal.toObject();
-        if (user.value("userId").toInt() == userId.toInt()) {
-            QString userStatus = user.value("status").toString();
-            if (userStatus == "封禁") {
-                response["success"] = false;
-                response["message"] = "您的账户已被封禁，无法购买图书";
-                return response;
-            }
-            break;
-        }
+    if (isPrincipalBanned("buyer", userId.toInt())) {
+        response["success"] = false;
+        response["message"] = "您的账户已被封禁，无法购买图书";
+        return response;
     }
     
-    // 将书籍添加到购物车（保存到数据库cart表）
-    if (Database::getInstance().addToCart(userId.toInt(), bookId, quantity)) {
+    // 将书籍添加到购物车（内存购物车，后台批量写回cart表）
+    if (CartService::getInstance().addItem(userId.toInt(), bookId, quantity)) {
         response["success"] = true;
         response["message"] = "已添加到购物车";
     } else {
@@ -2804,8 +3523,13 @@ QJsonObject TcpFileTask::handleGetCart(const QJsonObject &request)
         return response;
     }
     
-    // 从数据库cart表中查询该用户的购物车（每个用户只能看到自己的购物车）
-    QJsonArray cartItems = Database::getInstance().getCart(userId.toInt());
+    // 从内存购物车读取（首次访问时从cart表加载；每个用户只能看到自己的购物车）
+    QJsonArray cartItems;
+    if (!CartService::getInstance().items(userId.toInt(), &cartItems)) {
+        response["success"] = false;
+        response["message"] = "获取购物车失败，请重试";
+        return response;
+    }
     
     // 计算总价
     double total = 0.0;
@@ -2859,8 +3583,8 @@ QJsonObject TcpFileTask::handleUpdateCartQuantity(const QJsonObject &request)
         return response;
     }
     
-    // 更新数据库cart表中的数量
-    if (Database::getInstance().updateCartQuantity(userId.toInt(), bookId, quantity)) {
+    // 更新内存购物车中的数量（后台批量写回cart表）
+    if (CartService::getInstance().updateQuantity(userId.toInt(), bookId, quantity)) {
         response["success"] = true;
         response["message"] = "数量更新成功";
     } else {
@@ -2897,8 +3621,8 @@ QJsonObject TcpFileTask::handleRemoveFromCart(const QJsonObject &request)
         return response;
     }
     
-    // 从数据库cart表中删除对应的记录
-    if (Database::getInstance().removeFromCart(userId.toInt(), bookId)) {
+    // 从内存购物车中移除（后台批量写回cart表）
+    if (CartService::getInstance().removeItem(userId.toInt(), bookId)) {
         response["success"] = true;
         response["message"] = "已从购物车移除";
     } else {
@@ -2937,6 +3661,7 @@ QJsonObject TcpFileTask::handleAddFavorite(const QJsonObject &request)
     
     // 将书籍添加到收藏（保存到数据库favorites表）
     if (Database::getInstance().addFavorite(userId.toInt(), bookId)) {
+        RecommendEngine::getInstance().recordInteraction(userId.toInt(), QStringList{bookId});
         response["success"] = true;
         response["message"] = "已添加到收藏";
     } else {
@@ -2990,6 +3715,36 @@ QJsonObject TcpFileTask::handleRemoveFavorite(const QJsonObject &request)
     return response;
 }
 
+// 处理个性化推荐请求：按用户最近购买/收藏的图书合并相似图书，不足时用热门榜补齐
+// 未登录（userId为空）时只返回热门榜
+QJsonObject TcpFileTask::handleGetRecommendations(const QJsonObject &request)
+{
+    int userId = request.value("userId").toVariant().toInt();
+    int k = request.value("k").toInt(10);
+
+    QJsonObject response;
+    
+#if USE_DATABASE
+    if (!Database::getInstance().isConnected()) {
+        response["success"] = false;
+        response["message"] = "数据库未连接";
+        return response;
+    }
+    
+    QJsonArray books = RecommendEngine::getInstance().recommend(userId, k);
+    response["success"] = true;
+    response["books"] = books;
+    response["count"] = books.size();
+#else
+    Q_UNUSED(userId);
+    Q_UNUSED(k);
+    response["success"] = false;
+    response["message"] = "推荐功能需要数据库支持";
+#endif
+    
+    return response;
+}
+
 // 处理创建订单请求
 QJsonObject TcpFileTask::handleCreateOrder(const QJsonObject &request)
 {
@@ -3016,23 +3771,15 @@ QJsonObject TcpFileTask::handleCreateOrder(const QJsonObject &request)
         // 检查用户是否被封禁
 #if USE_DATABASE
         if (Database::getInstance().isConnected()) {
-            QJsonArray usersArray = Database::getInstance().getAllUsers();
-            for (const QJsonValue &userVal : usersArray) {
-                QJsonObject user = userVal.toObject();
-                if (user.value("userId").toInt() == userId.toInt()) {
-                    QString userStatus = user.value("status").toString();
-                    if (userStatus == "封禁") {
-                        response["success"] = false;
-                        response["message"] = "您的账户已被封禁，无法购买图书";
-                        return response;
-                    }
-                    break;
-                }
+            if (isPrincipalBanned("buyer", userId.toInt())) {
+                response["success"] = false;
+                response["message"] = "您的账户已被封禁，无法购买图书";
+                return response;
             }
         }
 #endif
-        // 生成订单ID
-        QString orderId = QString("ORDER_%1").arg(QDateTime::currentMSecsSinceEpoch());
+        // 生成订单ID：同一毫秒内并发下单也不会重复
+        QString orderId = IdGenerator::getInstance().nextId("ORDER_");
         
         // 计算总金额，并确保订单项包含merchantId
         double totalAmount = 0.0;
@@ -3045,18 +3792,23 @@ QJsonObject TcpFileTask::handleCreateOrder(const QJsonObject &request)
         
 #if USE_DATABASE
         if (Database::getInstance().isConnected()) {
-            // 直接通过getUserById获取用户信息以获取会员等级（更高效且准确）
-            QJsonObject user = Database::getInstance().getUserById(userId.toInt());
-            if (!user.isEmpty()) {
-                memberLevel = user.value("memberLevel").toString();
-                if (memberLevel.isEmpty()) {
-                    memberLevel = "普通会员";
-                }
-                memberDiscount = user.value("memberDiscount").toDouble();
-                if (memberDiscount <= 0 || memberDiscount > 1.0) {
-                    memberDiscount = 1.0;  // 确保折扣率在有效范围内
+            // 会员等级优先取自会话缓存（充值升级时由失效广播同步），没有会话时查询单个用户
+            if (m_session.isPrincipal("buyer", userId.toInt())) {
+                memberLevel = m_session.memberLevel;
+                memberDiscount = m_session.memberDiscount;
+            } else {
+                QJsonObject user = Database::getInstance().getUserById(userId.toInt());
+                if (!user.isEmpty()) {
+                    memberLevel = user.value("memberLevel").toString();
+                    memberDiscount = user.value("memberDiscount").toDouble();
                 }
             }
+            if (memberLevel.isEmpty()) {
+                memberLevel = "普通会员";
+            }
+            if (memberDiscount <= 0 || memberDiscount > 1.0) {
+                memberDiscount = 1.0;  // 确保折扣率在有效范围内
+            }
             
             // 从数据库获取图书信息，补充merchantId
             for (const QJsonValue &itemVal : items) {
@@ -3100,30 +3852,17 @@ QJsonObject TcpFileTask::handleCreateOrder(const QJsonObject &request)
         totalAmount = originalAmount * memberDiscount;
         
         // 处理优惠券使用
-        QString useCouponType = request.value("useCoupon").toString();  // "30" 或 "50" 或 ""
+        QString useCouponType = request.value("useCoupon").toString();  // 优惠券面额，如"30"、"50"，空表示不使用
         double couponDiscount = 0.0;
-        if (useCouponType == "30") {
-            // 检查用户是否有30元优惠券
-            int coupon30Count = Database::getInstance().getCoupon30Count(userId.toInt());
-            if (coupon30Count > 0) {
-                couponDiscount = 30.0;
-                // 使用优惠券（在支付时扣除）
-            } else {
-                response["success"] = false;
-                response["message"] = "您没有30元优惠券";
-                return response;
-            }
-        } else if (useCouponType == "50") {
-            // 检查用户是否有50元优惠券
-            int coupon50Count = Database::getInstance().getCoupon50Count(userId.toInt());
-            if (coupon50Count > 0) {
-                couponDiscount = 50.0;
-                // 使用优惠券（在支付时扣除）
-            } else {
+        if (!useCouponType.isEmpty()) {
+            // 检查钱包中是否有该面额的优惠券（在支付时扣除）
+            double couponValue = useCouponType.toDouble();
+            if (couponValue <= 0 || Database::getInstance().couponBalance(userId.toInt(), couponValue) <= 0) {
                 response["success"] = false;
-                response["message"] = "您没有50元优惠券";
+                response["message"] = QString("您没有%1元优惠券").arg(useCouponType);
                 return response;
             }
+            couponDiscount = couponValue;
         }
         
         // 应用优惠券折扣
@@ -3173,6 +3912,16 @@ QJsonObject TcpFileTask::handleCreateOrder(const QJsonObject &request)
             if (!savedOrderId.isEmpty() && savedOrderId == orderId) {
                 qDebug() << "✓ 订单已成功保存到数据库:" << orderId << "用户:" << userId << "金额:" << totalAmount;
                 
+                // 结算时立即写回购物车，不等后台写回周期
+                CartService::getInstance().flushUser(userIdInt);
+                
+                // 记入用户最近行为，推荐立即生效
+                QStringList orderedBookIds;
+                for (const QJsonValue &itemVal : enrichedItems) {
+                    orderedBookIds.append(itemVal.toObject()["bookId"].toString());
+                }
+                RecommendEngine::getInstance().recordInteraction(userIdInt, orderedBookIds);
+                
                 // 同时添加到全局订单列表（用于向后兼容）
                 QMutexLocker locker(&g_sellerOrdersMutex);
                 g_sellerOrders.append(order);
@@ -3301,18 +4050,10 @@ QJsonObject TcpFileTask::handlePayOrder(const QJsonObject &request)
         QJsonObject order = Database::getInstance().getOrder(orderId);
         if (!order.isEmpty() && order.contains("userId")) {
             int userId = order.value("userId").toInt();
-            QJsonArray usersArray = Database::getInstance().getAllUsers();
-            for (const QJsonValue &userVal : usersArray) {
-                QJsonObject user = userVal.toObject();
-                if (user.value("userId").toInt() == userId) {
-                    QString userStatus = user.value("status").toString();
-                    if (userStatus == "封禁") {
-                        response["success"] = false;
-                        response["message"] = "您的账户已被封禁，无法支付订单";
-                        return response;
-                    }
-                    break;
-                }
+            if (isPrincipalBanned("buyer", userId)) {
+                response["success"] = false;
+                response["message"] = "您的账户已被封禁，无法支付订单";
+                return response;
             }
         }
     }
@@ -3361,26 +4102,15 @@ QJsonObject TcpFileTask::handlePayOrder(const QJsonObject &request)
         
         // 处理优惠券使用（如果支付时选择了优惠券）
         double couponDiscount = 0.0;
-        if (useCoupon == "30") {
-            // 检查用户是否有30元优惠券
-            int coupon30Count = Database::getInstance().getCoupon30Count(userId);
-            if (coupon30Count > 0) {
-                couponDiscount = 30.0;
-            } else {
+        if (!useCoupon.isEmpty()) {
+            // 检查钱包中是否有该面额的优惠券（只读一行汇总）
+            double couponValue = useCoupon.toDouble();
+            if (couponValue <= 0 || Database::getInstance().couponBalance(userId, couponValue) <= 0) {
                 response["success"] = false;
-                response["message"] = "您没有30元优惠券";
-                return response;
-            }
-        } else if (useCoupon == "50") {
-            // 检查用户是否有50元优惠券
-            int coupon50Count = Database::getInstance().getCoupon50Count(userId);
-            if (coupon50Count > 0) {
-                couponDiscount = 50.0;
-            } else {
-                response["success"] = false;
-                response["message"] = "您没有50元优惠券";
+                response["message"] = QString("您没有%1元优惠券").arg(useCoupon);
                 return response;
             }
+            couponDiscount = couponValue;
         }
         
         // 应用优惠券折扣
@@ -3461,38 +4191,23 @@ QJsonObject TcpFileTask::handlePayOrder(const QJsonObject &request)
             }
             
             // 如果支付时使用了优惠券，先标记优惠券为已使用（在扣除余额之前）
+            // 钱包扣减和优惠券明细在同一事务中更新，张数不足时整体失败
             bool couponUsed = false;
-            if (useCoupon == "30") {
-                if (!Database::getInstance().useCoupon30(userId, 1, orderId)) {
-                    qWarning() << "使用30元优惠券失败，用户ID:" << userId << "订单ID:" << orderId;
+            if (couponDiscount > 0) {
+                if (!Database::getInstance().redeemCoupon(userId, couponDiscount, orderId)) {
+                    qWarning() << "使用优惠券失败，用户ID:" << userId << "面额:" << couponDiscount << "订单ID:" << orderId;
                     response["success"] = false;
-                    response["message"] = "使用30元优惠券失败，请检查优惠券数量";
+                    response["message"] = QString("使用%1元优惠券失败，请检查优惠券数量").arg(useCoupon);
                     return response;
-                } else {
-                    couponUsed = true;
-                    qDebug() << "30元优惠券使用成功，用户ID:" << userId << "订单ID:" << orderId;
-                }
-            } else if (useCoupon == "50") {
-                if (!Database::getInstance().useCoupon50(userId, 1, orderId)) {
-                    qWarning() << "使用50元优惠券失败，用户ID:" << userId << "订单ID:" << orderId;
-                    response["success"] = false;
-                    response["message"] = "使用50元优惠券失败，请检查优惠券数量";
-                    return response;
-                } else {
-                    couponUsed = true;
-                    qDebug() << "50元优惠券使用成功，用户ID:" << userId << "订单ID:" << orderId;
                 }
+                couponUsed = true;
             }
             
             // 扣除余额（在优惠券使用成功后）
             if (!Database::getInstance().deductUserBalance(userId, totalAmount)) {
                 // 如果扣除余额失败，需要回滚优惠券使用
                 if (couponUsed) {
-                    if (useCoupon == "30") {
-                        Database::getInstance().rollbackCoupon30(userId, orderId);
-                    } else if (useCoupon == "50") {
-                        Database::getInstance().rollbackCoupon50(userId, orderId);
-                    }
+                    Database::getInstance().rollbackCoupon(userId, couponDiscount, orderId);
                 }
                 response["success"] = false;
                 response["message"] = "扣除余额失败";
@@ -3715,66 +4430,8 @@ QJsonObject TcpFileTask::handleParticipateLottery(const QJsonObject &request)
     
 #if USE_DATABASE
     if (Database::getInstance().isConnected()) {
-        // 检查用户是否可以参与抽奖（累计满3积分）
-        if (!Database::getInstance().canParticipateLottery(userId)) {
-            int currentPoints = Database::getInstance().getUserPoints(userId);
-            response["success"] = false;
-            response["message"] = QString("积分不足，无法参与抽奖。当前积分：%1，需要3积分才能参与抽奖").arg(currentPoints);
-            return response;
-        }
-        
-        // 抽奖逻辑：随机生成奖品（等概率）
-        // 奖品列表：30元优惠券、50元优惠券、谢谢参与
-        QStringList prizes = {"30元优惠券", "50元优惠券", "谢谢参与"};
-        
-        // 等概率随机选择奖品（每个奖品1/3概率）
-        qsrand(QTime::currentTime().msec());
-        int randomIndex = qrand() % prizes.size();
-        QString prize = prizes[randomIndex];
-        
-        // 扣除3积分（无论抽中什么都要扣除）
-        int currentPoints = Database::getInstance().getUserPoints(userId);
-        if (currentPoints >= 3) {
-            // 使用addPoints添加负数来扣除积分
-            if (!Database::getInstance().addPoints(userId, -3)) {
-                response["success"] = false;
-                response["message"] = "扣除积分失败";
-                return response;
-            }
-        }
-        
-        // 根据抽中的奖品类型进行处理
-        if (prize == "30元优惠券") {
-            // 添加30元优惠券到用户账户（直接更新users表的coupon_30字段）
-            if (!Database::getInstance().addCoupon30(userId, 1)) {
-                qWarning() << "添加30元优惠券失败";
-                response["success"] = false;
-                response["message"] = "添加优惠券失败";
-                return response;
-            }
-        } else if (prize == "50元优惠券") {
-            // 添加50元优惠券到用户账户（直接更新users表的coupon_50字段）
-            if (!Database::getInstance().addCoupon50(userId, 1)) {
-                qWarning() << "添加50元优惠券失败";
-                response["success"] = false;
-                response["message"] = "添加优惠券失败";
-                return response;
-            }
-        }
-        // "谢谢参与"不需要处理
-        
-        // 获取更新后的优惠券数量
-        int coupon30 = Database::getInstance().getCoupon30Count(userId);
-        int coupon50 = Database::getInstance().getCoupon50Count(userId);
-        
-        response["success"] = true;
-        response["message"] = "抽奖成功";
-        response["prize"] = prize;
-        response["remainingPoints"] = Database::getInstance().getUserPoints(userId);
-        response["coupon30"] = coupon30;
-        response["coupon50"] = coupon50;
-        
-        qDebug() << "用户ID:" << userId << "参与抽奖，获得奖品:" << prize << "剩余积分:" << response["remainingPoints"].toInt();
+        // 抽奖、扣积分、发券和读回结果在LotteryService中一次完成
+        response = LotteryService::getInstance().draw(userId);
     } else {
         response["success"] = false;
         response["message"] = "数据库未连接";
@@ -3957,21 +4614,28 @@ QJsonObject TcpFileTask::handleGetChatHistory(const QJsonObject &request)
         
         // 如果是管理员，且指定了otherUserId，则获取与特定用户的聊天记录
         // 否则获取所有聊天记录（用于管理员查看所有消息）
+        // limit > 0 时按消息ID分页：beforeId为上一页最早一条消息的ID，不传表示从最新消息开始
+        const int beforeId = request.value("beforeId").toVariant().toInt();
+        const int limit = request.value("limit").toInt(0);
         if (userType == "admin") {
             if (otherUserId > 0 && !otherUserType.isEmpty()) {
                 // 管理员查看与特定用户的聊天记录
-                messages = Database::getInstance().getChatHistory(userId, userType, otherUserId, otherUserType);
+                messages = Database::getInstance().getChatHistory(userId, userType, otherUserId, otherUserType, beforeId, limit);
             } else {
                 // 管理员查看所有聊天记录
                 messages = Database::getInstance().getAllChatMessagesForAdmin();
             }
         } else {
             // 普通用户获取聊天记录
-            messages = Database::getInstance().getChatHistory(userId, userType, otherUserId, otherUserType);
+            messages = Database::getInstance().getChatHistory(userId, userType, otherUserId, otherUserType, beforeId, limit);
         }
         
         response["success"] = true;
         response["messages"] = messages;
+        if (limit > 0) {
+            response["hasMore"] = messages.size() >= limit;
+            response["nextBeforeId"] = messages.isEmpty() ? 0 : messages.first().toObject().value("messageId").toInt();
+        }
         response["message"] = "获取聊天历史成功";
         qDebug() << "获取聊天历史成功，用户ID:" << userId << "类型:" << userType << "消息数量:" << messages.size();
     } else {
@@ -3987,6 +4651,82 @@ QJsonObject TcpFileTask::handleGetChatHistory(const QJsonObject &request)
     return response;
 }
 
+// 解析聊天参与方ID：管理员ID是字符串格式（如"ADMIN001"），统一使用固定数字ID 999999
+static int parseChatUserId(const QJsonValue &value, const QString &userType)
+{
+    if (userType == "admin") {
+        return 999999;
+    }
+    return value.toVariant().toInt();
+}
+
+// 处理获取聊天会话列表请求：从conversations表按最近消息倒序分页
+QJsonObject TcpFileTask::handleGetConversations(const QJsonObject &request)
+{
+    QJsonObject response;
+    QString userType = request.value("userType").toString();
+    int userId = parseChatUserId(request.value("userId"), userType);
+    
+    if (userType.isEmpty() || userId <= 0) {
+        response["success"] = false;
+        response["message"] = "用户ID无效";
+        return response;
+    }
+    
+#if USE_DATABASE
+    if (Database::getInstance().isConnected()) {
+        const int offset = qMax(0, request.value("offset").toInt(0));
+        const int limit = qBound(1, request.value("limit").toInt(50), 200);
+        QJsonObject page = Database::getInstance().getConversations(
+            userId, userType, request.value("peerType").toString(), offset, limit);
+        response = page;
+        response["success"] = true;
+        response["message"] = "获取会话列表成功";
+    } else {
+        response["success"] = false;
+        response["message"] = "数据库未连接";
+    }
+#else
+    response["success"] = false;
+    response["message"] = "未启用数据库";
+    response["conversations"] = QJsonArray();
+#endif
+    
+    return response;
+}
+
+// 处理会话已读请求：打开与某人的聊天时清零本人的未读数
+QJsonObject TcpFileTask::handleMarkConversationRead(const QJsonObject &request)
+{
+    QJsonObject response;
+    QString userType = request.value("userType").toString();
+    int userId = parseChatUserId(request.value("userId"), userType);
+    QString peerType = request.value("peerType").toString();
+    int peerId = parseChatUserId(request.value("peerId"), peerType);
+    
+    if (userType.isEmpty() || userId <= 0 || peerType.isEmpty() || peerId <= 0) {
+        response["success"] = false;
+        response["message"] = "会话参数无效";
+        return response;
+    }
+    
+#if USE_DATABASE
+    if (Database::getInstance().isConnected()) {
+        bool success = Database::getInstance().markConversationRead(userId, userType, peerId, peerType);
+        response["success"] = success;
+        response["message"] = success ? "已标记为已读" : "标记已读失败";
+    } else {
+        response["success"] = false;
+        response["message"] = "数据库未连接";
+    }
+#else
+    response["success"] = false;
+    response["message"] = "未启用数据库";
+#endif
+    
+    return response;
+}
+
 // 处理添加评论请求
 QJsonObject TcpFileTask::handleAddReview(const QJsonObject &request)
 {
@@ -4448,7 +5188,7 @@ QJsonObject TcpFileTask::handleShipOrder(const QJsonObject &request)
         }
         
         // 更新数据库中的订单状态
-        QString finalTrackingNumber = trackingNumber.isEmpty() ? QString("SF%1").arg(QDateTime::currentMSecsSinceEpoch() % 1000000) : trackingNumber;
+        QString finalTrackingNumber = trackingNumber.isEmpty() ? IdGenerator::getInstance().nextId("SF") : trackingNumber;
         if (Database::getInstance().updateOrderStatus(orderId, "已发货", "", "", finalTrackingNumber)) {
             // 同时更新内存中的订单（用于向后兼容）
             QMutexLocker locker(&g_sellerOrdersMutex);
@@ -4495,7 +5235,7 @@ QJsonObject TcpFileTask::handleShipOrder(const QJsonObject &request)
             }
             
             // 更新订单状态为已发货
-            QString finalTrackingNumber = trackingNumber.isEmpty() ? QString("SF%1").arg(QDateTime::currentMSecsSinceEpoch() % 1000000) : trackingNumber;
+            QString finalTrackingNumber = trackingNumber.isEmpty() ? IdGenerator::getInstance().nextId("SF") : trackingNumber;
             order["status"] = "已发货";
             order["shipTime"] = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
             order["trackingNumber"] = finalTrackingNumber;
@@ -4749,6 +5489,9 @@ QJsonObject TcpFileTask::handleAdminLogin(const QJsonObject &request)
         response["message"] = "管理员登录成功";
         response["adminId"] = "ADMIN001";
         response["username"] = username;
+        response["userType"] = "admin";
+        response["userId"] = 0;
+        attachSession(response);
         qDebug() << "管理员登录成功：" << username;
     } else {
         response["success"] = false;
@@ -4769,6 +5512,18 @@ QJsonObject TcpFileTask::handleAdminGetAllUsers(const QJsonObject &request)
     response["message"] = "获取用户列表成功";
     
 #if USE_DATABASE
+    // 带limit时在查询中分页，直接返回这一页（不刷新内存中的用户列表）
+    const int limit = request.value("limit").toInt(0);
+    if (limit > 0 && Database::getInstance().isConnected()) {
+        const int offset = qMax(0, request.value("offset").toInt(0));
+        int total = 0;
+        QJsonArray usersArray = Database::getInstance().getAllUsers(offset, limit, &total);
+        response["users"] = usersArray;
+        response["total"] = total;
+        setPageInfo(response, offset, limit, usersArray.size(), total);
+        return response;
+    }
+    
     // 从数据库加载最新数据
     if (Database::getInstance().isConnected()) {
         g_adminUsers.clear();
@@ -4981,14 +5736,15 @@ QJsonObject TcpFileTask::handleAdminBanSeller(const QJsonObject &request)
 // 获取所有图书（全局）
 QJsonObject TcpFileTask::handleAdminGetAllBooks(const QJsonObject &request)
 {
-    Q_UNUSED(request);
-    
     QJsonObject response;
     
 #if USE_DATABASE
-    // 使用数据库获取所有图书
+    // 使用数据库获取图书，带limit时在查询中分页
     if (Database::getInstance().isConnected()) {
-        QJsonArray dbBooks = Database::getInstance().getAllBooks();
+        const int limit = request.value("limit").toInt(0);
+        const int offset = qMax(0, request.value("offset").toInt(0));
+        int total = 0;
+        QJsonArray dbBooks = Database::getInstance().getAllBooks(offset, limit, &total);
         QJsonArray booksArray;
         
         for (const QJsonValue &value : dbBooks) {
@@ -5021,7 +5777,8 @@ QJsonObject TcpFileTask::handleAdminGetAllBooks(const QJsonObject &request)
     response["success"] = true;
     response["message"] = "获取图书列表成功";
         response["books"] = booksArray;
-        response["total"] = booksArray.size();
+        response["total"] = total;
+        setPageInfo(response, offset, limit, booksArray.size(), total);
     } else {
         response["success"] = false;
         response["message"] = "数据库未连接";
@@ -5321,11 +6078,16 @@ QJsonObject TcpFileTask::handleAdminGetAllOrders(const QJsonObject &request)
 #if USE_DATABASE
     // 从数据库读取所有订单
     if (Database::getInstance().isConnected()) {
-        QJsonArray orders = Database::getInstance().getAllOrders();
+        // 带limit时在查询中分页
+        const int limit = request.value("limit").toInt(0);
+        const int offset = qMax(0, request.value("offset").toInt(0));
+        int total = 0;
+        QJsonArray orders = Database::getInstance().getAllOrders(offset, limit, &total);
         response["success"] = true;
         response["message"] = "获取订单列表成功";
         response["orders"] = orders;
-        response["total"] = orders.size();
+        response["total"] = total;
+        setPageInfo(response, offset, limit, orders.size(), total);
     } else {
         response["success"] = false;
         response["message"] = "数据库未连接";
@@ -5418,7 +6180,7 @@ QJsonObject TcpFileTask::handleAdminDeleteOrder(const QJsonObject &request)
 QJsonObject TcpFileTask::handleAdminGetSystemStats(const QJsonObject &request)
 {
 #if USE_DATABASE
-    // 使用数据库统计
+    // 数据库模式：读平台计数（内存中维护，定时按数据库校对），不扫表
     if (Database::getInstance().isConnected()) {
         QJsonObject stats = Database::getInstance().getSystemStats();
         QJsonObject response;
@@ -5463,8 +6225,16 @@ QJsonObject TcpFileTask::handleAdminGetRequestLogs(const QJsonObject &request)
     if (Database::getInstance().isConnected()) {
         int limit = request.value("limit").toInt(100);
         QString category = request.value("category").toString("");
+        QString action = request.value("logAction").toString("");
         
-        QJsonArray logs = Database::getInstance().getRequestLogs(limit, category);
+        // 先查在线的按天分表；不够limit条且请求includeArchive时继续查压缩归档
+        QJsonArray logs = Database::getInstance().getRequestLogs(limit, category, action);
+        if (logs.size() < limit && request.value("includeArchive").toBool()) {
+            const QJsonArray archived = RequestLogArchive::getInstance().search(limit - logs.size(), category, action);
+            for (const QJsonValue &log : archived) {
+                logs.append(log);
+            }
+        }
         
         response["success"] = true;
         response["message"] = "获取请求日志成功";
@@ -5481,6 +6251,17 @@ QJsonObject TcpFileTask::handleAdminGetRequestLogs(const QJsonObject &request)
 }
 
 // 管理员获取卖家认证信息
+// 获取服务器运行指标（按动作的请求数、错误数、延迟分位数，线程池和数据库锁排队情况）
+QJsonObject TcpFileTask::handleAdminGetServerMetrics(const QJsonObject &request)
+{
+    Q_UNUSED(request);
+    QJsonObject response;
+    response["success"] = true;
+    response["message"] = "获取服务器指标成功";
+    response["metrics"] = ServerMetrics::getInstance().snapshot();
+    return response;
+}
+
 QJsonObject TcpFileTask::handleAdminGetSellerCertification(const QJsonObject &request)
 {
     QString userId = request.value("userId").toString();
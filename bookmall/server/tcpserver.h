@@ -3,6 +3,9 @@
 
 #include <QTcpServer>
 #include <QTcpSocket>
+#include <QHostAddress>
+#include <QThread>
+#include <QList>
 #include <QFile>
 #include <QByteArray>
 #include <QDebug>
@@ -12,7 +15,9 @@
 #include <QDataStream>
 #include <QMutex>
 #include <QDateTime>
+#include <QVector>
 #include "threadpool.h"
+#include "sessionmanager.h"
 
 struct BookInfo {
     QString bookId;      // 图书ID
@@ -34,6 +39,12 @@ public:
     explicit TcpFileTask(qintptr socketDescriptor, QObject *parent = nullptr);
     // 任务执行函数：实现文件接收逻辑
     void run() override;
+    // 排队超时：不再处理该连接，回复繁忙后断开，客户端按retryAfterMs重试
+    void runExpired() override;
+
+    // 服务器退出前排空：各连接处理完已收到的请求后断开，不再等待新请求
+    static void setDraining(bool draining);
+    static bool isDraining();
 
 signals:
     // 新增信号：传递客户端IP、端口和接收的数据
@@ -47,10 +58,27 @@ private:
     quint16 m_clientPort;        // 客户端端口
     int m_currentSellerId;       // 当前登录的商家ID（-1表示未登录或非商家）
     QString m_currentUserType;   // 当前用户类型（"buyer"或"seller"）
+    Session m_session;           // 本连接缓存的会话副本（请求携带token时有效）
+    quint64 m_sessionGeneration; // 缓存会话时的失效广播版本
+    
+    // ===== 会话 =====
+    bool refreshSession(const QString& token, QJsonObject* error);  // 校验请求token，必要时刷新缓存的会话
+    void attachSession(QJsonObject& loginResponse);  // 登录成功后创建会话并在响应中返回token
+    bool isPrincipalBanned(const QString& userType, int principalId);  // 优先使用会话缓存判断是否封禁
+    bool authorizeRequest(const QString& action, const QJsonObject& request, QJsonObject* error);  // 请求身份须与会话一致
+    QJsonObject handleLogout(const QJsonObject &request);
     QList<BookInfo> getPresetBooks();
     
-    // 处理JSON格式的请求
-    QJsonObject processJsonRequest(const QJsonObject &request);
+    // 处理JSON格式的请求（记录运行指标后分发）
+    QJsonObject processJsonRequest(const QJsonObject &request, qint64* dbUs = nullptr);
+    // 按action分发请求
+    QJsonObject dispatchJsonRequest(const QJsonObject &request);
+    // 批量请求：一帧携带多个子请求，相邻的只读查询并行执行，响应按原顺序一帧返回
+    enum { MAX_BATCH_ITEMS = 32 };
+    class BatchItemTask;
+    void copyPrincipalFrom(const TcpFileTask &owner);  // 复制连接的身份和会话（批量子请求的独立上下文）
+    QJsonObject handleBatch(const QJsonObject &request);
+    void runBatchStage(const QVector<QJsonObject> &items, const QVector<int> &stage, QVector<QJsonObject> *results);
     // 发送JSON格式的响应（长度前缀协议）
     void sendJsonResponse(QTcpSocket &socket, const QJsonObject &response);
     // 处理登录请求
@@ -79,6 +107,8 @@ private:
     QJsonObject handleAddFavorite(const QJsonObject &request);
     // 处理从收藏移除请求
     QJsonObject handleRemoveFavorite(const QJsonObject &request);
+    // 处理个性化推荐请求
+    QJsonObject handleGetRecommendations(const QJsonObject &request);
     // 处理创建订单请求
     QJsonObject handleCreateOrder(const QJsonObject &request);
     // 处理获取订单列表请求
@@ -97,6 +127,10 @@ private:
     QJsonObject handleSendChatMessage(const QJsonObject &request);
     // 处理获取聊天历史请求
     QJsonObject handleGetChatHistory(const QJsonObject &request);
+    // 处理获取聊天会话列表请求（分页）
+    QJsonObject handleGetConversations(const QJsonObject &request);
+    // 处理会话已读请求
+    QJsonObject handleMarkConversationRead(const QJsonObject &request);
     // 处理添加评论请求
     QJsonObject handleAddReview(const QJsonObject &request);
     // 处理获取商品评论请求
@@ -127,6 +161,7 @@ private:
     QJsonObject handleSellerDeleteMember(const QJsonObject &request);
     QJsonObject handleSellerRechargeMember(const QJsonObject &request);
     QJsonObject handleSellerDashboardStats(const QJsonObject &request);
+    QJsonObject handleSellerDashboardSnapshot(const QJsonObject &request);
     QJsonObject handleSellerGetSystemSettings(const QJsonObject &request);
     QJsonObject handleSellerUpdateSystemSettings(const QJsonObject &request);
     QJsonObject handleSellerGetReportSales(const QJsonObject &request);
@@ -160,15 +195,26 @@ private:
     QJsonObject handleAdminRejectSellerCertification(const QJsonObject &request);
     QJsonObject handleAdminGetAllAppeals(const QJsonObject &request);  // 获取所有申诉
     QJsonObject handleAdminReviewAppeal(const QJsonObject &request);  // 审核申诉
+    QJsonObject handleAdminGetServerMetrics(const QJsonObject &request);  // 获取服务器运行指标
 };
 
 // TCP服务器类：监听并处理客户端的文件传输连接
+// 由TcpListenerGroup放到独立的接入线程中运行，接受连接后直接把套接字交给线程池
+class TcpListenerGroup;
+
 class TcpServer : public QTcpServer
 {
     Q_OBJECT
 public:
     explicit TcpServer(QObject *parent = nullptr);
 
+    // 设置监听参数（移入接入线程前调用）；reusePort为true时以SO_REUSEPORT打开监听套接字，允许多个监听者共用端口
+    void setListenParams(const QHostAddress &address, quint16 port, bool reusePort);
+    // 在所属线程中按监听参数开始监听
+    Q_INVOKABLE bool startListening();
+    // 连接任务的日志直接转发给监听组（启动接入线程前调用）；监听组比接入线程活得久，排空期间的日志不会丢失
+    void setLogSink(TcpListenerGroup *group) { m_logSink = group; }
+
 signals:
     void dataReceived(const QString& clientIp, quint16 clientPort, const QString& data);
     void logGenerated(const QString& log);
@@ -176,6 +222,55 @@ signals:
 protected:
     // 新客户端连接触发：创建任务并提交到线程池
     void incomingConnection(qintptr socketDescriptor) override;
+
+private:
+    QHostAddress m_listenAddress;
+    quint16 m_listenPort = 0;
+    bool m_reusePort = false;
+    TcpListenerGroup *m_logSink = nullptr;  // 为空时不转发连接日志
+};
+
+/**
+ * @brief 多接入线程监听组：每个接入线程拥有自己的事件循环和监听套接字
+ * @note 支持SO_REUSEPORT的平台（Linux）上各监听套接字绑定同一端口，由内核把新连接分摊到各接入线程；
+ *       其他平台退化为单个接入线程。接入线程数可通过环境变量 BOOKMALL_ACCEPT_THREADS 配置，
+ *       接受连接不再经过界面线程
+ */
+class TcpListenerGroup : public QObject
+{
+    Q_OBJECT
+public:
+    enum { MAX_ACCEPT_THREADS = 4 };  // 默认接入线程数上限（未配置环境变量时取CPU核数与该值的较小者）
+
+    explicit TcpListenerGroup(QObject *parent = nullptr);
+    ~TcpListenerGroup() override;
+
+    // 启动全部接入线程，任一监听失败时全部停止并返回false
+    bool start(const QHostAddress &address, quint16 port);
+    void stop();
+    bool isListening() const { return !m_acceptors.isEmpty(); }
+    // 是否把连接日志转发到本对象所在线程（无界面且不输出日志时关闭，日志不再经过主线程）
+    void setLogForwarding(bool enabled) { m_forwardLogs = enabled; }
+    int acceptorCount() const { return m_acceptors.size(); }
+    QString errorString() const { return m_error; }
+
+    static bool reusePortSupported();
+
+signals:
+    void dataReceived(const QString& clientIp, quint16 clientPort, const QString& data);
+    void logGenerated(const QString& log);
+
+private:
+    struct Acceptor {
+        QThread* thread;
+        TcpServer* server;
+    };
+
+    bool startAcceptor(int index, const QHostAddress &address, quint16 port, bool reusePort);
+
+    QList<Acceptor> m_acceptors;
+    QString m_error;
+    bool m_forwardLogs = true;
 };
 
 #endif // TCPSERVER_H
@@ -1,10 +1,92 @@
 #include "threadpool.h"
+#include "servermetrics.h"
+#include <QElapsedTimer>
+#include <QDebug>
 
-// 线程池构造函数：初始化线程池并设置最大线程数
-ThreadPool::ThreadPool(QObject *parent) : QObject(parent)
+// 排队计时包装：记录任务从提交到开始执行的等待时间，waitLimitMs大于0时超时的任务改为runExpired()
+class QueuedTask : public QRunnable
+{
+public:
+    QueuedTask(Task* task, QAtomicInt* queued, int waitLimitMs = 0)
+        : m_task(task), m_queued(queued), m_waitLimitMs(waitLimitMs)
+    {
+        m_enqueued.start();
+        ServerMetrics::getInstance().taskQueued();
+    }
+
+    void run() override
+    {
+        m_queued->deref();
+        const qint64 waitedUs = m_enqueued.nsecsElapsed() / 1000;
+        ServerMetrics::getInstance().taskStarted(waitedUs);
+        if (m_waitLimitMs > 0 && waitedUs > qint64(m_waitLimitMs) * 1000) {
+            ServerMetrics::getInstance().taskRejected();
+            m_task->runExpired();
+        } else {
+            m_task->run();
+        }
+        if (m_task->autoDelete()) {
+            delete m_task;
+        }
+    }
+
+private:
+    Task* m_task;
+    QAtomicInt* m_queued;
+    int m_waitLimitMs;
+    QElapsedTimer m_enqueued;
+};
+
+// 后台任务包装：结束（执行完或排空时被丢弃）后释放key，同一任务才能再次提交
+class BackgroundTask : public QRunnable
+{
+public:
+    BackgroundTask(const QString& key, Task* task, QMutex* mutex, QSet<QString>* pending)
+        : m_key(key), m_task(task), m_mutex(mutex), m_pending(pending)
+    {
+    }
+
+    ~BackgroundTask() override
+    {
+        if (m_task->autoDelete()) {
+            delete m_task;
+        }
+        QMutexLocker locker(m_mutex);
+        m_pending->remove(m_key);
+    }
+
+    void run() override
+    {
+        m_task->run();
+    }
+
+private:
+    QString m_key;
+    Task* m_task;
+    QMutex* m_mutex;
+    QSet<QString>* m_pending;
+};
+
+// 读取正整数环境变量，未设置或无效时返回默认值
+static int envInt(const char* name, int defaultValue)
+{
+    bool ok = false;
+    int value = qEnvironmentVariableIntValue(name, &ok);
+    return ok && value > 0 ? value : defaultValue;
+}
+
+// 线程池构造函数：初始化线程池并设置最大线程数和队列上限
+ThreadPool::ThreadPool(QObject *parent) : QObject(parent), m_queued(0)
 {
     m_pool = QThreadPool::globalInstance();  // 获取Qt全局线程池实例
-    m_pool->setMaxThreadCount(10);  // 设置最大线程数（可根据服务器性能调整）
+    m_pool->setMaxThreadCount(envInt("BOOKMALL_WORKER_THREADS", DEFAULT_MAX_THREADS));
+    m_queueLimit = envInt("BOOKMALL_TASK_QUEUE_LIMIT", DEFAULT_QUEUE_LIMIT);
+    m_queueWaitMs = envInt("BOOKMALL_TASK_QUEUE_WAIT_MS", DEFAULT_QUEUE_WAIT_MS);
+    m_backgroundPool = new QThreadPool(this);
+    m_backgroundPool->setMaxThreadCount(envInt("BOOKMALL_BACKGROUND_THREADS", DEFAULT_BACKGROUND_THREADS));
+    qDebug() << "✓ 线程池最大线程数:" << m_pool->maxThreadCount() << "排队上限:" << m_queueLimit
+             << "排队时限(ms):" << m_queueWaitMs
+             << "后台线程数:" << m_backgroundPool->maxThreadCount();
 }
 
 // 单例实例获取：静态局部变量确保唯一实例
@@ -17,5 +99,77 @@ ThreadPool& ThreadPool::getInstance()
 // 添加任务到线程池：线程池会自动分配线程执行任务的run()方法
 void ThreadPool::addTask(Task *task)
 {
-    m_pool->start(task);  // 提交任务到线程池队列
+    m_queued.ref();
+    m_pool->start(new QueuedTask(task, &m_queued));  // 提交到线程池队列（包装后自动删除）
+}
+
+bool ThreadPool::tryAddTask(Task *task)
+{
+    // 先占一个排队名额，避免并发提交同时越过上限
+    int queued = m_queued.load();
+    do {
+        if (queued >= m_queueLimit) {
+            ServerMetrics::getInstance().taskRejected();
+            return false;
+        }
+    } while (!m_queued.testAndSetOrdered(queued, queued + 1, queued));
+
+    m_pool->start(new QueuedTask(task, &m_queued, m_queueWaitMs));
+    return true;
+}
+
+bool ThreadPool::addBackgroundTask(const QString &key, Task *task)
+{
+    {
+        QMutexLocker locker(&m_backgroundMutex);
+        if (m_backgroundPending.contains(key)) {
+            locker.unlock();
+            if (task->autoDelete()) {
+                delete task;
+            }
+            return false;  // 上一次同类任务尚未结束
+        }
+        m_backgroundPending.insert(key);
+    }
+    m_backgroundPool->start(new BackgroundTask(key, task, &m_backgroundMutex, &m_backgroundPending));
+    return true;
+}
+
+int ThreadPool::activeThreadCount() const
+{
+    return m_pool->activeThreadCount();
+}
+
+int ThreadPool::maxThreadCount() const
+{
+    return m_pool->maxThreadCount();
+}
+
+int ThreadPool::queuedTaskCount() const
+{
+    return m_queued.load();
+}
+
+bool ThreadPool::isOverloaded() const
+{
+    return m_pool->activeThreadCount() >= m_pool->maxThreadCount()
+           && m_queued.load() * 2 >= m_queueLimit;
+}
+
+int ThreadPool::retryAfterMs() const
+{
+    // 排队越长等待越久：每多一轮（maxThreadCount个任务）加一个基础间隔
+    const int rounds = m_queued.load() / qMax(1, m_pool->maxThreadCount());
+    return qMin(int(RETRY_AFTER_MAX_MS), int(RETRY_AFTER_BASE_MS) * (rounds + 1));
+}
+
+bool ThreadPool::waitForDone(int msecs)
+{
+    // 还没开始的维护任务不必在退出前执行，下次启动会重新调度
+    m_backgroundPool->clear();
+    QElapsedTimer timer;
+    timer.start();
+    const bool connectionsDone = m_pool->waitForDone(msecs);
+    const int remaining = qMax(0, msecs - int(timer.elapsed()));
+    return m_backgroundPool->waitForDone(remaining) && connectionsDone;
 }
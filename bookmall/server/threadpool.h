@@ -4,6 +4,9 @@
 #include <QThreadPool>
 #include <QRunnable>
 #include <QObject>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QSet>
 
 // 通用任务基类，所有线程池任务需继承此类并实现run()方法
 class Task : public QRunnable
@@ -11,22 +14,58 @@ class Task : public QRunnable
 public:
     explicit Task() = default;  // 默认构造函数
     ~Task() override = default; // 析构函数，override确保重写父类方法
+    // 准入的任务在队列中等待超过排队时限时代替run()调用；默认照常执行
+    virtual void runExpired() { run(); }
 };
 
 // 线程池单例类，管理所有客户端请求的线程资源
+// 线程数、队列上限和排队时限可通过环境变量 BOOKMALL_WORKER_THREADS、BOOKMALL_TASK_QUEUE_LIMIT、
+// BOOKMALL_TASK_QUEUE_WAIT_MS 配置
+// 后台维护任务（推荐重建、计数校对、日志归档）使用独立的小线程池（BOOKMALL_BACKGROUND_THREADS），
+// 连接占满工作线程时仍能执行，也不计入连接的排队上限
 class ThreadPool : public QObject
 {
     Q_OBJECT
 public:
+    enum {
+        DEFAULT_MAX_THREADS = 10,
+        DEFAULT_QUEUE_LIMIT = 64,
+        DEFAULT_QUEUE_WAIT_MS = 5000,  // 排队超过该时长的连接不再处理，回复繁忙后断开
+        DEFAULT_BACKGROUND_THREADS = 2,
+        RETRY_AFTER_BASE_MS = 500,   // 建议客户端重试的基础等待时间
+        RETRY_AFTER_MAX_MS = 10000
+    };
+
     // 获取单例实例（全局唯一）
     static ThreadPool& getInstance();
-    // 向线程池添加任务（线程池自动调度执行）
+    // 向线程池添加任务（线程池自动调度执行），不受队列上限约束，用于服务器内部任务
     void addTask(Task* task);
+    // 准入控制：排队任务已达上限时拒绝并返回false，task仍归调用方所有；
+    // 已准入的任务排队超过时限时改为执行task->runExpired()
+    bool tryAddTask(Task* task);
+    // 提交后台维护任务：同一key的任务还在排队或执行时不重复提交，返回false并删除task
+    bool addBackgroundTask(const QString& key, Task* task);
+    // 线程池状态（用于运行指标和过载判断）
+    int activeThreadCount() const;
+    int maxThreadCount() const;
+    int queuedTaskCount() const;
+    int queueLimit() const { return m_queueLimit; }
+    int queueWaitLimitMs() const { return m_queueWaitMs; }
+    bool isOverloaded() const;  // 线程已全部占用且排队任务超过上限的一半
+    int retryAfterMs() const;   // 按当前排队长度估算的建议重试间隔
+    // 等待所有任务执行完毕（服务器退出时排空），尚未开始的后台任务直接丢弃，超时返回false
+    bool waitForDone(int msecs);
 
 private:
     // 私有构造函数（单例模式禁止外部实例化）
     explicit ThreadPool(QObject *parent = nullptr);
     QThreadPool* m_pool;  // Qt内置线程池对象
+    int m_queueLimit;
+    int m_queueWaitMs;
+    QAtomicInt m_queued;  // 已提交、尚未开始执行的任务数
+    QThreadPool* m_backgroundPool;  // 后台维护任务专用线程池
+    QMutex m_backgroundMutex;
+    QSet<QString> m_backgroundPending;  // 排队或执行中的后台任务key
 };
 
 #endif // THREADPOOL_H
@@ -0,0 +1,199 @@
+#include "trafficcapture.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QDebug>
+
+// 响应中签发、回放时需要换成新值的标识字段（回放端按录制值 -> 回放值替换之后请求中的同值字符串）
+static const char* const kIssuedKeys[] = {"token", "orderId"};
+
+TrafficCapture::TrafficCapture() : m_lastFlushUs(0), m_maxBytes(0)
+{
+    m_clock.start();
+
+    const QString path = QString::fromLocal8Bit(qgetenv("BOOKMALL_CAPTURE_FILE"));
+    if (path.isEmpty()) {
+        return;
+    }
+    bool ok = false;
+    int maxMb = qEnvironmentVariableIntValue("BOOKMALL_CAPTURE_MAX_MB", &ok);
+    if (!ok || maxMb <= 0) {
+        maxMb = DEFAULT_MAX_MB;
+    }
+    m_maxBytes = qint64(maxMb) * 1024 * 1024;
+
+    if (open(path)) {
+        m_enabled.storeRelease(1);
+        qDebug() << "✓ 流量录制已启用:" << path << "上限" << maxMb << "MB";
+    }
+}
+
+TrafficCapture::~TrafficCapture()
+{
+    stop();
+}
+
+TrafficCapture& TrafficCapture::getInstance()
+{
+    static TrafficCapture instance;
+    return instance;
+}
+
+bool TrafficCapture::open(const QString& path)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "❌ 无法创建流量录制文件:" << path << m_file.errorString();
+        return false;
+    }
+
+    QByteArray header;
+    QDataStream ds(&header, QIODevice::WriteOnly);
+    ds.setByteOrder(QDataStream::BigEndian);
+    ds.writeRawData("BMCP", 4);
+    ds << quint16(FORMAT_VERSION) << quint16(0) << quint64(QDateTime::currentMSecsSinceEpoch());
+    if (m_file.write(header) != header.size()) {
+        qWarning() << "❌ 写入流量录制文件头失败:" << m_file.errorString();
+        m_file.close();
+        return false;
+    }
+    m_file.flush();
+    return true;
+}
+
+QByteArray TrafficCapture::recordHeader(RecordType type, quint32 connectionId, qint64 timeUs)
+{
+    QByteArray record;
+    QDataStream ds(&record, QIODevice::WriteOnly);
+    ds.setByteOrder(QDataStream::BigEndian);
+    ds << quint8(type) << connectionId << quint64(qMax<qint64>(0, timeUs));
+    return record;
+}
+
+quint32 TrafficCapture::connectionOpened()
+{
+    if (!isEnabled()) {
+        return 0;
+    }
+    const quint32 connectionId = quint32(m_nextConnectionId.fetchAndAddOrdered(1) + 1);
+    append(recordHeader(RecordOpen, connectionId, nowUs()));
+    return connectionId;
+}
+
+void TrafficCapture::connectionClosed(quint32 connectionId)
+{
+    if (connectionId == 0 || !isEnabled()) {
+        return;
+    }
+    append(recordHeader(RecordClose, connectionId, nowUs()));
+}
+
+void TrafficCapture::requestHandled(quint32 connectionId, qint64 receivedUs, const QByteArray& payload,
+                                    const QJsonObject& response)
+{
+    if (connectionId == 0 || !isEnabled()) {
+        return;
+    }
+    const qint64 serviceUs = nowUs() - receivedUs;
+
+    quint8 flags = 0;
+    if (response.value("success").toBool()) {
+        flags |= 0x01;
+    }
+    if (response.value("serverBusy").toBool()) {
+        flags |= 0x02;
+    }
+
+    QByteArray issued;
+    if (response.value("success").toBool()) {
+        QJsonObject ids;
+        for (const char* key : kIssuedKeys) {
+            const QString value = response.value(QLatin1String(key)).toString();
+            if (!value.isEmpty()) {
+                ids[QLatin1String(key)] = value;
+            }
+        }
+        if (!ids.isEmpty()) {
+            issued = QJsonDocument(ids).toJson(QJsonDocument::Compact).left(0xffff);
+        }
+    }
+
+    QByteArray record = recordHeader(RecordRequest, connectionId, receivedUs);
+    QDataStream ds(&record, QIODevice::WriteOnly | QIODevice::Append);
+    ds.setByteOrder(QDataStream::BigEndian);
+    ds << quint32(qBound<qint64>(0, serviceUs, 0xffffffffLL)) << flags;
+    ds << quint32(payload.size());
+    ds.writeRawData(payload.constData(), payload.size());
+    ds << quint16(issued.size());
+    ds.writeRawData(issued.constData(), issued.size());
+    append(record);
+}
+
+void TrafficCapture::append(const QByteArray& record)
+{
+    QByteArray full;
+    {
+        QMutexLocker locker(&m_bufferMutex);
+        if (!isEnabled()) {
+            return;
+        }
+        m_buffer += record;
+        const qint64 now = nowUs();
+        if (m_buffer.size() < CAPTURE_BLOCK_BYTES && now - m_lastFlushUs < 1000000) {
+            return;
+        }
+        full.swap(m_buffer);
+        m_lastFlushUs = now;
+    }
+    // 压缩和写文件在缓冲区锁之外进行，其他连接可以继续追加记录
+    writeBlock(full);
+}
+
+void TrafficCapture::writeBlock(const QByteArray& records)
+{
+    if (records.isEmpty()) {
+        return;
+    }
+    const QByteArray block = qCompress(records, 6);
+
+    QMutexLocker locker(&m_fileMutex);
+    if (!m_file.isOpen()) {
+        return;
+    }
+    QByteArray length;
+    QDataStream ds(&length, QIODevice::WriteOnly);
+    ds.setByteOrder(QDataStream::BigEndian);
+    ds << quint32(block.size());
+    if (m_file.write(length) != length.size() || m_file.write(block) != block.size()) {
+        qWarning() << "❌ 写入流量录制文件失败，停止录制:" << m_file.errorString();
+        m_enabled.storeRelease(0);
+        m_file.close();
+        return;
+    }
+    m_file.flush();
+    if (m_file.size() >= m_maxBytes) {
+        qWarning() << "❌ 流量录制文件已达上限，停止录制:" << m_file.fileName();
+        m_enabled.storeRelease(0);
+        m_file.close();
+    }
+}
+
+void TrafficCapture::stop()
+{
+    QByteArray rest;
+    {
+        QMutexLocker locker(&m_bufferMutex);
+        if (!isEnabled() && m_buffer.isEmpty()) {
+            return;
+        }
+        m_enabled.storeRelease(0);
+        rest.swap(m_buffer);
+    }
+    writeBlock(rest);
+
+    QMutexLocker locker(&m_fileMutex);
+    if (m_file.isOpen()) {
+        m_file.close();
+        qDebug() << "✓ 流量录制已结束:" << m_file.fileName();
+    }
+}
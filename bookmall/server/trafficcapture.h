@@ -0,0 +1,85 @@
+#ifndef TRAFFICCAPTURE_H
+#define TRAFFICCAPTURE_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+
+/**
+ * @brief 流量录制（单例），供bookmall-bench --replay按原始节奏回放
+ * @note 设置BOOKMALL_CAPTURE_FILE（或配置文件[capture] file）后启用：TcpFileTask::run把每个连接的
+ *       建立/断开和收到的每一帧请求（原始JSON、单调时钟时间戳、服务端处理耗时、响应是否成功）
+ *       写入录制文件。记录先追加到内存缓冲区，满CAPTURE_BLOCK_BYTES或超过1秒时整块qCompress压缩写入，
+ *       不在请求线程中逐条写文件；文件超过BOOKMALL_CAPTURE_MAX_MB（默认1024）后停止录制。
+ *       录制文件包含登录密码和token，只应在测试环境中使用。
+ *
+ *       文件格式（大端）：
+ *         文件头：魔数"BMCP" | u16 版本(1) | u16 保留 | u64 录制开始时间(毫秒，UTC)
+ *         之后为若干块：u32 压缩后长度 | qCompress(记录...)
+ *         记录：u8 类型 | u32 连接ID | u64 相对录制开始的微秒数(单调时钟)
+ *           RecordOpen/RecordClose：无附加字段
+ *           RecordRequest：u32 处理耗时(微秒) | u8 标志(bit0成功, bit1繁忙拒绝)
+ *                          | u32 长度+请求JSON | u16 长度+响应中签发的标识(JSON：token/orderId)
+ *       请求记录在响应发出后写入，时间戳为收到完整帧的时间；不同连接的记录可能乱序，回放时按时间排序。
+ */
+class TrafficCapture
+{
+public:
+    static TrafficCapture& getInstance();
+
+    enum RecordType {
+        RecordOpen = 1,
+        RecordRequest = 2,
+        RecordClose = 3
+    };
+
+    enum {
+        FORMAT_VERSION = 1,
+        CAPTURE_BLOCK_BYTES = 256 * 1024,
+        DEFAULT_MAX_MB = 1024
+    };
+
+    bool isEnabled() const { return m_enabled.loadAcquire() != 0; }
+
+    // 相对录制开始的微秒数（单调时钟）
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+
+    // 连接建立时分配连接ID并记录；未启用时返回0
+    quint32 connectionOpened();
+    void connectionClosed(quint32 connectionId);
+
+    // 一帧请求处理完成：receivedUs为收到完整帧时的nowUs()
+    void requestHandled(quint32 connectionId, qint64 receivedUs, const QByteArray& payload, const QJsonObject& response);
+
+    // 写出缓冲区中剩余的记录并关闭文件（服务器退出时调用）
+    void stop();
+
+private:
+    TrafficCapture();
+    ~TrafficCapture();
+    TrafficCapture(const TrafficCapture&) = delete;
+    TrafficCapture& operator=(const TrafficCapture&) = delete;
+
+    bool open(const QString& path);
+    void append(const QByteArray& record);
+    void writeBlock(const QByteArray& records);
+    static QByteArray recordHeader(RecordType type, quint32 connectionId, qint64 timeUs);
+
+    QAtomicInt m_enabled;
+    QAtomicInt m_nextConnectionId;
+    QElapsedTimer m_clock;
+
+    QMutex m_bufferMutex;  // 保护m_buffer和m_lastFlushUs
+    QByteArray m_buffer;
+    qint64 m_lastFlushUs;
+
+    QMutex m_fileMutex;    // 压缩后的块按整块写入，不与其他线程交错
+    QFile m_file;
+    qint64 m_maxBytes;
+};
+
+#endif // TRAFFICCAPTURE_H